@@ -0,0 +1,13 @@
+//
+//  GWMCompatCoreSpotlight.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// GWMDataItem only refers to these classes by pointer
+@class CSSearchableItemAttributeSet;
+@class CSSearchableItem;
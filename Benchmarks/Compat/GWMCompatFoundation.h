@@ -0,0 +1,10 @@
+//
+//  GWMCompatFoundation.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <dispatch/dispatch.h>
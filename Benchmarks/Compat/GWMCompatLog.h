@@ -0,0 +1,15 @@
+//
+//  GWMCompatLog.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+// os_log is not available outside Apple platforms, messages go to NSLog and debug messages are dropped
+#define OS_LOG_DEFAULT NULL
+#define os_log(log, format, ...) NSLog(@format, ##__VA_ARGS__)
+#define os_log_error(log, format, ...) NSLog(@format, ##__VA_ARGS__)
+#define os_log_debug(log, format, ...) do { } while (0)
@@ -0,0 +1,9 @@
+//
+//  GWMCompatRuntime.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import <objc/runtime.h>
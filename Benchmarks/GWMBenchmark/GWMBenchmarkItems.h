@@ -0,0 +1,75 @@
+//
+//  GWMBenchmarkItems.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMRelationshipItem.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///@brief Represents the 'score' column of the benchmark item table.
+extern GWMColumnName const GWMBenchmarkColumnScore;
+///@brief Represents the 'quantity' column of the benchmark item table.
+extern GWMColumnName const GWMBenchmarkColumnQuantity;
+///@brief Represents the 'isActive' column of the benchmark item table.
+extern GWMColumnName const GWMBenchmarkColumnIsActive;
+///@brief Represents the 'dueDate' column of the benchmark item table.
+extern GWMColumnName const GWMBenchmarkColumnDueDate;
+///@brief Represents the 'firstSeen' column of the benchmark item table.
+extern GWMColumnName const GWMBenchmarkColumnFirstSeen;
+
+///@discussion The table GWMBenchmarkItem is mapped to.
+extern GWMTableName const GWMBenchmarkItemTable;
+///@discussion The table GWMBenchmarkRelationshipItem is mapped to.
+extern GWMTableName const GWMBenchmarkRelationshipTable;
+
+/*!
+ * @discussion Sets the controller returned by the databaseController of every benchmark item.
+ * @param databaseController The controller the benchmark is running against.
+ */
+FOUNDATION_EXTERN void GWMBenchmarkSetDatabaseController(GWMDatabaseController *_Nullable databaseController);
+
+/*!
+ * @class GWMBenchmarkItem
+ * @discussion A GWMDataItem with a real, an integer, a boolean, a date and time and a historic date column next to the columns of GWMDataItem, so mapping a row exercises every converter.
+ */
+@interface GWMBenchmarkItem : GWMDataItem
+
+@property (nonatomic, assign) double score;
+@property (nonatomic, assign) NSInteger quantity;
+@property (nonatomic, assign) BOOL isActive;
+@property (nonatomic, strong) NSDate *_Nullable dueDate;
+@property (nonatomic, strong) NSDate *_Nullable firstSeen;
+///@discussion The number of relationships of the item, selected with the list columns.
+@property (nonatomic, assign) NSInteger relationshipCount;
+
+/*!
+ * @discussion Returns the values of a generated row.
+ * @param index The index of the row. The same index always gives the same values.
+ * @return An NSDictionary where the key is the column.
+ */
++(NSDictionary<GWMColumnName,id> *)rowValuesWithIndex:(NSUInteger)index;
+
+@end
+
+/*!
+ * @class GWMBenchmarkRelationshipItem
+ * @discussion A GWMRelationshipItem between two benchmark items.
+ */
+@interface GWMBenchmarkRelationshipItem : GWMRelationshipItem
+
+/*!
+ * @discussion Returns the values of a generated row.
+ * @param dataItemID The pKey of the item.
+ * @param relatedDataItemID The pKey of the related item.
+ * @return An NSDictionary where the key is the column.
+ */
++(NSDictionary<GWMColumnName,id> *)rowValuesWithDataItemID:(NSInteger)dataItemID relatedDataItemID:(NSInteger)relatedDataItemID;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,88 @@
+//
+//  GWMBenchmarkItems.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMBenchmarkItems.h"
+#import "GWMDatabaseController.h"
+
+GWMColumnName const GWMBenchmarkColumnScore = @"score";
+GWMColumnName const GWMBenchmarkColumnQuantity = @"quantity";
+GWMColumnName const GWMBenchmarkColumnIsActive = @"isActive";
+GWMColumnName const GWMBenchmarkColumnDueDate = @"dueDate";
+GWMColumnName const GWMBenchmarkColumnFirstSeen = @"firstSeen";
+
+GWMTableName const GWMBenchmarkItemTable = @"benchmarkItems";
+GWMTableName const GWMBenchmarkRelationshipTable = @"benchmarkRelationships";
+
+static GWMDatabaseController *GWMBenchmarkDatabaseController = nil;
+
+void GWMBenchmarkSetDatabaseController(GWMDatabaseController *databaseController)
+{
+    GWMBenchmarkDatabaseController = databaseController;
+}
+
+@implementation GWMBenchmarkItem
+
+-(GWMDatabaseController *)databaseController
+{
+    return GWMBenchmarkDatabaseController;
+}
+
++(NSString *)tableAlias
+{
+    return @"BI";
+}
+
++(NSArray<GWMColumnDefinition*>*)columnDefinitionItems
+{
+    NSString *className = NSStringFromClass([self class]);
+    NSMutableArray<GWMColumnDefinition*> *mutableDefinitions = [NSMutableArray arrayWithArray:[super columnDefinitionItems]];
+    [mutableDefinitions addObjectsFromArray:@[[GWMColumnDefinition columnDefinitionWithName:GWMBenchmarkColumnScore affinity:GWMColumnAffinityReal defaultValue:nil property:NSStringFromSelector(@selector(score)) include:GWMColumnIncludeInList | GWMColumnIncludeInDetail options:GWMColumnOptionNone className:className sequence:3],
+                                              [GWMColumnDefinition columnDefinitionWithName:GWMBenchmarkColumnQuantity affinity:GWMColumnAffinityInteger defaultValue:nil property:NSStringFromSelector(@selector(quantity)) include:GWMColumnIncludeInList | GWMColumnIncludeInDetail options:GWMColumnOptionNone className:className sequence:4],
+                                              [GWMColumnDefinition columnDefinitionWithName:GWMBenchmarkColumnIsActive affinity:GWMColumnAffinityBoolean defaultValue:nil property:NSStringFromSelector(@selector(isActive)) include:GWMColumnIncludeInList | GWMColumnIncludeInDetail options:GWMColumnOptionNone className:className sequence:5],
+                                              [GWMColumnDefinition columnDefinitionWithName:GWMBenchmarkColumnDueDate affinity:GWMColumnAffinityDateTime defaultValue:nil property:NSStringFromSelector(@selector(dueDate)) include:GWMColumnIncludeInList | GWMColumnIncludeInDetail options:GWMColumnOptionNone className:className sequence:6],
+                                              [GWMColumnDefinition columnDefinitionWithName:GWMBenchmarkColumnFirstSeen affinity:GWMColumnAffinityHistoricDateTime defaultValue:nil property:NSStringFromSelector(@selector(firstSeen)) include:GWMColumnIncludeInList | GWMColumnIncludeInDetail options:GWMColumnOptionNone className:className sequence:7]]];
+    return [NSArray arrayWithArray:mutableDefinitions];
+}
+
++(NSArray<GWMAggregateDefinition*>*)aggregateDefinitionItems
+{
+    return @[[GWMAggregateDefinition aggregateDefinitionWithProperty:NSStringFromSelector(@selector(relationshipCount)) function:GWMAggregateCount column:nil table:GWMBenchmarkRelationshipTable foreignKeyColumn:GWMTableColumnDataItemKey include:GWMColumnIncludeInList collectionKey:nil]];
+}
+
++(NSDictionary<GWMColumnName,id> *)rowValuesWithIndex:(NSUInteger)index
+{
+    // spread the dates over about thirty years so they do not all share a prefix
+    NSDate *dueDate = [NSDate dateWithTimeIntervalSince1970:946684800 + (NSTimeInterval)((index * 7919) % 946080000)];
+    NSDate *firstSeen = [NSDate dateWithTimeIntervalSince1970:-631152000 + (NSTimeInterval)((index * 104729) % 1262304000)];
+
+    return @{GWMTableColumnName: [NSString stringWithFormat:@"Item %lu", (unsigned long)index],
+             GWMTableColumnDescription: [NSString stringWithFormat:@"Generated benchmark item number %lu", (unsigned long)index],
+             GWMBenchmarkColumnScore: @((double)(index % 1000) / 10.0),
+             GWMBenchmarkColumnQuantity: @(index % 97),
+             GWMBenchmarkColumnIsActive: @(index % 3 != 0),
+             GWMBenchmarkColumnDueDate: dueDate,
+             GWMBenchmarkColumnFirstSeen: firstSeen};
+}
+
+@end
+
+@implementation GWMBenchmarkRelationshipItem
+
+-(GWMDatabaseController *)databaseController
+{
+    return GWMBenchmarkDatabaseController;
+}
+
++(NSDictionary<GWMColumnName,id> *)rowValuesWithDataItemID:(NSInteger)dataItemID relatedDataItemID:(NSInteger)relatedDataItemID
+{
+    return @{GWMTableColumnDataItemKey: @(dataItemID),
+             GWMTableColumnRelatedDataItemKey: @(relatedDataItemID),
+             GWMTableColumnRelationshipKey: @(dataItemID % 5)};
+}
+
+@end
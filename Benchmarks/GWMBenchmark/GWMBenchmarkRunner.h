@@ -0,0 +1,64 @@
+//
+//  GWMBenchmarkRunner.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+///@discussion The largest resident set size of the process so far, in bytes.
+FOUNDATION_EXTERN NSUInteger GWMBenchmarkPeakResidentBytes(void);
+///@discussion The current resident set size of the process, in bytes, or 0 if it cannot be read.
+FOUNDATION_EXTERN NSUInteger GWMBenchmarkResidentBytes(void);
+
+/*!
+ * @class GWMBenchmarkRunner
+ * @discussion Times benchmarks and collects their results. Every benchmark is reported with its number of operations, wall time, operations per second, latency percentiles and the peak resident set size of the process when it finished. Times are in seconds. Operations are timed one at a time, except for batches, which are timed as a whole.
+ */
+@interface GWMBenchmarkRunner : NSObject
+
+///@discussion The results so far, in the order the benchmarks ran.
+@property (nonatomic, readonly) NSArray<NSDictionary<NSString*,id>*> *results;
+
+/*!
+ * @discussion Runs an operation a number of times and times each run.
+ * @param name The name of the benchmark.
+ * @param operations The number of times to run block.
+ * @param block The operation. idx counts from 0.
+ */
+-(void)measureName:(NSString *)name operations:(NSUInteger)operations block:(void (^)(NSUInteger idx))block;
+/*!
+ * @discussion Runs an operation on several threads at once and times each run.
+ * @param name The name of the benchmark.
+ * @param threads The number of threads.
+ * @param operations The number of times each thread runs block.
+ * @param block The operation. thread counts from 0 and idx counts from 0 on every thread.
+ */
+-(void)measureName:(NSString *)name threads:(NSUInteger)threads operations:(NSUInteger)operations block:(void (^)(NSUInteger thread, NSUInteger idx))block;
+/*!
+ * @discussion Runs a batch once and times it as a whole, such as a bulk insert.
+ * @param name The name of the benchmark.
+ * @param operations The number of operations in the batch, used for operations per second.
+ * @param block The batch.
+ */
+-(void)measureName:(NSString *)name batchOperations:(NSUInteger)operations block:(dispatch_block_t)block;
+/*!
+ * @discussion Adds values to the result of the most recent benchmark with a name.
+ * @param info Values that can be written as JSON.
+ * @param name The name of the benchmark.
+ */
+-(void)addInfo:(NSDictionary<NSString*,id> *)info toResultNamed:(NSString *)name;
+/*!
+ * @discussion Returns the report of every benchmark.
+ * @param environment A description of the run, such as the SQLite version and the size of the tables.
+ * @return An NSDictionary with an environment entry and a benchmarks entry that can be written as JSON.
+ */
+-(NSDictionary<NSString*,id> *)reportWithEnvironment:(NSDictionary<NSString*,id> *)environment;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,196 @@
+//
+//  GWMBenchmarkRunner.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMBenchmarkRunner.h"
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+NSUInteger GWMBenchmarkPeakResidentBytes(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    return (NSUInteger)usage.ru_maxrss;
+#else
+    // kilobytes on Linux
+    return (NSUInteger)usage.ru_maxrss * 1024;
+#endif
+}
+
+NSUInteger GWMBenchmarkResidentBytes(void)
+{
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+        return 0;
+
+    return (NSUInteger)info.resident_size;
+#else
+    FILE *file = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0, residentPages = 0;
+
+    if (file == NULL)
+        return 0;
+
+    int count = fscanf(file, "%lu %lu", &pages, &residentPages);
+    fclose(file);
+
+    return count == 2 ? (NSUInteger)residentPages * (NSUInteger)sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+static uint64_t GWMBenchmarkNanoseconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+static int GWMBenchmarkCompareLatencies(const void *latency1, const void *latency2)
+{
+    uint64_t value1 = *(const uint64_t *)latency1;
+    uint64_t value2 = *(const uint64_t *)latency2;
+    return value1 < value2 ? -1 : (value1 > value2 ? 1 : 0);
+}
+
+@interface GWMBenchmarkRunner ()
+
+@property (nonatomic, strong) NSMutableArray<NSMutableDictionary<NSString*,id>*> *mutableResults;
+
+@end
+
+@implementation GWMBenchmarkRunner
+
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _mutableResults = [NSMutableArray new];
+    }
+    return self;
+}
+
+-(NSArray<NSDictionary<NSString*,id>*> *)results
+{
+    return [NSArray arrayWithArray:self.mutableResults];
+}
+
+#pragma mark - Measuring
+
+-(void)measureName:(NSString *)name operations:(NSUInteger)operations block:(void (^)(NSUInteger idx))block
+{
+    [self measureName:name threads:1 operations:operations block:^(NSUInteger thread, NSUInteger idx){
+        block(idx);
+    }];
+}
+
+-(void)measureName:(NSString *)name threads:(NSUInteger)threads operations:(NSUInteger)operations block:(void (^)(NSUInteger thread, NSUInteger idx))block
+{
+    NSUInteger totalOperations = threads * operations;
+    uint64_t *latencies = calloc(MAX(totalOperations, 1), sizeof(uint64_t));
+
+    uint64_t start = GWMBenchmarkNanoseconds();
+
+    // each thread writes its own part of latencies
+    dispatch_apply(threads, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t thread){
+        uint64_t *threadLatencies = latencies + thread * operations;
+        for (NSUInteger idx = 0; idx < operations; idx++) {
+            @autoreleasepool {
+                uint64_t operationStart = GWMBenchmarkNanoseconds();
+                block(thread, idx);
+                threadLatencies[idx] = GWMBenchmarkNanoseconds() - operationStart;
+            }
+        }
+    });
+
+    uint64_t elapsed = GWMBenchmarkNanoseconds() - start;
+
+    [self addResultWithName:name threads:threads operations:totalOperations elapsed:elapsed latencies:latencies];
+
+    free(latencies);
+}
+
+-(void)measureName:(NSString *)name batchOperations:(NSUInteger)operations block:(dispatch_block_t)block
+{
+    uint64_t start = GWMBenchmarkNanoseconds();
+
+    @autoreleasepool {
+        block();
+    }
+
+    uint64_t elapsed = GWMBenchmarkNanoseconds() - start;
+
+    [self addResultWithName:name threads:1 operations:operations elapsed:elapsed latencies:NULL];
+}
+
+#pragma mark - Results
+
+-(void)addResultWithName:(NSString *)name threads:(NSUInteger)threads operations:(NSUInteger)operations elapsed:(uint64_t)elapsed latencies:(uint64_t *)latencies
+{
+    NSMutableDictionary<NSString*,id> *mutableResult = [NSMutableDictionary new];
+    double seconds = elapsed / 1e9;
+
+    mutableResult[@"name"] = name;
+    mutableResult[@"threads"] = @(threads);
+    mutableResult[@"operations"] = @(operations);
+    mutableResult[@"seconds"] = @(seconds);
+    mutableResult[@"operationsPerSecond"] = @(seconds > 0 ? operations / seconds : 0.0);
+    mutableResult[@"peakResidentBytes"] = @(GWMBenchmarkPeakResidentBytes());
+
+    if (latencies != NULL && operations > 0) {
+
+        qsort(latencies, operations, sizeof(uint64_t), GWMBenchmarkCompareLatencies);
+
+        uint64_t total = 0;
+        for (NSUInteger idx = 0; idx < operations; idx++)
+            total += latencies[idx];
+
+        // nearest rank
+        double (^percentile)(double) = ^double(double fraction){
+            NSUInteger rank = (NSUInteger)ceil(fraction * operations);
+            return latencies[rank > 0 ? rank - 1 : 0] / 1e9;
+        };
+
+        mutableResult[@"latency"] = @{@"mean": @((double)total / operations / 1e9),
+                                      @"p50": @(percentile(0.50)),
+                                      @"p90": @(percentile(0.90)),
+                                      @"p99": @(percentile(0.99)),
+                                      @"max": @(latencies[operations - 1] / 1e9)};
+    }
+
+    [self.mutableResults addObject:mutableResult];
+
+    fprintf(stderr, "%-40s %12.0f ops/s %10lu ops %10.3f s\n", name.UTF8String, [mutableResult[@"operationsPerSecond"] doubleValue], (unsigned long)operations, seconds);
+}
+
+-(void)addInfo:(NSDictionary<NSString*,id> *)info toResultNamed:(NSString *)name
+{
+    for (NSMutableDictionary<NSString*,id> *result in self.mutableResults.reverseObjectEnumerator) {
+        if ([result[@"name"] isEqualToString:name]) {
+            [result addEntriesFromDictionary:info];
+            return;
+        }
+    }
+}
+
+-(NSDictionary<NSString*,id> *)reportWithEnvironment:(NSDictionary<NSString*,id> *)environment
+{
+    return @{@"environment": environment,
+             @"benchmarks": self.results,
+             @"peakResidentBytes": @(GWMBenchmarkPeakResidentBytes())};
+}
+
+@end
@@ -0,0 +1,475 @@
+//
+//  main.m
+//  GWMBenchmark
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+//  Generates GWMBenchmarkItem and GWMBenchmarkRelationshipItem tables in a scratch database and times the fetch,
+//  map, bind and write paths of GWMDatabaseController against them. The report is written as JSON so runs can be
+//  compared. Options are read from the argument domain of NSUserDefaults, for example:
+//
+//      GWMBenchmark -rows 100000 -iterations 10000 -threads 1,2,4,8 -profile readMostly -output results.json
+//
+
+@import Foundation;
+#import <sqlite3.h>
+#import "GWMDatabaseController.h"
+#import "GWMDatabaseResult.h"
+#import "GWMColumnarResult.h"
+#import "GWMDateCoding.h"
+#import "GWMConnectionConfiguration.h"
+#import "GWMBenchmarkItems.h"
+#import "GWMBenchmarkRunner.h"
+
+static NSInteger GWMBenchmarkIntegerOption(NSString *key, NSInteger defaultValue)
+{
+    NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+    return [defaults objectForKey:key] ? [defaults integerForKey:key] : defaultValue;
+}
+
+///@discussion A pKey between 1 and rows that does not repeat in a regular pattern.
+static NSInteger GWMBenchmarkItemID(NSUInteger idx, NSUInteger rows)
+{
+    return (NSInteger)(((uint64_t)idx * 2654435761u) % rows) + 1;
+}
+
+static NSString *GWMBenchmarkSelectStatement(Class itemClass, GWMTableName table)
+{
+    return [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@", [[itemClass tableColumns] componentsJoinedByString:@", "], table, [itemClass tableAlias]];
+}
+
+#pragma mark - Reflection Mapping
+
+/*
+ Maps rows the way resultWithStatement did before row mapping plans: the class is looked up, the declared type and
+ name of every cell are compared as strings, dates go through a shared NSDateFormatter and every value is set with
+ KVC. It is the baseline the row mapping plan is compared against.
+ */
+static NSArray *GWMBenchmarkReflectionRows(sqlite3 *database, NSString *statement, NSDateFormatter *dateFormatter)
+{
+    NSMutableArray *mutableRows = [NSMutableArray new];
+    sqlite3_stmt *sqlite3PreparedStatement = NULL;
+
+    if (sqlite3_prepare_v2(database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL) != SQLITE_OK) {
+        NSLog(@"*** Could not prepare reflection statement: '%s' ***", sqlite3_errmsg(database));
+        return mutableRows;
+    }
+
+    NSTimeZone *utcTimeZone = [NSTimeZone timeZoneWithName:@"UTC"];
+
+    while (sqlite3_step(sqlite3PreparedStatement) == SQLITE_ROW) {
+
+        int columnCount = sqlite3_column_count(sqlite3PreparedStatement);
+        const char *classNameC = (const char *)sqlite3_column_text(sqlite3PreparedStatement, 0);
+        Class class = NSClassFromString([NSString stringWithUTF8String:classNameC]);
+        id obj = [[class alloc] init];
+
+        for (int index = 1; index < columnCount; index++) {
+
+            int dataType = sqlite3_column_type(sqlite3PreparedStatement, index);
+            const char *declaredDataTypeC = sqlite3_column_decltype(sqlite3PreparedStatement, index);
+            if (declaredDataTypeC == NULL)
+                declaredDataTypeC = "TEXT";
+
+            NSString *columnName = [NSString stringWithUTF8String:sqlite3_column_name(sqlite3PreparedStatement, index)];
+            NSString *setterName = [NSString stringWithFormat:@"set%@%@:", [[columnName substringToIndex:1] uppercaseString], [columnName substringFromIndex:1]];
+
+            if (![obj respondsToSelector:NSSelectorFromString(setterName)] || dataType == SQLITE_NULL)
+                continue;
+
+            id value = nil;
+
+            if (!strcmp(declaredDataTypeC, "DATE_TIME") || !strcmp(declaredDataTypeC, "HISTORIC_DATE_TIME") || [columnName containsString:@"Date"]) {
+                const char *stringValueC = (const char *)sqlite3_column_text(sqlite3PreparedStatement, index);
+                dateFormatter.dateFormat = strlen(stringValueC) == GWMDBDateStringLengthDateTime ? GWMDBDateFormatDateTime : GWMDBDateFormatShortDate;
+                dateFormatter.timeZone = utcTimeZone;
+                value = [dateFormatter dateFromString:[NSString stringWithUTF8String:stringValueC]];
+            } else if (!strcmp(declaredDataTypeC, "BOOLEAN")) {
+                value = @(sqlite3_column_int(sqlite3PreparedStatement, index) != 0);
+            } else if (dataType == SQLITE_INTEGER) {
+                value = @(sqlite3_column_int64(sqlite3PreparedStatement, index));
+            } else if (dataType == SQLITE_FLOAT) {
+                value = @(sqlite3_column_double(sqlite3PreparedStatement, index));
+            } else {
+                value = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(sqlite3PreparedStatement, index)];
+            }
+
+            [obj setValue:value forKey:columnName];
+        }
+
+        if (obj)
+            [mutableRows addObject:obj];
+    }
+
+    sqlite3_finalize(sqlite3PreparedStatement);
+
+    return mutableRows;
+}
+
+#pragma mark - Setup
+
+static BOOL GWMBenchmarkCreateDatabaseFile(NSString *path)
+{
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    for (NSString *suffix in @[@"-wal", @"-shm"])
+        [[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix] error:NULL];
+
+    sqlite3 *database = NULL;
+    int openCode = sqlite3_open_v2(path.UTF8String, &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+    sqlite3_close(database);
+
+    return openCode == SQLITE_OK;
+}
+
+static GWMConnectionConfiguration *GWMBenchmarkConnectionConfiguration(NSString *profile)
+{
+    if ([profile isEqualToString:@"readMostly"])
+        return [GWMConnectionConfiguration readMostlyConfiguration];
+    if ([profile isEqualToString:@"bulkLoad"])
+        return [GWMConnectionConfiguration bulkLoadConfiguration];
+    if ([profile isEqualToString:@"durable"])
+        return [GWMConnectionConfiguration durableConfiguration];
+    return [GWMConnectionConfiguration defaultConfiguration];
+}
+
+// the connection profile every controller of the run is opened with
+static GWMConnectionConfiguration *GWMBenchmarkConfiguration = nil;
+
+static GWMDatabaseController *GWMBenchmarkController(NSString *path, NSUInteger readerConnectionCount)
+{
+    GWMDatabaseController *controller = [GWMDatabaseController new];
+    if (GWMBenchmarkConfiguration)
+        controller.connectionConfiguration = GWMBenchmarkConfiguration;
+    controller.classToTableMapping = @{NSStringFromClass([GWMBenchmarkItem class]): GWMBenchmarkItemTable,
+                                       NSStringFromClass([GWMBenchmarkRelationshipItem class]): GWMBenchmarkRelationshipTable};
+    controller.readerConnectionCount = readerConnectionCount;
+
+    if ([controller openDatabaseAtPath:path] != GWMDBOperationDatabaseOpened)
+        return nil;
+
+    return controller;
+}
+
+#pragma mark - Benchmarks
+
+static void GWMBenchmarkWrites(GWMBenchmarkRunner *runner, GWMDatabaseController *controller, NSUInteger rows, NSUInteger chunkSize)
+{
+    NSMutableArray<NSDictionary<GWMColumnName,id>*> *mutableItemRows = [NSMutableArray arrayWithCapacity:rows];
+    for (NSUInteger idx = 0; idx < rows; idx++)
+        [mutableItemRows addObject:[GWMBenchmarkItem rowValuesWithIndex:idx]];
+
+    __block NSUInteger insertedItems = 0;
+    [runner measureName:@"insert.bulk.items" batchOperations:rows block:^{
+        [controller insertIntoTable:GWMBenchmarkItemTable rows:mutableItemRows chunkSize:chunkSize completion:^(NSUInteger insertedCount, NSDictionary<NSNumber*,NSError*> *rowErrors, NSError *error){
+            insertedItems = insertedCount;
+        }];
+    }];
+    [runner addInfo:@{@"insertedRows": @(insertedItems), @"chunkSize": @(chunkSize)} toResultNamed:@"insert.bulk.items"];
+
+    // every item is related to the next two
+    NSMutableArray<NSDictionary<GWMColumnName,id>*> *mutableRelationshipRows = [NSMutableArray arrayWithCapacity:rows * 2];
+    for (NSUInteger idx = 0; idx < rows; idx++) {
+        [mutableRelationshipRows addObject:[GWMBenchmarkRelationshipItem rowValuesWithDataItemID:idx + 1 relatedDataItemID:(idx + 1) % rows + 1]];
+        [mutableRelationshipRows addObject:[GWMBenchmarkRelationshipItem rowValuesWithDataItemID:idx + 1 relatedDataItemID:(idx + 2) % rows + 1]];
+    }
+
+    __block NSUInteger insertedRelationships = 0;
+    [runner measureName:@"insert.bulk.relationships" batchOperations:mutableRelationshipRows.count block:^{
+        [controller insertIntoTable:GWMBenchmarkRelationshipTable rows:mutableRelationshipRows chunkSize:chunkSize completion:^(NSUInteger insertedCount, NSDictionary<NSNumber*,NSError*> *rowErrors, NSError *error){
+            insertedRelationships = insertedCount;
+        }];
+    }];
+    [runner addInfo:@{@"insertedRows": @(insertedRelationships), @"chunkSize": @(chunkSize)} toResultNamed:@"insert.bulk.relationships"];
+}
+
+static void GWMBenchmarkReads(GWMBenchmarkRunner *runner, GWMDatabaseController *controller, NSString *path, NSUInteger rows, NSUInteger iterations, NSUInteger listSize, NSUInteger listIterations)
+{
+    Class itemClass = [GWMBenchmarkItem class];
+
+    [runner measureName:@"fetch.pkey" operations:iterations block:^(NSUInteger idx){
+        [controller fetchItemsOfClass:itemClass withIDs:@[@(GWMBenchmarkItemID(idx, rows))]];
+    }];
+
+    NSString *itemStatement = GWMBenchmarkSelectStatement(itemClass, GWMBenchmarkItemTable);
+    NSString *listStatement = [NSString stringWithFormat:@"%@ LIMIT %lu", itemStatement, (unsigned long)listSize];
+
+    [runner measureName:@"fetch.list" operations:listIterations block:^(NSUInteger idx){
+        [controller resultWithStatement:listStatement criteria:nil completion:nil];
+    }];
+    [runner addInfo:@{@"rowsPerOperation": @(listSize)} toResultNamed:@"fetch.list"];
+
+    // the mapping before row mapping plans, on a connection of its own
+    sqlite3 *database = NULL;
+    sqlite3_open_v2(path.UTF8String, &database, SQLITE_OPEN_READONLY, NULL);
+    NSDateFormatter *dateFormatter = [NSDateFormatter new];
+
+    [runner measureName:@"fetch.list.reflection" operations:listIterations block:^(NSUInteger idx){
+        GWMBenchmarkReflectionRows(database, listStatement, dateFormatter);
+    }];
+    [runner addInfo:@{@"rowsPerOperation": @(listSize)} toResultNamed:@"fetch.list.reflection"];
+
+    sqlite3_close(database);
+
+    // the list columns with the relationship count of each item as a subquery
+    NSString *aggregateListStatement = [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@ LIMIT %lu", [[itemClass listTableColumns] componentsJoinedByString:@", "], GWMBenchmarkItemTable, [itemClass tableAlias], (unsigned long)listSize];
+
+    [runner measureName:@"fetch.list.aggregates" operations:listIterations block:^(NSUInteger idx){
+        [controller resultWithStatement:aggregateListStatement criteria:nil completion:nil];
+    }];
+    [runner addInfo:@{@"rowsPerOperation": @(listSize)} toResultNamed:@"fetch.list.aggregates"];
+
+    // pages deeper into the list cost the same as the first
+    __block NSString *continuationToken = nil;
+
+    [runner measureName:@"fetch.list.page" operations:listIterations block:^(NSUInteger idx){
+        continuationToken = [controller pageOfItemsOfClass:itemClass criteria:nil sortBy:GWMBenchmarkColumnScore ascending:YES pageSize:listSize continuationToken:continuationToken].continuationToken;
+    }];
+    [runner addInfo:@{@"rowsPerOperation": @(listSize)} toResultNamed:@"fetch.list.page"];
+
+    [runner measureName:@"fetch.list.columnar" operations:listIterations block:^(NSUInteger idx){
+        [controller columnarResultWithStatement:listStatement criteria:nil];
+    }];
+    [runner addInfo:@{@"rowsPerOperation": @(listSize)} toResultNamed:@"fetch.list.columnar"];
+
+    NSString *relationshipStatement = GWMBenchmarkSelectStatement([GWMBenchmarkRelationshipItem class], GWMBenchmarkRelationshipTable);
+
+    [runner measureName:@"fetch.relationships" operations:iterations block:^(NSUInteger idx){
+        [controller resultWithStatement:relationshipStatement criteria:@[@{GWMTableColumnDataItemKey: @(GWMBenchmarkItemID(idx, rows))}] exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
+    }];
+
+    // the relationships and related items of a list page in two statements
+    NSArray<GWMBenchmarkItem*> *listItems = [controller resultWithStatement:listStatement criteria:nil completion:nil].data;
+
+    [runner measureName:@"fetch.relationships.prefetch" operations:listIterations block:^(NSUInteger idx){
+        [GWMBenchmarkRelationshipItem prefetchRelationshipsForItems:listItems relatedClass:itemClass];
+    }];
+    [runner addInfo:@{@"itemsPerOperation": @(listItems.count)} toResultNamed:@"fetch.relationships.prefetch"];
+
+    [runner measureName:@"count.all" operations:iterations block:^(NSUInteger idx){
+        [controller countOfRecordsFromTable:GWMBenchmarkItemTable column:GWMTableColumnPkey criteria:nil];
+    }];
+
+    [runner measureName:@"count.criteria" operations:iterations block:^(NSUInteger idx){
+        [controller countOfRecordsFromTable:GWMBenchmarkItemTable column:GWMTableColumnPkey criteria:@[@{GWMBenchmarkColumnIsActive: @(idx % 2)}]];
+    }];
+}
+
+static void GWMBenchmarkMemory(GWMBenchmarkRunner *runner, GWMDatabaseController *controller, NSUInteger rows)
+{
+    NSString *itemStatement = GWMBenchmarkSelectStatement([GWMBenchmarkItem class], GWMBenchmarkItemTable);
+
+    // the columnar result runs first so it cannot reuse pages freed by the objects
+    __block GWMColumnarResult *columnarResult = nil;
+    NSUInteger residentBytes = GWMBenchmarkResidentBytes();
+    [runner measureName:@"memory.all.columnar" batchOperations:rows block:^{
+        columnarResult = [controller columnarResultWithStatement:itemStatement criteria:nil];
+    }];
+    [runner addInfo:@{@"residentBytesDelta": @((NSInteger)GWMBenchmarkResidentBytes() - (NSInteger)residentBytes),
+                      @"estimatedBytes": @(columnarResult.memoryUsage),
+                      @"rows": @(columnarResult.rowCount)} toResultNamed:@"memory.all.columnar"];
+    columnarResult = nil;
+
+    __block GWMDatabaseResult *objectResult = nil;
+    residentBytes = GWMBenchmarkResidentBytes();
+    [runner measureName:@"memory.all.objects" batchOperations:rows block:^{
+        objectResult = [controller resultWithStatement:itemStatement criteria:nil completion:nil];
+    }];
+    [runner addInfo:@{@"residentBytesDelta": @((NSInteger)GWMBenchmarkResidentBytes() - (NSInteger)residentBytes),
+                      @"rows": @(objectResult.data.count)} toResultNamed:@"memory.all.objects"];
+    objectResult = nil;
+}
+
+static void GWMBenchmarkDates(GWMBenchmarkRunner *runner, NSUInteger iterations)
+{
+    char (*strings)[GWMDateTimeCStringBufferLength] = calloc(iterations, GWMDateTimeCStringBufferLength);
+    NSMutableArray<NSDate*> *mutableDates = [NSMutableArray arrayWithCapacity:iterations];
+
+    for (NSUInteger idx = 0; idx < iterations; idx++) {
+        NSDate *date = [NSDate dateWithTimeIntervalSince1970:-2208988800 + (NSTimeInterval)((idx * 2654435761u) % 4102444800u)];
+        [mutableDates addObject:date];
+        GWMDateTimeCStringWithDate(date, strings[idx]);
+    }
+
+    NSDateFormatter *dateFormatter = [NSDateFormatter new];
+    dateFormatter.dateFormat = GWMDBDateFormatDateTime;
+    dateFormatter.timeZone = [NSTimeZone timeZoneWithName:@"UTC"];
+
+    [runner measureName:@"date.decode.coding" operations:iterations block:^(NSUInteger idx){
+        GWMDateWithDateTimeCString(strings[idx]);
+    }];
+    [runner measureName:@"date.decode.formatter" operations:iterations block:^(NSUInteger idx){
+        [dateFormatter dateFromString:[NSString stringWithUTF8String:strings[idx]]];
+    }];
+
+    [runner measureName:@"date.encode.coding" operations:iterations block:^(NSUInteger idx){
+        char buffer[GWMDateTimeCStringBufferLength];
+        GWMDateTimeCStringWithDate(mutableDates[idx], buffer);
+    }];
+    [runner measureName:@"date.encode.formatter" operations:iterations block:^(NSUInteger idx){
+        [dateFormatter stringFromDate:mutableDates[idx]];
+    }];
+
+    // the decoder must give the same dates as the formatter it replaces
+    NSUInteger mismatches = 0;
+    for (NSUInteger idx = 0; idx < iterations; idx++) {
+        NSDate *decodedDate = GWMDateWithDateTimeCString(strings[idx]);
+        NSDate *formattedDate = [dateFormatter dateFromString:[NSString stringWithUTF8String:strings[idx]]];
+        if (!(decodedDate == formattedDate || [decodedDate isEqualToDate:formattedDate]))
+            mismatches++;
+    }
+    [runner addInfo:@{@"mismatches": @(mismatches)} toResultNamed:@"date.decode.coding"];
+
+    free(strings);
+}
+
+static void GWMBenchmarkUpdates(GWMBenchmarkRunner *runner, GWMDatabaseController *controller, NSUInteger rows, NSUInteger iterations)
+{
+    NSMutableArray<NSNumber*> *mutableItemIDs = [NSMutableArray arrayWithCapacity:iterations];
+    for (NSUInteger idx = 0; idx < iterations; idx++)
+        [mutableItemIDs addObject:@(GWMBenchmarkItemID(idx, rows))];
+
+    NSArray<GWMBenchmarkItem*> *items = [controller fetchItemsOfClass:[GWMBenchmarkItem class] withIDs:mutableItemIDs].data;
+
+    [runner measureName:@"save.single" operations:items.count block:^(NSUInteger idx){
+        GWMBenchmarkItem *item = items[idx];
+        item.score += 1.0;
+        item.updated = [NSDate date];
+        [item saveTo:GWMReadWriteLocal completion:nil];
+    }];
+
+    [runner measureName:@"update.criteria" operations:iterations block:^(NSUInteger idx){
+        [controller updateTable:GWMBenchmarkItemTable withValues:@{GWMBenchmarkColumnQuantity: @(idx)} criteria:@{GWMTableColumnPkey: @(GWMBenchmarkItemID(idx, rows))} completion:nil];
+    }];
+
+    // the same updates committed once
+    [runner measureName:@"update.criteria.transaction" batchOperations:iterations block:^{
+        [controller performTransaction:^(GWMTransaction *transaction){
+            for (NSUInteger idx = 0; idx < iterations; idx++)
+                [controller updateTable:GWMBenchmarkItemTable withValues:@{GWMBenchmarkColumnQuantity: @(idx + 1)} criteria:@{GWMTableColumnPkey: @(GWMBenchmarkItemID(idx, rows))} completion:nil];
+        } error:nil];
+    }];
+
+    // the same updates from several threads through the write-behind queue
+    [controller resetWriteBatchStatistics];
+    [runner measureName:@"update.criteria.enqueued" batchOperations:iterations block:^{
+        dispatch_apply(iterations, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t idx){
+            [controller enqueueUpdateTable:GWMBenchmarkItemTable withValues:@{GWMBenchmarkColumnQuantity: @(idx + 2)} criteria:@{GWMTableColumnPkey: @(GWMBenchmarkItemID(idx, rows))} completion:nil];
+        });
+        [controller flushWrites];
+    }];
+    [runner addInfo:@{@"writeBatches": [controller writeBatchStatistics]} toResultNamed:@"update.criteria.enqueued"];
+}
+
+static void GWMBenchmarkConcurrentReads(GWMBenchmarkRunner *runner, NSString *path, NSUInteger rows, NSUInteger iterations, NSArray<NSNumber*> *threadCounts)
+{
+    Class itemClass = [GWMBenchmarkItem class];
+
+    for (NSNumber *threadCount in threadCounts) {
+
+        NSUInteger threads = MAX(threadCount.unsignedIntegerValue, 1);
+        NSUInteger operations = MAX(iterations / threads, 1);
+
+        // one shared connection against a reader pool with a connection per thread
+        for (NSNumber *readerCount in @[@0, @(threads)]) {
+
+            GWMDatabaseController *controller = GWMBenchmarkController(path, readerCount.unsignedIntegerValue);
+            if (!controller)
+                continue;
+
+            NSString *name = [NSString stringWithFormat:@"read.concurrent.readers%@.threads%lu", readerCount, (unsigned long)threads];
+
+            [runner measureName:name threads:threads operations:operations block:^(NSUInteger thread, NSUInteger idx){
+                [controller fetchItemsOfClass:itemClass withIDs:@[@(GWMBenchmarkItemID(thread * operations + idx, rows))]];
+            }];
+            [runner addInfo:@{@"readerConnections": readerCount} toResultNamed:name];
+
+            [controller closeDatabase];
+        }
+    }
+}
+
+#pragma mark - Main
+
+int main(int argc, const char *argv[])
+{
+    @autoreleasepool {
+
+        NSUserDefaults *defaults = [NSUserDefaults standardUserDefaults];
+
+        NSUInteger rows = MAX(GWMBenchmarkIntegerOption(@"rows", 100000), 3);
+        NSUInteger iterations = MAX(GWMBenchmarkIntegerOption(@"iterations", 10000), 1);
+        NSUInteger listSize = MAX(GWMBenchmarkIntegerOption(@"listSize", 1000), 1);
+        NSUInteger listIterations = MAX(GWMBenchmarkIntegerOption(@"listIterations", 20), 1);
+        NSUInteger writeIterations = MAX(GWMBenchmarkIntegerOption(@"writeIterations", 1000), 1);
+        NSUInteger dateIterations = MAX(GWMBenchmarkIntegerOption(@"dateIterations", 100000), 1);
+        NSUInteger chunkSize = MAX(GWMBenchmarkIntegerOption(@"chunkSize", 1000), 1);
+        NSString *threadsOption = [defaults stringForKey:@"threads"] ?: @"1,2,4,8";
+        NSString *path = [defaults stringForKey:@"database"] ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"GWMBenchmark.sqlite"];
+        NSString *outputPath = [defaults stringForKey:@"output"];
+        NSString *profile = [defaults stringForKey:@"profile"] ?: @"default";
+
+        GWMBenchmarkConfiguration = GWMBenchmarkConnectionConfiguration(profile);
+
+        NSMutableArray<NSNumber*> *mutableThreadCounts = [NSMutableArray new];
+        for (NSString *component in [threadsOption componentsSeparatedByString:@","]) {
+            if (component.integerValue > 0)
+                [mutableThreadCounts addObject:@(component.integerValue)];
+        }
+
+        if (!GWMBenchmarkCreateDatabaseFile(path)) {
+            fprintf(stderr, "Could not create the database at %s\n", path.UTF8String);
+            return 1;
+        }
+
+        GWMDatabaseController *controller = GWMBenchmarkController(path, 0);
+        if (!controller) {
+            fprintf(stderr, "Could not open the database at %s\n", path.UTF8String);
+            return 1;
+        }
+
+        GWMBenchmarkSetDatabaseController(controller);
+        [controller createTableWithClassName:NSStringFromClass([GWMBenchmarkItem class]) schema:nil completion:nil];
+        [controller createTableWithClassName:NSStringFromClass([GWMBenchmarkRelationshipItem class]) schema:nil completion:nil];
+
+        GWMBenchmarkRunner *runner = [GWMBenchmarkRunner new];
+
+        GWMBenchmarkWrites(runner, controller, rows, chunkSize);
+        GWMBenchmarkReads(runner, controller, path, rows, iterations, listSize, listIterations);
+        GWMBenchmarkMemory(runner, controller, rows);
+        GWMBenchmarkDates(runner, dateIterations);
+        GWMBenchmarkUpdates(runner, controller, rows, writeIterations);
+        GWMBenchmarkConcurrentReads(runner, path, rows, iterations, mutableThreadCounts);
+
+        [controller closeDatabase];
+        GWMBenchmarkSetDatabaseController(nil);
+
+        NSProcessInfo *processInfo = [NSProcessInfo processInfo];
+        NSDictionary<NSString*,id> *environment = @{@"sqliteVersion": [controller sqliteLibraryVersion],
+                                                    @"operatingSystem": processInfo.operatingSystemVersionString,
+                                                    @"processors": @(processInfo.activeProcessorCount),
+                                                    @"date": @([NSDate date].timeIntervalSince1970),
+                                                    @"rows": @(rows),
+                                                    @"iterations": @(iterations),
+                                                    @"listSize": @(listSize),
+                                                    @"listIterations": @(listIterations),
+                                                    @"writeIterations": @(writeIterations),
+                                                    @"dateIterations": @(dateIterations),
+                                                    @"chunkSize": @(chunkSize),
+                                                    @"profile": profile};
+
+        NSError *error = nil;
+        NSData *report = [NSJSONSerialization dataWithJSONObject:[runner reportWithEnvironment:environment] options:NSJSONWritingPrettyPrinted error:&error];
+
+        if (!report) {
+            fprintf(stderr, "Could not write the report: %s\n", error.localizedDescription.UTF8String);
+            return 1;
+        }
+
+        if (outputPath)
+            [report writeToFile:outputPath atomically:YES];
+        else
+            [[NSFileHandle fileHandleWithStandardOutput] writeData:report];
+    }
+    return 0;
+}
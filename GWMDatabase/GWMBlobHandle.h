@@ -0,0 +1,82 @@
+//
+//  GWMBlobHandle.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMBlobHandle
+ * @discussion Reads and writes one BLOB value in pieces, so a value of several megabytes never has to be held in memory at once. You get a handle from a GWMDatabaseController with blobHandleWithTable:column:rowID:readOnly:error:. A handle can't change the size of a value; to write a new value, first insert or update the row with zeroblob(n) of the final size and then write the bytes. The handle stops working with SQLITE_ABORT if its row is changed or deleted by a statement. Writes are run on the controller's writer queue and are committed when the handle is closed, so close a handle you are done with.
+ */
+@interface GWMBlobHandle : NSObject
+
+///@discussion The size of the value in bytes.
+@property (nonatomic, readonly) NSUInteger length;
+///@discussion The row the handle is open on.
+@property (nonatomic, readonly) NSInteger rowID;
+///@discussion YES if the handle can only read.
+@property (nonatomic, readonly) BOOL isReadOnly;
+///@discussion YES once the handle is closed.
+@property (nonatomic, readonly) BOOL isClosed;
+
+-(instancetype)init NS_UNAVAILABLE;
+/*!
+ * @discussion Reads part of the value.
+ * @param length The number of bytes to read. offset + length must not be greater than the length of the value.
+ * @param offset The position of the first byte.
+ * @param error On return, the error if the bytes could not be read.
+ * @return The bytes or nil.
+ */
+-(NSData *_Nullable)readDataOfLength:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Reads part of the value into a buffer the caller owns, which lets a buffer be reused for every piece.
+ * @param buffer Memory for at least length bytes.
+ * @param length The number of bytes to read.
+ * @param offset The position of the first byte.
+ * @param error On return, the error if the bytes could not be read.
+ * @return YES if the bytes were read.
+ */
+-(BOOL)readBytes:(void *)buffer length:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Writes part of the value.
+ * @param data The bytes to write. offset + data.length must not be greater than the length of the value.
+ * @param offset The position of the first byte.
+ * @param error On return, the error if the bytes could not be written.
+ * @return YES if the bytes were written.
+ */
+-(BOOL)writeData:(NSData *)data atOffset:(NSUInteger)offset error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Copies the whole value to a stream in pieces.
+ * @param outputStream An open stream.
+ * @param chunkSize The number of bytes read at a time. Entering 0 uses 64 KB.
+ * @param error On return, the error if the value could not be copied.
+ * @return YES if every byte was written to the stream.
+ */
+-(BOOL)writeToOutputStream:(NSOutputStream *)outputStream chunkSize:(NSUInteger)chunkSize error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Fills the value from a stream in pieces, starting at the first byte.
+ * @param inputStream An open stream. Reading stops when the stream ends or the value is full.
+ * @param chunkSize The number of bytes written at a time. Entering 0 uses 64 KB.
+ * @param error On return, the error if the value could not be written.
+ * @return YES if the stream was copied.
+ */
+-(BOOL)readFromInputStream:(NSInputStream *)inputStream chunkSize:(NSUInteger)chunkSize error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Moves the handle to the same column of another row, which is faster than opening a new handle.
+ * @param rowID The rowid of the row.
+ * @param error On return, the error if the row has no value in the column.
+ * @return YES if the handle was moved. The handle is closed if it was not.
+ */
+-(BOOL)reopenAtRowID:(NSInteger)rowID error:(NSError *_Nullable *_Nullable)error;
+///@discussion Closes the handle, committing any bytes that were written.
+-(void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,255 @@
+//
+//  GWMBlobHandle.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMBlobHandle.h"
+#import "GWMDatabaseController.h"
+#import <sqlite3.h>
+
+static const NSUInteger GWMBlobHandleDefaultChunkSize = 65536;
+
+@interface GWMDatabaseController (GWMBlobHandle)
+
+-(void)performWrite:(dispatch_block_t)block;
+-(void)didChangeRowWithOperation:(int)operation schema:(const char *)schema table:(const char *)table rowID:(sqlite3_int64)rowID;
+
+@end
+
+@interface GWMBlobHandle ()
+{
+    sqlite3_blob *_blob;
+}
+
+@property (nonatomic, strong) GWMDatabaseController *databaseController;
+@property (nonatomic, strong) NSString *schema;
+@property (nonatomic, strong) NSString *table;
+@property (nonatomic, readwrite) NSUInteger length;
+@property (nonatomic, readwrite) NSInteger rowID;
+@property (nonatomic, readwrite) BOOL isReadOnly;
+@property (nonatomic, readwrite) BOOL isClosed;
+///@discussion YES once bytes were written to the current row.
+@property (nonatomic, assign) BOOL didWrite;
+
+@end
+
+@implementation GWMBlobHandle
+
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController blob:(sqlite3_blob *)blob schema:(NSString *)schema table:(NSString *)table rowID:(NSInteger)rowID readOnly:(BOOL)readOnly
+{
+    if (self = [super init]) {
+        _databaseController = databaseController;
+        _blob = blob;
+        _schema = schema;
+        _table = table;
+        _rowID = rowID;
+        _isReadOnly = readOnly;
+        _length = (NSUInteger)sqlite3_blob_bytes(blob);
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    [self close];
+}
+
+-(NSError *)errorWithName:(GWMSQLiteErrorName)name code:(int)code
+{
+    NSString *message = [NSString stringWithFormat:@"%@: %s", name, sqlite3_errstr(code)];
+    NSLog(@"*** %@ ***", message);
+    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+    return [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+}
+
+#pragma mark - Reading
+
+-(NSData *)readDataOfLength:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError **)error
+{
+    NSMutableData *mutableData = [NSMutableData dataWithLength:length];
+
+    if (![self readBytes:mutableData.mutableBytes length:length atOffset:offset error:error])
+        return nil;
+
+    return mutableData;
+}
+
+-(BOOL)readBytes:(void *)buffer length:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError **)error
+{
+    int readCode = self.isClosed ? SQLITE_MISUSE : sqlite3_blob_read(_blob, buffer, (int)length, (int)offset);
+
+    if (readCode != SQLITE_OK) {
+        if (error)
+            *error = [self errorWithName:GWMSQLiteErrorReadingBlob code:readCode];
+        return NO;
+    }
+
+    return YES;
+}
+
+-(BOOL)writeToOutputStream:(NSOutputStream *)outputStream chunkSize:(NSUInteger)chunkSize error:(NSError **)error
+{
+    if (chunkSize == 0)
+        chunkSize = GWMBlobHandleDefaultChunkSize;
+
+    NSMutableData *buffer = [NSMutableData dataWithLength:chunkSize];
+    uint8_t *bytes = buffer.mutableBytes;
+    NSUInteger offset = 0;
+
+    while (offset < self.length) {
+
+        NSUInteger length = MIN(chunkSize, self.length - offset);
+
+        if (![self readBytes:bytes length:length atOffset:offset error:error])
+            return NO;
+
+        NSUInteger written = 0;
+        while (written < length) {
+            NSInteger count = [outputStream write:bytes + written maxLength:length - written];
+            if (count <= 0) {
+                if (error)
+                    *error = outputStream.streamError;
+                return NO;
+            }
+            written += (NSUInteger)count;
+        }
+
+        offset += length;
+    }
+
+    return YES;
+}
+
+#pragma mark - Writing
+
+-(BOOL)writeData:(NSData *)data atOffset:(NSUInteger)offset error:(NSError **)error
+{
+    return [self writeBytes:data.bytes length:data.length atOffset:offset error:error];
+}
+
+-(BOOL)writeBytes:(const void *)bytes length:(NSUInteger)length atOffset:(NSUInteger)offset error:(NSError **)error
+{
+    __block int writeCode = SQLITE_MISUSE;
+
+    if (!self.isClosed && !self.isReadOnly) {
+        [self.databaseController performWrite:^{
+            writeCode = sqlite3_blob_write(self->_blob, bytes, (int)length, (int)offset);
+        }];
+    }
+
+    if (writeCode != SQLITE_OK) {
+        if (error)
+            *error = [self errorWithName:GWMSQLiteErrorWritingBlob code:writeCode];
+        return NO;
+    }
+
+    self.didWrite = YES;
+
+    return YES;
+}
+
+-(BOOL)readFromInputStream:(NSInputStream *)inputStream chunkSize:(NSUInteger)chunkSize error:(NSError **)error
+{
+    if (chunkSize == 0)
+        chunkSize = GWMBlobHandleDefaultChunkSize;
+
+    NSMutableData *buffer = [NSMutableData dataWithLength:chunkSize];
+    uint8_t *bytes = buffer.mutableBytes;
+    NSUInteger offset = 0;
+
+    while (offset < self.length) {
+
+        NSInteger count = [inputStream read:bytes maxLength:MIN(chunkSize, self.length - offset)];
+
+        if (count < 0) {
+            if (error)
+                *error = inputStream.streamError;
+            return NO;
+        }
+
+        if (count == 0)
+            break;
+
+        if (![self writeBytes:bytes length:(NSUInteger)count atOffset:offset error:error])
+            return NO;
+
+        offset += (NSUInteger)count;
+    }
+
+    return YES;
+}
+
+#pragma mark - Life Cycle
+
+-(void)reportWrite
+{
+    if (!self.didWrite)
+        return;
+
+    // incremental writes are not reported by the update hook
+    self.didWrite = NO;
+    [self.databaseController didChangeRowWithOperation:SQLITE_UPDATE schema:self.schema.UTF8String table:self.table.UTF8String rowID:self.rowID];
+}
+
+-(BOOL)reopenAtRowID:(NSInteger)rowID error:(NSError **)error
+{
+    __block int reopenCode = SQLITE_MISUSE;
+
+    dispatch_block_t reopen = ^{
+        [self reportWrite];
+        reopenCode = sqlite3_blob_reopen(self->_blob, rowID);
+    };
+
+    if (!self.isClosed) {
+        if (self.isReadOnly)
+            reopen();
+        else
+            [self.databaseController performWrite:reopen];
+    }
+
+    if (reopenCode != SQLITE_OK) {
+        if (error)
+            *error = [self errorWithName:GWMSQLiteErrorOpeningBlob code:reopenCode];
+        [self close];
+        return NO;
+    }
+
+    self.rowID = rowID;
+    self.length = (NSUInteger)sqlite3_blob_bytes(_blob);
+
+    return YES;
+}
+
+-(void)close
+{
+    if (self.isClosed)
+        return;
+
+    self.isClosed = YES;
+
+    // the block must not capture self, close is also called from dealloc
+    sqlite3_blob *blob = _blob;
+    _blob = NULL;
+    GWMDatabaseController *databaseController = self.databaseController;
+    BOOL didWrite = self.didWrite;
+    NSString *schema = self.schema;
+    NSString *table = self.table;
+    NSInteger rowID = self.rowID;
+
+    dispatch_block_t close = ^{
+        sqlite3_blob_close(blob);
+        // incremental writes are not reported by the update hook
+        if (didWrite)
+            [databaseController didChangeRowWithOperation:SQLITE_UPDATE schema:schema.UTF8String table:table.UTF8String rowID:rowID];
+    };
+
+    if (self.isReadOnly)
+        close();
+    else
+        [databaseController performWrite:close];
+}
+
+@end
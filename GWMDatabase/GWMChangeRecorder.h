@@ -0,0 +1,69 @@
+//
+//  GWMChangeRecorder.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import <sqlite3.h>
+#import "GWMChangeSet.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMChangeRecorder
+ * @discussion Records the rows changed by the transaction that is open on the main connection, in the order the update hook reports them, so the changes of a savepoint that is rolled back can be dropped again. The changes are only combined into a GWMChangeSet when the transaction is committed. The recorder can be used from several threads.
+ */
+@interface GWMChangeRecorder : NSObject
+
+///@discussion YES if changes have been recorded since the last change set.
+@property (nonatomic, readonly) BOOL hasChanges;
+
+/*!
+ * @discussion Records a changed row.
+ * @param operation SQLITE_INSERT, SQLITE_UPDATE or SQLITE_DELETE.
+ * @param schema The schema of the table.
+ * @param table The table.
+ * @param rowID The rowid of the row.
+ */
+-(void)recordOperation:(int)operation schema:(const char *)schema table:(const char *)table rowID:(sqlite3_int64)rowID;
+///@discussion Returns a mark for the changes recorded so far, such as when a savepoint begins.
+-(NSUInteger)mark;
+/*!
+ * @discussion Drops the changes recorded after a mark, such as when a savepoint is rolled back.
+ * @param mark A mark returned by mark.
+ */
+-(void)rollbackToMark:(NSUInteger)mark;
+///@discussion Drops every recorded change, such as when the transaction is rolled back.
+-(void)removeAllChanges;
+/*!
+ * @discussion Combines the recorded changes into a change set and removes them.
+ * @return The change set, or nil if no changes were recorded.
+ */
+-(GWMChangeSet *_Nullable)takeChangeSet;
+
+@end
+
+/*!
+ * @class GWMChangeSubscription
+ * @discussion A block that is given the change sets of a GWMDatabaseController that touch some tables.
+ */
+@interface GWMChangeSubscription : NSObject
+
+///@discussion The tables the block is interested in, or nil for every table.
+@property (nonatomic, readonly) NSSet<GWMTableName> *_Nullable tables;
+@property (nonatomic, readonly) dispatch_queue_t queue;
+@property (nonatomic, readonly) void (^block)(GWMChangeSet *changeSet);
+
+-(instancetype)initWithTables:(NSSet<GWMTableName> *_Nullable)tables queue:(dispatch_queue_t)queue block:(void (^)(GWMChangeSet *changeSet))block;
+/*!
+ * @discussion Runs the block asynchronously on the queue with the changes to the tables of the subscription.
+ * @param changeSet A committed change set.
+ */
+-(void)deliverChangeSet:(GWMChangeSet *)changeSet;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,221 @@
+//
+//  GWMChangeRecorder.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMChangeRecorder.h"
+
+typedef struct {
+    int operation;
+    NSUInteger tableIndex;
+    sqlite3_int64 rowID;
+} GWMChangeEvent;
+
+@interface GWMChangeSet (GWMChangeRecorder)
+
+-(instancetype)initWithInsertedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)insertedRowIDs updatedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)updatedRowIDs deletedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)deletedRowIDs isComplete:(BOOL)isComplete;
+
+@end
+
+@interface GWMChangeRecorder ()
+
+// guarded by @synchronized (self)
+@property (nonatomic, strong) NSMutableData *events;
+@property (nonatomic, strong) NSMutableArray<GWMTableName> *tableNames;
+@property (nonatomic, strong) NSMutableDictionary<GWMTableName,NSNumber*> *tableIndexes;
+
+@end
+
+@implementation GWMChangeRecorder
+
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _events = [NSMutableData new];
+        _tableNames = [NSMutableArray<GWMTableName> new];
+        _tableIndexes = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+-(BOOL)hasChanges
+{
+    @synchronized (self) {
+        return self.events.length > 0;
+    }
+}
+
+#pragma mark - Recording
+
+-(NSUInteger)indexOfTable:(const char *)table schema:(const char *)schema
+{
+    GWMTableName name = nil;
+    if (schema == NULL || strcmp(schema, "main") == 0)
+        name = [NSString stringWithUTF8String:table];
+    else
+        name = [NSString stringWithFormat:@"%s.%s", schema, table];
+
+    NSNumber *tableIndex = self.tableIndexes[name];
+    if (tableIndex)
+        return tableIndex.unsignedIntegerValue;
+
+    [self.tableNames addObject:name];
+    self.tableIndexes[name] = @(self.tableNames.count - 1);
+    return self.tableNames.count - 1;
+}
+
+-(void)recordOperation:(int)operation schema:(const char *)schema table:(const char *)table rowID:(sqlite3_int64)rowID
+{
+    if (table == NULL)
+        return;
+
+    @synchronized (self) {
+        GWMChangeEvent event = {operation, [self indexOfTable:table schema:schema], rowID};
+        [self.events appendBytes:&event length:sizeof(GWMChangeEvent)];
+    }
+}
+
+-(NSUInteger)mark
+{
+    @synchronized (self) {
+        return self.events.length;
+    }
+}
+
+-(void)rollbackToMark:(NSUInteger)mark
+{
+    @synchronized (self) {
+        if (mark < self.events.length)
+            self.events.length = mark;
+    }
+}
+
+-(void)removeAllChanges
+{
+    @synchronized (self) {
+        self.events.length = 0;
+        [self.tableNames removeAllObjects];
+        [self.tableIndexes removeAllObjects];
+    }
+}
+
+#pragma mark - Change Sets
+
+-(GWMChangeSet *)takeChangeSet
+{
+    NSData *events = nil;
+    NSArray<GWMTableName> *tableNames = nil;
+
+    @synchronized (self) {
+        if (self.events.length == 0)
+            return nil;
+        events = [self.events copy];
+        tableNames = [self.tableNames copy];
+        self.events.length = 0;
+        [self.tableNames removeAllObjects];
+        [self.tableIndexes removeAllObjects];
+    }
+
+    NSUInteger tableCount = tableNames.count;
+    NSMutableArray<NSMutableIndexSet*> *inserted = [NSMutableArray arrayWithCapacity:tableCount];
+    NSMutableArray<NSMutableIndexSet*> *updated = [NSMutableArray arrayWithCapacity:tableCount];
+    NSMutableArray<NSMutableIndexSet*> *deleted = [NSMutableArray arrayWithCapacity:tableCount];
+    for (NSUInteger idx = 0; idx < tableCount; idx++) {
+        [inserted addObject:[NSMutableIndexSet indexSet]];
+        [updated addObject:[NSMutableIndexSet indexSet]];
+        [deleted addObject:[NSMutableIndexSet indexSet]];
+    }
+
+    const GWMChangeEvent *event = events.bytes;
+    NSUInteger eventCount = events.length / sizeof(GWMChangeEvent);
+
+    for (NSUInteger idx = 0; idx < eventCount; idx++, event++) {
+
+        // NSIndexSet cannot hold negative rowids
+        if (event->rowID < 0 || event->tableIndex >= tableCount)
+            continue;
+
+        NSUInteger rowID = (NSUInteger)event->rowID;
+        NSMutableIndexSet *tableInserted = inserted[event->tableIndex];
+        NSMutableIndexSet *tableUpdated = updated[event->tableIndex];
+        NSMutableIndexSet *tableDeleted = deleted[event->tableIndex];
+
+        switch (event->operation) {
+            case SQLITE_INSERT:
+                // a row deleted and inserted again in the same transaction was replaced
+                if ([tableDeleted containsIndex:rowID]) {
+                    [tableDeleted removeIndex:rowID];
+                    [tableUpdated addIndex:rowID];
+                } else {
+                    [tableInserted addIndex:rowID];
+                }
+                break;
+            case SQLITE_UPDATE:
+                if (![tableInserted containsIndex:rowID])
+                    [tableUpdated addIndex:rowID];
+                break;
+            case SQLITE_DELETE:
+                if ([tableInserted containsIndex:rowID]) {
+                    [tableInserted removeIndex:rowID];
+                } else {
+                    [tableUpdated removeIndex:rowID];
+                    [tableDeleted addIndex:rowID];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    NSMutableDictionary<GWMTableName,NSIndexSet*> *mutableInserted = [NSMutableDictionary new];
+    NSMutableDictionary<GWMTableName,NSIndexSet*> *mutableUpdated = [NSMutableDictionary new];
+    NSMutableDictionary<GWMTableName,NSIndexSet*> *mutableDeleted = [NSMutableDictionary new];
+    for (NSUInteger idx = 0; idx < tableCount; idx++) {
+        if (inserted[idx].count > 0)
+            mutableInserted[tableNames[idx]] = [inserted[idx] copy];
+        if (updated[idx].count > 0)
+            mutableUpdated[tableNames[idx]] = [updated[idx] copy];
+        if (deleted[idx].count > 0)
+            mutableDeleted[tableNames[idx]] = [deleted[idx] copy];
+    }
+
+    GWMChangeSet *changeSet = [[GWMChangeSet alloc] initWithInsertedRowIDs:mutableInserted updatedRowIDs:mutableUpdated deletedRowIDs:mutableDeleted isComplete:YES];
+
+    // changes that cancel each other out, such as a row inserted and deleted again
+    if (changeSet.count == 0)
+        return nil;
+
+    return changeSet;
+}
+
+@end
+
+@implementation GWMChangeSubscription
+
+-(instancetype)initWithTables:(NSSet<GWMTableName> *)tables queue:(dispatch_queue_t)queue block:(void (^)(GWMChangeSet *changeSet))block
+{
+    if (self = [super init]) {
+        _tables = [tables copy];
+        _queue = queue;
+        _block = [block copy];
+    }
+    return self;
+}
+
+-(void)deliverChangeSet:(GWMChangeSet *)changeSet
+{
+    GWMChangeSet *filteredChangeSet = self.tables ? [changeSet changeSetWithTables:self.tables] : changeSet;
+
+    if (!filteredChangeSet)
+        return;
+
+    void (^block)(GWMChangeSet *changeSet) = self.block;
+    dispatch_async(self.queue, ^{
+        block(filteredChangeSet);
+    });
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  GWMChangeSet.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseHelperItems.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMChangeSet
+ * @discussion The rows inserted, updated and deleted by one committed transaction, by table. Changes to the same row are combined: a row inserted and then updated is only inserted, a row inserted and then deleted is left out, and a row deleted and then inserted again is updated. Tables of the main database are named without their schema, tables of other schemas as schema.table. Changes to WITHOUT ROWID tables are not reported. Change sets are immutable and can be shared between threads.
+ */
+@interface GWMChangeSet : NSObject
+
+///@discussion The tables with changes, sorted by name.
+@property (nonatomic, readonly) NSArray<GWMTableName> *tables;
+///@discussion The number of rows inserted, updated or deleted.
+@property (nonatomic, readonly) NSUInteger count;
+///@discussion NO when rows were also changed without being reported one at a time. Data read before the change set may then be out of date in any table. Change sets of a GWMDatabaseController are complete, because it has DELETE without a WHERE clause remove rows one at a time instead of emptying the table at once. Writes to the FTS5 tables of search indexes are left out.
+@property (nonatomic, readonly) BOOL isComplete;
+
+/*!
+ * @discussion Returns the rowids of the rows inserted in a table.
+ * @param table The table.
+ * @return The rowids. Empty if no rows were inserted.
+ */
+-(NSIndexSet *)insertedRowIDsInTable:(GWMTableName)table;
+/*!
+ * @discussion Returns the rowids of the rows updated in a table.
+ * @param table The table.
+ * @return The rowids. Empty if no rows were updated.
+ */
+-(NSIndexSet *)updatedRowIDsInTable:(GWMTableName)table;
+/*!
+ * @discussion Returns the rowids of the rows deleted from a table.
+ * @param table The table.
+ * @return The rowids. Empty if no rows were deleted.
+ */
+-(NSIndexSet *)deletedRowIDsInTable:(GWMTableName)table;
+/*!
+ * @discussion Returns YES if rows of a table were changed.
+ * @param table The table.
+ */
+-(BOOL)containsTable:(GWMTableName)table;
+/*!
+ * @discussion Returns the changes to some of the tables.
+ * @param tables The tables to keep.
+ * @return A change set with only the changes to tables, or nil if none of them changed and the change set is complete.
+ */
+-(GWMChangeSet *_Nullable)changeSetWithTables:(NSSet<GWMTableName> *)tables;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,99 @@
+//
+//  GWMChangeSet.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMChangeSet.h"
+
+@interface GWMChangeSet ()
+
+@property (nonatomic, strong) NSDictionary<GWMTableName,NSIndexSet*> *insertedRowIDs;
+@property (nonatomic, strong) NSDictionary<GWMTableName,NSIndexSet*> *updatedRowIDs;
+@property (nonatomic, strong) NSDictionary<GWMTableName,NSIndexSet*> *deletedRowIDs;
+@property (nonatomic, readwrite) NSArray<GWMTableName> *tables;
+@property (nonatomic, readwrite) NSUInteger count;
+@property (nonatomic, readwrite) BOOL isComplete;
+
+@end
+
+@implementation GWMChangeSet
+
+-(instancetype)initWithInsertedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)insertedRowIDs updatedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)updatedRowIDs deletedRowIDs:(NSDictionary<GWMTableName,NSIndexSet*> *)deletedRowIDs isComplete:(BOOL)isComplete
+{
+    if (self = [super init]) {
+        NSMutableSet<GWMTableName> *mutableTables = [NSMutableSet new];
+        NSUInteger count = 0;
+
+        for (NSDictionary<GWMTableName,NSIndexSet*> *rowIDs in @[insertedRowIDs, updatedRowIDs, deletedRowIDs]) {
+            [rowIDs enumerateKeysAndObjectsUsingBlock:^(GWMTableName _Nonnull table, NSIndexSet *_Nonnull indexSet, BOOL *stop){
+                if (indexSet.count > 0)
+                    [mutableTables addObject:table];
+            }];
+            for (NSIndexSet *indexSet in rowIDs.allValues)
+                count += indexSet.count;
+        }
+
+        _insertedRowIDs = insertedRowIDs;
+        _updatedRowIDs = updatedRowIDs;
+        _deletedRowIDs = deletedRowIDs;
+        _tables = [mutableTables.allObjects sortedArrayUsingSelector:@selector(compare:)];
+        _count = count;
+        _isComplete = isComplete;
+    }
+    return self;
+}
+
+-(NSString *)description
+{
+    NSMutableArray<NSString*> *mutableTables = [NSMutableArray<NSString*> new];
+    for (GWMTableName table in self.tables)
+        [mutableTables addObject:[NSString stringWithFormat:@"%@: %lu inserted, %lu updated, %lu deleted", table, (unsigned long)[self insertedRowIDsInTable:table].count, (unsigned long)[self updatedRowIDsInTable:table].count, (unsigned long)[self deletedRowIDsInTable:table].count]];
+    return [NSString stringWithFormat:@"<%@: %p%@ {%@}>", NSStringFromClass([self class]), self, self.isComplete ? @"" : @" incomplete", [mutableTables componentsJoinedByString:@"; "]];
+}
+
+#pragma mark - Rows
+
+-(NSIndexSet *)insertedRowIDsInTable:(GWMTableName)table
+{
+    return self.insertedRowIDs[table] ?: [NSIndexSet indexSet];
+}
+
+-(NSIndexSet *)updatedRowIDsInTable:(GWMTableName)table
+{
+    return self.updatedRowIDs[table] ?: [NSIndexSet indexSet];
+}
+
+-(NSIndexSet *)deletedRowIDsInTable:(GWMTableName)table
+{
+    return self.deletedRowIDs[table] ?: [NSIndexSet indexSet];
+}
+
+-(BOOL)containsTable:(GWMTableName)table
+{
+    return self.insertedRowIDs[table].count > 0 || self.updatedRowIDs[table].count > 0 || self.deletedRowIDs[table].count > 0;
+}
+
+-(GWMChangeSet *)changeSetWithTables:(NSSet<GWMTableName> *)tables
+{
+    NSDictionary<GWMTableName,NSIndexSet*> *(^filter)(NSDictionary<GWMTableName,NSIndexSet*> *) = ^NSDictionary<GWMTableName,NSIndexSet*> *(NSDictionary<GWMTableName,NSIndexSet*> *rowIDs){
+        NSMutableDictionary<GWMTableName,NSIndexSet*> *mutableRowIDs = [NSMutableDictionary new];
+        [rowIDs enumerateKeysAndObjectsUsingBlock:^(GWMTableName _Nonnull table, NSIndexSet *_Nonnull indexSet, BOOL *stop){
+            if ([tables containsObject:table])
+                mutableRowIDs[table] = indexSet;
+        }];
+        return [NSDictionary dictionaryWithDictionary:mutableRowIDs];
+    };
+
+    GWMChangeSet *changeSet = [[GWMChangeSet alloc] initWithInsertedRowIDs:filter(self.insertedRowIDs) updatedRowIDs:filter(self.updatedRowIDs) deletedRowIDs:filter(self.deletedRowIDs) isComplete:self.isComplete];
+
+    // an incomplete change set can have changed any table
+    if (changeSet.count == 0 && changeSet.isComplete)
+        return nil;
+
+    return changeSet;
+}
+
+@end
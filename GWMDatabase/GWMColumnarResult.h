@@ -0,0 +1,85 @@
+//
+//  GWMColumnarResult.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseResult.h"
+
+///@discussion How the values of a column are stored. The type of a column is the SQLite storage class of its first value that is not NULL; values of other storage classes in later rows are converted to it.
+typedef NS_ENUM(NSInteger, GWMColumnarType) {
+    GWMColumnarTypeNull = 0,
+    GWMColumnarTypeInteger,
+    GWMColumnarTypeDouble,
+    GWMColumnarTypeText,
+    GWMColumnarTypeBlob
+};
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMColumnarResult
+ * @discussion The rows of a query stored by column instead of as one object per row. Integer and double columns are kept in contiguous arrays of int64_t and double, the bytes of every text and blob value are kept in one shared buffer, and each column has a bitmap marking its NULL values. Reading a value does not allocate unless an Objective-C object is asked for. Use it for reports and long lists that only need a few columns of many rows. You get a columnar result from a GWMDatabaseController with columnarResultWithStatement:criteria:. The data property is always nil.
+ */
+@interface GWMColumnarResult : GWMDatabaseResult
+
+///@discussion The number of rows.
+@property (nonatomic, readonly) NSUInteger rowCount;
+///@discussion The number of columns.
+@property (nonatomic, readonly) NSUInteger columnCount;
+///@discussion The names of the columns in the order they were returned by the query.
+@property (nonatomic, readonly) NSArray<NSString*> *columnNames;
+///@discussion The number of bytes allocated for the values, bitmaps and text of the result.
+@property (nonatomic, readonly) NSUInteger memoryUsage;
+
+/*!
+ * @discussion Returns the index of a column.
+ * @param columnName The name of the column.
+ * @return The index of the column or NSNotFound.
+ */
+-(NSUInteger)indexOfColumn:(NSString *)columnName;
+/*!
+ * @discussion Returns how the values of a column are stored.
+ * @param column The index of the column.
+ * @return GWMColumnarTypeNull if every value of the column is NULL.
+ */
+-(GWMColumnarType)typeOfColumn:(NSUInteger)column;
+///@discussion YES if the value is NULL or the row or column is out of range.
+-(BOOL)isNullAtRow:(NSUInteger)row column:(NSUInteger)column;
+///@discussion The value of an integer column, or 0 if it is NULL. Double columns are truncated.
+-(int64_t)int64AtRow:(NSUInteger)row column:(NSUInteger)column;
+///@discussion The value of a double column, or 0 if it is NULL. Integer columns are converted.
+-(double)doubleAtRow:(NSUInteger)row column:(NSUInteger)column;
+/*!
+ * @discussion Returns the bytes of a text or blob value without copying them.
+ * @param row The index of the row.
+ * @param column The index of the column.
+ * @param length On return, the number of bytes, not counting the terminating NUL. Can be NULL.
+ * @return A NUL terminated pointer that is valid as long as the result is, or NULL if the value is NULL or the column is not text or blob.
+ */
+-(const char *_Nullable)UTF8StringAtRow:(NSUInteger)row column:(NSUInteger)column length:(NSUInteger *_Nullable)length;
+///@discussion The value of a text column as a new NSString, or nil if it is NULL.
+-(NSString *_Nullable)stringAtRow:(NSUInteger)row column:(NSUInteger)column;
+///@discussion The value of a blob column as a new NSData, or nil if it is NULL.
+-(NSData *_Nullable)dataAtRow:(NSUInteger)row column:(NSUInteger)column;
+///@discussion The value of a text column in the format yyyy-MM-dd HH:mm:ss as an NSDate, or nil if it is NULL or not in that format.
+-(NSDate *_Nullable)dateAtRow:(NSUInteger)row column:(NSUInteger)column;
+/*!
+ * @discussion Returns every value of an integer column for fast iteration. NULL values are 0.
+ * @param column The index of the column.
+ * @return rowCount values that are valid as long as the result is, or NULL if the column is not an integer column.
+ */
+-(const int64_t *_Nullable)int64ValuesOfColumn:(NSUInteger)column;
+/*!
+ * @discussion Returns every value of a double column for fast iteration. NULL values are 0.
+ * @param column The index of the column.
+ * @return rowCount values that are valid as long as the result is, or NULL if the column is not a double column.
+ */
+-(const double *_Nullable)doubleValuesOfColumn:(NSUInteger)column;
+
+@end
+
+NS_ASSUME_NONNULL_END
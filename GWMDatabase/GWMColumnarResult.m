@@ -0,0 +1,310 @@
+//
+//  GWMColumnarResult.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMColumnarResult.h"
+#import "GWMDateCoding.h"
+
+///@discussion One value of a column. Text and blob values are an offset into the shared buffer.
+typedef union {
+    int64_t integer;
+    double real;
+    NSUInteger offset;
+} GWMColumnarValue;
+
+typedef struct {
+    GWMColumnarType type;
+    GWMColumnarValue *values;
+    ///@discussion The byte lengths of text and blob values, NULL for other columns.
+    NSUInteger *lengths;
+    ///@discussion One bit per row, set when the value is NULL.
+    uint8_t *nulls;
+} GWMColumnarColumn;
+
+@interface GWMColumnarResult ()
+{
+    GWMColumnarColumn *_columns;
+    NSUInteger _rowCapacity;
+    char *_buffer;
+    NSUInteger _bufferLength;
+    NSUInteger _bufferCapacity;
+}
+
+@property (nonatomic, readwrite) NSUInteger rowCount;
+@property (nonatomic, readwrite) NSUInteger columnCount;
+@property (nonatomic, readwrite) NSArray<NSString*> *columnNames;
+
+@end
+
+@implementation GWMColumnarResult
+
+-(void)dealloc
+{
+    for (NSUInteger column = 0; column < _columnCount; column++) {
+        free(_columns[column].values);
+        free(_columns[column].lengths);
+        free(_columns[column].nulls);
+    }
+    free(_columns);
+    free(_buffer);
+}
+
+#pragma mark - Filling
+
+-(void)setColumnsWithPreparedStatement:(sqlite3_stmt *)preparedStatement
+{
+    int columnCount = sqlite3_column_count(preparedStatement);
+    NSMutableArray<NSString*> *mutableColumnNames = [NSMutableArray<NSString*> new];
+
+    for (int index = 0; index < columnCount; index++)
+        [mutableColumnNames addObject:[NSString stringWithUTF8String:sqlite3_column_name(preparedStatement, index)]];
+
+    self.columnNames = [NSArray arrayWithArray:mutableColumnNames];
+    self.columnCount = (NSUInteger)columnCount;
+    _columns = calloc(columnCount > 0 ? columnCount : 1, sizeof(GWMColumnarColumn));
+}
+
+-(void)growToRowCapacity:(NSUInteger)rowCapacity
+{
+    NSUInteger oldBitmapLength = (_rowCapacity + 7) / 8;
+    NSUInteger bitmapLength = (rowCapacity + 7) / 8;
+
+    for (NSUInteger column = 0; column < _columnCount; column++) {
+        GWMColumnarColumn *columnStorage = &_columns[column];
+        columnStorage->values = realloc(columnStorage->values, rowCapacity * sizeof(GWMColumnarValue));
+        if (columnStorage->lengths)
+            columnStorage->lengths = realloc(columnStorage->lengths, rowCapacity * sizeof(NSUInteger));
+        columnStorage->nulls = realloc(columnStorage->nulls, bitmapLength);
+        memset(columnStorage->nulls + oldBitmapLength, 0, bitmapLength - oldBitmapLength);
+    }
+
+    _rowCapacity = rowCapacity;
+}
+
+-(NSUInteger)appendBytes:(const void *)bytes length:(NSUInteger)length
+{
+    // every value is NUL terminated so text can be handed out without copying
+    if (_bufferLength + length + 1 > _bufferCapacity) {
+        _bufferCapacity = MAX(_bufferCapacity * 2, _bufferLength + length + 1);
+        _bufferCapacity = MAX(_bufferCapacity, 4096);
+        _buffer = realloc(_buffer, _bufferCapacity);
+    }
+
+    NSUInteger offset = _bufferLength;
+    if (length > 0)
+        memcpy(_buffer + offset, bytes, length);
+    _buffer[offset + length] = '\0';
+    _bufferLength += length + 1;
+
+    return offset;
+}
+
+-(void)appendRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    if (_rowCount == _rowCapacity)
+        [self growToRowCapacity:MAX(_rowCapacity * 2, 64)];
+
+    NSUInteger row = _rowCount;
+
+    for (NSUInteger column = 0; column < _columnCount; column++) {
+
+        GWMColumnarColumn *columnStorage = &_columns[column];
+        int index = (int)column;
+        int dataTypeI = sqlite3_column_type(preparedStatement, index);
+
+        if (dataTypeI == SQLITE_NULL) {
+            columnStorage->nulls[row >> 3] |= (uint8_t)(1 << (row & 7));
+            columnStorage->values[row].integer = 0;
+            if (columnStorage->lengths)
+                columnStorage->lengths[row] = 0;
+            continue;
+        }
+
+        // the first value that is not NULL decides the type of the column
+        if (columnStorage->type == GWMColumnarTypeNull) {
+            switch (dataTypeI) {
+                case SQLITE_INTEGER:
+                    columnStorage->type = GWMColumnarTypeInteger;
+                    break;
+                case SQLITE_FLOAT:
+                    columnStorage->type = GWMColumnarTypeDouble;
+                    break;
+                case SQLITE_BLOB:
+                    columnStorage->type = GWMColumnarTypeBlob;
+                    columnStorage->lengths = calloc(_rowCapacity, sizeof(NSUInteger));
+                    break;
+                default:
+                    columnStorage->type = GWMColumnarTypeText;
+                    columnStorage->lengths = calloc(_rowCapacity, sizeof(NSUInteger));
+                    break;
+            }
+        }
+
+        switch (columnStorage->type) {
+            case GWMColumnarTypeInteger:
+                columnStorage->values[row].integer = sqlite3_column_int64(preparedStatement, index);
+                break;
+            case GWMColumnarTypeDouble:
+                columnStorage->values[row].real = sqlite3_column_double(preparedStatement, index);
+                break;
+            case GWMColumnarTypeText: {
+                const unsigned char *text = sqlite3_column_text(preparedStatement, index);
+                NSUInteger length = (NSUInteger)sqlite3_column_bytes(preparedStatement, index);
+                columnStorage->values[row].offset = [self appendBytes:text length:length];
+                columnStorage->lengths[row] = length;
+                break;
+            }
+            case GWMColumnarTypeBlob: {
+                const void *blob = sqlite3_column_blob(preparedStatement, index);
+                NSUInteger length = (NSUInteger)sqlite3_column_bytes(preparedStatement, index);
+                columnStorage->values[row].offset = [self appendBytes:blob length:length];
+                columnStorage->lengths[row] = length;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    _rowCount++;
+}
+
+#pragma mark - Columns
+
+-(NSUInteger)indexOfColumn:(NSString *)columnName
+{
+    return [self.columnNames indexOfObject:columnName];
+}
+
+-(GWMColumnarType)typeOfColumn:(NSUInteger)column
+{
+    if (column >= _columnCount)
+        return GWMColumnarTypeNull;
+    return _columns[column].type;
+}
+
+-(NSUInteger)memoryUsage
+{
+    NSUInteger memoryUsage = _bufferCapacity + _columnCount * sizeof(GWMColumnarColumn);
+
+    for (NSUInteger column = 0; column < _columnCount; column++) {
+        memoryUsage += _rowCapacity * sizeof(GWMColumnarValue) + (_rowCapacity + 7) / 8;
+        if (_columns[column].lengths)
+            memoryUsage += _rowCapacity * sizeof(NSUInteger);
+    }
+
+    return memoryUsage;
+}
+
+#pragma mark - Values
+
+-(BOOL)isNullAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    if (row >= _rowCount || column >= _columnCount)
+        return YES;
+    return (_columns[column].nulls[row >> 3] & (1 << (row & 7))) != 0;
+}
+
+-(int64_t)int64AtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    if ([self isNullAtRow:row column:column])
+        return 0;
+
+    GWMColumnarColumn *columnStorage = &_columns[column];
+
+    switch (columnStorage->type) {
+        case GWMColumnarTypeInteger:
+            return columnStorage->values[row].integer;
+        case GWMColumnarTypeDouble:
+            return (int64_t)columnStorage->values[row].real;
+        case GWMColumnarTypeText:
+            return strtoll(_buffer + columnStorage->values[row].offset, NULL, 10);
+        default:
+            return 0;
+    }
+}
+
+-(double)doubleAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    if ([self isNullAtRow:row column:column])
+        return 0.0;
+
+    GWMColumnarColumn *columnStorage = &_columns[column];
+
+    switch (columnStorage->type) {
+        case GWMColumnarTypeInteger:
+            return (double)columnStorage->values[row].integer;
+        case GWMColumnarTypeDouble:
+            return columnStorage->values[row].real;
+        case GWMColumnarTypeText:
+            return strtod(_buffer + columnStorage->values[row].offset, NULL);
+        default:
+            return 0.0;
+    }
+}
+
+-(const char *)UTF8StringAtRow:(NSUInteger)row column:(NSUInteger)column length:(NSUInteger *)length
+{
+    if ([self isNullAtRow:row column:column] || !_columns[column].lengths)
+        return NULL;
+
+    if (length)
+        *length = _columns[column].lengths[row];
+
+    return _buffer + _columns[column].values[row].offset;
+}
+
+-(NSString *)stringAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    NSUInteger length = 0;
+    const char *text = [self UTF8StringAtRow:row column:column length:&length];
+
+    if (text == NULL)
+        return nil;
+
+    return [[NSString alloc] initWithBytes:text length:length encoding:NSUTF8StringEncoding];
+}
+
+-(NSData *)dataAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    NSUInteger length = 0;
+    const char *bytes = [self UTF8StringAtRow:row column:column length:&length];
+
+    if (bytes == NULL)
+        return nil;
+
+    return [NSData dataWithBytes:bytes length:length];
+}
+
+-(NSDate *)dateAtRow:(NSUInteger)row column:(NSUInteger)column
+{
+    if ([self typeOfColumn:column] != GWMColumnarTypeText)
+        return nil;
+
+    const char *text = [self UTF8StringAtRow:row column:column length:NULL];
+
+    if (text == NULL)
+        return nil;
+
+    return GWMDateWithDateTimeCString(text);
+}
+
+-(const int64_t *)int64ValuesOfColumn:(NSUInteger)column
+{
+    if ([self typeOfColumn:column] != GWMColumnarTypeInteger)
+        return NULL;
+    return &_columns[column].values->integer;
+}
+
+-(const double *)doubleValuesOfColumn:(NSUInteger)column
+{
+    if ([self typeOfColumn:column] != GWMColumnarTypeDouble)
+        return NULL;
+    return &_columns[column].values->real;
+}
+
+@end
@@ -0,0 +1,134 @@
+//
+//  GWMCompiledQuery.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseHelperItems.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///@discussion SELECT value FROM json_each(?). A subquery that matches a column against a set of IDs bound as one JSON array, so the statement does not change with the number of IDs.
+FOUNDATION_EXTERN NSString * const GWMSQLiteItemIDSetSelect;
+/*!
+ * @discussion Encodes IDs as the JSON array bound to GWMSQLiteItemIDSetSelect.
+ * @param itemIDs NSNumber objects with integer values.
+ * @return A string such as [1,2,3].
+ */
+FOUNDATION_EXTERN NSString *GWMJSONArrayWithItemIDs(NSArray<NSNumber*> *itemIDs);
+
+typedef NS_ENUM(NSInteger, GWMCompiledQueryKind) {
+    GWMCompiledQuerySelect = 0,
+    GWMCompiledQueryUpdate,
+    GWMCompiledQueryDelete
+};
+
+///@discussion Where a page of a page query starts.
+typedef NS_ENUM(NSInteger, GWMPagePosition) {
+    ///@discussion The first page.
+    GWMPagePositionFirst = 0,
+    ///@discussion After the row with a sort value and a key.
+    GWMPagePositionAfterRow,
+    ///@discussion After the row with a key whose sort value is NULL.
+    GWMPagePositionAfterNullRow
+};
+
+/*!
+ * @class GWMCompiledQuery
+ * @discussion A statement built once from a table, the shape of its criteria, a sort and a limit, that can then be run any number of times with new values. The criteria shape has the same OR-of-AND form as the criteria dictionaries accepted by GWMDatabaseController: each entry is the columns of one AND group and the groups are joined with OR. The columns of each group are sorted, so the same shape always gives the same SQL and the same order of parameters, and the prepared statement is reused from the statement cache. Running a compiled query only looks up and binds values. A column that contains a ? is used as the predicate instead of column = ?. Compiled queries are immutable and can be shared between threads.
+ */
+@interface GWMCompiledQuery : NSObject
+
+@property (nonatomic, readonly) GWMCompiledQueryKind kind;
+///@discussion The SQL of the query.
+@property (nonatomic, readonly) NSString *statement;
+///@discussion The columns of each AND group, sorted.
+@property (nonatomic, readonly) NSArray<NSArray<GWMColumnName>*> *criteriaShape;
+///@discussion The columns set by an update query, sorted. Empty for other queries.
+@property (nonatomic, readonly) NSArray<GWMColumnName> *columns;
+///@discussion YES if a select query leaves out the rows whose pKey is in a set of excluded items.
+@property (nonatomic, readonly) BOOL excludesItems;
+///@discussion The number of values bound each time the query is run.
+@property (nonatomic, readonly) NSUInteger parameterCount;
+
+/*!
+ * @discussion Returns the shape of criteria dictionaries.
+ * @param criteria An NSArray of NSDictionary entries where the key is a table column. Can be nil.
+ * @return The sorted keys of each dictionary.
+ */
++(NSArray<NSArray<GWMColumnName>*> *)criteriaShapeWithCriteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria;
+/*!
+ * @discussion Creates a select query.
+ * @param table The table to select from.
+ * @param columns The result columns. Entering nil selects every column. To map rows to a GWMDataItem subclass, include a column named class whose value is the name of the class.
+ * @param criteriaShape The columns of each AND group. Can be nil.
+ * @param sortBy The column to sort by. Can be nil.
+ * @param ascending Enter NO to sort in descending order.
+ * @param limit The largest number of rows to return. Entering 0 returns every row.
+ * @return A GWMCompiledQuery object.
+ */
++(instancetype)queryWithTable:(GWMTableName)table columns:(NSArray<NSString*> *_Nullable)columns criteriaShape:(NSArray<NSArray<GWMColumnName>*> *_Nullable)criteriaShape sortBy:(GWMColumnName _Nullable)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit;
+/*!
+ * @discussion Creates a select query from a statement that does not have a WHERE clause, such as the statement of a GWMDataItem class.
+ * @param statement A SELECT ... FROM ... statement.
+ * @param criteriaShape The columns of each AND group. Can be nil.
+ * @param excludesItems Enter YES to leave out the rows of a set of excluded items each time the query is run.
+ * @param sortBy The column to sort by. Can be nil.
+ * @param ascending Enter NO to sort in descending order.
+ * @param limit The largest number of rows to return. Entering 0 returns every row.
+ * @return A GWMCompiledQuery object.
+ */
++(instancetype)queryWithStatement:(NSString *)statement criteriaShape:(NSArray<NSArray<GWMColumnName>*> *_Nullable)criteriaShape excludesItems:(BOOL)excludesItems sortBy:(GWMColumnName _Nullable)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit;
+/*!
+ * @discussion Creates a select query that reads one page of a sorted list. The rows are sorted by the sort column and then by the key column, so rows with the same sort value keep their order, and a page after the first starts with WHERE (sortBy, keyColumn) > (?, ?), or < for a descending sort. Each page therefore costs the same no matter how far into the list it is, unlike OFFSET. SQLite sorts NULL before other values, so a page after a row whose sort value is NULL needs its own position. The query is the same for every page after the first with the same position, so the prepared statement is reused.
+ * @param statement A SELECT ... FROM table AS alias statement, such as the list statement of a GWMDataItem class.
+ * @param alias The alias of the table in the statement. The sort and key columns are qualified with it.
+ * @param criteriaShape The columns of each AND group. Can be nil.
+ * @param sortBy The column to sort by.
+ * @param keyColumn A column with a unique value in every row, such as the primary key.
+ * @param ascending Enter NO to sort in descending order.
+ * @param position Where the page starts.
+ * @param limit The largest number of rows to return.
+ * @return A GWMCompiledQuery object.
+ */
++(instancetype)pageQueryWithStatement:(NSString *)statement tableAlias:(GWMTableAlias)alias criteriaShape:(NSArray<NSArray<GWMColumnName>*> *_Nullable)criteriaShape sortBy:(GWMColumnName)sortBy keyColumn:(GWMColumnName)keyColumn ascending:(BOOL)ascending position:(GWMPagePosition)position limit:(NSInteger)limit;
+/*!
+ * @discussion Creates an update query.
+ * @param table The table to update.
+ * @param columns The columns to set.
+ * @param criteriaShape The columns of each AND group. Entering nil updates every record.
+ * @param onConflict The conflict resolution of the update.
+ * @return A GWMCompiledQuery object.
+ */
++(instancetype)updateQueryWithTable:(GWMTableName)table columns:(NSArray<GWMColumnName> *)columns criteriaShape:(NSArray<NSArray<GWMColumnName>*> *_Nullable)criteriaShape onConflict:(GWMDBOnConflict)onConflict;
+/*!
+ * @discussion Creates a delete query.
+ * @param table The table to delete from.
+ * @param criteriaShape The columns of each AND group. Entering nil deletes every record.
+ * @return A GWMCompiledQuery object.
+ */
++(instancetype)deleteQueryWithTable:(GWMTableName)table criteriaShape:(NSArray<NSArray<GWMColumnName>*> *_Nullable)criteriaShape;
+-(instancetype)init NS_UNAVAILABLE;
+/*!
+ * @discussion Returns the values to bind, in the order of the parameters of the statement. A column missing from values or criteria is bound as NULL.
+ * @param values The new values of the columns of an update query, where the key is the column. Can be nil.
+ * @param criteria One NSDictionary for each AND group of the criteria shape, in the same order. Can be nil if the query has no criteria.
+ * @param excludedItemIDs The itemIDs to leave out of a query that excludes items. Can be nil.
+ * @return An NSArray, or nil if the number of dictionaries in criteria does not match the criteria shape.
+ */
+-(NSArray *_Nullable)valuesWithValues:(NSDictionary<GWMColumnName,id> *_Nullable)values criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria excludedItemIDs:(NSArray<NSNumber*> *_Nullable)excludedItemIDs;
+/*!
+ * @discussion Returns the values to bind to a page query, in the order of the parameters of the statement.
+ * @param criteria One NSDictionary for each AND group of the criteria shape, in the same order. Can be nil if the query has no criteria.
+ * @param sortValue The sort value of the row the page starts after. Ignored for the first page and after a NULL sort value.
+ * @param key The key of the row the page starts after. Ignored for the first page.
+ * @return An NSArray, or nil if the number of dictionaries in criteria does not match the criteria shape.
+ */
+-(NSArray *_Nullable)valuesWithCriteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria afterSortValue:(id _Nullable)sortValue key:(id _Nullable)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,288 @@
+//
+//  GWMCompiledQuery.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMCompiledQuery.h"
+
+// https://www.sqlite.org/json1.html#jeach
+NSString * const GWMSQLiteItemIDSetSelect = @"SELECT value FROM json_each(?)";
+
+NSString *GWMJSONArrayWithItemIDs(NSArray<NSNumber*> *itemIDs)
+{
+    return [NSString stringWithFormat:@"[%@]", [itemIDs componentsJoinedByString:@","]];
+}
+
+static NSString *GWMConflictStringWithConflict(GWMDBOnConflict conflict)
+{
+    switch (conflict) {
+        case GWMDBOnConflictRollback:
+            return @"OR ROLLBACK";
+        case GWMDBOnConflictFail:
+            return @"OR FAIL";
+        case GWMDBOnConflictIgnore:
+            return @"OR IGNORE";
+        case GWMDBOnConflictReplace:
+            return @"OR REPLACE";
+        default:
+            return @"OR ABORT";
+    }
+}
+
+@interface GWMCompiledQuery ()
+
+@property (nonatomic, readwrite) GWMCompiledQueryKind kind;
+@property (nonatomic, readwrite) NSString *statement;
+@property (nonatomic, readwrite) NSArray<NSArray<GWMColumnName>*> *criteriaShape;
+@property (nonatomic, readwrite) NSArray<GWMColumnName> *columns;
+@property (nonatomic, readwrite) BOOL excludesItems;
+@property (nonatomic, readwrite) NSUInteger parameterCount;
+///@discussion The values a page query binds after the criteria: the sort value and the key, only the key, or none.
+@property (nonatomic, assign) NSUInteger pageParameterCount;
+
+@end
+
+@implementation GWMCompiledQuery
+
+#pragma mark - Construction
+
++(NSArray<NSArray<GWMColumnName>*> *)criteriaShapeWithCriteria:(NSArray<NSDictionary<GWMColumnName,id>*> *)criteria
+{
+    NSMutableArray<NSArray<GWMColumnName>*> *mutableShape = [NSMutableArray new];
+
+    for (NSDictionary<GWMColumnName,id> *info in criteria)
+        [mutableShape addObject:[info.allKeys sortedArrayUsingSelector:@selector(compare:)]];
+
+    return [NSArray arrayWithArray:mutableShape];
+}
+
++(NSArray<NSArray<GWMColumnName>*> *)canonicalShapeWithShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape
+{
+    NSMutableArray<NSArray<GWMColumnName>*> *mutableShape = [NSMutableArray new];
+
+    for (NSArray<GWMColumnName> *columns in criteriaShape)
+        [mutableShape addObject:[columns sortedArrayUsingSelector:@selector(compare:)]];
+
+    return [NSArray arrayWithArray:mutableShape];
+}
+
+///@discussion The OR-of-AND predicate of a canonical shape, or nil if the shape is empty.
++(NSString *)predicateWithShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape
+{
+    if (criteriaShape.count == 0)
+        return nil;
+
+    NSMutableArray<NSString*> *mutableOrPredicates = [NSMutableArray<NSString*> new];
+
+    for (NSArray<GWMColumnName> *columns in criteriaShape) {
+
+        NSMutableArray<NSString*> *mutableAndPredicates = [NSMutableArray<NSString*> new];
+
+        for (GWMColumnName column in columns) {
+            // support other comparisons besides 'equals'
+            if ([column containsString:@"?"])
+                [mutableAndPredicates addObject:column];
+            else
+                [mutableAndPredicates addObject:[NSString stringWithFormat:@"%@ = ?", column]];
+        }
+
+        // an empty group has nothing to match
+        [mutableOrPredicates addObject:mutableAndPredicates.count > 0 ? [mutableAndPredicates componentsJoinedByString:@" AND "] : @"1"];
+    }
+
+    if (mutableOrPredicates.count == 1)
+        return mutableOrPredicates.firstObject;
+
+    return [NSString stringWithFormat:@"(%@)", [mutableOrPredicates componentsJoinedByString:@") OR ("]];
+}
+
++(NSUInteger)parameterCountWithShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape
+{
+    NSUInteger parameterCount = 0;
+
+    for (NSArray<GWMColumnName> *columns in criteriaShape)
+        parameterCount += columns.count;
+
+    return parameterCount;
+}
+
++(instancetype)queryWithTable:(GWMTableName)table columns:(NSArray<NSString*> *)columns criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit
+{
+    NSString *resultColumns = columns.count > 0 ? [columns componentsJoinedByString:@", "] : @"*";
+    NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@", resultColumns, table];
+
+    return [self queryWithStatement:statement criteriaShape:criteriaShape excludesItems:NO sortBy:sortBy ascending:ascending limit:limit];
+}
+
++(instancetype)queryWithStatement:(NSString *)statement criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape excludesItems:(BOOL)excludesItems sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit
+{
+    GWMCompiledQuery *query = [[self alloc] initWithKind:GWMCompiledQuerySelect criteriaShape:criteriaShape columns:nil];
+    NSString *predicate = [self predicateWithShape:query.criteriaShape];
+
+    NSMutableString *mutableStatement = [NSMutableString stringWithString:statement];
+
+    if (predicate && excludesItems)
+        [mutableStatement appendFormat:@" WHERE (%@) AND pKey NOT IN (%@)", predicate, GWMSQLiteItemIDSetSelect];
+    else if (predicate)
+        [mutableStatement appendFormat:@" WHERE %@", predicate];
+    else if (excludesItems)
+        [mutableStatement appendFormat:@" WHERE pKey NOT IN (%@)", GWMSQLiteItemIDSetSelect];
+
+    if (sortBy)
+        [mutableStatement appendFormat:@" ORDER BY %@ %@", sortBy, ascending ? @"ASC" : @"DESC"];
+
+    if (limit > 0)
+        [mutableStatement appendFormat:@" LIMIT %li", (long)limit];
+
+    query.statement = [NSString stringWithString:mutableStatement];
+    query.excludesItems = excludesItems;
+    if (excludesItems)
+        query.parameterCount++;
+
+    return query;
+}
+
++(instancetype)pageQueryWithStatement:(NSString *)statement tableAlias:(GWMTableAlias)alias criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape sortBy:(GWMColumnName)sortBy keyColumn:(GWMColumnName)keyColumn ascending:(BOOL)ascending position:(GWMPagePosition)position limit:(NSInteger)limit
+{
+    GWMCompiledQuery *query = [[self alloc] initWithKind:GWMCompiledQuerySelect criteriaShape:criteriaShape columns:nil];
+    NSString *predicate = [self predicateWithShape:query.criteriaShape];
+
+    NSString *sortColumn = [NSString stringWithFormat:@"%@.%@", alias, sortBy];
+    NSString *qualifiedKeyColumn = [NSString stringWithFormat:@"%@.%@", alias, keyColumn];
+    NSString *direction = ascending ? @"ASC" : @"DESC";
+    NSString *comparison = ascending ? @">" : @"<";
+    NSString *pagePredicate = nil;
+
+    if ([sortBy isEqualToString:keyColumn]) {
+        // the key alone orders the rows
+        if (position != GWMPagePositionFirst) {
+            pagePredicate = [NSString stringWithFormat:@"%@ %@ ?", qualifiedKeyColumn, comparison];
+            query.pageParameterCount = 1;
+        }
+    } else if (position == GWMPagePositionAfterRow) {
+        // NULL sort values come first in an ascending sort and last in a descending one
+        if (ascending)
+            pagePredicate = [NSString stringWithFormat:@"(%@, %@) > (?, ?)", sortColumn, qualifiedKeyColumn];
+        else
+            pagePredicate = [NSString stringWithFormat:@"((%@, %@) < (?, ?) OR %@ IS NULL)", sortColumn, qualifiedKeyColumn, sortColumn];
+        query.pageParameterCount = 2;
+    } else if (position == GWMPagePositionAfterNullRow) {
+        if (ascending)
+            pagePredicate = [NSString stringWithFormat:@"(%@ IS NOT NULL OR %@ > ?)", sortColumn, qualifiedKeyColumn];
+        else
+            pagePredicate = [NSString stringWithFormat:@"(%@ IS NULL AND %@ < ?)", sortColumn, qualifiedKeyColumn];
+        query.pageParameterCount = 1;
+    }
+
+    NSMutableString *mutableStatement = [NSMutableString stringWithString:statement];
+
+    if (predicate && pagePredicate)
+        [mutableStatement appendFormat:@" WHERE (%@) AND %@", predicate, pagePredicate];
+    else if (predicate)
+        [mutableStatement appendFormat:@" WHERE %@", predicate];
+    else if (pagePredicate)
+        [mutableStatement appendFormat:@" WHERE %@", pagePredicate];
+
+    if ([sortBy isEqualToString:keyColumn])
+        [mutableStatement appendFormat:@" ORDER BY %@ %@", qualifiedKeyColumn, direction];
+    else
+        [mutableStatement appendFormat:@" ORDER BY %@ %@, %@ %@", sortColumn, direction, qualifiedKeyColumn, direction];
+
+    if (limit > 0)
+        [mutableStatement appendFormat:@" LIMIT %li", (long)limit];
+
+    query.statement = [NSString stringWithString:mutableStatement];
+    query.parameterCount += query.pageParameterCount;
+
+    return query;
+}
+
++(instancetype)updateQueryWithTable:(GWMTableName)table columns:(NSArray<GWMColumnName> *)columns criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape onConflict:(GWMDBOnConflict)onConflict
+{
+    GWMCompiledQuery *query = [[self alloc] initWithKind:GWMCompiledQueryUpdate criteriaShape:criteriaShape columns:columns];
+    NSString *predicate = [self predicateWithShape:query.criteriaShape];
+
+    NSMutableArray<NSString*> *mutableAssignments = [NSMutableArray<NSString*> new];
+    for (GWMColumnName column in query.columns)
+        [mutableAssignments addObject:[NSString stringWithFormat:@"%@ = ?", column]];
+
+    NSMutableString *mutableStatement = [NSMutableString stringWithFormat:@"UPDATE %@ %@ SET %@", GWMConflictStringWithConflict(onConflict), table, [mutableAssignments componentsJoinedByString:@", "]];
+
+    if (predicate)
+        [mutableStatement appendFormat:@" WHERE %@", predicate];
+
+    query.statement = [NSString stringWithString:mutableStatement];
+
+    return query;
+}
+
++(instancetype)deleteQueryWithTable:(GWMTableName)table criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape
+{
+    GWMCompiledQuery *query = [[self alloc] initWithKind:GWMCompiledQueryDelete criteriaShape:criteriaShape columns:nil];
+    NSString *predicate = [self predicateWithShape:query.criteriaShape];
+
+    if (predicate)
+        query.statement = [NSString stringWithFormat:@"DELETE FROM %@ WHERE %@", table, predicate];
+    else
+        query.statement = [NSString stringWithFormat:@"DELETE FROM %@", table];
+
+    return query;
+}
+
+-(instancetype)initWithKind:(GWMCompiledQueryKind)kind criteriaShape:(NSArray<NSArray<GWMColumnName>*> *)criteriaShape columns:(NSArray<GWMColumnName> *)columns
+{
+    if (self = [super init]) {
+        _kind = kind;
+        _criteriaShape = [GWMCompiledQuery canonicalShapeWithShape:criteriaShape];
+        _columns = columns ? [columns sortedArrayUsingSelector:@selector(compare:)] : @[];
+        _parameterCount = _columns.count + [GWMCompiledQuery parameterCountWithShape:_criteriaShape];
+    }
+    return self;
+}
+
+#pragma mark - Values
+
+-(NSArray *)valuesWithValues:(NSDictionary<GWMColumnName,id> *)values criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *)criteria excludedItemIDs:(NSArray<NSNumber*> *)excludedItemIDs
+{
+    if (criteria.count != self.criteriaShape.count)
+        return nil;
+
+    NSMutableArray *mutableValues = [NSMutableArray arrayWithCapacity:self.parameterCount];
+    NSNull *null = [NSNull null];
+
+    for (GWMColumnName column in self.columns)
+        [mutableValues addObject:values[column] ?: null];
+
+    [self.criteriaShape enumerateObjectsUsingBlock:^(NSArray<GWMColumnName> *_Nonnull columns, NSUInteger idx, BOOL *stop){
+        NSDictionary<GWMColumnName,id> *info = criteria[idx];
+        for (GWMColumnName column in columns)
+            [mutableValues addObject:info[column] ?: null];
+    }];
+
+    if (self.excludesItems)
+        [mutableValues addObject:GWMJSONArrayWithItemIDs(excludedItemIDs ?: @[])];
+
+    return mutableValues;
+}
+
+-(NSArray *)valuesWithCriteria:(NSArray<NSDictionary<GWMColumnName,id>*> *)criteria afterSortValue:(id)sortValue key:(id)key
+{
+    NSMutableArray *mutableValues = [[self valuesWithValues:nil criteria:criteria excludedItemIDs:nil] mutableCopy];
+
+    if (!mutableValues)
+        return nil;
+
+    NSNull *null = [NSNull null];
+
+    if (self.pageParameterCount == 2)
+        [mutableValues addObject:sortValue ?: null];
+    if (self.pageParameterCount > 0)
+        [mutableValues addObject:key ?: null];
+
+    return mutableValues;
+}
+
+@end
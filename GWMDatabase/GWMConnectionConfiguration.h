@@ -0,0 +1,82 @@
+//
+//  GWMConnectionConfiguration.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseHelperItems.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString *GWMJournalMode;
+
+///@discussion Leaves the journal mode of the database as it is.
+extern GWMJournalMode const GWMJournalModeDefault;
+extern GWMJournalMode const GWMJournalModeDelete;
+extern GWMJournalMode const GWMJournalModeTruncate;
+extern GWMJournalMode const GWMJournalModePersist;
+extern GWMJournalMode const GWMJournalModeMemory;
+extern GWMJournalMode const GWMJournalModeWAL;
+extern GWMJournalMode const GWMJournalModeOff;
+
+typedef NS_ENUM(NSInteger, GWMSynchronousMode) {
+    GWMSynchronousModeDefault = -1,
+    GWMSynchronousModeOff = 0,
+    GWMSynchronousModeNormal = 1,
+    GWMSynchronousModeFull = 2,
+    GWMSynchronousModeExtra = 3
+};
+
+typedef NS_ENUM(NSInteger, GWMTempStore) {
+    GWMTempStoreDefault = 0,
+    GWMTempStoreFile = 1,
+    GWMTempStoreMemory = 2
+};
+
+///@discussion A value of a GWMConnectionConfiguration property that leaves the setting of the connection as it is.
+FOUNDATION_EXTERN NSInteger const GWMConnectionSettingDefault;
+
+/*!
+ * @class GWMConnectionConfiguration
+ * @discussion The PRAGMA settings a GWMDatabaseController applies once to each connection it opens: the main connection, every reader connection and every database attached to them. Settings left at their default values are not applied, so SQLite keeps its own. Use one of the profiles or change a copy of one. Changes only affect connections opened after the configuration is set.
+ */
+@interface GWMConnectionConfiguration : NSObject <NSCopying>
+
+///@discussion PRAGMA journal_mode. The reader pool switches the database to GWMJournalModeWAL whatever this is. The default is GWMJournalModeDefault.
+@property (nonatomic, copy) GWMJournalMode journalMode;
+///@discussion PRAGMA synchronous. The default is GWMSynchronousModeDefault.
+@property (nonatomic, assign) GWMSynchronousMode synchronous;
+///@discussion PRAGMA mmap_size, in bytes. 0 turns memory-mapped I/O off. The default is GWMConnectionSettingDefault.
+@property (nonatomic, assign) NSInteger mmapSize;
+///@discussion PRAGMA cache_size, in KiB, for each schema of each connection. The default is GWMConnectionSettingDefault.
+@property (nonatomic, assign) NSInteger cacheSizeKiB;
+///@discussion PRAGMA temp_store. The default is GWMTempStoreDefault.
+@property (nonatomic, assign) GWMTempStore tempStore;
+///@discussion PRAGMA page_size, in bytes. Only takes effect on a database that has no tables yet, or after vacuum:, and not while the database is in write-ahead logging mode. The default is GWMConnectionSettingDefault.
+@property (nonatomic, assign) NSInteger pageSize;
+///@discussion PRAGMA busy_timeout, in seconds. How long a connection waits for a lock held by another process before failing with SQLITE_BUSY. The default is 0, which fails at once.
+@property (nonatomic, assign) NSTimeInterval busyTimeout;
+
+///@discussion Applies no settings. The configuration of a GWMDatabaseController until another is set.
++(instancetype)defaultConfiguration;
+///@discussion For databases that are queried much more than they are written: write-ahead logging, synchronous NORMAL, 256 MB of memory-mapped I/O, a 64 MB page cache, temporary tables in memory and a 5 second busy timeout. A commit can be lost to a power failure, but the database is not corrupted.
++(instancetype)readMostlyConfiguration;
+///@discussion For large imports: write-ahead logging, synchronous OFF, a 256 MB page cache, temporary tables in memory and a 5 second busy timeout. Commits do not wait for the disk, so a power failure or an operating system crash during an import can lose or corrupt the most recent commits. A crash of the app alone does not.
++(instancetype)bulkLoadConfiguration;
+///@discussion For data that must not be lost once a commit returns: write-ahead logging, synchronous FULL and a 5 second busy timeout.
++(instancetype)durableConfiguration;
+
+/*!
+ * @discussion Returns the PRAGMA statements of the configuration, in the order they must be run.
+ * @param schema The schema to apply the settings to. Entering nil applies them to the main database and includes the settings of the whole connection, temp_store and busy_timeout.
+ * @param readOnly Enter YES for a read-only connection, which leaves out journal_mode, synchronous and page_size.
+ * @return The statements. Empty if nothing is applied.
+ */
+-(NSArray<NSString*> *)statementsWithSchema:(GWMSchemaName _Nullable)schema readOnly:(BOOL)readOnly;
+
+@end
+
+NS_ASSUME_NONNULL_END
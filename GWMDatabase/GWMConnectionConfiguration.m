@@ -0,0 +1,123 @@
+//
+//  GWMConnectionConfiguration.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMConnectionConfiguration.h"
+
+GWMJournalMode const GWMJournalModeDefault = @"";
+GWMJournalMode const GWMJournalModeDelete = @"DELETE";
+GWMJournalMode const GWMJournalModeTruncate = @"TRUNCATE";
+GWMJournalMode const GWMJournalModePersist = @"PERSIST";
+GWMJournalMode const GWMJournalModeMemory = @"MEMORY";
+GWMJournalMode const GWMJournalModeWAL = @"WAL";
+GWMJournalMode const GWMJournalModeOff = @"OFF";
+
+NSInteger const GWMConnectionSettingDefault = -1;
+
+@implementation GWMConnectionConfiguration
+
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _journalMode = GWMJournalModeDefault;
+        _synchronous = GWMSynchronousModeDefault;
+        _mmapSize = GWMConnectionSettingDefault;
+        _cacheSizeKiB = GWMConnectionSettingDefault;
+        _tempStore = GWMTempStoreDefault;
+        _pageSize = GWMConnectionSettingDefault;
+        _busyTimeout = 0;
+    }
+    return self;
+}
+
+-(id)copyWithZone:(NSZone *)zone
+{
+    GWMConnectionConfiguration *configuration = [[[self class] allocWithZone:zone] init];
+    configuration.journalMode = self.journalMode;
+    configuration.synchronous = self.synchronous;
+    configuration.mmapSize = self.mmapSize;
+    configuration.cacheSizeKiB = self.cacheSizeKiB;
+    configuration.tempStore = self.tempStore;
+    configuration.pageSize = self.pageSize;
+    configuration.busyTimeout = self.busyTimeout;
+    return configuration;
+}
+
+#pragma mark - Profiles
+
++(instancetype)defaultConfiguration
+{
+    return [[self alloc] init];
+}
+
++(instancetype)readMostlyConfiguration
+{
+    GWMConnectionConfiguration *configuration = [[self alloc] init];
+    configuration.journalMode = GWMJournalModeWAL;
+    configuration.synchronous = GWMSynchronousModeNormal;
+    configuration.mmapSize = 256 * 1024 * 1024;
+    configuration.cacheSizeKiB = 64 * 1024;
+    configuration.tempStore = GWMTempStoreMemory;
+    configuration.busyTimeout = 5.0;
+    return configuration;
+}
+
++(instancetype)bulkLoadConfiguration
+{
+    GWMConnectionConfiguration *configuration = [[self alloc] init];
+    configuration.journalMode = GWMJournalModeWAL;
+    configuration.synchronous = GWMSynchronousModeOff;
+    configuration.cacheSizeKiB = 256 * 1024;
+    configuration.tempStore = GWMTempStoreMemory;
+    configuration.busyTimeout = 5.0;
+    return configuration;
+}
+
++(instancetype)durableConfiguration
+{
+    GWMConnectionConfiguration *configuration = [[self alloc] init];
+    configuration.journalMode = GWMJournalModeWAL;
+    configuration.synchronous = GWMSynchronousModeFull;
+    configuration.busyTimeout = 5.0;
+    return configuration;
+}
+
+#pragma mark - Statements
+
+// https://www.sqlite.org/pragma.html
+-(NSArray<NSString*> *)statementsWithSchema:(GWMSchemaName)schema readOnly:(BOOL)readOnly
+{
+    NSMutableArray<NSString*> *mutableStatements = [NSMutableArray<NSString*> new];
+    NSString *prefix = schema.length > 0 ? [NSString stringWithFormat:@"%@.", schema] : @"";
+
+    // the page size can't change once the database is in write-ahead logging mode
+    if (!readOnly && self.pageSize > 0)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA %@page_size = %ld;", prefix, (long)self.pageSize]];
+
+    if (!readOnly && self.journalMode.length > 0)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA %@journal_mode = %@;", prefix, self.journalMode]];
+
+    if (!readOnly && self.synchronous != GWMSynchronousModeDefault)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA %@synchronous = %ld;", prefix, (long)self.synchronous]];
+
+    if (self.mmapSize >= 0)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA %@mmap_size = %ld;", prefix, (long)self.mmapSize]];
+
+    // a negative cache size is in KiB rather than pages
+    if (self.cacheSizeKiB >= 0)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA %@cache_size = -%ld;", prefix, (long)self.cacheSizeKiB]];
+
+    if (schema.length == 0 && self.tempStore != GWMTempStoreDefault)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA temp_store = %ld;", (long)self.tempStore]];
+
+    if (schema.length == 0 && self.busyTimeout > 0)
+        [mutableStatements addObject:[NSString stringWithFormat:@"PRAGMA busy_timeout = %ld;", (long)(self.busyTimeout * 1000)]];
+
+    return [NSArray arrayWithArray:mutableStatements];
+}
+
+@end
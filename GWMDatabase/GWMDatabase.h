@@ -18,6 +18,13 @@ FOUNDATION_EXPORT const unsigned char GWMDatabaseVersionString[];
 
 #import <GWMDatabase/GWMDatabaseController.h>
 #import <GWMDatabase/GWMDatabaseResult.h>
+#import <GWMDatabase/GWMDatabaseCursor.h>
+#import <GWMDatabase/GWMColumnarResult.h>
+#import <GWMDatabase/GWMBlobHandle.h>
+#import <GWMDatabase/GWMCompiledQuery.h>
+#import <GWMDatabase/GWMConnectionConfiguration.h>
+#import <GWMDatabase/GWMTransaction.h>
+#import <GWMDatabase/GWMChangeSet.h>
 #import <GWMDatabase/GWMDataItem.h>
 #import <GWMDatabase/GWMRelationshipItem.h>
 
@@ -0,0 +1,56 @@
+//
+//  GWMDatabaseConnection.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import <sqlite3.h>
+
+@class GWMStatementCache;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMDatabaseConnection
+ * @discussion A read-only SQLite connection in the reader pool of a GWMDatabaseController. Each connection has its own prepared-statement cache and is used by one thread at a time.
+ */
+@interface GWMDatabaseConnection : NSObject
+
+///@discussion The SQLite connection. NULL once the connection is closed.
+@property (nonatomic, readonly) sqlite3 *_Nullable database;
+///@discussion The prepared statements of this connection.
+@property (nonatomic, readonly) GWMStatementCache *statementCache;
+///@discussion The thread the connection is checked out to or nil if the connection is idle.
+@property (nonatomic, weak) NSThread *_Nullable thread;
+///@discussion The number of statements the thread is holding on this connection.
+@property (nonatomic, assign) NSUInteger checkoutCount;
+
+/*!
+ * @discussion Keeps a block to run on the connection once it is checked in, for a change that has to reach every connection while this one is in use.
+ * @param block The block.
+ */
+-(void)addDeferredBlock:(void (^)(GWMDatabaseConnection *connection))block;
+///@discussion Runs the deferred blocks in the order they were added and removes them.
+-(void)runDeferredBlocks;
+/*!
+ * @discussion Opens a read-only connection.
+ * @param path The path of the database file.
+ * @param statementCacheCapacity The capacity of the connection's statement cache.
+ * @return A connection or nil if the database could not be opened.
+ */
+-(instancetype _Nullable)initWithPath:(NSString *)path statementCacheCapacity:(NSUInteger)statementCacheCapacity;
+/*!
+ * @discussion Runs one or more statements that do not return rows, such as ATTACH DATABASE.
+ * @param statement The SQL text.
+ * @return The SQLite result code.
+ */
+-(int)executeStatement:(NSString *)statement;
+///@discussion Finalizes the cached statements and closes the connection.
+-(void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
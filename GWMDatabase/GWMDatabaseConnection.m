@@ -0,0 +1,94 @@
+//
+//  GWMDatabaseConnection.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMDatabaseConnection.h"
+#import "GWMDatabaseController.h"
+#import "GWMStatementCache.h"
+
+@interface GWMDatabaseConnection ()
+
+@property (nonatomic, strong) NSMutableArray<void (^)(GWMDatabaseConnection *connection)> *deferredBlocks;
+
+@end
+
+@implementation GWMDatabaseConnection
+
+-(instancetype)initWithPath:(NSString *)path statementCacheCapacity:(NSUInteger)statementCacheCapacity
+{
+    if (self = [super init]) {
+
+        sqlite3 *db = NULL;
+
+        // the connection is only ever used by the thread that checked it out
+        int openCode = sqlite3_open_v2(path.UTF8String, &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL);
+
+        if (openCode != SQLITE_OK) {
+            NSLog(@"*** %@ at path: %@ with error: '%s' ***", GWMSQLiteErrorOpeningDatabase, path, sqlite3_errmsg(db));
+            sqlite3_close(db);
+            return nil;
+        }
+
+        _database = db;
+        _statementCache = [[GWMStatementCache alloc] initWithDatabase:db capacity:statementCacheCapacity];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    [self close];
+}
+
+-(void)addDeferredBlock:(void (^)(GWMDatabaseConnection *connection))block
+{
+    if (!self.deferredBlocks)
+        self.deferredBlocks = [NSMutableArray new];
+    [self.deferredBlocks addObject:[block copy]];
+}
+
+-(void)runDeferredBlocks
+{
+    NSArray<void (^)(GWMDatabaseConnection *connection)> *blocks = self.deferredBlocks;
+    self.deferredBlocks = nil;
+
+    for (void (^block)(GWMDatabaseConnection *connection) in blocks)
+        block(self);
+}
+
+-(int)executeStatement:(NSString *)statement
+{
+    char *errorMessageC = NULL;
+
+    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+
+    if (executeCode != SQLITE_OK) {
+        NSLog(@"*** %@: Message: %s Statement: '%@' ***", GWMSQLiteErrorExecutingStatement, errorMessageC, statement);
+        sqlite3_free(errorMessageC);
+    }
+
+    return executeCode;
+}
+
+-(void)close
+{
+    if (self.database == NULL)
+        return;
+
+    [self.statementCache removeAllStatements];
+
+    int closeCode = sqlite3_close(self.database);
+
+    if (closeCode != SQLITE_OK) {
+        NSLog(@"*** %@: Message:'%s' ***", GWMSQLiteErrorClosingDatabase, sqlite3_errmsg(self.database));
+        return;
+    }
+
+    _database = NULL;
+}
+
+@end
@@ -8,9 +8,16 @@
 
 @import Foundation;
 #import "GWMDatabaseHelperItems.h"
+#import "GWMTransaction.h"
 
 @class GWMDataItem;
 @class GWMDatabaseResult;
+@class GWMDatabaseCursor;
+@class GWMColumnarResult;
+@class GWMBlobHandle;
+@class GWMCompiledQuery;
+@class GWMConnectionConfiguration;
+@class GWMChangeSet;
 
 #pragma mark - Data Types
 
@@ -54,6 +61,11 @@ typedef void (^GWMDBErrorCompletionBlock)(NSError *_Nullable error);
  * @param error An NSError object that is generated if there was a problem.
  */
 typedef void (^GWMDatabaseResultBlock)(GWMDataItem *_Nullable itm, NSError *_Nullable error);
+/*!
+ * @brief A write run by the write-behind queue.
+ * @discussion This block takes no arguments and returns an NSError to roll the write back, or nil to keep it.
+ */
+typedef NSError *_Nullable (^GWMDBWriteBlock)(void);
 /*!
  * @brief Binds values in a SQLite statement.
  * @discussion This block takes three arguments and returns void.
@@ -62,11 +74,51 @@ typedef void (^GWMDatabaseResultBlock)(GWMDataItem *_Nullable itm, NSError *_Nul
  * @param stop A BOOL value.
  */
 typedef void (^GWMBindValuesEnumerationBlock)(id value, NSUInteger idx, BOOL  *stop);
+/*!
+ * @brief Receives the rows of a query one at a time.
+ * @discussion This block takes three arguments and returns void.
+ * @param obj The object the row was mapped to.
+ * @param idx The index of the row.
+ * @param stop Set to YES to stop enumerating rows.
+ */
+typedef void (^GWMDBRowEnumerationBlock)(id obj, NSUInteger idx, BOOL *stop);
+/*!
+ * @brief Receives the BLOB values of a query one at a time.
+ * @discussion This block takes three arguments and returns void.
+ * @param data The value of the first column of the row without copying it, or nil if it is NULL. The bytes belong to SQLite and are only valid until the block returns; copy the data to keep it.
+ * @param idx The index of the row.
+ * @param stop Set to YES to stop enumerating rows.
+ */
+typedef void (^GWMDBBlobEnumerationBlock)(NSData *_Nullable data, NSUInteger idx, BOOL *stop);
+/*!
+ * @brief Runs on completion of a bulk insert.
+ * @discussion This block takes three arguments and returns void.
+ * @param insertedCount The number of rows that were inserted.
+ * @param rowErrors An NSDictionary where the key is the index of a row that could not be inserted and the value is the error. nil if every row was inserted.
+ * @param error An NSError object that is generated if the insert had to stop before every row was attempted.
+ */
+typedef void (^GWMDBBulkInsertCompletionBlock)(NSUInteger insertedCount, NSDictionary<NSNumber*,NSError*> *_Nullable rowErrors, NSError *_Nullable error);
+/*!
+ * @brief Runs on completion of a bulk upsert.
+ * @discussion This block takes three arguments and returns void.
+ * @param itemIDs An NSArray with the value of the returning column of each row, in the same order as the rows. Rows that could not be written have kGWMNewRecordValue.
+ * @param rowErrors An NSDictionary where the key is the index of a row that could not be written and the value is the error. nil if every row was written.
+ * @param error An NSError object that is generated if the upsert had to stop before every row was attempted.
+ */
+typedef void (^GWMDBBulkUpsertCompletionBlock)(NSArray<NSNumber*> *itemIDs, NSDictionary<NSNumber*,NSError*> *_Nullable rowErrors, NSError *_Nullable error);
+/*!
+ * @brief Runs on completion of a bulk delete.
+ * @discussion This block takes three arguments and returns void.
+ * @param deletedCount The number of records that were deleted.
+ * @param rowErrors An NSDictionary where the key is the index of a row whose DELETE statement failed and the value is the error. nil if every statement succeeded.
+ * @param error An NSError object that is generated if the transaction could not be committed.
+ */
+typedef void (^GWMDBBulkDeleteCompletionBlock)(NSUInteger deletedCount, NSDictionary<NSNumber*,NSError*> *_Nullable rowErrors, NSError *_Nullable error);
 
 #pragma mark Notification Names
 /*!
- *@brief Posted when data is updated or deleted in a database.
- *@discussion This notification has no userInfo dictionary.
+ *@brief Posted when data is inserted, updated or deleted in a database.
+ *@discussion Posted once for each committed transaction that changed rows, including changes made with processStatement: and applyStatements:identifier:completion:, on the thread that made the last write of the transaction once the write has returned. The object is the GWMDatabaseController and the userInfo dictionary holds the GWMChangeSet under GWMDBChangeSetKey.
  */
 extern NSNotificationName const GWMDatabaseControllerDidUpdateDataNotification;
 /*!
@@ -85,6 +137,11 @@ extern NSNotificationName const GWMDatabaseControllerDidFinishUserDataMigrationN
  *@discussion The value is a NSString.
  */
 extern NSString * const GWMDBStatementKey;
+/*!
+ *@brief Key to retrieve the committed changes from the userInfo dictionary of GWMDatabaseControllerDidUpdateDataNotification.
+ *@discussion The value is a GWMChangeSet.
+ */
+extern NSString * const GWMDBChangeSetKey;
 
 #pragma mark Date & Time Strings
 /*!
@@ -117,8 +174,12 @@ extern GWMSQLiteErrorName const GWMSQLiteErrorBindingNullValue;
 extern GWMSQLiteErrorName const GWMSQLiteErrorBindingTextValue;
 extern GWMSQLiteErrorName const GWMSQLiteErrorBindingIntegerValue;
 extern GWMSQLiteErrorName const GWMSQLiteErrorBindingDoubleValue;
+extern GWMSQLiteErrorName const GWMSQLiteErrorBindingBlobValue;
 extern GWMSQLiteErrorName const GWMSQLiteErrorSteppingToRow;
 extern GWMSQLiteErrorName const GWMSQLiteErrorFinalizingStatement;
+extern GWMSQLiteErrorName const GWMSQLiteErrorOpeningBlob;
+extern GWMSQLiteErrorName const GWMSQLiteErrorReadingBlob;
+extern GWMSQLiteErrorName const GWMSQLiteErrorWritingBlob;
 
 #pragma mark Error Domain
 /*!
@@ -164,6 +225,50 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
 @property (nonatomic) BOOL foreignKeysEnabled;
 @property (nonatomic, readonly) NSDateFormatter *dateFormatter;
 @property (nonatomic, readonly) NSNotificationCenter *notificationCenter;
+///@discussion The maximum number of prepared statements kept for reuse by each database connection. The least recently used statement is finalized when the limit is reached. The default is 64. Entering 0 disables statement caching.
+@property (nonatomic, assign) NSUInteger statementCacheCapacity;
+///@discussion The number of times a prepared statement was reused instead of being prepared again.
+@property (nonatomic, readonly) NSUInteger statementCacheHits;
+///@discussion The number of times a statement had to be prepared because it was not in the statement cache.
+@property (nonatomic, readonly) NSUInteger statementCacheMisses;
+///@discussion The largest estimated size, in bytes, of the objects kept by the identity map. When greater than 0, rows of the classes in classToTableMapping that have an itemID column are mapped to an object once and the same object is returned for that row until it is inserted, updated or deleted, or until it is evicted because it is the least recently used and the limit is reached. Rows read with different columns are kept as separate objects. The objects are shared by every caller, so treat them as read-only, and only turn the map on when queries for a mapped class read its columns from the class's table. The default is 0, which turns the identity map off.
+@property (nonatomic, assign) NSUInteger identityMapMemoryLimit;
+///@discussion The number of times a row was returned from the identity map instead of being mapped again.
+@property (nonatomic, readonly) NSUInteger identityMapHits;
+///@discussion The number of times a row had to be mapped because it was not in the identity map.
+@property (nonatomic, readonly) NSUInteger identityMapMisses;
+///@discussion The fraction of identity map lookups that were hits, from 0 to 1.
+@property (nonatomic, readonly) double identityMapHitRate;
+///@discussion The estimated size, in bytes, of the objects in the identity map.
+@property (nonatomic, readonly) NSUInteger identityMapMemoryUsage;
+///@discussion The number of objects in the identity map.
+@property (nonatomic, readonly) NSUInteger identityMapCount;
+///@discussion The largest estimated size, in bytes, of the query results kept by the result cache. When greater than 0, the rows returned by resultWithStatement:criteria:completion: and resultWithStatement:criteria:exclude:sortBy:ascending:limit:completion: are kept with the tables the query read and returned again for the same SQL text and values until one of those tables is changed, or until the result is evicted because it is the least recently used and the limit is reached. The objects in a cached result are shared by every caller, so treat them as read-only. The default is 0, which turns the result cache off.
+@property (nonatomic, assign) NSUInteger resultCacheMemoryLimit;
+///@discussion The number of times a query was answered from the result cache.
+@property (nonatomic, readonly) NSUInteger resultCacheHits;
+///@discussion The number of times a query had to run because its result was not in the result cache.
+@property (nonatomic, readonly) NSUInteger resultCacheMisses;
+///@discussion The number of results evicted from the result cache to stay under resultCacheMemoryLimit.
+@property (nonatomic, readonly) NSUInteger resultCacheEvictions;
+///@discussion The number of results removed from the result cache because a table they were read from changed.
+@property (nonatomic, readonly) NSUInteger resultCacheInvalidations;
+///@discussion The estimated size, in bytes, of the results in the result cache.
+@property (nonatomic, readonly) NSUInteger resultCacheMemoryUsage;
+///@discussion The number of read-only connections opened next to the main connection. When greater than 0, the database is switched to write-ahead logging, queries run by resultWithStatement and countOfRecords are spread over the read-only connections so they can run on several threads at once, and inserts, updates, deletes and transactions are run one after another on a serial queue. Set this before the database is opened. The default is 0, which runs everything on the main connection.
+@property (nonatomic, assign) NSUInteger readerConnectionCount;
+///@discussion The PRAGMA settings applied once to the main connection, to every reader connection and to every database attached to them, when they are opened. Set this before the database is opened. The default is GWMConnectionConfiguration.defaultConfiguration, which applies none.
+@property (nonatomic, copy) GWMConnectionConfiguration *connectionConfiguration;
+///@discussion When YES, every statement run on the database connections is recorded: how often it ran, how long it took, the rows it returned, how often it was prepared and the full-scan step, sort, automatic index and virtual machine step counters of sqlite3_stmt_status. Statements are grouped by their SQL text. Read the results with profilingSnapshot. When NO, the connections are not traced at all. The default is NO.
+@property (nonatomic, assign) BOOL profilingEnabled;
+///@discussion While profilingEnabled is YES, runs that take at least this long, in seconds, are kept as slow statements with the values that were bound and the query plan. The 100 most recent are kept. Bound values can hold private data, so only set this while investigating. The default is 0, which keeps none.
+@property (nonatomic, assign) NSTimeInterval slowStatementThreshold;
+///@discussion How long, in seconds, the first write added with enqueueWrite:completion: waits for others to be committed with it. The default is 0.01.
+@property (nonatomic, assign) NSTimeInterval writeBatchInterval;
+///@discussion The largest number of writes added with enqueueWrite:completion: that are committed in one transaction. A batch is committed at once when this many writes are waiting. The default is 256.
+@property (nonatomic, assign) NSUInteger writeBatchSize;
+///@discussion The number of writes added with enqueueWrite:completion: that have not been committed yet.
+@property (nonatomic, readonly) NSUInteger writeQueueDepth;
 
 +(instancetype)sharedController;
 
@@ -179,6 +284,100 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  */
 -(NSString *)sqliteLibraryVersion;
 
+#pragma mark - Statement Cache
+/*!
+ * @brief Finalize every cached prepared statement.
+ * @discussion The statement cache is cleared automatically after schema changes made through the controller. Call this method after changing the schema by other means.
+ */
+-(void)clearStatementCache;
+/*!
+ * @discussion Sets the statement cache hit and miss counters back to zero.
+ */
+-(void)resetStatementCacheStatistics;
+
+#pragma mark - Profiling
+/*!
+ * @discussion Returns what has been recorded while profilingEnabled was YES. Works out the EXPLAIN QUERY PLAN of slow statements that do not have one yet on the main connection.
+ * @return An NSDictionary with two entries. statements is an NSArray with a dictionary for each statement, sorted from the most to the least total time, with the keys statement, calls, totalTime, p50Time, p99Time, rows, prepares, fullScanSteps, sorts, autoIndexes and vmSteps. The percentiles are of the 512 most recent runs. slowStatements is an NSArray with a dictionary for each slow run, from the oldest to the newest, with the keys statement, expandedStatement (the statement with its bound values), time, date (seconds since 1970), rows and queryPlan. Times are in seconds.
+ */
+-(NSDictionary<NSString*,id> *)profilingSnapshot;
+/*!
+ * @discussion Returns profilingSnapshot as JSON.
+ * @param error On return, the error if the snapshot could not be written as JSON.
+ * @return UTF-8 encoded JSON or nil.
+ */
+-(NSData *_Nullable)profilingSnapshotJSONDataWithError:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Removes every recorded statement and slow statement.
+ */
+-(void)resetProfiling;
+
+#pragma mark - Write-Behind Queue
+/*!
+ * @discussion Adds a small write to the write-behind queue instead of committing it on its own. Writes from every thread are collected for writeBatchInterval, or until writeBatchSize of them are waiting, and are then committed together in one transaction on a serial queue, so they share a single sync to disk. Each write runs in its own SAVEPOINT inside the batch, so a write that returns an error or throws is rolled back without the rest of the batch. The write is durable once its completion runs with a nil error.
+ * @param write The write, such as a call to updateTable:withValues:criteria:completion:. Runs on the serial queue of the write-behind queue. Return an error to roll the write back.
+ * @param completion Runs on the serial queue of the write-behind queue after the batch has been committed or rolled back. The error is the error of the write or, if the batch could not be committed, of the batch. This parameter can be nil.
+ */
+-(void)enqueueWrite:(GWMDBWriteBlock)write completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Adds an UPDATE to the write-behind queue. See enqueueWrite:completion:.
+ * @param table The table to update.
+ * @param values An NSDictionary where the key is the column and the value is the new value.
+ * @param criteria An NSDictionary where the key is the column and the value is the value to match.
+ * @param completion Runs after the batch has been committed or rolled back. This parameter can be nil.
+ */
+-(void)enqueueUpdateTable:(GWMTableName)table withValues:(NSDictionary<GWMColumnName,id> *)values criteria:(NSDictionary<GWMColumnName,id> *)criteria completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Commits every write waiting in the write-behind queue and waits until their completions have run. Does nothing when called from a write or a completion of the queue, or while a transaction of this thread is in progress, such as inside the block of performTransaction:, because the batch commits in a transaction of its own and would wait for the one it was called from.
+ */
+-(void)flushWrites;
+/*!
+ * @discussion Returns the counters of the write-behind queue.
+ * @return An NSDictionary with the keys enqueuedWrites, committedWrites, failedWrites, batches, queueDepth, maxQueueDepth, meanBatchSize, maxBatchSize, meanCommitTime, maxCommitTime, meanLatency and maxLatency. The commit time is how long a batch transaction took and the latency is the time from enqueueWrite:completion: to the end of the batch's completions. Times are in seconds.
+ */
+-(NSDictionary<NSString*,id> *)writeBatchStatistics;
+/*!
+ * @discussion Sets the counters of the write-behind queue back to zero.
+ */
+-(void)resetWriteBatchStatistics;
+
+#pragma mark - Change Feed
+/*!
+ * @discussion Calls a block with the rows changed by each committed transaction, like GWMDatabaseControllerDidUpdateDataNotification but filtered by table, so a list can apply the changed rows instead of fetching every row again.
+ * @param tables The tables to observe, named as in GWMChangeSet. Entering nil observes every table.
+ * @param queue The queue the block runs on. Entering nil uses the main queue.
+ * @param block Runs asynchronously with the changes to tables. Runs for every incomplete change set, which can leave out changes to tables.
+ * @return An object to pass to removeChangeObserver:.
+ */
+-(id<NSObject>)addChangeObserverForTables:(NSArray<GWMTableName> *_Nullable)tables queue:(dispatch_queue_t _Nullable)queue block:(void (^)(GWMChangeSet *changeSet))block;
+/*!
+ * @discussion Stops calling the block of a change observer. A change set that is already on its way can still be delivered.
+ * @param observer An object returned by addChangeObserverForTables:queue:block:.
+ */
+-(void)removeChangeObserver:(id<NSObject>)observer;
+
+#pragma mark - Identity Map
+/*!
+ * @brief Removes every object from the identity map.
+ * @discussion Rows changed through the database connection are removed from the identity map automatically and the map is cleared after schema changes made through the controller. Call this method after changing the database by other means, such as another process.
+ */
+-(void)clearIdentityMap;
+/*!
+ * @discussion Sets the identity map hit and miss counters back to zero.
+ */
+-(void)resetIdentityMapStatistics;
+
+#pragma mark - Result Cache
+/*!
+ * @brief Removes every result from the result cache.
+ * @discussion Results are removed automatically when a table they were read from is changed through the database connection and the cache is cleared after schema changes made through the controller. Call this method after changing the database by other means, such as another process.
+ */
+-(void)clearResultCache;
+/*!
+ * @discussion Sets the result cache hit, miss, eviction and invalidation counters back to zero.
+ */
+-(void)resetResultCacheStatistics;
+
 #pragma mark - Introspection
 /*!
  * @discussion Returns the schema version (set using pragma) of the specified SQLite database.
@@ -250,7 +449,19 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @return A BOOL value indicating whether the statement execution was successful.
  */
 -(GWMDBOperationResult)detachDatabase:(GWMSchemaName)alias;
+/*!
+ * @brief Open the database named in the preferences.
+ * @discussion Opens the main database named by the GWMPK_MainDatabaseName and GWMPK_MainDatabaseExtension preferences and attaches the user database named by GWMPK_UserDatabaseName and GWMPK_UserDatabaseAlias. Does nothing if the database is already open, so it is cheap to call before every statement.
+ */
+-(void)openDatabase;
 -(GWMDBOperationResult)openDatabase:(NSString *)name extension:(NSString *)extension;
+/*!
+ * @brief Open a SQLite database file.
+ * @discussion Opens the file for reading and writing, as openDatabase:extension: does for a file in the main bundle. The file must already exist.
+ * @param path The path of the database file.
+ * @return GWMDBOperationDatabaseOpened if the database is open.
+ */
+-(GWMDBOperationResult)openDatabaseAtPath:(NSString *)path;
 -(GWMDBOperationResult)closeDatabase;
 -(BOOL)isDatabaseOpen;
 
@@ -324,17 +535,53 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @param completion A block that will run after the query has finished. This paramter can be nil.
  */
 -(void)dropTrigger:(GWMTriggerName)trigger schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Creates the full-text search index of a class that returns searchableColumns. The index is an FTS5 table named after the table with an _fts suffix. It uses the table as external content, so the text is not stored twice, and AFTER INSERT, UPDATE and DELETE triggers keep it in sync with the table. The rows the table already has are indexed. createTableWithClassName:schema:completion: calls this method for classes with searchableColumns.
+ * @param className A NSString representation of the class associated with the table to index.
+ * @param schema The database that contains the table. Leaving this parameter nil will have the same result as inputing @"main".
+ * @param completion A block that will run after the index is created. This paramter can be nil.
+ */
+-(void)createSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Drops the full-text search index of a class and its triggers. To load many rows at once, drop the index, load the rows and create it again, which indexes the rows in one pass instead of one trigger at a time.
+ * @param className A NSString representation of the class associated with the indexed table.
+ * @param schema The database that contains the table. Leaving this parameter nil will have the same result as inputing @"main".
+ * @param completion A block that will run after the index is dropped. This paramter can be nil.
+ */
+-(void)dropSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Rebuilds the full-text search index of a class from the rows of its table, such as after rows were written with the triggers dropped.
+ * @param className A NSString representation of the class associated with the indexed table.
+ * @param schema The database that contains the table. Leaving this parameter nil will have the same result as inputing @"main".
+ * @param completion A block that will run after the index is rebuilt. This paramter can be nil.
+ */
+-(void)rebuildSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+/*!
+ * @discussion Merges the segments of the full-text search index of a class into one, which makes searches faster after many rows were written. Call it after a bulk load, not after every write.
+ * @param className A NSString representation of the class associated with the indexed table.
+ * @param schema The database that contains the table. Leaving this parameter nil will have the same result as inputing @"main".
+ * @param completion A block that will run after the index is optimized. This paramter can be nil.
+ */
+-(void)optimizeSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion;
 
 #pragma mark - CRUD Database Operations
 
 #pragma mark Create
 /*!
- * @discussion Insert multiple records into a SQLite database table with new values for columns that you specify.
+ * @discussion Insert multiple records into a SQLite database table with new values for columns that you specify. All records are inserted in one transaction. A record that fails does not stop the others from being inserted. Use insertIntoTable:rows:chunkSize:completion: to find out which records failed.
  * @param table The name of the table to insert into. This parameter cannot be nil.
- * @param valuesToInsert An NSArray of NSDictionary values to insert where each dictionary represents a record to be inserted. Within each dictionary, the key is the table column and the value is the value to insert. Every dictionary must have the same number of entries and the keys must be in the same order. SQLite's binding functions are used to bind the values to the statement.
- * @param completionHandler A block that will run after the query has finished. This paramter can be nil.
+ * @param valuesToInsert An NSArray of NSDictionary values to insert where each dictionary represents a record to be inserted. Within each dictionary, the key is the table column and the value is the value to insert. Dictionaries can have different keys. SQLite's binding functions are used to bind the values to the statement.
+ * @param completionHandler A block that will run after the query has finished. Within this block, you have access to a GWMDataItem with the itemID of the last record inserted or the error of the first record that failed. This paramter can be nil.
  */
 -(void)insertIntoTable:(GWMTableName)table newValues:(NSArray<NSDictionary<GWMColumnName,id> *> *)valuesToInsert completion:(GWMDatabaseResultBlock _Nullable)completionHandler;
+/*!
+ * @discussion Insert a large number of records. One statement is prepared for each distinct set of columns and reused for every record with those columns, so rows are inserted at SQLite's own rate. Records that fail are reported and skipped; the rest of the batch is still inserted. If a transaction is already open the records become part of it, otherwise the records are committed in chunks.
+ * @param table The name of the table to insert into. This parameter cannot be nil.
+ * @param rows An NSArray of NSDictionary values where each dictionary is one record. Within each dictionary, the key is the table column and the value is the value to insert. Columns that are left out get their default value. This parameter cannot be nil.
+ * @param chunkSize The number of records to commit at a time. Entering 0 commits every record in a single transaction.
+ * @param completion A block that will run after the records have been inserted. This parameter can be nil.
+ */
+-(void)insertIntoTable:(GWMTableName)table rows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkInsertCompletionBlock _Nullable)completion;
 /*!
  * @discussion Insert records into a SQLite database table with new values for columns that you specify.
  * @param table The name of the table to insert into. This parameter cannot be nil.
@@ -350,6 +597,27 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @param completionHandler A block that will run after the query has finished. This paramter can be nil.
  */
 -(void)insertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values onConflict:(GWMDBOnConflict)onConflict completion:(GWMDatabaseResultBlock _Nullable)completionHandler;
+/*!
+ * @discussion Insert a record or, if a record with the same values in the conflict columns already exists, update that record, in a single statement. Requires SQLite 3.35 or later and a PRIMARY KEY or UNIQUE constraint on the conflict columns.
+ * @param table The name of the table to insert into. This parameter cannot be nil.
+ * @param values An NSDictionary of values where the key is the table column and the value is the value to insert. Columns that are not conflict columns are updated when the record already exists. This parameter cannot be nil.
+ * @param conflictColumns The columns of the PRIMARY KEY or UNIQUE constraint that identifies an existing record. This parameter cannot be nil.
+ * @param returningColumn The integer column to return, usually the primary key. An updated record does not change sqlite3_last_insert_rowid, so this parameter cannot be nil.
+ * @param completionHandler A block that will run after the statement has finished. Within this block, you have access to a GWMDataItem with the value of the returning column as its itemID or an NSError if the statement failed. The block does not run if the statement could not be prepared. This parameter can be nil.
+ * @return A GWMDatabaseResult object. If the statement could not be prepared, its resultCode is not GWMSQLiteResultOK and the caller can fall back to selecting the record and updating or inserting it.
+ */
+-(GWMDatabaseResult *)upsertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn completion:(GWMDatabaseResultBlock _Nullable)completionHandler;
+/*!
+ * @discussion Insert or update a large number of records. One upsert statement is prepared for each distinct set of columns and reused for every record with those columns. Records are committed like insertIntoTable:rows:chunkSize:completion: commits them. Requires SQLite 3.35 or later and a PRIMARY KEY or UNIQUE constraint on the conflict columns.
+ * @param table The name of the table to write to. This parameter cannot be nil.
+ * @param rows An NSArray of NSDictionary values where each dictionary is one record. Within each dictionary, the key is the table column and the value is the value to write. This parameter cannot be nil.
+ * @param conflictColumns The columns of the PRIMARY KEY or UNIQUE constraint that identifies an existing record. This parameter cannot be nil.
+ * @param returningColumn The integer column to return for each record, usually the primary key. An updated record does not change sqlite3_last_insert_rowid, so this parameter cannot be nil.
+ * @param chunkSize The number of records to commit at a time. Entering 0 commits every record in a single transaction.
+ * @param completion A block that will run after the records have been written. The block does not run if the statement for the first record could not be prepared. This parameter can be nil.
+ * @return A GWMDatabaseResult object. If the statement for the first record could not be prepared, its resultCode is not GWMSQLiteResultOK and nothing was written.
+ */
+-(GWMDatabaseResult *)upsertIntoTable:(GWMTableName)table rows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkUpsertCompletionBlock _Nullable)completion;
 
 -(void)insertWithStatement:(NSString *)statement values:(NSArray *)values completion:(GWMDBCompletionBlock _Nullable)completion;
 
@@ -366,7 +634,7 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @discussion You use the returned GWMDatabaseResult object's data property to access an NSArray of data rows.
  * @param statement A SQLite statement string. While it is possible to include a WHERE clause and criteria in the statement, it is recommended to pass criteria into the criteriaValues parameter. This will cause the database controller to add the WHERE clause to the statement for you. SQLite's binding functions will be used when the query is run. This parameter cannot be nil.
  * @param criteriaValues An NSArray of NSDictionary entries where the key is the name of the table column and the value is the value from the row to match against. Entries from different dictionaries will cause an OR comparison. Entries within the same dictionary will cause an AND comparison. This parameter can be nil.
- * @param excludedItems An NSArray of GWMDataItem objects that will be excluded from the query results.  This parameter can be nil.
+ * @param excludedItems An NSArray of GWMDataItem objects that will be excluded from the query results. The itemIDs are bound as a single JSON array and matched against the pKey column with json_each, so the statement is the same for any number of excluded items. This parameter can be nil.
  * @param sortBy The table column to use to sort the query results. This parameter can be nil.
  * @param ascending Enter NO to sort the query results in descending order.
  * @param limit An NSInteger to limit the number of result rows returned by the query. This uses SQLite LIMIT clause. Entering 0 means there is no limit.
@@ -374,6 +642,91 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @return A GWMDatabaseResult object.
  */
 -(GWMDatabaseResult *)resultWithStatement:(NSString *)statement criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteriaValues exclude:(NSArray<__kindof GWMDataItem*>*_Nullable)excludedItems sortBy:(GWMColumnName _Nullable)sortBy ascending:(BOOL)ascending limit:(NSInteger) limit completion:(GWMDBCompletionBlock _Nullable)completionHandler;
+/*!
+ * @discussion Reads many records of a class with one statement. The IDs are bound as a single JSON array and matched against the primary key with json_each, so the statement is prepared once for any number of IDs. Rows are returned in table order and IDs without a record are left out.
+ * @param itemClass A GWMDataItem class that has a table in classToTableMapping. Its tableColumns are selected.
+ * @param itemIDs The itemIDs of the records to read. This parameter cannot be nil.
+ * @return A GWMDatabaseResult object. The data property contains an object of itemClass for each record found.
+ */
+-(GWMDatabaseResult *)fetchItemsOfClass:(Class)itemClass withIDs:(NSArray<NSNumber*> *)itemIDs;
+/*!
+ * @discussion Searches the full-text search index of a class, see createSearchIndexWithClassName:schema:completion:. Every word of the text must match the start of a word in the record, in any order. Punctuation in the text is matched literally, so the text of a search field can be passed as it is. The best matches come first.
+ * @param itemClass A GWMDataItem class that returns searchableColumns and has a table in classToTableMapping. Its tableColumns are selected.
+ * @param text The text to search for. Text without words returns no records.
+ * @param scope One of the searchableColumns of itemClass to search, such as the column of the selected search scope button, or nil to search all of them.
+ * @param limit The maximum number of records to return. Entering 0 means there is no limit.
+ * @return A GWMDatabaseResult object. The data property contains an object of itemClass for each record found, ranked by relevance.
+ */
+-(GWMDatabaseResult *)searchItemsOfClass:(Class)itemClass matching:(NSString *)text scope:(GWMColumnName _Nullable)scope limit:(NSUInteger)limit;
+/*!
+ * @discussion Reads a sorted list one page at a time, such as for a list that loads more rows as it scrolls. Instead of skipping rows with OFFSET, each page starts after the sort value and primary key of the last row of the page before it, so every page costs the same no matter how deep it is, and rows inserted or deleted before the position do not shift the pages. The statement is the same for every page after the first, so the prepared statement is reused.
+ * @param itemClass A GWMDataItem class that has a table in classToTableMapping. Its listTableColumns are selected.
+ * @param criteria An NSArray of NSDictionary entries where the key is the name of the table column and the value is the value from the row to match against. Entries from different dictionaries will cause an OR comparison. Entries within the same dictionary will cause an AND comparison. Pass the same criteria for every page. This parameter can be nil.
+ * @param sortBy The table column to sort by. Its values must be integers, reals or text. Rows with the same value are sorted by the primary key. Entering nil sorts by the primary key.
+ * @param ascending Enter NO to sort in descending order.
+ * @param pageSize The number of records in a page. Must be greater than 0. A page has fewer records when rows of it can't be mapped to an object; the continuation token still starts the next page after them.
+ * @param continuationToken The continuationToken of the previous page, or nil for the first page. A token only reads pages with the sortBy and ascending it was made with.
+ * @return A GWMDatabaseResult object. The data property contains an object of itemClass for each record of the page and continuationToken reads the next page.
+ */
+-(GWMDatabaseResult *)pageOfItemsOfClass:(Class)itemClass criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria sortBy:(GWMColumnName _Nullable)sortBy ascending:(BOOL)ascending pageSize:(NSUInteger)pageSize continuationToken:(NSString *_Nullable)continuationToken;
+/*!
+ * @discussion Runs a select query that was compiled once. Only the values are looked up and bound, so running the query again does not build any SQL. resultWithStatement:criteria:exclude:sortBy:ascending:limit:completion: is the same as compiling a query and running it once.
+ * @param query A GWMCompiledQuery made with queryWithTable:columns:criteriaShape:sortBy:ascending:limit: or queryWithStatement:criteriaShape:excludesItems:sortBy:ascending:limit:. This parameter cannot be nil.
+ * @param criteria One NSDictionary for each AND group of the criteria shape of the query, in the same order. This parameter can be nil if the query has no criteria.
+ * @param excludedItems The GWMDataItem objects to leave out if the query excludes items. This parameter can be nil.
+ * @param completionHandler A block that will run after the query is finished. This parameter can be nil.
+ * @return A GWMDatabaseResult object. Its resultCode is GWMSQLiteResultError if the criteria do not match the criteria shape.
+ */
+-(GWMDatabaseResult *)resultWithCompiledQuery:(GWMCompiledQuery *)query criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria exclude:(NSArray<__kindof GWMDataItem*> *_Nullable)excludedItems completion:(GWMDBCompletionBlock _Nullable)completionHandler;
+/*!
+ * @discussion Use a cursor instead of resultWithStatement:criteria:completion: when a query can return more rows than you want to hold in memory at once. The statement is run as rows are asked for and each row is mapped to an object the same way resultWithStatement:criteria:completion: maps it.
+ * @param statement A SQLite statement string. The class of each row is returned by the first column. This parameter cannot be nil.
+ * @param criteria An NSArray containing the values to bind to the ? placeholders in the statement. This parameter can be nil.
+ * @return A GWMDatabaseCursor positioned before the first row.
+ */
+-(GWMDatabaseCursor *)cursorWithStatement:(NSString *)statement criteria:(NSArray *_Nullable)criteria;
+/*!
+ * @discussion Runs a query and passes each row to a block without keeping the rows. Temporary objects are released after every 256 rows, so memory use does not grow with the size of the result.
+ * @param statement A SQLite statement string. The class of each row is returned by the first column. This parameter cannot be nil.
+ * @param criteria An NSArray containing the values to bind to the ? placeholders in the statement. This parameter can be nil.
+ * @param block A block that is called once for each row. This parameter cannot be nil.
+ * @return A GWMDatabaseResult object with any SQLite errors. Its data property is nil.
+ */
+-(GWMDatabaseResult *)enumerateRowsWithStatement:(NSString *)statement criteria:(NSArray *_Nullable)criteria block:(GWMDBRowEnumerationBlock)block;
+/*!
+ * @discussion Runs a query and passes each row to a block without keeping the rows.
+ * @param statement A SQLite statement string. The class of each row is returned by the first column. This parameter cannot be nil.
+ * @param criteria An NSArray containing the values to bind to the ? placeholders in the statement. This parameter can be nil.
+ * @param batchSize The number of rows after which temporary objects are released. Entering 0 uses the default of 256.
+ * @param block A block that is called once for each row. This parameter cannot be nil.
+ * @return A GWMDatabaseResult object with any SQLite errors. Its data property is nil.
+ */
+-(GWMDatabaseResult *)enumerateRowsWithStatement:(NSString *)statement criteria:(NSArray *_Nullable)criteria batchSize:(NSUInteger)batchSize block:(GWMDBRowEnumerationBlock)block;
+/*!
+ * @discussion Runs a query and keeps the values of each column in typed arrays instead of creating an object per row. Use it for reports and long lists that read a few columns of many rows.
+ * @param statement A SQLite statement string. Unlike resultWithStatement:criteria:completion:, the statement does not need a class column. This parameter cannot be nil.
+ * @param criteria An NSArray containing the values to bind to the ? placeholders in the statement. This parameter can be nil.
+ * @return A GWMColumnarResult with the rows and any SQLite errors.
+ */
+-(GWMColumnarResult *)columnarResultWithStatement:(NSString *)statement criteria:(NSArray *_Nullable)criteria;
+/*!
+ * @discussion Runs a query and passes the BLOB in the first column of each row to a block without copying it out of SQLite.
+ * @param statement A SQLite statement string that returns the BLOB in its first column. This parameter cannot be nil.
+ * @param criteria An NSArray containing the values to bind to the ? placeholders in the statement. This parameter can be nil.
+ * @param block A block that is called once for each row. This parameter cannot be nil.
+ * @return A GWMDatabaseResult object with any SQLite errors. Its data property is nil.
+ */
+-(GWMDatabaseResult *)enumerateBlobsWithStatement:(NSString *)statement criteria:(NSArray *_Nullable)criteria block:(GWMDBBlobEnumerationBlock)block;
+/*!
+ * @discussion Opens a BLOB value for reading and writing in pieces.
+ * @param table The table, optionally prefixed with the schema name, such as user.Photos.
+ * @param column The column holding the value.
+ * @param rowID The rowid of the row, which is the pKey of tables created for GWMDataItem.
+ * @param readOnly Enter YES to only read the value.
+ * @param error On return, the error if the value could not be opened.
+ * @return A GWMBlobHandle or nil.
+ */
+-(GWMBlobHandle *_Nullable)blobHandleWithTable:(GWMTableName)table column:(GWMColumnName)column rowID:(NSInteger)rowID readOnly:(BOOL)readOnly error:(NSError *_Nullable *_Nullable)error;
 
 #pragma mark Update
 /*!
@@ -413,6 +766,26 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
  * @warning If this method is called with nil criteria, all records in the specified table will be deleted.
  */
 -(void)deleteFromTable:(GWMTableName)table criteria:(NSArray<NSDictionary<GWMColumnName,NSObject*>*>*_Nullable)criteria completion:(GWMDBErrorCompletionBlock _Nullable)completionHandler;
+/*!
+ * @discussion Delete a large number of records identified by the values of one or more columns. Records are deleted with DELETE ... WHERE column IN (...) statements that each match up to chunkSize records, all in one transaction. If a transaction is already open the deletes become part of it.
+ * @param table The SQLite database table to delete from. This parameter cannot be nil.
+ * @param columns The columns that identify a record, usually the primary key. This parameter cannot be nil.
+ * @param rows An NSArray where each entry is an NSArray with the values of the columns for one record, in the same order as the columns. This parameter cannot be nil.
+ * @param chunkSize The number of records to match in one statement. Entering 0 matches as many as SQLite allows.
+ * @param completion A block that will run after the records have been deleted. This parameter can be nil.
+ */
+-(void)deleteFromTable:(GWMTableName)table matchingColumns:(NSArray<GWMColumnName> *)columns values:(NSArray<NSArray *> *)rows chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkDeleteCompletionBlock _Nullable)completion;
+
+#pragma mark Compiled Queries
+/*!
+ * @discussion Runs an update or delete query that was compiled once on the writer queue. Only the values are looked up and bound. If a transaction is already open the change becomes part of it.
+ * @param query A GWMCompiledQuery made with updateQueryWithTable:columns:criteriaShape:onConflict: or deleteQueryWithTable:criteriaShape:. This parameter cannot be nil.
+ * @param values The new values of the columns of an update query, where the key is the column. A column that is missing is set to NULL. This parameter can be nil for a delete query.
+ * @param criteria One NSDictionary for each AND group of the criteria shape of the query, in the same order. This parameter can be nil if the query has no criteria.
+ * @param completionHandler A block that will run after the query has finished, with an NSError if it failed. This parameter can be nil.
+ * @return A GWMDatabaseResult object.
+ */
+-(GWMDatabaseResult *)performCompiledQuery:(GWMCompiledQuery *)query values:(NSDictionary<GWMColumnName,id> *_Nullable)values criteria:(NSArray<NSDictionary<GWMColumnName,id>*> *_Nullable)criteria completion:(GWMDBErrorCompletionBlock _Nullable)completionHandler;
 
 #pragma mark - Convenience
 /*!
@@ -431,6 +804,28 @@ extern NSString * const GWMPK_UserDatabaseSchemaVersion;
 
 //int callback(void *arg, int argc, char **argv, char **colName);
 
+/*!
+ * @discussion Runs a block in an IMMEDIATE transaction. See performTransactionWithMode:block:error:.
+ * @param block The writes to run. Use the transaction to roll them back.
+ * @param error An NSError object that is generated if the transaction was rolled back or could not be committed.
+ * @return YES if the changes of the block were committed.
+ */
+-(BOOL)performTransaction:(void (^)(GWMTransaction *transaction))block error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Runs a block in a transaction and commits it once when the block returns, so many writes share a single sync to disk. The insert, update, delete and upsert methods called inside the block join the transaction instead of committing on their own. Calling performTransaction inside the block opens a nested scope with a SAVEPOINT, which can be rolled back on its own. A scope is rolled back when the block calls rollback or rollbackWithError: on the transaction, or throws an exception, which is thrown again once the scope is rolled back. When readerConnectionCount is greater than 0 the block runs on the writer queue, so other writes wait until it returns; call the controller from the same thread inside the block.
+ * @param mode How the outermost transaction takes the write lock. Nested scopes ignore this.
+ * @param block The writes to run. Use the transaction to roll them back.
+ * @param error An NSError object that is generated if the transaction was rolled back or could not be committed.
+ * @return YES if the changes of the block were committed.
+ */
+-(BOOL)performTransactionWithMode:(GWMTransactionMode)mode block:(void (^)(GWMTransaction *transaction))block error:(NSError *_Nullable *_Nullable)error;
+/*!
+ * @discussion Runs SQL statements one after another in a transaction. If a statement fails the transaction is rolled back and a GWMExecutingStatementException is thrown. Inside performTransaction the statements run in a nested scope.
+ * @param statements The SQL statements.
+ * @param identifier A name for the transaction used in the log.
+ * @param completion A block that runs once the statements are committed. This parameter can be nil.
+ * @return NO if statements is nil.
+ */
 -(BOOL)applyStatements:(NSArray<NSString*> *)statements identifier:(NSString *)identifier completion:(GWMDBCompletionBlock _Nullable)completion;
 
 #pragma mark - Convenience
@@ -9,6 +9,23 @@
 #import "GWMDatabaseController.h"
 #import "GWMDatabaseResult.h"
 #import "GWMDataItem.h"
+#import "GWMStatementCache.h"
+#import "GWMRowMappingPlan.h"
+#import "GWMDateCoding.h"
+#import "GWMDatabaseCursor.h"
+#import "GWMColumnarResult.h"
+#import "GWMBlobHandle.h"
+#import "GWMDatabaseConnection.h"
+#import "GWMIdentityMap.h"
+#import "GWMResultCache.h"
+#import "GWMClassMetadata.h"
+#import "GWMCompiledQuery.h"
+#import "GWMStatementProfiler.h"
+#import "GWMConnectionConfiguration.h"
+#import "GWMTransaction.h"
+#import "GWMWriteBatcher.h"
+#import "GWMChangeSet.h"
+#import "GWMChangeRecorder.h"
 
 @import os.log;
 
@@ -51,12 +68,16 @@ typedef NS_ENUM(int, GWMDBThreadingMode) {
     /* In serialized mode, SQLite can be safely used by multiple threads with no restriction. */
 };
 
+// https://www.sqlite.org/lang_returning.html
+static const int GWMSQLiteUpsertReturningMinimumVersion = 3035000;
+
 #pragma mark Notification Keys
 NSString * const GWMDatabaseControllerDidUpdateDataNotification = @"GWMDatabaseControllerDidUpdateDataNotification";
 NSString * const GWMDatabaseControllerDidBeginUserDataMigrationNotification = @"GWMDatabaseControllerDidBeginUserDataMigrationNotification";
 NSString * const GWMDatabaseControllerDidFinishUserDataMigrationNotification = @"GWMDatabaseControllerDidFinishUserDataMigrationNotification";
 #pragma mark Notification UserInfo Keys
 NSString * const GWMDBStatementKey = @"GWMDBStatementKey";
+NSString * const GWMDBChangeSetKey = @"GWMDBChangeSetKey";
 
 #pragma mark Date & Time Strings
 NSString * const GWMDBDateFormatDateTime = @"yyyy-MM-dd HH:mm:ss";
@@ -73,8 +94,12 @@ GWMSQLiteErrorName const GWMSQLiteErrorBindingNullValue = @"Error binding null v
 GWMSQLiteErrorName const GWMSQLiteErrorBindingTextValue = @"Error binding text value";
 GWMSQLiteErrorName const GWMSQLiteErrorBindingIntegerValue = @"Error binding integer value";
 GWMSQLiteErrorName const GWMSQLiteErrorBindingDoubleValue = @"Error binding double value";
+GWMSQLiteErrorName const GWMSQLiteErrorBindingBlobValue = @"Error binding blob value";
 GWMSQLiteErrorName const GWMSQLiteErrorSteppingToRow = @"Error stepping to row";
 GWMSQLiteErrorName const GWMSQLiteErrorFinalizingStatement = @"Error finalizing statement";
+GWMSQLiteErrorName const GWMSQLiteErrorOpeningBlob = @"Error opening blob";
+GWMSQLiteErrorName const GWMSQLiteErrorReadingBlob = @"Error reading blob";
+GWMSQLiteErrorName const GWMSQLiteErrorWritingBlob = @"Error writing blob";
 
 #pragma mark Error Domain
 NSErrorDomain const GWMErrorDomainDatabase = @"GWMDatabase";
@@ -97,6 +122,35 @@ NSString * const GWMPK_VersionOfMainDatabase = @"GWMPK_VersionOfMainDatabase";
 NSString * const GWMPK_VersionOfUserDatabase = @"GWMPK_VersionOfUserDatabase";
 NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVersion";
 
+@interface GWMDatabaseCursor (GWMDatabaseController)
+
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController preparedStatement:(sqlite3_stmt *)preparedStatement rowMappingPlan:(GWMRowMappingPlan *)rowMappingPlan result:(GWMDatabaseResult *)result;
+
+@end
+
+@interface GWMBlobHandle (GWMDatabaseController)
+
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController blob:(sqlite3_blob *)blob schema:(NSString *)schema table:(NSString *)table rowID:(NSInteger)rowID readOnly:(BOOL)readOnly;
+
+@end
+
+@interface GWMTransaction (GWMDatabaseController)
+
+-(instancetype)initWithName:(NSString *)name mode:(GWMTransactionMode)mode depth:(NSUInteger)depth isSavepoint:(BOOL)isSavepoint;
+-(BOOL)isSavepoint;
+-(NSString *)beginStatement;
+-(NSString *)commitStatement;
+-(NSString *)rollbackStatement;
+
+@end
+
+@interface GWMColumnarResult (GWMDatabaseController)
+
+-(void)setColumnsWithPreparedStatement:(sqlite3_stmt *)preparedStatement;
+-(void)appendRowOfStatement:(sqlite3_stmt *)preparedStatement;
+
+@end
+
 @interface GWMDatabaseController ()
 {
 //    sqlite3 *_database;
@@ -109,10 +163,46 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
 @property (nonatomic, strong) NSString *_Nullable databasePath;
 @property (assign) BOOL isTransactionInProgress;
 @property (nonatomic, strong) NSString *_Nullable transactionName;
+///@discussion The open scopes of performTransaction, outermost first. Only used on the writer queue.
+@property (nonatomic, strong) NSMutableArray<GWMTransaction*> *transactionStack;
 
 @property (assign) GWMDBOpenFlags openFlags;
 
+@property (nonatomic, strong) GWMStatementCache *_Nullable statementCache;
+
+///@discussion Every read-only connection in the pool.
+@property (nonatomic, strong) NSArray<GWMDatabaseConnection*> *_Nullable readerConnections;
+///@discussion The read-only connections that are not checked out.
+@property (nonatomic, strong) NSMutableArray<GWMDatabaseConnection*> *_Nullable idleReaderConnections;
+///@discussion Guards the reader pool. Kept when the pool is closed, so a connection checked in afterwards still has a lock.
+@property (nonatomic, strong) NSObject *_Nullable readerPoolLock;
+///@discussion Counts the idle read-only connections.
+@property (nonatomic, strong) dispatch_semaphore_t _Nullable readerSemaphore;
+///@discussion Serializes writes when the reader pool is in use.
+@property (nonatomic, strong) dispatch_queue_t _Nullable writerQueue;
+
+///@discussion The objects created for mapped rows, nil when identityMapMemoryLimit is 0.
+@property (strong) GWMIdentityMap *_Nullable identityMap;
+///@discussion The class names of each table in classToTableMapping where the key is the table name without its schema.
+@property (nonatomic, strong) NSDictionary<NSString*,NSArray<NSString*>*> *_Nullable classNamesByTable;
+///@discussion The classToTableMapping classNamesByTable was built from.
+@property (nonatomic, strong) NSDictionary<NSString*,GWMTableName> *_Nullable classNamesByTableMapping;
+///@discussion The results of queries, nil when resultCacheMemoryLimit is 0.
+@property (strong) GWMResultCache *_Nullable resultCache;
+///@discussion Records the statements of every connection while profilingEnabled is YES. Kept when profiling is turned off so its snapshot can still be read.
+@property (strong) GWMStatementProfiler *_Nullable statementProfiler;
+
+@property (nonatomic, strong) GWMWriteBatcher *writeBatcher;
+
+@property (nonatomic, strong) GWMChangeRecorder *changeRecorder;
+// guarded by @synchronized (self.changeSubscriptions)
+@property (nonatomic, strong) NSMutableArray<GWMChangeSubscription*> *changeSubscriptions;
+
 -(GWMBindValuesEnumerationBlock)bindValuesEnumerationBlockWithResult:(GWMDatabaseResult *_Nullable)databaseResult preparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement;
+-(id _Nullable)objectWithRowOfStatement:(sqlite3_stmt *)sqlite3PreparedStatement rowMappingPlan:(GWMRowMappingPlan *)rowMappingPlan identityMapGeneration:(NSUInteger)identityMapGeneration;
+-(void)didChangeRowWithOperation:(int)operation schema:(const char *)schema table:(const char *)table rowID:(sqlite3_int64)rowID;
+-(NSString *)insertStatementWithTable:(GWMTableName)table columns:(NSArray<GWMColumnName> *)columns conflictColumns:(NSArray<GWMColumnName> *_Nullable)conflictColumns returningColumn:(GWMColumnName _Nullable)returningColumn;
+-(NSUInteger)writeRows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows toTable:(GWMTableName)table conflictColumns:(NSArray<GWMColumnName> *_Nullable)conflictColumns returningColumn:(GWMColumnName _Nullable)returningColumn chunkSize:(NSUInteger)chunkSize itemIDs:(NSMutableArray<NSNumber*> *)itemIDs rowErrors:(NSMutableDictionary<NSNumber*,NSError*> *)rowErrors error:(NSError *_Nullable *_Nullable)error;
 
 @end
 
@@ -132,6 +222,19 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
     return _databaseController;
 }
 
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _statementCacheCapacity = 64;
+        _connectionConfiguration = [GWMConnectionConfiguration defaultConfiguration];
+        _transactionStack = [NSMutableArray<GWMTransaction*> new];
+        _writeBatcher = [[GWMWriteBatcher alloc] initWithDatabaseController:self];
+        _changeRecorder = [GWMChangeRecorder new];
+        _changeSubscriptions = [NSMutableArray<GWMChangeSubscription*> new];
+    }
+    return self;
+}
+
 -(NSDateFormatter *)dateFormatter
 {
     if (!_dateFormatter) {
@@ -147,699 +250,1522 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
     return _notificationCenter;
 }
 
-#pragma mark - SQLite Version
+#pragma mark - Statement Cache
 
--(NSString *)sqliteVersion
+-(void)setStatementCacheCapacity:(NSUInteger)statementCacheCapacity
 {
-    return [NSString stringWithUTF8String:SQLITE_VERSION];
+    _statementCacheCapacity = statementCacheCapacity;
+    self.statementCache.capacity = statementCacheCapacity;
 }
 
--(NSString *)sqliteLibraryVersion
+-(NSUInteger)statementCacheHits
 {
-    const char *versionC = sqlite3_libversion();
-    return [NSString stringWithUTF8String:versionC];
+    NSUInteger hits = self.statementCache.hits;
+    for (GWMDatabaseConnection *connection in self.readerConnections)
+        hits += connection.statementCache.hits;
+    return hits;
 }
 
-#pragma mark - Introspection
+-(NSUInteger)statementCacheMisses
+{
+    NSUInteger misses = self.statementCache.misses;
+    for (GWMDatabaseConnection *connection in self.readerConnections)
+        misses += connection.statementCache.misses;
+    return misses;
+}
 
--(int)databaseVersionAtPath:(NSString *)filePath withExtension:(NSString *)extension
+-(void)clearStatementCache
 {
-    /*
-     this method temporarily opens a database to get PRAGMA user_version and then closes the database
-     */
-    
-//    [self closeDatabase];
-    
-    NSString *databasePathNS = [[NSBundle mainBundle] pathForResource:filePath ofType:extension];
-    const char *databasePathC = [databasePathNS UTF8String];
-    int databaseVersion = -1;
-    
-    sqlite3 *tempDatabase = NULL;
-    
-    int openCode = sqlite3_open(databasePathC, &tempDatabase);
-    if(openCode != GWMSQLiteResultOK) {
-        NSLog(@"%@: %s", GWMSQLiteErrorOpeningDatabase, sqlite3_errmsg(tempDatabase));
-        os_log(OS_LOG_DEFAULT,  "%s: %s", [GWMSQLiteErrorOpeningDatabase UTF8String], sqlite3_errmsg(tempDatabase));
-    } else {
-        static sqlite3_stmt *sqlite3PreparedStatement;
-        int prepareCode = sqlite3_prepare_v2(tempDatabase, "PRAGMA user_version;", -1, &sqlite3PreparedStatement, NULL);
-        if(prepareCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(tempDatabase));
-        else {
-            int stepCode = GWMSQLiteResultRow;
-            while(stepCode == GWMSQLiteResultRow) {
-                stepCode = sqlite3_step(sqlite3PreparedStatement);
-                if (stepCode == GWMSQLiteResultRow) {
-                    databaseVersion = sqlite3_column_int(sqlite3PreparedStatement, 0);
-                    NSLog(@"Database: %@ version: %d", databasePathNS, databaseVersion);
-                    os_log(OS_LOG_DEFAULT, "Database: %s version: %d", [databasePathNS UTF8String], databaseVersion);
-                }
-            }
-            if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-                NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(tempDatabase));
-        }
-        int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-        if(finalizeCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(tempDatabase));
-        
-        int closeCode = sqlite3_close(tempDatabase);
-        if(closeCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %@ Message: %s", GWMSQLiteErrorClosingDatabase, databasePathNS, sqlite3_errmsg(tempDatabase));
-        
-        tempDatabase = NULL;
-    }
-    
-    return databaseVersion;
+    [self.statementCache removeAllStatements];
+    for (GWMDatabaseConnection *connection in self.readerConnections)
+        [connection.statementCache removeAllStatements];
 }
 
--(int)databaseVersionAtFilePath:(NSString *)filePath
+-(void)resetStatementCacheStatistics
 {
-    /*
-     this method temporarily opens a database to get PRAGMA user_version and then closes the database
-     */
-    
-//    [self closeDatabase];
-    
-    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
-    NSString *documentsDirectoryPath = [paths firstObject];
-    NSString *databasePathNS = [documentsDirectoryPath stringByAppendingPathComponent:filePath];
-    const char *databasePathC = [databasePathNS UTF8String];
-    int databaseVersion = -1;
-    
-    sqlite3 *tempDatabase = NULL;
+    [self.statementCache resetStatistics];
+    for (GWMDatabaseConnection *connection in self.readerConnections)
+        [connection.statementCache resetStatistics];
+}
+
+-(sqlite3_stmt *)preparedStatementWithString:(NSString *)statement code:(int *)prepareCode
+{
+    if (self.statementCache)
+        return [self.statementCache checkoutStatement:statement prepareCode:prepareCode];
     
-    int openCode = sqlite3_open(databasePathC, &tempDatabase);
-    if(openCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorOpeningDatabase, sqlite3_errmsg(tempDatabase));
+    sqlite3_stmt *sqlite3PreparedStatement = NULL;
+    *prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    return sqlite3PreparedStatement;
+}
+
+-(sqlite3_stmt *)readerStatementWithString:(NSString *)statement code:(int *)prepareCode database:(sqlite3 **)database
+{
+    GWMDatabaseConnection *connection = [self checkoutReaderConnection];
     
-    else {
+    if (connection) {
         
-        static sqlite3_stmt *sqlite3PreparedStatement;
+        sqlite3_stmt *sqlite3PreparedStatement = [connection.statementCache checkoutStatement:statement prepareCode:prepareCode];
         
-        int prepareCode = sqlite3_prepare_v2(tempDatabase, "PRAGMA user_version;", -1, &sqlite3PreparedStatement, NULL);
-        if(prepareCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(tempDatabase));
-        else {
-            int stepCode = GWMSQLiteResultRow;
-            while(stepCode == GWMSQLiteResultRow) {
-                stepCode = sqlite3_step(sqlite3PreparedStatement);
-                if (stepCode == GWMSQLiteResultRow) {
-                    databaseVersion = sqlite3_column_int(sqlite3PreparedStatement, 0);
-                    NSLog(@"Database: %@ version: %d", databasePathNS, databaseVersion);
-                }
-            }
-            if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-                NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(tempDatabase));
+        if (*prepareCode == GWMSQLiteResultOK && sqlite3_stmt_readonly(sqlite3PreparedStatement)) {
+            *database = connection.database;
+            return sqlite3PreparedStatement;
         }
-        int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-        if(finalizeCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(tempDatabase));
-        
-        int closeCode = sqlite3_close(tempDatabase);
-        if(closeCode != GWMSQLiteResultOK)
-            NSLog(@"%@: %@ Message: %s", GWMSQLiteErrorClosingDatabase, databasePathNS, sqlite3_errmsg(tempDatabase));
         
-        tempDatabase = NULL;
+        // statements that write, or that fail on the reader, are run on the main connection
+        [connection.statementCache checkinStatement:sqlite3PreparedStatement];
+        [self checkinReaderConnection:connection];
     }
     
-    return databaseVersion;
+    // the caller reads the error of a failed prepare from the connection that prepared it
+    *database = self.database;
+    return [self preparedStatementWithString:statement code:prepareCode];
 }
 
--(NSArray<GWMDatabaseItem*>*)databases
+-(int)relinquishPreparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement
 {
-    /*
-     PRAGMA database_list;
-     
-     This pragma works like a query to return one row for each database attached to the current database connection. The second column is the "main" for the main database file, "temp" for the database file used to store TEMP objects, or the name of the ATTACHed database for other database files. The third column is the name of the database file itself, or an empty string if the database is not associated with a file.
-     */
-    if (!self.isDatabaseOpen)
-        return nil;
-    
-    NSMutableArray<GWMDatabaseItem*> *mutableDatabases = [NSMutableArray<GWMDatabaseItem*> new];
+    GWMDatabaseConnection *connection = [self readerConnectionForPreparedStatement:sqlite3PreparedStatement];
     
-    static sqlite3_stmt *sqlite3PreparedStatement;
-    
-    int prepareCode = sqlite3_prepare_v2(self.database, "PRAGMA database_list;", -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                GWMDatabaseItem *dataItem = [GWMDatabaseItem new];
-                
-                char *schemaNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 1);
-                dataItem.name = [NSString stringWithUTF8String:schemaNameC];
-                
-                char *flieNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
-                dataItem.filename = [NSString stringWithUTF8String:flieNameC];
-                
-                [mutableDatabases addObject:dataItem];
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    if (connection) {
+        int finalizeCode = [connection.statementCache checkinStatement:sqlite3PreparedStatement];
+        [self checkinReaderConnection:connection];
+        return finalizeCode;
     }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
     
-    return [NSArray<GWMDatabaseItem*> arrayWithArray:mutableDatabases];
+    if (self.statementCache)
+        return [self.statementCache checkinStatement:sqlite3PreparedStatement];
+    
+    return sqlite3_finalize(sqlite3PreparedStatement);
 }
 
--(NSArray<GWMTableName>*)tablesWithSchema:(GWMSchemaName)schema
+-(GWMStatementCache *)statementCacheForPreparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement
 {
-    if (!self.isDatabaseOpen)
-        return nil;
-    //char *sql = "SELECT name FROM sqlite_master WHERE type='table'";
-    NSMutableArray<GWMTableName> *mutableTables = [NSMutableArray<GWMTableName> new];
-    
-    static sqlite3_stmt *sqlite3PreparedStatement;
-    
-    schema = schema ? schema : @"main";
+    GWMDatabaseConnection *connection = [self readerConnectionForPreparedStatement:sqlite3PreparedStatement];
+    return connection ? connection.statementCache : self.statementCache;
+}
+
+-(GWMRowMappingPlan *)rowMappingPlanForPreparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement searchesForClassColumn:(BOOL)searchesForClassColumn
+{
+    // the plan is kept with the cached statement so it is only worked out once per statement
+    NSMutableDictionary *userInfo = [[self statementCacheForPreparedStatement:sqlite3PreparedStatement] userInfoForStatement:sqlite3PreparedStatement];
+    NSString *key = searchesForClassColumn ? @"GWMRowMappingPlanClassColumn" : @"GWMRowMappingPlanFirstColumn";
     
-    NSString *statement = [NSString stringWithFormat:@"SELECT name FROM %@.sqlite_master WHERE type='table'",schema];
+    GWMRowMappingPlan *plan = userInfo[key];
+    if (plan)
+        return plan;
     
-    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                
-                char *tableNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
-                GWMTableName table = (GWMTableName)[NSString stringWithUTF8String:tableNameC];
-                
-                [mutableTables addObject:table];
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    plan = [[GWMRowMappingPlan alloc] initWithPreparedStatement:sqlite3PreparedStatement searchesForClassColumn:searchesForClassColumn];
+    userInfo[key] = plan;
     
-    return [NSArray<GWMTableName> arrayWithArray:mutableTables];
+    return plan;
 }
 
--(NSArray<GWMColumnItem*>*)columnsWithTable:(GWMTableName)table
+#pragma mark - Identity Map
+
+-(void)setIdentityMapMemoryLimit:(NSUInteger)identityMapMemoryLimit
 {
-    /*
-     PRAGMA table_info(table-name)
-     */
-    NSString *statement = nil;
+    _identityMapMemoryLimit = identityMapMemoryLimit;
     
-    if(table)
-        statement = [NSString stringWithFormat:@"PRAGMA table_info(%@);",table];
+    if (identityMapMemoryLimit == 0)
+        self.identityMap = nil;
+    else if (self.identityMap)
+        self.identityMap.memoryLimit = identityMapMemoryLimit;
     else
-        return @[];
-    
-    NSMutableArray *mutableColumns = [NSMutableArray new];
-    
-    static sqlite3_stmt *sqlite3PreparedStatement;
-    
-    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                GWMColumnItem *columnItem = [GWMColumnItem new];
-                
-                int columnId = sqlite3_column_int(sqlite3PreparedStatement, 0);
-                columnItem.columnId = columnId;
-                
-                char *columnNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 1);
-                columnItem.name = [NSString stringWithUTF8String:columnNameC];
-                
-                char *fileNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
-                columnItem.affinity = [NSString stringWithUTF8String:fileNameC];
-                
-                int notNull = sqlite3_column_int(sqlite3PreparedStatement, 3);
-                columnItem.notNull = [NSNumber numberWithBool:notNull].boolValue;
-                
-                char *defaultValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 4);
-                columnItem.defaultValue = defaultValueC ? [NSString stringWithUTF8String:defaultValueC] : nil;
-                
-                int primaryKeyIndex = sqlite3_column_int(sqlite3PreparedStatement, 5);
-                columnItem.primaryKeyIndex = primaryKeyIndex;
-                
-                [mutableColumns addObject:columnItem];
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
-    
-    return [NSArray arrayWithArray:mutableColumns];
+        self.identityMap = [[GWMIdentityMap alloc] initWithMemoryLimit:identityMapMemoryLimit];
 }
 
--(BOOL)foreignKeysEnabled
+-(NSUInteger)identityMapHits
 {
-    /*
-    PRAGMA foreign_keys;
-     */
-    
-    BOOL isEnabled = NO;
-    static sqlite3_stmt *sqlite3PreparedStatement;
-    
-    int prepareCode = sqlite3_prepare_v2(self.database, "PRAGMA foreign_keys;", -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                NSInteger enabled = sqlite3_column_int(sqlite3PreparedStatement, 0);
-                isEnabled = enabled != 0;
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
-    
-    return isEnabled;
+    return self.identityMap.hits;
 }
 
--(void)setForeignKeysEnabled:(BOOL)foreignKeysEnabled
+-(NSUInteger)identityMapMisses
 {
-    // PRAGMA foreign_keys = boolean;
-    NSString *statement = nil;
-    
-    if(foreignKeysEnabled)
-        statement = [NSString stringWithFormat:@"PRAGMA foreign_keys = ON"];
-    else
-        statement = [NSString stringWithFormat:@"PRAGMA foreign_keys = OFF"];
-    
-    static sqlite3_stmt *sqlite3PreparedStatement;
-    
-    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                NSInteger enabled = sqlite3_column_int(sqlite3PreparedStatement, 0);
-//                isEnabled = enabled != 0;
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    return self.identityMap.misses;
 }
 
-#pragma mark - Maintenance
+-(double)identityMapHitRate
+{
+    GWMIdentityMap *identityMap = self.identityMap;
+    NSUInteger lookups = identityMap.hits + identityMap.misses;
+    return lookups > 0 ? (double)identityMap.hits / (double)lookups : 0.0;
+}
 
--(void)vacuum:(GWMSchemaName)schema
+-(NSUInteger)identityMapMemoryUsage
 {
-    // VACUUM
+    return self.identityMap.memoryUsage;
+}
+
+-(NSUInteger)identityMapCount
+{
+    return self.identityMap.count;
+}
+
+-(NSUInteger)identityMapGeneration
+{
+    return self.identityMap.generation;
+}
+
+-(void)clearIdentityMap
+{
+    [self.identityMap removeAllObjects];
+}
+
+-(void)resetIdentityMapStatistics
+{
+    [self.identityMap resetStatistics];
+}
+
+#pragma mark - Result Cache
+
+-(void)setResultCacheMemoryLimit:(NSUInteger)resultCacheMemoryLimit
+{
+    _resultCacheMemoryLimit = resultCacheMemoryLimit;
     
-    NSString *statement = nil;
-    if(schema)
-        statement = [NSString stringWithFormat:@"VACUMM %@;",schema];
+    if (resultCacheMemoryLimit == 0)
+        self.resultCache = nil;
+    else if (self.resultCache)
+        self.resultCache.memoryLimit = resultCacheMemoryLimit;
     else
-        statement = @"VACUUM;";
-    
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        NSLog(@"%@",exception);
-    } @finally {
-        
-    }
+        self.resultCache = [[GWMResultCache alloc] initWithMemoryLimit:resultCacheMemoryLimit];
+}
+
+-(NSUInteger)resultCacheHits
+{
+    return self.resultCache.hits;
+}
+
+-(NSUInteger)resultCacheMisses
+{
+    return self.resultCache.misses;
+}
+
+-(NSUInteger)resultCacheEvictions
+{
+    return self.resultCache.evictions;
+}
+
+-(NSUInteger)resultCacheInvalidations
+{
+    return self.resultCache.invalidations;
+}
+
+-(NSUInteger)resultCacheMemoryUsage
+{
+    return self.resultCache.memoryUsage;
+}
+
+-(void)clearResultCache
+{
+    [self.resultCache removeAllData];
+}
+
+-(void)resetResultCacheStatistics
+{
+    [self.resultCache resetStatistics];
+}
+
+-(void)cacheResultData:(NSArray *)data forKey:(NSString *)key preparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement cost:(NSUInteger)cost generation:(NSUInteger)generation
+{
+    // statements that are not in the statement cache have no recorded tables and can't be invalidated
+    NSSet<NSString*> *readTables = [[self statementCacheForPreparedStatement:sqlite3PreparedStatement] readTablesForStatement:sqlite3PreparedStatement];
     
+    if (readTables)
+        [self.resultCache setData:data forKey:key tables:readTables cost:cost generation:generation];
 }
 
--(NSArray<NSString*>*)checkIntegrity:(GWMSchemaName)schema rows:(NSInteger)rowCount
+#pragma mark - Profiling
+
+-(void)setProfilingEnabled:(BOOL)profilingEnabled
 {
-    /*
-     PRAGMA schema.integrity_check;
-     PRAGMA schema.integrity_check(N);
-     
-     This pragma does an integrity check of the entire database. The integrity_check pragma looks for out-of-order records, missing pages, malformed records, missing index entries, and UNIQUE, CHECK, and NOT NULL constraint errors. If the integrity_check pragma finds problems, strings are returned (as multiple rows with a single column per row) which describe the problems. Pragma integrity_check will return at most N errors before the analysis quits, with N defaulting to 100. If pragma integrity_check finds no errors, a single row with the value 'ok' is returned.
-     
-     PRAGMA integrity_check does not find FOREIGN KEY errors. Use the PRAGMA foreign_key_check command for to find errors in FOREIGN KEY constraints.
-     
-     See also the PRAGMA quick_check command which does most of the checking of PRAGMA integrity_check but runs much faster.
-     */
-    if(!schema)
-        schema = GWMSchemaNameMain;
+    if (profilingEnabled == _profilingEnabled)
+        return;
     
-    NSString *statement;
+    _profilingEnabled = profilingEnabled;
     
-    if (rowCount > 0) {
-        statement = [NSString stringWithFormat:@"PRAGMA %@.integrity_check(%li);",schema,rowCount];
-    } else {
-        statement = [NSString stringWithFormat:@"PRAGMA %@.integrity_check;",schema];
+    if (profilingEnabled && !self.statementProfiler) {
+        GWMStatementProfiler *profiler = [GWMStatementProfiler new];
+        profiler.slowStatementThreshold = self.slowStatementThreshold;
+        self.statementProfiler = profiler;
     }
     
-    NSMutableArray<NSString*> *mutableErrorStrings = [NSMutableArray<NSString*> new];
-    static sqlite3_stmt *sqlite3PreparedStatement;
+    GWMStatementProfiler *profiler = self.statementProfiler;
     
-    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                
-                char *schemaNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
-                NSString *message = [NSString stringWithUTF8String:schemaNameC];
-                
-                [mutableErrorStrings addObject:message];
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    // a trace callback can only be changed while no other thread is using the connection
+    [self performWrite:^{
+        if (self.database == NULL)
+            return;
+        if (profilingEnabled)
+            [profiler attachToDatabase:self.database];
+        else
+            [GWMStatementProfiler detachFromDatabase:self.database];
+    }];
     
-    return [NSArray<NSString*> arrayWithArray:mutableErrorStrings];
+    if (self.readerConnections) {
+        [self performWithAllReaderConnections:^(GWMDatabaseConnection *connection){
+            if (profilingEnabled)
+                [profiler attachToDatabase:connection.database];
+            else
+                [GWMStatementProfiler detachFromDatabase:connection.database];
+        }];
+    }
 }
 
--(NSArray<GWMForeignKeyIntegrityCheckItem*> *)checkForeignKeysIntegrity:(GWMSchemaName)schema table:(GWMTableName)table
+-(void)setSlowStatementThreshold:(NSTimeInterval)slowStatementThreshold
 {
-    /*
-     PRAGMA schema.foreign_key_check;
-     PRAGMA schema.foreign_key_check(table-name);
-     
-     The foreign_key_check pragma checks the database, or the table called "table-name", for foreign key constraints that are violated and returns one row of output for each violation. There are four columns in each result row. The first column is the name of the table that contains the REFERENCES clause. The second column is the rowid of the row that contains the invalid REFERENCES clause, or NULL if the child table is a WITHOUT ROWID table. The third column is the name of the table that is referred to. The fourth column is the index of the specific foreign key constraint that failed. The fourth column in the output of the foreign_key_check pragma is the same integer as the first column in the output of the foreign_key_list pragma. When a "table-name" is specified, the only foreign key constraints checked are those created by REFERENCES clauses in the CREATE TABLE statement for table-name.
-     */
-    
-    NSMutableArray<GWMForeignKeyIntegrityCheckItem*> *mutableCheckItems = [NSMutableArray<GWMForeignKeyIntegrityCheckItem*> new];
-    
-    NSString *statement = nil;
-    
-    if(!schema)
-        schema = GWMSchemaNameMain;
-    
-    if(!table)
-        statement = [NSString stringWithFormat:@"PRAGMA %@.foreign_key_check",schema];
-    else
-        statement = [NSString stringWithFormat:@"PRAGMA %@.foreign_key_check(%@)",schema,table];
+    _slowStatementThreshold = slowStatementThreshold;
+    self.statementProfiler.slowStatementThreshold = slowStatementThreshold;
+}
+
+-(NSDictionary<NSString*,id> *)profilingSnapshot
+{
+    GWMStatementProfiler *profiler = self.statementProfiler;
     
-    static sqlite3_stmt *sqlite3PreparedStatement;
+    if (!profiler)
+        return @{@"statements": @[], @"slowStatements": @[]};
     
-    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
-    if(prepareCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-    else {
-        int stepCode = GWMSQLiteResultRow;
-        while(stepCode == GWMSQLiteResultRow) {
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            if (stepCode == GWMSQLiteResultRow) {
-                GWMForeignKeyIntegrityCheckItem *checkItem = [GWMForeignKeyIntegrityCheckItem new];
-                
-                char *tableC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
-                checkItem.table = [NSString stringWithUTF8String:tableC];
-                
-                int rowID = sqlite3_column_int(sqlite3PreparedStatement, 1);
-                checkItem.rowID = rowID;
-                
-                char *referedTableC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
-                checkItem.referredTable = [NSString stringWithUTF8String:referedTableC];
-                
-                int failedRowID = sqlite3_column_int(sqlite3PreparedStatement, 3);
-                checkItem.failedRowID = failedRowID;
-                
-                [mutableCheckItems addObject:checkItem];
-            }
-        }
-        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    if (self.database != NULL) {
+        [self performWrite:^{
+            if (self.database != NULL)
+                [profiler explainSlowStatementsWithDatabase:self.database];
+        }];
     }
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if(finalizeCode != GWMSQLiteResultOK)
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
     
-    return [NSArray<GWMForeignKeyIntegrityCheckItem*> arrayWithArray:mutableCheckItems];
+    return [profiler snapshot];
 }
 
-#pragma mark - Attach and Detach Database
+-(NSData *)profilingSnapshotJSONDataWithError:(NSError **)error
+{
+    return [NSJSONSerialization dataWithJSONObject:[self profilingSnapshot] options:NSJSONWritingPrettyPrinted error:error];
+}
 
--(GWMDBOperationResult)attachDatabase:(GWMDatabaseFileName)databaseFileName schemaName:(GWMSchemaName)alias
+-(void)resetProfiling
 {
-    NSArray<GWMDatabaseItem*> *databases = self.databases;
-    
-    __block BOOL attached = NO;
-    [databases enumerateObjectsUsingBlock:^(GWMDatabaseItem *_Nonnull db, NSUInteger idx, BOOL *stop){
-        if ([db.name isEqualToString:alias]) {
-            attached = YES;
-            *stop = YES;
-        }
-    }];
-    if(attached){
-        NSLog(@"Database with alias '%@' already attached", alias);
-        return GWMDBOperationDatabaseAttached;
-    }
-    
-    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
-    NSString *documentPath = [paths firstObject];
-    
-    NSString *fullPath = [documentPath stringByAppendingPathComponent:databaseFileName];
-    NSString *statement = [NSString stringWithFormat:@"ATTACH DATABASE \'%@\' AS %@;", fullPath, alias];
-    char *errorMessageC;
-    
-    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
-    
-    if (executeCode != GWMSQLiteResultOK) {
+    [self.statementProfiler reset];
+}
 
-        NSLog(@"Error while attaching database '%@' (%@): '%s'", databaseFileName, alias, errorMessageC);
-        sqlite3_free(errorMessageC);
-        return GWMDBOperationDatabaseNotAttached;
-    }
+#pragma mark - Write-Behind Queue
 
-    NSLog(@"Successfully attached database: '%@' as '%@'", databaseFileName, alias);
-    return GWMDBOperationDatabaseAttached;
+-(NSTimeInterval)writeBatchInterval
+{
+    return self.writeBatcher.batchInterval;
 }
 
--(GWMDBOperationResult)detachDatabase:(GWMDatabaseAlias)databaseName
+-(void)setWriteBatchInterval:(NSTimeInterval)writeBatchInterval
 {
-    if (self.isTransactionInProgress) {
-        NSLog(@"Can't detach database: %@ while transaction: '%@' is in progress", databaseName, self.transactionName);
-        return GWMDBOperationDatabaseNotDetached;
+    self.writeBatcher.batchInterval = writeBatchInterval;
+}
+
+-(NSUInteger)writeBatchSize
+{
+    return self.writeBatcher.batchSize;
+}
+
+-(void)setWriteBatchSize:(NSUInteger)writeBatchSize
+{
+    self.writeBatcher.batchSize = writeBatchSize;
+}
+
+-(NSUInteger)writeQueueDepth
+{
+    return self.writeBatcher.queueDepth;
+}
+
+-(void)enqueueWrite:(GWMDBWriteBlock)write completion:(GWMDBErrorCompletionBlock)completion
+{
+    [self.writeBatcher enqueueWrite:write completion:completion];
+}
+
+-(void)enqueueUpdateTable:(GWMTableName)table withValues:(NSDictionary<GWMColumnName,id> *)values criteria:(NSDictionary<GWMColumnName,id> *)criteria completion:(GWMDBErrorCompletionBlock)completion
+{
+    [self enqueueWrite:^NSError *{
+        __block NSError *updateError = nil;
+        GWMDatabaseResult *result = [self updateTable:table withValues:values criteria:criteria completion:^(GWMDataItem *_Nullable itm, NSError *_Nullable error){
+            updateError = error;
+        }];
+        if (!updateError && result.errors.count > 0)
+            updateError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:result.resultMessage ?: GWMSQLiteErrorExecutingStatement}];
+        return updateError;
+    } completion:completion];
+}
+
+-(void)flushWrites
+{
+    // without a writer queue the transaction in progress belongs to the caller
+    if (self.isTransactionInProgress && (!self.writerQueue || [self isOnWriterQueue])) {
+        NSLog(@"*** Can't flush writes because transaction: '%@' is in progress ***", self.transactionName);
+        return;
     }
-    NSString *statement = [NSString stringWithFormat:@"DETACH DATABASE \'%@\';", databaseName];
-    char *errorMessageC;
+
+    [self.writeBatcher flush];
+}
+
+-(NSDictionary<NSString*,id> *)writeBatchStatistics
+{
+    return [self.writeBatcher statistics];
+}
+
+-(void)resetWriteBatchStatistics
+{
+    [self.writeBatcher resetStatistics];
+}
+
+#pragma mark - Change Tracking
+
+static BOOL GWMIsSearchIndexTable(const char *table)
+{
+    if (table == NULL)
+        return NO;
     
-    int result = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    const char *suffix = strstr(table, "_fts");
+    while (suffix != NULL) {
+        // <table>_fts or one of its shadow tables, such as <table>_fts_data
+        if (suffix[4] == '\0' || suffix[4] == '_')
+            return YES;
+        suffix = strstr(suffix + 4, "_fts");
+    }
+    return NO;
+}
+
+static void GWMDatabaseUpdateHook(void *context, int operation, const char *schema, const char *table, sqlite3_int64 rowID)
+{
+    GWMDatabaseController *databaseController = (__bridge GWMDatabaseController *)context;
+    [databaseController didChangeRowWithOperation:operation schema:schema table:table rowID:rowID];
+}
+
+static void GWMDatabaseRollbackHook(void *context)
+{
+    GWMDatabaseController *databaseController = (__bridge GWMDatabaseController *)context;
+    [databaseController.changeRecorder removeAllChanges];
+}
+
+-(id<NSObject>)addChangeObserverForTables:(NSArray<GWMTableName> *)tables queue:(dispatch_queue_t)queue block:(void (^)(GWMChangeSet *changeSet))block
+{
+    GWMChangeSubscription *subscription = [[GWMChangeSubscription alloc] initWithTables:tables ? [NSSet setWithArray:tables] : nil queue:queue ?: dispatch_get_main_queue() block:block];
     
-    if (result != GWMSQLiteResultOK) {
-        NSLog(@"Error while detaching database: '%@' Message: '%s'", databaseName, errorMessageC);
-        sqlite3_free(errorMessageC);
-        return GWMDBOperationDatabaseNotDetached;
-    } else {
-        NSLog(@"Successfully detached database: '%@'", databaseName);
-        return GWMDBOperationDatabaseDetached;
+    @synchronized (self.changeSubscriptions) {
+        [self.changeSubscriptions addObject:subscription];
     }
+    
+    return subscription;
 }
 
-#pragma mark - Open and close the Database; check if Database is open
+-(void)removeChangeObserver:(id<NSObject>)observer
+{
+    @synchronized (self.changeSubscriptions) {
+        [self.changeSubscriptions removeObjectIdenticalTo:observer];
+    }
+}
 
--(void)openDatabase
+-(void)publishChangeSet:(GWMChangeSet *)changeSet
 {
-    NSString *mainDatabaseName = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_MainDatabaseName];
-    NSString *mainDatabaseExtension = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_MainDatabaseExtension];
-    NSString *userDatabaseName = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_UserDatabaseName];
-    NSString *userDatabaseAlias = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_UserDatabaseAlias];
+    if (!changeSet)
+        return;
     
-    if (mainDatabaseName && mainDatabaseExtension) {
-        BOOL success = [self openDatabase:mainDatabaseName extension:mainDatabaseExtension];
+    [self.notificationCenter postNotificationName:GWMDatabaseControllerDidUpdateDataNotification object:self userInfo:@{GWMDBChangeSetKey:changeSet}];
+    
+    NSArray<GWMChangeSubscription*> *subscriptions = nil;
+    @synchronized (self.changeSubscriptions) {
+        subscriptions = [self.changeSubscriptions copy];
+    }
+    
+    for (GWMChangeSubscription *subscription in subscriptions)
+        [subscription deliverChangeSet:changeSet];
+}
+
+-(void)didChangeSchema
+{
+    [self clearStatementCache];
+    [self clearIdentityMap];
+    [self clearResultCache];
+}
+
+-(NSArray<NSString*> *)classNamesMappedToTable:(NSString *)table
+{
+    @synchronized (self) {
         
-        if (success && userDatabaseName && userDatabaseAlias) {
-            success = [self attachDatabase:userDatabaseName schemaName:userDatabaseAlias];
+        NSDictionary<NSString*,GWMTableName> *classToTableMapping = self.classToTableMapping;
+        
+        if (!self.classNamesByTable || self.classNamesByTableMapping != classToTableMapping) {
+            
+            NSMutableDictionary<NSString*,NSMutableArray<NSString*>*> *mutableClassNamesByTable = [NSMutableDictionary new];
             
+            [classToTableMapping enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull className, GWMTableName _Nonnull tableName, BOOL *stop){
+                // the update hook reports the table without its schema
+                NSString *key = [tableName componentsSeparatedByString:@"."].lastObject;
+                if (!mutableClassNamesByTable[key])
+                    mutableClassNamesByTable[key] = [NSMutableArray new];
+                [mutableClassNamesByTable[key] addObject:className];
+            }];
+            
+            self.classNamesByTable = mutableClassNamesByTable;
+            self.classNamesByTableMapping = classToTableMapping;
         }
+        
+        return self.classNamesByTable[table];
     }
 }
 
--(GWMDBOperationResult)openDatabase:(NSString *)name extension:(NSString *)extension
+-(void)didChangeRowWithOperation:(int)operation schema:(const char *)schema table:(const char *)table rowID:(sqlite3_int64)rowID
 {
-    if ([self isDatabaseOpen])
-        return GWMDBOperationDatabaseOpened;
+    // the triggers of a search index write to the shadow tables of its FTS5 table, which no query reads directly
+    if (GWMIsSearchIndexTable(table))
+        return;
     
-    self.databasePath = [[NSBundle mainBundle] pathForResource:name ofType:extension];
+    [self.changeRecorder recordOperation:operation schema:schema table:table rowID:rowID];
     
-    sqlite3 *db = NULL;
+    GWMResultCache *resultCache = self.resultCache;
     
-//    sqlite3_shutdown();
-//    sqlite3_config(SQLITE_CONFIG_SERIALIZED);
-//    sqlite3_initialize();
-//    int openCode = sqlite3_open(self.databasePath.UTF8String, &db);
+    if (resultCache)
+        [resultCache removeDataReadingTable:[NSString stringWithFormat:@"%s.%s", schema, table]];
     
-//    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_FULLMUTEX;
+    GWMIdentityMap *identityMap = self.identityMap;
     
-    self.openFlags = GWMDBOpenReadWrite | GWMDBOpenFullMutex;
-    int openCode = sqlite3_open_v2(self.databasePath.UTF8String, &db, self.openFlags, NULL);
+    if (!identityMap)
+        return;
     
-    self.database = db;
+    NSArray<NSString*> *classNames = [self classNamesMappedToTable:[NSString stringWithUTF8String:table]];
     
-    if (openCode != GWMSQLiteResultOK) {
-        NSLog(@"*** %@ at path: %@ with error: '%s' ***", GWMSQLiteErrorOpeningDatabase, self.databasePath, sqlite3_errmsg(self.database));
-        [self closeDatabase];
-        return GWMDBOperationDatabaseNotOpened;
+    for (NSString *className in classNames)
+        [identityMap removeObjectsForClassName:className itemID:(NSInteger)rowID];
+}
+
+-(id)objectWithRowOfStatement:(sqlite3_stmt *)sqlite3PreparedStatement rowMappingPlan:(GWMRowMappingPlan *)rowMappingPlan identityMapGeneration:(NSUInteger)identityMapGeneration
+{
+    GWMIdentityMap *identityMap = self.identityMap;
+    NSInteger itemID = 0;
+    
+    if (!identityMap || ![rowMappingPlan getItemID:&itemID ofRowOfStatement:sqlite3PreparedStatement])
+        return [rowMappingPlan objectWithRowOfStatement:sqlite3PreparedStatement];
+    
+    // only rows of mapped tables are removed from the map when they change
+    Class rowClass = [rowMappingPlan classOfRowOfStatement:sqlite3PreparedStatement];
+    NSString *className = rowClass ? NSStringFromClass(rowClass) : nil;
+    
+    if (!className || !self.classToTableMapping[className])
+        return [rowMappingPlan objectWithRowOfStatement:sqlite3PreparedStatement];
+    
+    NSString *columnSignature = rowMappingPlan.columnSignature;
+    
+    id obj = [identityMap objectForClassName:className itemID:itemID columnSignature:columnSignature];
+    if (obj)
+        return obj;
+    
+    obj = [rowMappingPlan objectWithRowOfStatement:sqlite3PreparedStatement];
+    
+    if (obj) {
+        NSUInteger cost = [rowMappingPlan costOfRowOfStatement:sqlite3PreparedStatement];
+        [identityMap setObject:obj forClassName:className itemID:itemID columnSignature:columnSignature cost:cost generation:identityMapGeneration];
+    }
+    
+    return obj;
+}
+
+#pragma mark - Connection Configuration
+
+-(void)applyConnectionConfigurationWithSchema:(GWMSchemaName)schema
+{
+    for (NSString *statement in [self.connectionConfiguration statementsWithSchema:schema readOnly:NO]) {
+        char *errorMessageC = NULL;
+        int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+        if (executeCode != GWMSQLiteResultOK) {
+            NSLog(@"*** Could not apply connection setting '%@': '%s' ***", statement, errorMessageC);
+            sqlite3_free(errorMessageC);
+        }
+    }
+}
+
+-(void)applyConnectionConfigurationToReaderConnection:(GWMDatabaseConnection *)connection schema:(GWMSchemaName)schema
+{
+    for (NSString *statement in [self.connectionConfiguration statementsWithSchema:schema readOnly:YES])
+        [connection executeStatement:statement];
+}
+
+#pragma mark - Reader Pool
+
+-(void)openReaderConnections
+{
+    if (self.readerConnectionCount == 0)
+        return;
+    
+    // readers only see committed data and never block the writer in write-ahead logging mode
+    char *errorMessageC = NULL;
+    int executeCode = sqlite3_exec(self.database, "PRAGMA journal_mode=WAL;", NULL, NULL, &errorMessageC);
+    if (executeCode != GWMSQLiteResultOK) {
+        NSLog(@"*** Could not enable write-ahead logging, reader connections not opened: '%s' ***", errorMessageC);
+        sqlite3_free(errorMessageC);
+        return;
     }
     
-    NSLog(@"*** SQLite version: %@ ***", [self sqliteVersion]);
-    NSLog(@"*** SQLite library version: %@ ***", [self sqliteLibraryVersion]);
+    NSMutableArray<GWMDatabaseConnection*> *mutableConnections = [NSMutableArray<GWMDatabaseConnection*> new];
     
-    return GWMDBOperationDatabaseOpened;
+    for (NSUInteger idx = 0; idx < self.readerConnectionCount; idx++) {
+        GWMDatabaseConnection *connection = [[GWMDatabaseConnection alloc] initWithPath:self.databasePath statementCacheCapacity:self.statementCacheCapacity];
+        if (!connection)
+            continue;
+        [self applyConnectionConfigurationToReaderConnection:connection schema:nil];
+        if (self.profilingEnabled)
+            [self.statementProfiler attachToDatabase:connection.database];
+        [mutableConnections addObject:connection];
+    }
+    
+    if (mutableConnections.count == 0)
+        return;
+    
+    if (!self.readerPoolLock)
+        self.readerPoolLock = [NSObject new];
+    
+    @synchronized (self.readerPoolLock) {
+        self.readerConnections = [NSArray arrayWithArray:mutableConnections];
+        self.idleReaderConnections = mutableConnections;
+        self.readerSemaphore = dispatch_semaphore_create(mutableConnections.count);
+    }
+    self.writerQueue = dispatch_queue_create("GWMDatabaseController.writer", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(self.writerQueue, (__bridge void *)self, (__bridge void *)self, NULL);
+    
+    os_log_debug(OS_LOG_DEFAULT, "Opened %lu reader connections", (unsigned long)self.readerConnections.count);
 }
 
--(GWMDBOperationResult)closeDatabase
+-(void)closeReaderConnections
 {
+    if (!self.readerConnections)
+        return;
     
-    if (![self isDatabaseOpen])
-        return GWMDBOperationDatabaseClosed;
+    // a connection that is still in use is closed when it is checked in
+    [self performWithAllReaderConnections:^(GWMDatabaseConnection *connection){
+        [connection close];
+    }];
+    
+    @synchronized (self.readerPoolLock) {
+        self.readerConnections = nil;
+        self.idleReaderConnections = nil;
+        self.readerSemaphore = nil;
+    }
+    self.writerQueue = nil;
+}
 
-    if (self.isTransactionInProgress) {
-        NSLog(@"*** Can't close database because transaction: '%@' is in progress ***", self.transactionName);
-        return GWMDBOperationDatabaseNotClosed;
+-(BOOL)isOnWriterQueue
+{
+    return self.writerQueue && dispatch_get_specific((__bridge void *)self) == (__bridge void *)self;
+}
+
+-(GWMDatabaseConnection *)checkoutReaderConnection
+{
+    // the writer queue sees its own uncommitted changes on the main connection, every other thread reads a committed snapshot
+    if (!self.readerConnections || [self isOnWriterQueue])
+        return nil;
+    
+    NSThread *thread = [NSThread currentThread];
+    dispatch_semaphore_t readerSemaphore = nil;
+    
+    @synchronized (self.readerPoolLock) {
+        // a thread that already holds a reader keeps using it, waiting for a second one could deadlock the pool
+        for (GWMDatabaseConnection *connection in self.readerConnections) {
+            if (connection.thread == thread) {
+                connection.checkoutCount++;
+                return connection;
+            }
+        }
+        readerSemaphore = self.readerSemaphore;
     }
     
-    NSArray<GWMDatabaseItem*> *databases = self.databases;
+    if (!readerSemaphore)
+        return nil;
     
-    [databases enumerateObjectsUsingBlock:^(GWMDatabaseItem *_Nonnull db, NSUInteger idx, BOOL *stop){
-        if(![db.name isEqualToString:GWMSchemaNameMain])
-            [self detachDatabase:db.name];
-    }];
+    dispatch_semaphore_wait(readerSemaphore, DISPATCH_TIME_FOREVER);
     
-    int closeCode = sqlite3_close(self.database);
+    @synchronized (self.readerPoolLock) {
+        GWMDatabaseConnection *connection = self.idleReaderConnections.lastObject;
+        if (!connection)
+            return nil;
+        [self.idleReaderConnections removeLastObject];
+        connection.thread = thread;
+        connection.checkoutCount = 1;
+        return connection;
+    }
+}
+
+-(void)checkinReaderConnection:(GWMDatabaseConnection *)connection
+{
+    dispatch_semaphore_t readerSemaphore = nil;
     
-    if (closeCode != GWMSQLiteResultOK) {
-        NSLog(@"*** %@: Message:'%s' ***", GWMSQLiteErrorClosingDatabase, sqlite3_errmsg(self.database));
-        return GWMDBOperationDatabaseNotClosed;
+    @synchronized (self.readerPoolLock) {
+        
+        if (--connection.checkoutCount > 0)
+            return;
+        
+        connection.thread = nil;
+        
+        // changes made to every connection while this one was in use
+        [connection runDeferredBlocks];
+        
+        // the pool was closed while the connection was in use
+        if ([self.readerConnections indexOfObjectIdenticalTo:connection] == NSNotFound)
+            return;
+        
+        [self.idleReaderConnections addObject:connection];
+        readerSemaphore = self.readerSemaphore;
     }
-    self.database = NULL;
     
-    NSLog(@"*** Database was closed ***");
-    return GWMDBOperationDatabaseClosed;
+    dispatch_semaphore_signal(readerSemaphore);
 }
 
--(BOOL)isDatabaseOpen
+-(GWMDatabaseConnection *)readerConnectionForPreparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement
 {
-    return self.database != NULL;
+    if (!self.readerConnections || sqlite3PreparedStatement == NULL)
+        return nil;
+    
+    sqlite3 *database = sqlite3_db_handle(sqlite3PreparedStatement);
+    
+    for (GWMDatabaseConnection *connection in self.readerConnections) {
+        if (connection.database == database)
+            return connection;
+    }
+    
+    return nil;
 }
 
-#pragma mark -  Helper Methods
+-(void)performWithAllReaderConnections:(void (^)(GWMDatabaseConnection *connection))block
+{
+    // a connection in use, even by the calling thread, runs the block when it is checked in instead of being waited for, so no caller can deadlock on the pool
+    @synchronized (self.readerPoolLock) {
+        for (GWMDatabaseConnection *connection in self.readerConnections) {
+            if (connection.checkoutCount > 0)
+                [connection addDeferredBlock:block];
+            else
+                block(connection);
+        }
+    }
+}
 
--(NSDate *)dateWithFormat:(NSString *)dateFormat string:(NSString *)dateString andTimeZone:(NSTimeZone *)timeZone
+-(void)performWrite:(dispatch_block_t)block
 {
-    NSDate *resultDate;
+    if (!self.writerQueue || [self isOnWriterQueue]) {
+        [self publishChangeSet:[self performTrackedWrite:block]];
+        return;
+    }
     
-    [self.dateFormatter setDateFormat:dateFormat];// format for going from sqlite table to NSDate object
-    [self.dateFormatter setTimeZone:timeZone];
-    resultDate = [self.dateFormatter dateFromString:dateString];
+    // exceptions must not unwind through dispatch_sync
+    __block NSException *writeException = nil;
+    __block GWMChangeSet *changeSet = nil;
     
-    return resultDate;
+    dispatch_sync(self.writerQueue, ^{
+        @try {
+            changeSet = [self performTrackedWrite:block];
+        } @catch (NSException *exception) {
+            writeException = exception;
+        }
+    });
+    
+    // observers are told outside the writer queue
+    [self publishChangeSet:changeSet];
+    
+    if (writeException)
+        @throw writeException;
 }
 
--(GWMBindValuesEnumerationBlock)bindValuesEnumerationBlockWithResult:(GWMDatabaseResult *)databaseResult preparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement
+-(GWMChangeSet *)performTrackedWrite:(dispatch_block_t)block
 {
-    return ^(id _Nonnull value, NSUInteger idx, BOOL  * _Nonnull stop){
-        
-        int statementIdx = (int)idx + 1;
-        int bindCode = GWMSQLiteResultOK;
-        NSError *error = nil;
+    if (self.database == NULL) {
+        block();
+        return nil;
+    }
+    
+    @try {
+        block();
+    } @finally {
         
-        if ([value isKindOfClass:[NSDate class]]) {
-            
-            NSDate *date = (NSDate*)value;
-            [self.dateFormatter setDateFormat:GWMDBDateFormatDateTime];
-            NSString *string = [self.dateFormatter stringFromDate:date];
-            bindCode = sqlite3_bind_text(sqlite3PreparedStatement, statementIdx, string.UTF8String, -1, SQLITE_TRANSIENT);
-            if (bindCode != GWMSQLiteResultOK) {
-                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingNullValue,sqlite3_errmsg(self.database)];
-                databaseResult.resultCode = bindCode;
-                databaseResult.resultMessage = message;
-                databaseResult.errors[@(bindCode)] = message;
-                NSLog(@"*** %@ ***", message);
-                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-            }
-            
-        } else if ([value isKindOfClass:[NSNull class]]) {
-            
-            bindCode = sqlite3_bind_null(sqlite3PreparedStatement, statementIdx);
-            if (bindCode != GWMSQLiteResultOK) {
-                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingNullValue,sqlite3_errmsg(self.database)];
-                databaseResult.resultCode = bindCode;
-                databaseResult.resultMessage = message;
-                databaseResult.errors[@(bindCode)] = message;
-                NSLog(@"*** %@ ***", message);
-                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-            }
-            
-        } else if ([value isKindOfClass:[NSString class]]) {
-            
-            NSString *string = (NSString*)value;
-            bindCode = sqlite3_bind_text(sqlite3PreparedStatement, statementIdx, string.UTF8String, -1, SQLITE_TRANSIENT);
-            if (bindCode != GWMSQLiteResultOK) {
-                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingTextValue,sqlite3_errmsg(self.database)];
-                databaseResult.resultCode = bindCode;
-                databaseResult.resultMessage = message;
-                databaseResult.errors[@(bindCode)] = message;
-                NSLog(@"*** %@ ***", message);
-                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-            }
-            
-        } else if ([value isKindOfClass:[NSNumber class]]){
-            //TODO: number type IMPROVING
-            // https://stackoverflow.com/questions/2518761/get-type-of-nsnumber
-            NSNumber *numberNS = (NSNumber *)value;
-            CFNumberType numberType = CFNumberGetType((CFNumberRef)numberNS);
-            //                    const char *type = [value objCType];
-            //                    const char *encoding = @encode(char);
-            //                    BOOL same = (strcmp(type, encoding) == 0);
-            switch (numberType) {
-                case kCFNumberFloatType:
-                case kCFNumberFloat32Type:
-                case kCFNumberFloat64Type:
-                case kCFNumberCGFloatType:
-                {
-                    float numberF = [numberNS floatValue];
-                    bindCode = sqlite3_bind_double(sqlite3PreparedStatement, statementIdx, numberF);
-                    if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingDoubleValue,sqlite3_errmsg(self.database)];
-                        databaseResult.resultCode = bindCode;
-                        databaseResult.resultMessage = message;
-                        databaseResult.errors[@(bindCode)] = message;
+        if (self.database != NULL && sqlite3_get_autocommit(self.database)) {
+            // changed rows are removed again once they are committed or rolled back
+            [self.identityMap removePendingRows];
+            [self.resultCache removePendingTables];
+        }
+    }
+    
+    // changes are published once nothing is left to roll back
+    if (self.database != NULL && sqlite3_get_autocommit(self.database))
+        return [self.changeRecorder takeChangeSet];
+    
+    return nil;
+}
+
+#pragma mark - SQLite Version
+
+-(NSString *)sqliteVersion
+{
+    return [NSString stringWithUTF8String:SQLITE_VERSION];
+}
+
+-(NSString *)sqliteLibraryVersion
+{
+    const char *versionC = sqlite3_libversion();
+    return [NSString stringWithUTF8String:versionC];
+}
+
+#pragma mark - Introspection
+
+-(int)databaseVersionAtPath:(NSString *)filePath withExtension:(NSString *)extension
+{
+    /*
+     this method temporarily opens a database to get PRAGMA user_version and then closes the database
+     */
+    
+//    [self closeDatabase];
+    
+    NSString *databasePathNS = [[NSBundle mainBundle] pathForResource:filePath ofType:extension];
+    const char *databasePathC = [databasePathNS UTF8String];
+    int databaseVersion = -1;
+    
+    sqlite3 *tempDatabase = NULL;
+    
+    int openCode = sqlite3_open(databasePathC, &tempDatabase);
+    if(openCode != GWMSQLiteResultOK) {
+        NSLog(@"%@: %s", GWMSQLiteErrorOpeningDatabase, sqlite3_errmsg(tempDatabase));
+        os_log(OS_LOG_DEFAULT,  "%s: %s", [GWMSQLiteErrorOpeningDatabase UTF8String], sqlite3_errmsg(tempDatabase));
+    } else {
+        static sqlite3_stmt *sqlite3PreparedStatement;
+        int prepareCode = sqlite3_prepare_v2(tempDatabase, "PRAGMA user_version;", -1, &sqlite3PreparedStatement, NULL);
+        if(prepareCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(tempDatabase));
+        else {
+            int stepCode = GWMSQLiteResultRow;
+            while(stepCode == GWMSQLiteResultRow) {
+                stepCode = sqlite3_step(sqlite3PreparedStatement);
+                if (stepCode == GWMSQLiteResultRow) {
+                    databaseVersion = sqlite3_column_int(sqlite3PreparedStatement, 0);
+                    NSLog(@"Database: %@ version: %d", databasePathNS, databaseVersion);
+                    os_log(OS_LOG_DEFAULT, "Database: %s version: %d", [databasePathNS UTF8String], databaseVersion);
+                }
+            }
+            if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+                NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(tempDatabase));
+        }
+        int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+        if(finalizeCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(tempDatabase));
+        
+        int closeCode = sqlite3_close(tempDatabase);
+        if(closeCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %@ Message: %s", GWMSQLiteErrorClosingDatabase, databasePathNS, sqlite3_errmsg(tempDatabase));
+        
+        tempDatabase = NULL;
+    }
+    
+    return databaseVersion;
+}
+
+-(int)databaseVersionAtFilePath:(NSString *)filePath
+{
+    /*
+     this method temporarily opens a database to get PRAGMA user_version and then closes the database
+     */
+    
+//    [self closeDatabase];
+    
+    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
+    NSString *documentsDirectoryPath = [paths firstObject];
+    NSString *databasePathNS = [documentsDirectoryPath stringByAppendingPathComponent:filePath];
+    const char *databasePathC = [databasePathNS UTF8String];
+    int databaseVersion = -1;
+    
+    sqlite3 *tempDatabase = NULL;
+    
+    int openCode = sqlite3_open(databasePathC, &tempDatabase);
+    if(openCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorOpeningDatabase, sqlite3_errmsg(tempDatabase));
+    
+    else {
+        
+        static sqlite3_stmt *sqlite3PreparedStatement;
+        
+        int prepareCode = sqlite3_prepare_v2(tempDatabase, "PRAGMA user_version;", -1, &sqlite3PreparedStatement, NULL);
+        if(prepareCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(tempDatabase));
+        else {
+            int stepCode = GWMSQLiteResultRow;
+            while(stepCode == GWMSQLiteResultRow) {
+                stepCode = sqlite3_step(sqlite3PreparedStatement);
+                if (stepCode == GWMSQLiteResultRow) {
+                    databaseVersion = sqlite3_column_int(sqlite3PreparedStatement, 0);
+                    NSLog(@"Database: %@ version: %d", databasePathNS, databaseVersion);
+                }
+            }
+            if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+                NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(tempDatabase));
+        }
+        int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+        if(finalizeCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(tempDatabase));
+        
+        int closeCode = sqlite3_close(tempDatabase);
+        if(closeCode != GWMSQLiteResultOK)
+            NSLog(@"%@: %@ Message: %s", GWMSQLiteErrorClosingDatabase, databasePathNS, sqlite3_errmsg(tempDatabase));
+        
+        tempDatabase = NULL;
+    }
+    
+    return databaseVersion;
+}
+
+-(NSArray<GWMDatabaseItem*>*)databases
+{
+    /*
+     PRAGMA database_list;
+     
+     This pragma works like a query to return one row for each database attached to the current database connection. The second column is the "main" for the main database file, "temp" for the database file used to store TEMP objects, or the name of the ATTACHed database for other database files. The third column is the name of the database file itself, or an empty string if the database is not associated with a file.
+     */
+    if (!self.isDatabaseOpen)
+        return nil;
+    
+    NSMutableArray<GWMDatabaseItem*> *mutableDatabases = [NSMutableArray<GWMDatabaseItem*> new];
+    
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, "PRAGMA database_list;", -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                GWMDatabaseItem *dataItem = [GWMDatabaseItem new];
+                
+                char *schemaNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 1);
+                dataItem.name = [NSString stringWithUTF8String:schemaNameC];
+                
+                char *flieNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
+                dataItem.filename = [NSString stringWithUTF8String:flieNameC];
+                
+                [mutableDatabases addObject:dataItem];
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return [NSArray<GWMDatabaseItem*> arrayWithArray:mutableDatabases];
+}
+
+-(NSArray<GWMTableName>*)tablesWithSchema:(GWMSchemaName)schema
+{
+    if (!self.isDatabaseOpen)
+        return nil;
+    //char *sql = "SELECT name FROM sqlite_master WHERE type='table'";
+    NSMutableArray<GWMTableName> *mutableTables = [NSMutableArray<GWMTableName> new];
+    
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    schema = schema ? schema : @"main";
+    
+    NSString *statement = [NSString stringWithFormat:@"SELECT name FROM %@.sqlite_master WHERE type='table'",schema];
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                
+                char *tableNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
+                GWMTableName table = (GWMTableName)[NSString stringWithUTF8String:tableNameC];
+                
+                [mutableTables addObject:table];
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return [NSArray<GWMTableName> arrayWithArray:mutableTables];
+}
+
+-(NSArray<GWMColumnItem*>*)columnsWithTable:(GWMTableName)table
+{
+    /*
+     PRAGMA table_info(table-name)
+     */
+    NSString *statement = nil;
+    
+    if(table)
+        statement = [NSString stringWithFormat:@"PRAGMA table_info(%@);",table];
+    else
+        return @[];
+    
+    NSMutableArray *mutableColumns = [NSMutableArray new];
+    
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                GWMColumnItem *columnItem = [GWMColumnItem new];
+                
+                int columnId = sqlite3_column_int(sqlite3PreparedStatement, 0);
+                columnItem.columnId = columnId;
+                
+                char *columnNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 1);
+                columnItem.name = [NSString stringWithUTF8String:columnNameC];
+                
+                char *fileNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
+                columnItem.affinity = [NSString stringWithUTF8String:fileNameC];
+                
+                int notNull = sqlite3_column_int(sqlite3PreparedStatement, 3);
+                columnItem.notNull = [NSNumber numberWithBool:notNull].boolValue;
+                
+                char *defaultValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 4);
+                columnItem.defaultValue = defaultValueC ? [NSString stringWithUTF8String:defaultValueC] : nil;
+                
+                int primaryKeyIndex = sqlite3_column_int(sqlite3PreparedStatement, 5);
+                columnItem.primaryKeyIndex = primaryKeyIndex;
+                
+                [mutableColumns addObject:columnItem];
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return [NSArray arrayWithArray:mutableColumns];
+}
+
+-(BOOL)foreignKeysEnabled
+{
+    /*
+    PRAGMA foreign_keys;
+     */
+    
+    BOOL isEnabled = NO;
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, "PRAGMA foreign_keys;", -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                NSInteger enabled = sqlite3_column_int(sqlite3PreparedStatement, 0);
+                isEnabled = enabled != 0;
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return isEnabled;
+}
+
+-(void)setForeignKeysEnabled:(BOOL)foreignKeysEnabled
+{
+    // PRAGMA foreign_keys = boolean;
+    NSString *statement = nil;
+    
+    if(foreignKeysEnabled)
+        statement = [NSString stringWithFormat:@"PRAGMA foreign_keys = ON"];
+    else
+        statement = [NSString stringWithFormat:@"PRAGMA foreign_keys = OFF"];
+    
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                NSInteger enabled = sqlite3_column_int(sqlite3PreparedStatement, 0);
+//                isEnabled = enabled != 0;
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+}
+
+#pragma mark - Maintenance
+
+-(void)vacuum:(GWMSchemaName)schema
+{
+    // VACUUM
+    
+    NSString *statement = nil;
+    if(schema)
+        statement = [NSString stringWithFormat:@"VACUMM %@;",schema];
+    else
+        statement = @"VACUUM;";
+    
+    @try {
+        [self processStatement:statement];
+    } @catch (NSException *exception) {
+        NSLog(@"%@",exception);
+    } @finally {
+        
+    }
+    
+}
+
+-(NSArray<NSString*>*)checkIntegrity:(GWMSchemaName)schema rows:(NSInteger)rowCount
+{
+    /*
+     PRAGMA schema.integrity_check;
+     PRAGMA schema.integrity_check(N);
+     
+     This pragma does an integrity check of the entire database. The integrity_check pragma looks for out-of-order records, missing pages, malformed records, missing index entries, and UNIQUE, CHECK, and NOT NULL constraint errors. If the integrity_check pragma finds problems, strings are returned (as multiple rows with a single column per row) which describe the problems. Pragma integrity_check will return at most N errors before the analysis quits, with N defaulting to 100. If pragma integrity_check finds no errors, a single row with the value 'ok' is returned.
+     
+     PRAGMA integrity_check does not find FOREIGN KEY errors. Use the PRAGMA foreign_key_check command for to find errors in FOREIGN KEY constraints.
+     
+     See also the PRAGMA quick_check command which does most of the checking of PRAGMA integrity_check but runs much faster.
+     */
+    if(!schema)
+        schema = GWMSchemaNameMain;
+    
+    NSString *statement;
+    
+    if (rowCount > 0) {
+        statement = [NSString stringWithFormat:@"PRAGMA %@.integrity_check(%li);",schema,rowCount];
+    } else {
+        statement = [NSString stringWithFormat:@"PRAGMA %@.integrity_check;",schema];
+    }
+    
+    NSMutableArray<NSString*> *mutableErrorStrings = [NSMutableArray<NSString*> new];
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                
+                char *schemaNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
+                NSString *message = [NSString stringWithUTF8String:schemaNameC];
+                
+                [mutableErrorStrings addObject:message];
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return [NSArray<NSString*> arrayWithArray:mutableErrorStrings];
+}
+
+-(NSArray<GWMForeignKeyIntegrityCheckItem*> *)checkForeignKeysIntegrity:(GWMSchemaName)schema table:(GWMTableName)table
+{
+    /*
+     PRAGMA schema.foreign_key_check;
+     PRAGMA schema.foreign_key_check(table-name);
+     
+     The foreign_key_check pragma checks the database, or the table called "table-name", for foreign key constraints that are violated and returns one row of output for each violation. There are four columns in each result row. The first column is the name of the table that contains the REFERENCES clause. The second column is the rowid of the row that contains the invalid REFERENCES clause, or NULL if the child table is a WITHOUT ROWID table. The third column is the name of the table that is referred to. The fourth column is the index of the specific foreign key constraint that failed. The fourth column in the output of the foreign_key_check pragma is the same integer as the first column in the output of the foreign_key_list pragma. When a "table-name" is specified, the only foreign key constraints checked are those created by REFERENCES clauses in the CREATE TABLE statement for table-name.
+     */
+    
+    NSMutableArray<GWMForeignKeyIntegrityCheckItem*> *mutableCheckItems = [NSMutableArray<GWMForeignKeyIntegrityCheckItem*> new];
+    
+    NSString *statement = nil;
+    
+    if(!schema)
+        schema = GWMSchemaNameMain;
+    
+    if(!table)
+        statement = [NSString stringWithFormat:@"PRAGMA %@.foreign_key_check",schema];
+    else
+        statement = [NSString stringWithFormat:@"PRAGMA %@.foreign_key_check(%@)",schema,table];
+    
+    static sqlite3_stmt *sqlite3PreparedStatement;
+    
+    int prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    if(prepareCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+    else {
+        int stepCode = GWMSQLiteResultRow;
+        while(stepCode == GWMSQLiteResultRow) {
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode == GWMSQLiteResultRow) {
+                GWMForeignKeyIntegrityCheckItem *checkItem = [GWMForeignKeyIntegrityCheckItem new];
+                
+                char *tableC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
+                checkItem.table = [NSString stringWithUTF8String:tableC];
+                
+                int rowID = sqlite3_column_int(sqlite3PreparedStatement, 1);
+                checkItem.rowID = rowID;
+                
+                char *referedTableC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 2);
+                checkItem.referredTable = [NSString stringWithUTF8String:referedTableC];
+                
+                int failedRowID = sqlite3_column_int(sqlite3PreparedStatement, 3);
+                checkItem.failedRowID = failedRowID;
+                
+                [mutableCheckItems addObject:checkItem];
+            }
+        }
+        if(stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+    }
+    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    if(finalizeCode != GWMSQLiteResultOK)
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+    
+    return [NSArray<GWMForeignKeyIntegrityCheckItem*> arrayWithArray:mutableCheckItems];
+}
+
+#pragma mark - Attach and Detach Database
+
+-(GWMDBOperationResult)attachDatabase:(GWMDatabaseFileName)databaseFileName schemaName:(GWMSchemaName)alias
+{
+    NSArray<GWMDatabaseItem*> *databases = self.databases;
+    
+    __block BOOL attached = NO;
+    [databases enumerateObjectsUsingBlock:^(GWMDatabaseItem *_Nonnull db, NSUInteger idx, BOOL *stop){
+        if ([db.name isEqualToString:alias]) {
+            attached = YES;
+            *stop = YES;
+        }
+    }];
+    if(attached){
+        NSLog(@"Database with alias '%@' already attached", alias);
+        return GWMDBOperationDatabaseAttached;
+    }
+    
+    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES);
+    NSString *documentPath = [paths firstObject];
+    
+    NSString *fullPath = [documentPath stringByAppendingPathComponent:databaseFileName];
+    NSString *statement = [NSString stringWithFormat:@"ATTACH DATABASE \'%@\' AS %@;", fullPath, alias];
+    char *errorMessageC;
+    
+    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    
+    if (executeCode != GWMSQLiteResultOK) {
+
+        NSLog(@"Error while attaching database '%@' (%@): '%s'", databaseFileName, alias, errorMessageC);
+        sqlite3_free(errorMessageC);
+        return GWMDBOperationDatabaseNotAttached;
+    }
+
+    [self applyConnectionConfigurationWithSchema:alias];
+
+    if (self.readerConnections) {
+        
+        NSString *journalStatement = [NSString stringWithFormat:@"PRAGMA %@.journal_mode=WAL;", alias];
+        sqlite3_exec(self.database, journalStatement.UTF8String, NULL, NULL, NULL);
+        
+        [self performWithAllReaderConnections:^(GWMDatabaseConnection *connection){
+            [connection executeStatement:statement];
+            [self applyConnectionConfigurationToReaderConnection:connection schema:alias];
+        }];
+    }
+    
+    NSLog(@"Successfully attached database: '%@' as '%@'", databaseFileName, alias);
+    return GWMDBOperationDatabaseAttached;
+}
+
+-(GWMDBOperationResult)detachDatabase:(GWMDatabaseAlias)databaseName
+{
+    if (self.isTransactionInProgress) {
+        NSLog(@"Can't detach database: %@ while transaction: '%@' is in progress", databaseName, self.transactionName);
+        return GWMDBOperationDatabaseNotDetached;
+    }
+    NSString *statement = [NSString stringWithFormat:@"DETACH DATABASE \'%@\';", databaseName];
+    char *errorMessageC;
+    
+    int result = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    
+    if (result != GWMSQLiteResultOK) {
+        NSLog(@"Error while detaching database: '%@' Message: '%s'", databaseName, errorMessageC);
+        sqlite3_free(errorMessageC);
+        return GWMDBOperationDatabaseNotDetached;
+    } else {
+        [self performWithAllReaderConnections:^(GWMDatabaseConnection *connection){
+            [connection executeStatement:statement];
+        }];
+        NSLog(@"Successfully detached database: '%@'", databaseName);
+        return GWMDBOperationDatabaseDetached;
+    }
+}
+
+#pragma mark - Open and close the Database; check if Database is open
+
+-(void)openDatabase
+{
+    // runs before every statement, so the preferences are only read while the database is closed
+    if (self.database != NULL)
+        return;
+    
+    NSString *mainDatabaseName = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_MainDatabaseName];
+    NSString *mainDatabaseExtension = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_MainDatabaseExtension];
+    NSString *userDatabaseName = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_UserDatabaseName];
+    NSString *userDatabaseAlias = [[NSUserDefaults standardUserDefaults] stringForKey:GWMPK_UserDatabaseAlias];
+    
+    if (mainDatabaseName && mainDatabaseExtension) {
+        GWMDBOperationResult openResult = [self openDatabase:mainDatabaseName extension:mainDatabaseExtension];
+        
+        if (openResult == GWMDBOperationDatabaseOpened && userDatabaseName && userDatabaseAlias)
+            [self attachDatabase:userDatabaseName schemaName:userDatabaseAlias];
+    }
+}
+
+-(GWMDBOperationResult)openDatabase:(NSString *)name extension:(NSString *)extension
+{
+    if ([self isDatabaseOpen])
+        return GWMDBOperationDatabaseOpened;
+    
+    NSString *path = [[NSBundle mainBundle] pathForResource:name ofType:extension];
+    
+    if (!path) {
+        NSLog(@"*** %@: '%@.%@' is not in the main bundle ***", GWMSQLiteErrorOpeningDatabase, name, extension);
+        return GWMDBOperationDatabaseNotOpened;
+    }
+    
+    return [self openDatabaseAtPath:path];
+}
+
+-(GWMDBOperationResult)openDatabaseAtPath:(NSString *)path
+{
+    if ([self isDatabaseOpen])
+        return GWMDBOperationDatabaseOpened;
+    
+    self.databasePath = path;
+    
+    sqlite3 *db = NULL;
+    
+//    sqlite3_shutdown();
+//    sqlite3_config(SQLITE_CONFIG_SERIALIZED);
+//    sqlite3_initialize();
+//    int openCode = sqlite3_open(self.databasePath.UTF8String, &db);
+    
+//    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_FULLMUTEX;
+    
+    self.openFlags = GWMDBOpenReadWrite | GWMDBOpenFullMutex;
+    int openCode = sqlite3_open_v2(self.databasePath.UTF8String, &db, self.openFlags, NULL);
+    
+    self.database = db;
+    
+    if (openCode != GWMSQLiteResultOK) {
+        NSLog(@"*** %@ at path: %@ with error: '%s' ***", GWMSQLiteErrorOpeningDatabase, self.databasePath, sqlite3_errmsg(self.database));
+        [self closeDatabase];
+        return GWMDBOperationDatabaseNotOpened;
+    }
+    
+    self.statementCache = [[GWMStatementCache alloc] initWithDatabase:db capacity:self.statementCacheCapacity];
+    // DELETE without a WHERE clause would otherwise empty a table without calling the update hook
+    self.statementCache.deletesRowsIndividually = YES;
+    
+    sqlite3_update_hook(db, GWMDatabaseUpdateHook, (__bridge void *)self);
+    sqlite3_rollback_hook(db, GWMDatabaseRollbackHook, (__bridge void *)self);
+    
+    if (self.profilingEnabled)
+        [self.statementProfiler attachToDatabase:db];
+    
+    [self applyConnectionConfigurationWithSchema:nil];
+    
+    [self openReaderConnections];
+    
+    os_log_debug(OS_LOG_DEFAULT, "SQLite version: %s library version: %s", SQLITE_VERSION, sqlite3_libversion());
+    
+    return GWMDBOperationDatabaseOpened;
+}
+
+-(GWMDBOperationResult)closeDatabase
+{
+    
+    if (![self isDatabaseOpen])
+        return GWMDBOperationDatabaseClosed;
+
+    if (self.isTransactionInProgress) {
+        NSLog(@"*** Can't close database because transaction: '%@' is in progress ***", self.transactionName);
+        return GWMDBOperationDatabaseNotClosed;
+    }
+
+    // writes waiting in the write-behind queue are committed before the connection goes away
+    [self.writeBatcher flush];
+    
+    NSArray<GWMDatabaseItem*> *databases = self.databases;
+    
+    [databases enumerateObjectsUsingBlock:^(GWMDatabaseItem *_Nonnull db, NSUInteger idx, BOOL *stop){
+        if(![db.name isEqualToString:GWMSchemaNameMain])
+            [self detachDatabase:db.name];
+    }];
+    
+    [self closeReaderConnections];
+    
+    // cached statements must be finalized before the connection can be closed
+    [self.statementCache removeAllStatements];
+    
+    int closeCode = sqlite3_close(self.database);
+    
+    if (closeCode != GWMSQLiteResultOK) {
+        NSLog(@"*** %@: Message:'%s' ***", GWMSQLiteErrorClosingDatabase, sqlite3_errmsg(self.database));
+        return GWMDBOperationDatabaseNotClosed;
+    }
+    self.database = NULL;
+    self.statementCache = nil;
+    [self clearIdentityMap];
+    [self clearResultCache];
+    
+    NSLog(@"*** Database was closed ***");
+    return GWMDBOperationDatabaseClosed;
+}
+
+-(BOOL)isDatabaseOpen
+{
+    return self.database != NULL;
+}
+
+#pragma mark -  Helper Methods
+
+-(NSDate *)dateWithFormat:(NSString *)dateFormat string:(NSString *)dateString andTimeZone:(NSTimeZone *)timeZone
+{
+    NSDate *resultDate;
+    
+    @synchronized (self.dateFormatter) {
+        [self.dateFormatter setDateFormat:dateFormat];// format for going from sqlite table to NSDate object
+        [self.dateFormatter setTimeZone:timeZone];
+        resultDate = [self.dateFormatter dateFromString:dateString];
+    }
+    
+    return resultDate;
+}
+
+-(NSString *)stringWithDate:(NSDate *)date
+{
+    // only used for dates that GWMDateTimeCStringWithDate cannot encode
+    @synchronized (self.dateFormatter) {
+        [self.dateFormatter setDateFormat:GWMDBDateFormatDateTime];
+        [self.dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
+        return [self.dateFormatter stringFromDate:date];
+    }
+}
+
+-(GWMBindValuesEnumerationBlock)bindValuesEnumerationBlockWithResult:(GWMDatabaseResult *)databaseResult preparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement
+{
+    sqlite3 *database = sqlite3_db_handle(sqlite3PreparedStatement);
+    
+    return ^(id _Nonnull value, NSUInteger idx, BOOL  * _Nonnull stop){
+        
+        int statementIdx = (int)idx + 1;
+        int bindCode = GWMSQLiteResultOK;
+        NSError *error = nil;
+        
+        if ([value isKindOfClass:[NSDate class]]) {
+            
+            NSDate *date = (NSDate*)value;
+            char dateStringC[GWMDateTimeCStringBufferLength];
+            if (GWMDateTimeCStringWithDate(date, dateStringC)) {
+                bindCode = sqlite3_bind_text(sqlite3PreparedStatement, statementIdx, dateStringC, GWMDBDateStringLengthDateTime, SQLITE_TRANSIENT);
+            } else {
+                NSString *string = [self stringWithDate:date];
+                bindCode = sqlite3_bind_text(sqlite3PreparedStatement, statementIdx, string.UTF8String, -1, SQLITE_TRANSIENT);
+            }
+            if (bindCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingNullValue,sqlite3_errmsg(database)];
+                databaseResult.resultCode = bindCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(bindCode)] = message;
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            }
+            
+        } else if ([value isKindOfClass:[NSNull class]]) {
+            
+            bindCode = sqlite3_bind_null(sqlite3PreparedStatement, statementIdx);
+            if (bindCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingNullValue,sqlite3_errmsg(database)];
+                databaseResult.resultCode = bindCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(bindCode)] = message;
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            }
+            
+        } else if ([value isKindOfClass:[NSString class]]) {
+            
+            NSString *string = (NSString*)value;
+            bindCode = sqlite3_bind_text(sqlite3PreparedStatement, statementIdx, string.UTF8String, -1, SQLITE_TRANSIENT);
+            if (bindCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingTextValue,sqlite3_errmsg(database)];
+                databaseResult.resultCode = bindCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(bindCode)] = message;
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            }
+            
+        } else if ([value isKindOfClass:[NSData class]]) {
+            
+            NSData *data = (NSData *)value;
+            // an empty NSData has no bytes and sqlite3_bind_blob would bind NULL
+            if (data.length == 0)
+                bindCode = sqlite3_bind_zeroblob(sqlite3PreparedStatement, statementIdx, 0);
+            else
+                bindCode = sqlite3_bind_blob64(sqlite3PreparedStatement, statementIdx, data.bytes, (sqlite3_uint64)data.length, SQLITE_TRANSIENT);
+            if (bindCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingBlobValue,sqlite3_errmsg(database)];
+                databaseResult.resultCode = bindCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(bindCode)] = message;
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            }
+            
+        } else if ([value isKindOfClass:[NSNumber class]]){
+            // the type encoding of the number, unsigned values are bound as the next larger signed type
+            NSNumber *numberNS = (NSNumber *)value;
+            switch ([numberNS objCType][0]) {
+                case 'f':
+                {
+                    float numberF = [numberNS floatValue];
+                    bindCode = sqlite3_bind_double(sqlite3PreparedStatement, statementIdx, numberF);
+                    if (bindCode != GWMSQLiteResultOK) {
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingDoubleValue,sqlite3_errmsg(database)];
+                        databaseResult.resultCode = bindCode;
+                        databaseResult.resultMessage = message;
+                        databaseResult.errors[@(bindCode)] = message;
                         NSLog(@"*** %@ ***", message);
                         NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
                         error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
                     }
                     break;
                 }
-                case kCFNumberDoubleType:
+                case 'd':
                 {
                     double numberD = [numberNS doubleValue];
                     bindCode = sqlite3_bind_double(sqlite3PreparedStatement, (statementIdx), numberD);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingDoubleValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingDoubleValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -849,12 +1775,13 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberCharType:
+                case 'c':
+                case 'B':
                 {
                     char numberC = [numberNS charValue];
                     bindCode = sqlite3_bind_int(sqlite3PreparedStatement, (statementIdx), numberC);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -864,15 +1791,14 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberIntType:
-                case kCFNumberSInt8Type:
-                case kCFNumberSInt16Type:
-                case kCFNumberSInt32Type:
+                case 'i':
+                case 'C':
+                case 'S':
                 {
                     int numberI = [numberNS intValue];
                     bindCode = sqlite3_bind_int(sqlite3PreparedStatement, (statementIdx), numberI);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -882,42 +1808,12 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberShortType:
+                case 's':
                 {
                     short numberI = [numberNS shortValue];
                     bindCode = sqlite3_bind_int(sqlite3PreparedStatement, (statementIdx), numberI);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
-                        databaseResult.resultCode = bindCode;
-                        databaseResult.resultMessage = message;
-                        databaseResult.errors[@(bindCode)] = message;
-                        NSLog(@"*** %@ ***", message);
-                        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                        error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-                    }
-                    break;
-                }
-                case kCFNumberSInt64Type:
-                {
-                    SInt64 numberI = [numberNS integerValue];
-                    bindCode = sqlite3_bind_int64(sqlite3PreparedStatement, (statementIdx), numberI);
-                    if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
-                        databaseResult.resultCode = bindCode;
-                        databaseResult.resultMessage = message;
-                        databaseResult.errors[@(bindCode)] = message;
-                        NSLog(@"*** %@ ***", message);
-                        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                        error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-                    }
-                    break;
-                }
-                case kCFNumberNSIntegerType:
-                {
-                    NSInteger numberI = [numberNS integerValue];
-                    bindCode = sqlite3_bind_int64(sqlite3PreparedStatement, (statementIdx), numberI);
-                    if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -927,12 +1823,12 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberLongType:
+                case 'l':
                 {
                     long numberL = [numberNS longValue];
                     bindCode = sqlite3_bind_int64(sqlite3PreparedStatement, (statementIdx), numberL);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -942,12 +1838,15 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberLongLongType:
+                case 'q':
+                case 'I':
+                case 'L':
+                case 'Q':
                 {
                     long long numberLL = [numberNS longLongValue];
                     bindCode = sqlite3_bind_int64(sqlite3PreparedStatement, (statementIdx), numberLL);
                     if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
+                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(database)];
                         databaseResult.resultCode = bindCode;
                         databaseResult.resultMessage = message;
                         databaseResult.errors[@(bindCode)] = message;
@@ -957,585 +1856,1446 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
                     }
                     break;
                 }
-                case kCFNumberCFIndexType:
-                {
-                    int numberI = [numberNS intValue];
-                    bindCode = sqlite3_bind_int64(sqlite3PreparedStatement, (statementIdx), numberI);
-                    if (bindCode != GWMSQLiteResultOK) {
-                        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorBindingIntegerValue,sqlite3_errmsg(self.database)];
-                        databaseResult.resultCode = bindCode;
-                        databaseResult.resultMessage = message;
-                        databaseResult.errors[@(bindCode)] = message;
-                        NSLog(@"*** %@ ***", message);
-                        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-                        error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-                    }
+                default:
                     break;
+            }
+        }
+    };
+}
+
+-(void)processStatement:(NSString *_Nonnull)statement
+{
+    [self performWrite:^{
+        char *errorMessageC;
+        int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    //    NSError *error = nil;
+        if (executeCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: Message: %s Database: '%@'", GWMSQLiteErrorExecutingStatement, errorMessageC, self.databasePath];
+            NSLog(@"%@", message);
+            sqlite3_free(errorMessageC);
+            NSDictionary *info = @{GWMDBStatementKey:statement};
+    //        error = [NSError errorWithDomain:@"GWMKit" code:<#(NSInteger)#> userInfo:info];
+            NSException *exception = [NSException exceptionWithName:GWMExecutingStatementException reason:message userInfo:info];
+            @throw exception;
+        }
+    //    return error;
+    }];
+}
+
+-(NSString *)stringWithConflict:(GWMDBOnConflict)conflict
+{
+    switch (conflict) {
+        case GWMDBOnConflictRollback:
+            return @"OR ROLLBACK";
+            break;
+        case GWMDBOnConflictAbort:
+            return @"OR ABORT";
+            break;
+        case GWMDBOnConflictFail:
+            return @"OR FAIL";
+            break;
+        case GWMDBOnConflictIgnore:
+            return @"OR IGNORE";
+            break;
+        case GWMDBOnConflictReplace:
+            return @"OR REPLACE";
+            break;
+        default:
+            return @"OR ABORT";
+            break;
+    }
+}
+
+#pragma mark - DDL Database Operations
+
+#pragma mark Tables
+-(void)createTableWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    Class<GWMDataItem> class = NSClassFromString(className);
+    
+    NSArray<GWMColumnDefinition*> *tableColumnDefinitions = [class columnDefinitionItems];
+    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:NSStringFromSelector(@selector(sequence)) ascending:YES];
+//    NSArray<GWMColumnDefinition*> *sortedColumns = [tableColumnDefinitions sortedArrayUsingSelector:@selector(sequence)];
+    NSArray<GWMColumnDefinition*> *sortedColumns = [tableColumnDefinitions sortedArrayUsingDescriptors:@[sortDescriptor]];
+    
+    NSArray *constraintDefs = [class constraintDefinitionItems];
+    NSString *table = self.classToTableMapping[className];
+    
+    if ([class searchableColumns].count == 0) {
+        [self createTable:table columns:sortedColumns constraints:constraintDefs schema:schema completion:completion];
+        return;
+    }
+    
+    __block NSError *tableError = nil;
+    [self createTable:table columns:sortedColumns constraints:constraintDefs schema:schema completion:^(NSError *_Nullable error){
+        tableError = error;
+    }];
+    
+    if (tableError) {
+        if (completion)
+            completion(tableError);
+        return;
+    }
+    
+    [self createSearchIndexWithClassName:className schema:schema completion:completion];
+}
+
+-(void)createTable:(GWMTableName)tableName columns:(nonnull NSArray<GWMColumnDefinition *> *)columnDefinitions constraints:(NSArray<GWMTableConstraintDefinition*>*)constraintDefinitions schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion
+{
+    NSMutableArray<NSString*> *mutableTableColumnDefinitions = [NSMutableArray new];
+    
+    [columnDefinitions enumerateObjectsUsingBlock:^(GWMColumnDefinition *_Nonnull definition, NSUInteger idx, BOOL *_Nonnull stop){
+        if (definition.createString)
+            [mutableTableColumnDefinitions addObject:definition.createString];
+    }];
+    
+    NSString *columnDefString = [mutableTableColumnDefinitions componentsJoinedByString:@", "];
+    
+    NSString *constraintDefString = nil;
+    if(constraintDefinitions){
+        NSMutableArray *mutableConstraintDefs = [NSMutableArray new];
+        [constraintDefinitions enumerateObjectsUsingBlock:^(GWMTableConstraintDefinition *_Nullable def, NSUInteger idx, BOOL *stop){
+            [mutableConstraintDefs addObject:def.body];
+        }];
+        constraintDefString = [mutableConstraintDefs componentsJoinedByString:@", "];
+    }
+    
+    NSString *statement = nil;
+    if(constraintDefString)
+        statement = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@.%@ (%@, %@)", schema, tableName, columnDefString, constraintDefString];
+    else
+        statement = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@.%@ (%@)", schema, tableName, columnDefString];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)dropTableWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *table = self.classToTableMapping[className];
+    
+    [self dropTable:table schema:schema completion:completion];
+}
+
+-(void)dropTable:(NSString *)tableName schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion
+{
+    NSString *statement = nil;
+    if(schema)
+        statement = [NSString stringWithFormat:@"DROP TABLE IF EXISTS %@.%@", schema, tableName];
+    else
+        statement = [NSString stringWithFormat:@"DROP TABLE IF EXISTS %@", tableName];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)renameTable:(GWMTableName)oldName newName:(GWMTableName)newName schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *alias = schema ? schema : GWMSchemaNameMain;
+    
+    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ RENAME TO %@", alias, oldName, newName];
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+    
+}
+
+-(void)renameColumn:(GWMColumnName)oldName newName:(GWMColumnName)newName table:(GWMTableName)table schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *alias = schema ? schema : GWMSchemaNameMain;
+    
+    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ RENAME COLUMN %@ TO %@", alias, table, oldName, newName];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)addColumn:(GWMColumnDefinition *)columnDefinition toTable:(GWMTableName)table schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *alias = schema ? schema : GWMSchemaNameMain;
+    
+    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ ADD COLUMN %@", alias, table, [columnDefinition createString]];
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+#pragma mark Indexes
+
+-(void)createIndex:(GWMIndexDefinition *)indexDefinition completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSError *error = nil;
+    @try {
+        [self processStatement:indexDefinition.indexCreationString];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)dropIndex:(GWMIndexName)index schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *statement = nil;
+    
+    if(schema)
+        statement = [NSString stringWithFormat:@"DROP INDEX IF EXISTS %@.%@", schema, index];
+    else
+        statement = [NSString stringWithFormat:@"DROP INDEX IF EXISTS %@", index];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+#pragma mark Triggers
+
+-(void)createTrigger:(GWMTriggerDefinition *)triggerDefinition completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:triggerDefinition.triggerString];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+    
+}
+
+-(void)dropTrigger:(GWMTriggerName)trigger schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    NSString *statement = nil;
+    
+    if(schema)
+        statement = [NSString stringWithFormat:@"DROP TRIGGER IF EXISTS %@.%@", schema, trigger];
+    else
+        statement = [NSString stringWithFormat:@"DROP TRIGGER IF EXISTS %@", trigger];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+#pragma mark Search Indexes
+
+-(GWMTableName)searchIndexTableWithTable:(GWMTableName)table
+{
+    return [NSString stringWithFormat:@"%@_fts", table];
+}
+
+-(NSError *)searchIndexErrorWithClassName:(NSString *)className
+{
+    NSString *message = [NSString stringWithFormat:@"%@ has no table, primary key column or searchable columns", className];
+    NSLog(@"*** %@ ***", message);
+    return [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+}
+
+-(void)createSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    Class itemClass = NSClassFromString(className);
+    NSArray<GWMColumnName> *columns = [itemClass searchableColumns];
+    GWMTableName table = self.classToTableMapping[className];
+    GWMColumnName primaryKeyColumn = itemClass ? [GWMClassMetadata metadataForClass:itemClass].primaryKeyColumn : nil;
+    
+    if (!table || !primaryKeyColumn || columns.count == 0) {
+        NSError *error = [self searchIndexErrorWithClassName:className];
+        if (completion)
+            completion(error);
+        return;
+    }
+    
+    GWMTableName searchTable = [self searchIndexTableWithTable:table];
+    NSString *qualifiedSearchTable = schema ? [NSString stringWithFormat:@"%@.%@", schema, searchTable] : searchTable;
+    NSString *columnList = [columns componentsJoinedByString:@", "];
+    
+    NSMutableArray<NSString*> *mutableNewValues = [NSMutableArray<NSString*> new];
+    NSMutableArray<NSString*> *mutableOldValues = [NSMutableArray<NSString*> new];
+    for (GWMColumnName column in columns) {
+        [mutableNewValues addObject:[NSString stringWithFormat:@"new.%@", column]];
+        [mutableOldValues addObject:[NSString stringWithFormat:@"old.%@", column]];
+    }
+    
+    // external content: the index keeps only the terms and reads the text back from the table
+    NSString *createStatement = [NSString stringWithFormat:@"CREATE VIRTUAL TABLE IF NOT EXISTS %@ USING fts5(%@, content='%@', content_rowid='%@')", qualifiedSearchTable, columnList, table, primaryKeyColumn];
+    
+    // statements inside a trigger cannot name a schema, they use the schema of the trigger
+    NSString *insertBody = [NSString stringWithFormat:@"INSERT INTO %@ (rowid, %@) VALUES (new.%@, %@);", searchTable, columnList, primaryKeyColumn, [mutableNewValues componentsJoinedByString:@", "]];
+    NSString *deleteBody = [NSString stringWithFormat:@"INSERT INTO %@ (%@, rowid, %@) VALUES ('delete', old.%@, %@);", searchTable, searchTable, columnList, primaryKeyColumn, [mutableOldValues componentsJoinedByString:@", "]];
+    
+    NSMutableArray<GWMColumnName> *updateColumns = [NSMutableArray<GWMColumnName> arrayWithObject:primaryKeyColumn];
+    [updateColumns addObjectsFromArray:columns];
+    
+    NSArray<GWMTriggerDefinition*> *triggers = @[[GWMTriggerDefinition triggerDefinitionWithName:[NSString stringWithFormat:@"%@_insert", searchTable] schema:schema table:table timing:GWMTriggerAfter style:GWMTriggerInsert when:nil columns:@[] body:insertBody],
+                                                 [GWMTriggerDefinition triggerDefinitionWithName:[NSString stringWithFormat:@"%@_delete", searchTable] schema:schema table:table timing:GWMTriggerAfter style:GWMTriggerDelete when:nil columns:@[] body:deleteBody],
+                                                 [GWMTriggerDefinition triggerDefinitionWithName:[NSString stringWithFormat:@"%@_update", searchTable] schema:schema table:table timing:GWMTriggerAfter style:GWMTriggerUpdate when:nil columns:updateColumns body:[NSString stringWithFormat:@"%@ %@", deleteBody, insertBody]]];
+    
+    // the rebuild indexes the rows the table already has
+    NSString *rebuildStatement = [NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES ('rebuild')", qualifiedSearchTable, searchTable];
+    
+    __block NSError *error = nil;
+    NSError *transactionError = nil;
+    
+    @try {
+        [self performTransaction:^(GWMTransaction *transaction){
+            [self processStatement:createStatement];
+            for (GWMTriggerDefinition *trigger in triggers) {
+                [self createTrigger:trigger completion:^(NSError *_Nullable triggerError){
+                    if (triggerError && !error)
+                        error = triggerError;
+                }];
+                if (error) {
+                    [transaction rollbackWithError:error];
+                    return;
                 }
-                default:
-                    break;
             }
+            [self processStatement:rebuildStatement];
+        } error:&transactionError];
+        // a failed statement or COMMIT rolls the whole index back
+        if (!error)
+            error = transactionError;
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)dropSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    GWMTableName table = self.classToTableMapping[className];
+    
+    if (!table) {
+        NSError *error = [self searchIndexErrorWithClassName:className];
+        if (completion)
+            completion(error);
+        return;
+    }
+    
+    GWMTableName searchTable = [self searchIndexTableWithTable:table];
+    NSString *qualifiedSearchTable = schema ? [NSString stringWithFormat:@"%@.%@", schema, searchTable] : searchTable;
+    
+    NSMutableArray<NSString*> *mutableStatements = [NSMutableArray<NSString*> new];
+    for (NSString *suffix in @[@"_insert", @"_delete", @"_update"])
+        [mutableStatements addObject:[NSString stringWithFormat:@"DROP TRIGGER IF EXISTS %@%@", qualifiedSearchTable, suffix]];
+    [mutableStatements addObject:[NSString stringWithFormat:@"DROP TABLE IF EXISTS %@", qualifiedSearchTable]];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self performTransaction:^(GWMTransaction *transaction){
+            for (NSString *statement in mutableStatements)
+                [self processStatement:statement];
+        } error:&error];
+        [self didChangeSchema];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)runSearchIndexCommand:(NSString *)command className:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    GWMTableName table = self.classToTableMapping[className];
+    
+    if (!table) {
+        NSError *error = [self searchIndexErrorWithClassName:className];
+        if (completion)
+            completion(error);
+        return;
+    }
+    
+    GWMTableName searchTable = [self searchIndexTableWithTable:table];
+    NSString *qualifiedSearchTable = schema ? [NSString stringWithFormat:@"%@.%@", schema, searchTable] : searchTable;
+    NSString *statement = [NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES ('%@')", qualifiedSearchTable, searchTable, command];
+    
+    NSError *error = nil;
+    
+    @try {
+        [self processStatement:statement];
+        // the update hook does not report virtual tables, so cached searches are dropped here
+        [self.resultCache removeDataReadingTable:[NSString stringWithFormat:@"%@.%@", schema ?: GWMSchemaNameMain, searchTable]];
+    } @catch (NSException *exception) {
+        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
+    } @finally {
+        if(completion)
+            completion(error);
+    }
+}
+
+-(void)rebuildSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    [self runSearchIndexCommand:@"rebuild" className:className schema:schema completion:completion];
+}
+
+-(void)optimizeSearchIndexWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+{
+    [self runSearchIndexCommand:@"optimize" className:className schema:schema completion:completion];
+}
+
+#pragma mark - CRUD Database Operations
+
+#pragma mark Create
+
+-(void)insertIntoTable:(GWMTableName)table newValues:(NSArray<NSDictionary<GWMColumnName,id> *> *)valuesToInsert completion:(GWMDatabaseResultBlock)completionHandler
+{
+    [self performWrite:^{
+        
+        __block NSError *firstError = nil;
+        
+        [self insertIntoTable:table rows:valuesToInsert chunkSize:0 completion:^(NSUInteger insertedCount, NSDictionary<NSNumber*,NSError*> *rowErrors, NSError *error){
+            
+            firstError = error;
+            
+            if (!firstError && rowErrors.count > 0) {
+                NSNumber *firstIndex = [rowErrors.allKeys sortedArrayUsingSelector:@selector(compare:)].firstObject;
+                firstError = rowErrors[firstIndex];
+            }
+        }];
+        
+        if (firstError) {
+            if (completionHandler)
+                completionHandler(nil,firstError);
+            return;
         }
-    };
+        
+        GWMDataItem *obj = [GWMDataItem dataItemWithItemID:(NSInteger)sqlite3_last_insert_rowid(self.database)];
+        
+        if (completionHandler)
+            completionHandler(obj,nil);
+    }];
 }
 
--(void)processStatement:(NSString *_Nonnull)statement
+-(void)insertIntoTable:(GWMTableName)table rows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkInsertCompletionBlock)completion
 {
-    char *errorMessageC;
-    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
-//    NSError *error = nil;
-    if (executeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: Message: %s Database: '%@'", GWMSQLiteErrorExecutingStatement, errorMessageC, self.databasePath];
-        NSLog(@"%@", message);
-        sqlite3_free(errorMessageC);
-        NSDictionary *info = @{GWMDBStatementKey:statement};
-//        error = [NSError errorWithDomain:@"GWMKit" code:<#(NSInteger)#> userInfo:info];
-        NSException *exception = [NSException exceptionWithName:GWMExecutingStatementException reason:message userInfo:info];
-        @throw exception;
+    [self performWrite:^{
+        
+        NSMutableArray<NSNumber*> *mutableItemIDs = [NSMutableArray<NSNumber*> new];
+        NSMutableDictionary<NSNumber*,NSError*> *mutableRowErrors = [NSMutableDictionary<NSNumber*,NSError*> new];
+        NSError *error = nil;
+        
+        NSUInteger insertedCount = [self writeRows:rows toTable:table conflictColumns:nil returningColumn:nil chunkSize:chunkSize itemIDs:mutableItemIDs rowErrors:mutableRowErrors error:&error];
+        
+        if (completion)
+            completion(insertedCount, mutableRowErrors.count > 0 ? [NSDictionary dictionaryWithDictionary:mutableRowErrors] : nil, error);
+    }];
+}
+
+-(GWMDatabaseResult *)upsertIntoTable:(GWMTableName)table rows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkUpsertCompletionBlock)completion
+{
+    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+    
+    if (sqlite3_libversion_number() < GWMSQLiteUpsertReturningMinimumVersion) {
+        NSString *message = [NSString stringWithFormat:@"%@: SQLite %@ does not support UPSERT ... RETURNING", GWMSQLiteErrorPreparingStatement, [self sqliteVersion]];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        return databaseResult;
+    }
+    
+    // sqlite3_last_insert_rowid is not changed by the DO UPDATE of an upsert
+    if (!returningColumn) {
+        NSString *message = [NSString stringWithFormat:@"%@: an upsert needs a returning column to report the key of an updated record", GWMSQLiteErrorPreparingStatement];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        return databaseResult;
     }
-//    return error;
+    
+    [self performWrite:^{
+        
+        // make sure the table can be upserted before writing anything
+        if (rows.count > 0) {
+            NSArray<GWMColumnName> *columns = [rows.firstObject.allKeys sortedArrayUsingSelector:@selector(compare:)];
+            NSString *upsertStatement = [self insertStatementWithTable:table columns:columns conflictColumns:conflictColumns returningColumn:returningColumn];
+            databaseResult.statement = upsertStatement;
+            
+            int prepareCode = GWMSQLiteResultOK;
+            sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:upsertStatement code:&prepareCode];
+            
+            if (prepareCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),upsertStatement];
+                databaseResult.resultCode = prepareCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(prepareCode)] = message;
+                [self relinquishPreparedStatement:sqlite3PreparedStatement];
+                return;
+            }
+            
+            // the statement stays in the cache for writeRows
+            [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        }
+        
+        NSMutableArray<NSNumber*> *mutableItemIDs = [NSMutableArray<NSNumber*> new];
+        NSMutableDictionary<NSNumber*,NSError*> *mutableRowErrors = [NSMutableDictionary<NSNumber*,NSError*> new];
+        NSError *error = nil;
+        
+        [self writeRows:rows toTable:table conflictColumns:conflictColumns returningColumn:returningColumn chunkSize:chunkSize itemIDs:mutableItemIDs rowErrors:mutableRowErrors error:&error];
+        
+        if (completion)
+            completion([NSArray arrayWithArray:mutableItemIDs], mutableRowErrors.count > 0 ? [NSDictionary dictionaryWithDictionary:mutableRowErrors] : nil, error);
+    }];
+    
+    return databaseResult;
 }
 
--(NSString *)stringWithConflict:(GWMDBOnConflict)conflict
+-(NSString *)insertStatementWithTable:(GWMTableName)table columns:(NSArray<GWMColumnName> *)columns conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn
 {
-    switch (conflict) {
-        case GWMDBOnConflictRollback:
-            return @"OR ROLLBACK";
-            break;
-        case GWMDBOnConflictAbort:
-            return @"OR ABORT";
-            break;
-        case GWMDBOnConflictFail:
-            return @"OR FAIL";
-            break;
-        case GWMDBOnConflictIgnore:
-            return @"OR IGNORE";
-            break;
-        case GWMDBOnConflictReplace:
-            return @"OR REPLACE";
-            break;
-        default:
-            return @"OR ABORT";
-            break;
+    if (columns.count == 0)
+        return [NSString stringWithFormat:@"INSERT INTO %@ DEFAULT VALUES", table];
+    
+    NSMutableArray<NSString*> *mutableValuePlaceholders = [NSMutableArray<NSString*> new];
+    NSMutableArray<NSString*> *mutableAssignments = [NSMutableArray<NSString*> new];
+    [columns enumerateObjectsUsingBlock:^(GWMColumnName _Nonnull column, NSUInteger idx, BOOL *stop){
+        [mutableValuePlaceholders addObject:@"?"];
+        if (![conflictColumns containsObject:column])
+            [mutableAssignments addObject:[NSString stringWithFormat:@"%@ = excluded.%@", column, column]];
+    }];
+    
+    NSString *insertStatement = [NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES (%@)", table, [columns componentsJoinedByString:@","], [mutableValuePlaceholders componentsJoinedByString:@","]];
+    
+    if (conflictColumns.count == 0)
+        return insertStatement;
+    
+    // DO NOTHING would not return the existing row
+    if (mutableAssignments.count == 0)
+        [mutableAssignments addObject:[NSString stringWithFormat:@"%@ = excluded.%@", conflictColumns.firstObject, conflictColumns.firstObject]];
+    
+    NSString *upsertStatement = [NSString stringWithFormat:@"%@ ON CONFLICT (%@) DO UPDATE SET %@", insertStatement, [conflictColumns componentsJoinedByString:@","], [mutableAssignments componentsJoinedByString:@", "]];
+    
+    if (returningColumn)
+        upsertStatement = [upsertStatement stringByAppendingFormat:@" RETURNING %@", returningColumn];
+    
+    return upsertStatement;
+}
+
+-(void)resetItemIDs:(NSMutableArray<NSNumber*> *)itemIDs range:(NSRange)range
+{
+    for (NSUInteger idx = range.location; idx < NSMaxRange(range) && idx < itemIDs.count; idx++)
+        itemIDs[idx] = @(kGWMNewRecordValue);
+}
+
+-(NSUInteger)writeRows:(NSArray<NSDictionary<GWMColumnName,id> *> *)rows toTable:(GWMTableName)table conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn chunkSize:(NSUInteger)chunkSize itemIDs:(NSMutableArray<NSNumber*> *)itemIDs rowErrors:(NSMutableDictionary<NSNumber*,NSError*> *)rowErrors error:(NSError **)error
+{
+    NSUInteger writtenCount = 0;
+    NSUInteger chunkCount = 0;
+    
+    // one prepared statement for every distinct set of columns
+    NSMutableDictionary<NSArray<GWMColumnName>*,NSValue*> *mutableStatements = [NSMutableDictionary new];
+    NSMutableDictionary<NSArray<GWMColumnName>*,GWMDatabaseResult*> *mutableBindResults = [NSMutableDictionary new];
+    NSMutableDictionary<NSArray<GWMColumnName>*,GWMBindValuesEnumerationBlock> *mutableBindBlocks = [NSMutableDictionary new];
+    NSMutableDictionary<NSArray<GWMColumnName>*,NSError*> *mutablePrepareErrors = [NSMutableDictionary new];
+    
+    // join a transaction that is already open, otherwise commit in chunks
+    BOOL ownsTransaction = sqlite3_get_autocommit(self.database) != 0;
+    if (ownsTransaction) {
+        int beginCode = sqlite3_exec(self.database, "BEGIN IMMEDIATE TRANSACTION", NULL, NULL, NULL);
+        // without the transaction every row would be committed on its own
+        if (beginCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database)];
+            NSLog(@"*** %@ ***", message);
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            if (error)
+                *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            for (NSUInteger idx = 0; idx < rows.count; idx++)
+                [itemIDs addObject:@(kGWMNewRecordValue)];
+            return 0;
+        }
+    }
+    
+    // the first row of the chunk that has not been committed yet
+    NSUInteger chunkStart = 0;
+    
+    for (NSUInteger idx = 0; idx < rows.count; idx++) {
+        
+        @autoreleasepool {
+            
+            [itemIDs addObject:@(kGWMNewRecordValue)];
+            
+            NSDictionary<GWMColumnName,id> *row = rows[idx];
+            NSArray<GWMColumnName> *columns = [row.allKeys sortedArrayUsingSelector:@selector(compare:)];
+            
+            sqlite3_stmt *sqlite3PreparedStatement = [mutableStatements[columns] pointerValue];
+            
+            if (mutablePrepareErrors[columns]) {
+                rowErrors[@(idx)] = mutablePrepareErrors[columns];
+                continue;
+            }
+            
+            if (!sqlite3PreparedStatement) {
+                
+                NSString *insertStatement = [self insertStatementWithTable:table columns:columns conflictColumns:conflictColumns returningColumn:returningColumn];
+                
+                int prepareCode = GWMSQLiteResultOK;
+                sqlite3PreparedStatement = [self preparedStatementWithString:insertStatement code:&prepareCode];
+                
+                if (prepareCode != GWMSQLiteResultOK) {
+                    NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),insertStatement];
+                    NSLog(@"*** %@ ***", message);
+                    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                    mutablePrepareErrors[columns] = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                    rowErrors[@(idx)] = mutablePrepareErrors[columns];
+                    [self relinquishPreparedStatement:sqlite3PreparedStatement];
+                    continue;
+                }
+                
+                GWMDatabaseResult *bindResult = [GWMDatabaseResult new];
+                mutableStatements[columns] = [NSValue valueWithPointer:sqlite3PreparedStatement];
+                mutableBindResults[columns] = bindResult;
+                mutableBindBlocks[columns] = [self bindValuesEnumerationBlockWithResult:bindResult preparedStatement:sqlite3PreparedStatement];
+            }
+            
+            // bind values
+            GWMDatabaseResult *bindResult = mutableBindResults[columns];
+            NSArray *values = [row objectsForKeys:columns notFoundMarker:[NSNull null]];
+            [values enumerateObjectsUsingBlock:mutableBindBlocks[columns]];
+            
+            int stepCode = GWMSQLiteResultDone;
+            sqlite3_int64 itemID = kGWMNewRecordValue;
+            
+            if (bindResult.resultCode == GWMSQLiteResultOK) {
+                stepCode = sqlite3_step(sqlite3PreparedStatement);
+                
+                // the RETURNING row of an upsert, the row is written by the first step
+                if (stepCode == GWMSQLiteResultRow) {
+                    itemID = sqlite3_column_int64(sqlite3PreparedStatement, 0);
+                    while (stepCode == GWMSQLiteResultRow)
+                        stepCode = sqlite3_step(sqlite3PreparedStatement);
+                } else if (stepCode == GWMSQLiteResultDone && conflictColumns.count == 0) {
+                    // after a DO UPDATE the last insert rowid belongs to an earlier insert, upserts report the RETURNING row
+                    itemID = sqlite3_last_insert_rowid(self.database);
+                }
+            }
+            
+            if (bindResult.resultCode != GWMSQLiteResultOK) {
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:bindResult.resultMessage ?: GWMSQLiteErrorBindingTextValue};
+                rowErrors[@(idx)] = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                bindResult.resultCode = GWMSQLiteResultOK;
+            } else if (stepCode != GWMSQLiteResultDone) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                rowErrors[@(idx)] = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            } else {
+                itemIDs[idx] = @(itemID);
+                writtenCount++;
+                chunkCount++;
+            }
+            
+            sqlite3_reset(sqlite3PreparedStatement);
+            sqlite3_clear_bindings(sqlite3PreparedStatement);
+            
+            // errors such as SQLITE_FULL roll back the whole transaction, not just the row
+            if (ownsTransaction && sqlite3_get_autocommit(self.database)) {
+                writtenCount -= chunkCount;
+                [self resetItemIDs:itemIDs range:NSMakeRange(chunkStart, idx + 1 - chunkStart)];
+                NSString *message = [NSString stringWithFormat:@"%@: the transaction was rolled back after row %lu, %lu rows were not committed", GWMSQLiteErrorExecutingStatement, (unsigned long)idx, (unsigned long)chunkCount];
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                if (error)
+                    *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                ownsTransaction = NO;
+                break;
+            }
+            
+            if (ownsTransaction && chunkSize > 0 && chunkCount >= chunkSize) {
+                
+                int commitCode = sqlite3_exec(self.database, "COMMIT TRANSACTION", NULL, NULL, NULL);
+                
+                // the rows of a chunk that was not committed are not counted
+                if (commitCode != GWMSQLiteResultOK) {
+                    NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database)];
+                    NSLog(@"*** %@ ***", message);
+                    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                    if (error)
+                        *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                    writtenCount -= chunkCount;
+                    [self resetItemIDs:itemIDs range:NSMakeRange(chunkStart, idx + 1 - chunkStart)];
+                    if (!sqlite3_get_autocommit(self.database))
+                        sqlite3_exec(self.database, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+                    ownsTransaction = NO;
+                    break;
+                }
+                
+                chunkCount = 0;
+                chunkStart = idx + 1;
+                
+                // the rows that are left are not written outside of a transaction
+                int beginCode = sqlite3_exec(self.database, "BEGIN IMMEDIATE TRANSACTION", NULL, NULL, NULL);
+                if (beginCode != GWMSQLiteResultOK) {
+                    NSString *message = [NSString stringWithFormat:@"%@: %s, %lu rows were not written", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database), (unsigned long)(rows.count - chunkStart)];
+                    NSLog(@"*** %@ ***", message);
+                    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                    if (error)
+                        *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                    ownsTransaction = NO;
+                    break;
+                }
+            }
+        }
+    }
+    
+    if (ownsTransaction) {
+        int commitCode = sqlite3_exec(self.database, "COMMIT TRANSACTION", NULL, NULL, NULL);
+        if (commitCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database)];
+            NSLog(@"*** %@ ***", message);
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            if (error)
+                *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            writtenCount -= chunkCount;
+            [self resetItemIDs:itemIDs range:NSMakeRange(chunkStart, itemIDs.count - chunkStart)];
+            sqlite3_exec(self.database, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+        }
     }
+    
+    // rows after a failed chunk were not written
+    while (itemIDs.count < rows.count)
+        [itemIDs addObject:@(kGWMNewRecordValue)];
+    
+    [mutableStatements enumerateKeysAndObjectsUsingBlock:^(NSArray<GWMColumnName> *_Nonnull columns, NSValue *_Nonnull statementValue, BOOL *stop){
+        [self relinquishPreparedStatement:statementValue.pointerValue];
+    }];
+    
+    return writtenCount;
 }
 
--(GWMWhereClauseItem *)whereClauseWithCriteria:(NSArray<NSDictionary<NSString*,id>*>*)criteria
+-(void)insertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values completion:(GWMDatabaseResultBlock)completionHandler
 {
-    // build the WHERE clause
-    GWMWhereClauseItem *container = [GWMWhereClauseItem new];
-    
-    if (criteria) {
+    [self insertIntoTable:table values:values onConflict:GWMDBOnConflictAbort completion:completionHandler];
+}
+
+-(void)insertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values onConflict:(GWMDBOnConflict)onConflict completion:(GWMDatabaseResultBlock)completionHandler
+{
+    [self performWrite:^{
+        // conflict resolution
+        NSString *conflict = [self stringWithConflict:onConflict];
+        
+        // build statement
+        NSMutableArray<NSString*> *mutableKeys = [NSMutableArray<NSString*> new];
+        NSMutableArray<NSString*> *mutableValuePlaceholders = [NSMutableArray<NSString*> new];
+        NSMutableArray<NSString*> *mutableValuesToBind = [NSMutableArray<NSString*> new];
+        [values enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key,id _Nonnull obj,BOOL *stop){
+            [mutableKeys addObject:key];
+            [mutableValuePlaceholders addObject:@"?"];
+            [mutableValuesToBind addObject:obj];
+        }];
+        NSString *columns = [[NSArray arrayWithArray:mutableKeys] componentsJoinedByString:@","];
+        NSString *valuePlaceholders = [[NSArray arrayWithArray:mutableValuePlaceholders] componentsJoinedByString:@","];
+        NSString *insertStatement = [NSString stringWithFormat:@"INSERT %@ INTO %@ (%@) VALUES (%@)", conflict, table, columns, valuePlaceholders];
         
-        NSMutableArray<NSString*> *mutableOrPredicates = [NSMutableArray<NSString*> new];
-        NSMutableArray<NSString*> *mutableValues = [NSMutableArray<NSString*> new];
+        // prepare statement
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:insertStatement code:&prepareCode]; // database prepared statment
         
-        [criteria enumerateObjectsUsingBlock:^(NSDictionary<NSString*,id> *_Nonnull info, NSUInteger idx, BOOL *stop){
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),insertStatement];
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            if (completionHandler)
+                completionHandler(nil,error);
             
-            NSMutableArray<NSString*> *mutableAndPredicates = [NSMutableArray<NSString*> new];
+        } else {
             
-            [info enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, id val, BOOL *stop){
-                [mutableValues addObject:val];
-                
-                NSString *predicate = nil;
-                // support other comparisons besides 'equals'
-                if ([key containsString:@"?"])
-                    predicate = key;
-                else
-                    predicate = [NSString stringWithFormat:@"%@ = ?", key];
-                [mutableAndPredicates addObject:predicate];
-            }];
+            BOOL ownsTransaction = [self beginWriteTransaction];
             
-            NSString *andPredicate = [[NSArray arrayWithArray:mutableAndPredicates] componentsJoinedByString:@" AND "];
-            [mutableOrPredicates addObject:andPredicate];
+            NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
+            // bind values
+            [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:nil preparedStatement:sqlite3PreparedStatement]];
             
-        }];
+            //TODO: fix step error DONE
+            int stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                if (completionHandler)
+                    completionHandler(nil,error);
+            }
+            
+            [self endWriteTransaction:ownsTransaction];
+        }
         
-        NSString *orPredicate = [[NSArray arrayWithArray:mutableOrPredicates] componentsJoinedByString:@") OR ("];
-        NSString *finalOrPredicate = nil;
-        if (mutableOrPredicates.count > 1)
-            finalOrPredicate = [NSString stringWithFormat:@"(%@)", orPredicate];
-        else
-            finalOrPredicate = orPredicate;
+        int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        if (finalizeCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+            NSLog(@"*** %@ ***", message);
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            if (completionHandler)
+                completionHandler(nil,error);
+            return;
+        }
+        // execute statement
         
-        container.whereClause = [NSString stringWithFormat:@" WHERE %@", finalOrPredicate];
-        container.whereValues = [NSArray arrayWithArray:mutableValues];
-    }
-    return container;
-}
-
-#pragma mark - DDL Database Operations
-
-#pragma mark Tables
--(void)createTableWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
-{
-    Class<GWMDataItem> class = NSClassFromString(className);
-    
-    NSArray<GWMColumnDefinition*> *tableColumnDefinitions = [class columnDefinitionItems];
-    NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:NSStringFromSelector(@selector(sequence)) ascending:YES];
-//    NSArray<GWMColumnDefinition*> *sortedColumns = [tableColumnDefinitions sortedArrayUsingSelector:@selector(sequence)];
-    NSArray<GWMColumnDefinition*> *sortedColumns = [tableColumnDefinitions sortedArrayUsingDescriptors:@[sortDescriptor]];
-    
-    NSArray *constraintDefs = [class constraintDefinitionItems];
-    NSString *table = self.classToTableMapping[className];
-    
-    [self createTable:table columns:sortedColumns constraints:constraintDefs schema:schema completion:completion];
+        NSString *statement = [NSString stringWithFormat:@"SELECT '%@' AS class, pKey AS itemID FROM %@ ORDER BY inserted DESC LIMIT 1", NSStringFromClass([GWMDataItem class]), table];
+        GWMDatabaseResult *result = [self resultWithStatement:statement criteria:nil completion:nil];
+        GWMDataItem *obj = result.data.firstObject;
+        
+        if (completionHandler) {
+            completionHandler(obj,nil);
+        }
+    }];
 }
 
--(void)createTable:(GWMTableName)tableName columns:(nonnull NSArray<GWMColumnDefinition *> *)columnDefinitions constraints:(NSArray<GWMTableConstraintDefinition*>*)constraintDefinitions schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion
+-(GWMDatabaseResult *)upsertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values conflictColumns:(NSArray<GWMColumnName> *)conflictColumns returningColumn:(GWMColumnName)returningColumn completion:(GWMDatabaseResultBlock)completionHandler
 {
-    NSMutableArray<NSString*> *mutableTableColumnDefinitions = [NSMutableArray new];
-    
-    [columnDefinitions enumerateObjectsUsingBlock:^(GWMColumnDefinition *_Nonnull definition, NSUInteger idx, BOOL *_Nonnull stop){
-        if (definition.createString)
-            [mutableTableColumnDefinitions addObject:definition.createString];
-    }];
-    
-    NSString *columnDefString = [mutableTableColumnDefinitions componentsJoinedByString:@", "];
+    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
     
-    NSString *constraintDefString = nil;
-    if(constraintDefinitions){
-        NSMutableArray *mutableConstraintDefs = [NSMutableArray new];
-        [constraintDefinitions enumerateObjectsUsingBlock:^(GWMTableConstraintDefinition *_Nullable def, NSUInteger idx, BOOL *stop){
-            [mutableConstraintDefs addObject:def.body];
-        }];
-        constraintDefString = [mutableConstraintDefs componentsJoinedByString:@", "];
+    // RETURNING is needed to learn the key of an updated row without another query
+    if (sqlite3_libversion_number() < GWMSQLiteUpsertReturningMinimumVersion) {
+        NSString *message = [NSString stringWithFormat:@"%@: SQLite %@ does not support UPSERT ... RETURNING", GWMSQLiteErrorPreparingStatement, [self sqliteVersion]];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        return databaseResult;
     }
     
-    NSString *statement = nil;
-    if(constraintDefString)
-        statement = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@.%@ (%@, %@)", schema, tableName, columnDefString, constraintDefString];
-    else
-        statement = [NSString stringWithFormat:@"CREATE TABLE IF NOT EXISTS %@.%@ (%@)", schema, tableName, columnDefString];
-    
-    NSError *error = nil;
-    
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
+    // sqlite3_last_insert_rowid is not changed by the DO UPDATE of an upsert
+    if (!returningColumn) {
+        NSString *message = [NSString stringWithFormat:@"%@: an upsert needs a returning column to report the key of an updated record", GWMSQLiteErrorPreparingStatement];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        return databaseResult;
     }
-}
-
--(void)dropTableWithClassName:(NSString *)className schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
-{
-    NSString *table = self.classToTableMapping[className];
-    
-    [self dropTable:table schema:schema completion:completion];
-}
-
--(void)dropTable:(NSString *)tableName schema:(GWMSchemaName _Nullable)schema completion:(GWMDBErrorCompletionBlock _Nullable)completion
-{
-    NSString *statement = nil;
-    if(schema)
-        statement = [NSString stringWithFormat:@"DROP TABLE IF EXISTS %@.%@", schema, tableName];
-    else
-        statement = [NSString stringWithFormat:@"DROP TABLE IF EXISTS %@", tableName];
     
-    NSError *error = nil;
+    [self performWrite:^{
+        
+        // build statement
+        NSArray<GWMColumnName> *columns = [values.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        NSString *upsertStatement = [self insertStatementWithTable:table columns:columns conflictColumns:conflictColumns returningColumn:returningColumn];
+        databaseResult.statement = upsertStatement;
+        
+        // prepare statement
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:upsertStatement code:&prepareCode];
+        
+        // a table without a unique constraint on the conflict columns cannot be upserted
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),upsertStatement];
+            databaseResult.resultCode = prepareCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(prepareCode)] = message;
+            [self relinquishPreparedStatement:sqlite3PreparedStatement];
+            return;
+        }
+        
+        // bind values
+        NSArray *valuesToBind = [values objectsForKeys:columns notFoundMarker:[NSNull null]];
+        [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+        
+        NSError *error = nil;
+        GWMDataItem *obj = nil;
+        
+        int stepCode = GWMSQLiteResultError;
+        if (databaseResult.resultCode == GWMSQLiteResultOK)
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+        
+        if (stepCode == GWMSQLiteResultRow) {
+            obj = [GWMDataItem dataItemWithItemID:(NSInteger)sqlite3_column_int64(sqlite3PreparedStatement, 0)];
+            while (stepCode == GWMSQLiteResultRow)
+                stepCode = sqlite3_step(sqlite3PreparedStatement);
+        }
+        
+        if (stepCode != GWMSQLiteResultDone) {
+            NSString *message = databaseResult.resultMessage;
+            if (databaseResult.resultCode == GWMSQLiteResultOK) {
+                message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                databaseResult.resultCode = stepCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(stepCode)] = message;
+                NSLog(@"*** %@ ***", message);
+            }
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            obj = nil;
+        }
+        
+        [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        
+        if (completionHandler)
+            completionHandler(obj,error);
+    }];
     
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
+    return databaseResult;
 }
 
--(void)renameTable:(GWMTableName)oldName newName:(GWMTableName)newName schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+-(void)insertWithStatement:(NSString *)statement values:(nonnull NSArray *)values completion:(GWMDBCompletionBlock _Nullable)completion
 {
-    NSString *alias = schema ? schema : GWMSchemaNameMain;
-    
-    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ RENAME TO %@", alias, oldName, newName];
-    NSError *error = nil;
-    
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
-    
+    [self performWrite:^{
+        GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+        
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:statement code:&prepareCode]; // database prepared statment
+        
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
+            databaseResult.resultCode = prepareCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(prepareCode)] = message;
+            NSLog(@"*** %@ ***", message);
+        } else {
+            
+            BOOL ownsTransaction = [self beginWriteTransaction];
+            
+            [values enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+            
+            //TODO: fix step error DONE
+            int stepCode = sqlite3_step(sqlite3PreparedStatement);
+            if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                databaseResult.resultCode = stepCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(stepCode)] = message;
+                NSLog(@"*** %@ ***", message);
+            }
+            
+            [self endWriteTransaction:ownsTransaction];
+        }
+        
+        //TODO: fix finalize error DONE
+        int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        if (finalizeCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+            databaseResult.resultCode = finalizeCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(finalizeCode)] = message;
+            NSLog(@"*** %@ ***", message);
+        }
+        
+    //    NSMutableDictionary *mutableUserInfo = [NSMutableDictionary dictionary];
+    //
+    //    [columns enumerateObjectsUsingBlock:^(NSString *key, NSUInteger idx, BOOL *stop){
+    //        mutableUserInfo[key] = values[idx];
+    //    }];
+        
+        if (completion) {
+            completion();
+        }
+    }];
 }
 
--(void)renameColumn:(GWMColumnName)oldName newName:(GWMColumnName)newName table:(GWMTableName)table schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
-{
-    NSString *alias = schema ? schema : GWMSchemaNameMain;
-    
-    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ RENAME COLUMN %@ TO %@", alias, table, oldName, newName];
-    
-    NSError *error = nil;
-    
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
-}
+#pragma mark Read
 
--(void)addColumn:(GWMColumnDefinition *)columnDefinition toTable:(GWMTableName)table schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+-(GWMDatabaseResult *)resultWithStatement:(NSString *)statement criteria:(NSArray *)criteria completion:(GWMDBCompletionBlock)completionHandler
 {
-    NSString *alias = schema ? schema : GWMSchemaNameMain;
+    [self openDatabase];
     
-    NSString *statement = [NSString stringWithFormat:@"ALTER TABLE %@.%@ ADD COLUMN %@", alias, table, [columnDefinition createString]];
-    NSError *error = nil;
+    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
     
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
-}
-
-#pragma mark Indexes
-
--(void)createIndex:(GWMIndexDefinition *)indexDefinition completion:(GWMDBErrorCompletionBlock)completion
-{
-    NSError *error = nil;
-    @try {
-        [self processStatement:indexDefinition.indexCreationString];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
-}
-
--(void)dropIndex:(GWMIndexName)index schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
-{
-    NSString *statement = nil;
+    NSArray<NSString*> *statementComponents = [statement componentsSeparatedByString:@"?"];
     
-    if(schema)
-        statement = [NSString stringWithFormat:@"DROP INDEX IF EXISTS %@.%@", schema, index];
-    else
-        statement = [NSString stringWithFormat:@"DROP INDEX IF EXISTS %@", index];
+    NSMutableString *mutableStatement = [[NSMutableString alloc] init];
+    
+    [statementComponents enumerateObjectsUsingBlock:^(NSString *_Nonnull str, NSUInteger idx, BOOL *stop){
+        
+        [mutableStatement appendString:str];
+        
+        if (idx < [criteria count]) {
+            id value = criteria[idx];
+            
+            if ([value isKindOfClass:[NSString class]]) {
+                NSString *stringNS = (NSString *)value;
+                [mutableStatement appendString:stringNS];
+            } else if ([value isKindOfClass:[NSNumber class]]){
+                NSNumber *numberNS = (NSNumber *)value;
+                [mutableStatement appendString:[numberNS stringValue]];
+            }
+        }
+    }];
     
-    NSError *error = nil;
+    databaseResult.statement = [NSString stringWithString:mutableStatement];
     
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
+    return [self resultWithDatabaseResult:databaseResult statement:statement values:criteria searchesForClassColumn:NO completion:completionHandler];
 }
 
-#pragma mark Triggers
-
--(void)createTrigger:(GWMTriggerDefinition *)triggerDefinition completion:(GWMDBErrorCompletionBlock)completion
+-(GWMDatabaseResult *)resultWithStatement:(NSString *)statement criteria:(NSArray<NSDictionary<GWMColumnName,id> *> *)criteriaValues exclude:(NSArray<__kindof GWMDataItem *> *)excludedItems sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit completion:(GWMDBCompletionBlock)completionHandler
 {
-    NSError *error = nil;
-    
-    @try {
-        [self processStatement:triggerDefinition.triggerString];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
-    }
+    // the columns of each dictionary are sorted, so the same criteria shape always gives the same statement
+    NSArray<NSArray<GWMColumnName>*> *criteriaShape = [GWMCompiledQuery criteriaShapeWithCriteria:criteriaValues];
+    GWMCompiledQuery *query = [GWMCompiledQuery queryWithStatement:statement criteriaShape:criteriaShape excludesItems:excludedItems.count > 0 sortBy:sortBy ascending:ascending limit:limit];
     
+    return [self resultWithCompiledQuery:query criteria:criteriaValues exclude:excludedItems completion:completionHandler];
 }
 
--(void)dropTrigger:(GWMTriggerName)trigger schema:(GWMSchemaName)schema completion:(GWMDBErrorCompletionBlock)completion
+-(GWMDatabaseResult *)resultWithCompiledQuery:(GWMCompiledQuery *)query criteria:(NSArray<NSDictionary<GWMColumnName,id> *> *)criteria exclude:(NSArray<__kindof GWMDataItem *> *)excludedItems completion:(GWMDBCompletionBlock)completionHandler
 {
-    NSString *statement = nil;
+    NSMutableArray<NSNumber*> *mutableExcludedIDs = nil;
+    if (query.excludesItems) {
+        mutableExcludedIDs = [NSMutableArray<NSNumber*> arrayWithCapacity:excludedItems.count];
+        for (GWMDataItem *item in excludedItems)
+            [mutableExcludedIDs addObject:@(item.itemID)];
+    }
     
-    if(schema)
-        statement = [NSString stringWithFormat:@"DROP TRIGGER IF EXISTS %@.%@", schema, trigger];
-    else
-        statement = [NSString stringWithFormat:@"DROP TRIGGER IF EXISTS %@", trigger];
+    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+    databaseResult.statement = query.statement;
     
-    NSError *error = nil;
+    NSArray *values = [query valuesWithValues:nil criteria:criteria excludedItemIDs:mutableExcludedIDs];
     
-    @try {
-        [self processStatement:statement];
-    } @catch (NSException *exception) {
-        error = [[NSError alloc] initWithDomain:GWMErrorDomainDatabase code:0 userInfo:exception.userInfo];
-    } @finally {
-        if(completion)
-            completion(error);
+    if (!values || query.kind != GWMCompiledQuerySelect) {
+        NSString *message = [NSString stringWithFormat:@"%@: the criteria do not match the compiled query", GWMSQLiteErrorExecutingStatement];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        NSLog(@"*** %@ ***", message);
+        if (completionHandler)
+            completionHandler();
+        return databaseResult;
     }
+    
+    return [self resultWithDatabaseResult:databaseResult statement:query.statement values:values searchesForClassColumn:YES completion:completionHandler];
 }
 
-#pragma mark - CRUD Database Operations
-
-#pragma mark Create
-
--(void)insertIntoTable:(GWMTableName)table newValues:(NSArray<NSDictionary<GWMColumnName,id> *> *)valuesToInsert completion:(GWMDatabaseResultBlock)completionHandler
+///@discussion Runs a query on a reader connection, or returns its rows from the result cache, and fills in databaseResult.
+-(GWMDatabaseResult *)resultWithDatabaseResult:(GWMDatabaseResult *)databaseResult statement:(NSString *)statement values:(NSArray *)values searchesForClassColumn:(BOOL)searchesForClassColumn completion:(GWMDBCompletionBlock)completionHandler
 {
-    // build statement
-    
-    NSMutableArray<NSString*> *mutableKeys = [NSMutableArray<NSString*> new];
-    NSMutableArray<NSString*> *mutableValuePlaceholders = [NSMutableArray<NSString*> new];
-    NSMutableArray<NSString*> *mutableValuesToBind = [NSMutableArray<NSString*> new];
-    
-    [valuesToInsert enumerateObjectsUsingBlock:^(NSDictionary<NSString*,id> *_Nonnull dictionary, NSUInteger idx, BOOL *stop){
+    /* return the cached rows if the tables of the query have not changed */
+    NSString *resultCacheKey = self.resultCache ? [GWMResultCache keyWithStatement:statement values:values] : nil;
+    NSUInteger resultCacheGeneration = self.resultCache.generation;
+    NSArray *cachedData = resultCacheKey ? [self.resultCache dataForKey:resultCacheKey] : nil;
+    
+    if (cachedData) {
+        databaseResult.data = cachedData;
+        databaseResult.resultCode = GWMSQLiteResultOK;
+        databaseResult.resultMessage = [NSString stringWithUTF8String:sqlite3_errstr(GWMSQLiteResultOK)];
         
-        [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, id _Nonnull obj, BOOL *stop){
-            
-            NSArray *keys = [NSArray arrayWithArray:mutableKeys];
-            if (![keys containsObject:key])
-                [mutableKeys addObject:key];
-            
-            [mutableValuePlaceholders addObject:@"?"];
-            [mutableValuesToBind addObject:obj];
-        }];
+        if (completionHandler) {
+            completionHandler();
+        }
         
-    }];
-    
-    NSString *columns = [[NSArray arrayWithArray:mutableKeys] componentsJoinedByString:@","];
-    NSString *valuePlaceholders = [[NSArray arrayWithArray:mutableValuePlaceholders] componentsJoinedByString:@","];
-    NSString *insertStatement = [NSString stringWithFormat:@"INSERT INTO %@ (%@) VALUES (%@)", table, columns, valuePlaceholders];
+        return databaseResult;
+    }
     
-    // prepare statement
-    sqlite3_stmt *sqlite3PreparedStatement; // database prepared statment
+    int prepareCode = GWMSQLiteResultOK;
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&prepareCode database:&database];
     
-    const char *statementC = [insertStatement UTF8String];
+    /* instantiate object to contain the result */
+    NSMutableArray *resultArray = [NSMutableArray new];
     
-    int prepareCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, NULL);
     if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),insertStatement];
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        if (completionHandler)
-            completionHandler(nil,error);
-        
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(database)];
+        databaseResult.resultCode = prepareCode;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(prepareCode)] = message;
+        NSLog(@"*** %@ ***", message);
+        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
+        NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
+        @throw exception;
     } else {
         
-        sqlite3_exec(self.database, "BEGIN TRANSACTION", NULL, NULL, NULL);
+        /* bind values to statement */
+        [values enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
         
-        NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
-        // bind values
-        [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:nil preparedStatement:sqlite3PreparedStatement]];
+        GWMRowMappingPlan *rowMappingPlan = nil;
+        NSUInteger identityMapGeneration = [self identityMapGeneration];
+        NSUInteger resultCost = 0;
+        int stepCode = GWMSQLiteResultRow;
         
-        int stepCode = sqlite3_step(sqlite3PreparedStatement);
-        if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
-            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
-            NSLog(@"*** %@ ***", message);
-            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-            NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-            if (completionHandler)
-                completionHandler(nil,error);
+        while (stepCode == GWMSQLiteResultRow) {
+            
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
+            
+            if (stepCode == GWMSQLiteResultDone)
+                break;
+            
+            //TODO: step
+            if (stepCode != GWMSQLiteResultRow) {
+                
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(database)];
+                int extendedResultCode = sqlite3_extended_errcode(database);
+                const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
+                databaseResult.resultCode = stepCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(stepCode)] = message;
+                databaseResult.extendedResultCode = extendedResultCode;
+                databaseResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
+                NSLog(@"*** %@ ***", message);
+                
+            } else {
+                
+                /*
+                 1. each row has a class that will be used to contain the values from the row
+                 2. each row can have a different class associated with than all the other rows have
+                 3. the class name is returned by the first column, or by the 'class' column when searchesForClassColumn is YES
+                 */
+                if (!rowMappingPlan)
+                    rowMappingPlan = [self rowMappingPlanForPreparedStatement:sqlite3PreparedStatement searchesForClassColumn:searchesForClassColumn];
+                
+                id obj = [self objectWithRowOfStatement:sqlite3PreparedStatement rowMappingPlan:rowMappingPlan identityMapGeneration:identityMapGeneration];
+                
+                [resultArray addObject:obj];
+                
+                if (resultCacheKey)
+                    resultCost += [rowMappingPlan costOfRowOfStatement:sqlite3PreparedStatement];
+            }
         }
         
-        sqlite3_exec(self.database, "END TRANSACTION", NULL, NULL, NULL);
+        if (resultCacheKey && databaseResult.errors.count == 0)
+            [self cacheResultData:[NSArray arrayWithArray:resultArray] forKey:resultCacheKey preparedStatement:sqlite3PreparedStatement cost:resultCost generation:resultCacheGeneration];
     }
     
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
     if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(database)];
+        databaseResult.resultCode = finalizeCode;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(finalizeCode)] = message;
         NSLog(@"*** %@ ***", message);
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        if (completionHandler)
-            completionHandler(nil,error);
-        return;
+        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
+        NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
+        @throw exception;
     }
-    // execute statement
     
-    NSString *statement = [NSString stringWithFormat:@"SELECT '%@' AS class, pKey AS itemID FROM %@ ORDER BY inserted DESC LIMIT 1", NSStringFromClass([GWMDataItem class]), table];
-    GWMDatabaseResult *result = [self resultWithStatement:statement criteria:nil completion:nil];
-    GWMDataItem *obj = result.data.firstObject;
+    databaseResult.data = [NSArray arrayWithArray:resultArray];
+    databaseResult.resultCode = prepareCode;
+    databaseResult.resultMessage = [NSString stringWithFormat:@"%s",sqlite3_errmsg(self.database)];
     
     if (completionHandler) {
-        completionHandler(obj,nil);
+        completionHandler();
     }
+    
+    return databaseResult;
 }
 
--(void)insertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values completion:(GWMDatabaseResultBlock)completionHandler
+-(GWMDatabaseResult *)fetchItemsOfClass:(Class)itemClass withIDs:(NSArray<NSNumber*> *)itemIDs
 {
-    [self insertIntoTable:table values:values onConflict:GWMDBOnConflictAbort completion:completionHandler];
+    NSString *table = self.classToTableMapping[NSStringFromClass(itemClass)];
+    GWMClassMetadata *metadata = [GWMClassMetadata metadataForClass:itemClass];
+    
+    if (!table || !metadata.primaryKeyColumn) {
+        GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+        NSString *message = [NSString stringWithFormat:@"%@ has no table or primary key column", NSStringFromClass(itemClass)];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        NSLog(@"*** %@ ***", message);
+        return databaseResult;
+    }
+    
+    if (itemIDs.count == 0) {
+        GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+        databaseResult.data = @[];
+        databaseResult.resultCode = GWMSQLiteResultOK;
+        return databaseResult;
+    }
+    
+    NSString *statement = [NSString stringWithFormat:@"%@ WHERE %@.%@ IN (%@)", [metadata selectStatementWithTable:table], [itemClass tableAlias], metadata.primaryKeyColumn, GWMSQLiteItemIDSetSelect];
+    
+    return [self resultWithStatement:statement criteria:@[GWMJSONArrayWithItemIDs(itemIDs)] completion:nil];
 }
 
--(void)insertIntoTable:(GWMTableName)table values:(NSDictionary<GWMColumnName,id> *)values onConflict:(GWMDBOnConflict)onConflict completion:(GWMDatabaseResultBlock)completionHandler
+-(NSString *)searchQueryWithText:(NSString *)text scope:(GWMColumnName)scope
 {
-    // conflict resolution
-    NSString *conflict = [self stringWithConflict:onConflict];
-    
-    // build statement
-    NSMutableArray<NSString*> *mutableKeys = [NSMutableArray<NSString*> new];
-    NSMutableArray<NSString*> *mutableValuePlaceholders = [NSMutableArray<NSString*> new];
-    NSMutableArray<NSString*> *mutableValuesToBind = [NSMutableArray<NSString*> new];
-    [values enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key,id _Nonnull obj,BOOL *stop){
-        [mutableKeys addObject:key];
-        [mutableValuePlaceholders addObject:@"?"];
-        [mutableValuesToBind addObject:obj];
-    }];
-    NSString *columns = [[NSArray arrayWithArray:mutableKeys] componentsJoinedByString:@","];
-    NSString *valuePlaceholders = [[NSArray arrayWithArray:mutableValuePlaceholders] componentsJoinedByString:@","];
-    NSString *insertStatement = [NSString stringWithFormat:@"INSERT %@ INTO %@ (%@) VALUES (%@)", conflict, table, columns, valuePlaceholders];
+    // every word is quoted, so punctuation in the text is not read as FTS5 query syntax
+    NSMutableArray<NSString*> *mutableTerms = [NSMutableArray<NSString*> new];
+    for (NSString *word in [text componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]]) {
+        if (word.length == 0)
+            continue;
+        [mutableTerms addObject:[NSString stringWithFormat:@"\"%@\"*", [word stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""]]];
+    }
     
-    // prepare statement
-    sqlite3_stmt *sqlite3PreparedStatement; // database prepared statment
+    if (mutableTerms.count == 0)
+        return nil;
     
-    const char *statementC = [insertStatement UTF8String];
+    NSString *query = [mutableTerms componentsJoinedByString:@" "];
     
-    //TODO: prepare DONE
-    int prepareCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, NULL);
-    if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),insertStatement];
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        if (completionHandler)
-            completionHandler(nil,error);
-        
-    } else {
-        
-        sqlite3_exec(self.database, "BEGIN TRANSACTION", NULL, NULL, NULL);
-        
-        NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
-        // bind values
-        [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:nil preparedStatement:sqlite3PreparedStatement]];
-        
-        //TODO: fix step error DONE
-        int stepCode = sqlite3_step(sqlite3PreparedStatement);
-        if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
-            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
-            NSLog(@"*** %@ ***", message);
-            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-            NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-            if (completionHandler)
-                completionHandler(nil,error);
-        }
-        
-        sqlite3_exec(self.database, "END TRANSACTION", NULL, NULL, NULL);
-    }
+    if (scope)
+        return [NSString stringWithFormat:@"{%@} : (%@)", scope, query];
     
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+    return query;
+}
+
+-(GWMDatabaseResult *)searchItemsOfClass:(Class)itemClass matching:(NSString *)text scope:(GWMColumnName)scope limit:(NSUInteger)limit
+{
+    NSString *table = self.classToTableMapping[NSStringFromClass(itemClass)];
+    GWMClassMetadata *metadata = [GWMClassMetadata metadataForClass:itemClass];
+    NSArray<GWMColumnName> *columns = [itemClass searchableColumns];
+    
+    if (!table || !metadata.primaryKeyColumn || columns.count == 0 || (scope && ![columns containsObject:scope])) {
+        GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+        NSString *message = scope ? [NSString stringWithFormat:@"%@ cannot be searched by %@", NSStringFromClass(itemClass), scope] : [NSString stringWithFormat:@"%@ has no table, primary key column or searchable columns", NSStringFromClass(itemClass)];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
         NSLog(@"*** %@ ***", message);
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        NSError *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        if (completionHandler)
-            completionHandler(nil,error);
-        return;
+        return databaseResult;
     }
-    // execute statement
     
-    NSString *statement = [NSString stringWithFormat:@"SELECT '%@' AS class, pKey AS itemID FROM %@ ORDER BY inserted DESC LIMIT 1", NSStringFromClass([GWMDataItem class]), table];
-    GWMDatabaseResult *result = [self resultWithStatement:statement criteria:nil completion:nil];
-    GWMDataItem *obj = result.data.firstObject;
+    NSString *query = [self searchQueryWithText:text scope:scope];
     
-    if (completionHandler) {
-        completionHandler(obj,nil);
+    if (!query) {
+        GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+        databaseResult.data = @[];
+        databaseResult.resultCode = GWMSQLiteResultOK;
+        return databaseResult;
     }
+    
+    GWMTableName searchTable = [self searchIndexTableWithTable:table];
+    
+    // rank orders by bm25 and lets FTS5 stop early when there is a limit; a negative LIMIT has none
+    NSString *statement = [NSString stringWithFormat:@"%@ JOIN %@ ON %@.rowid = %@.%@ WHERE %@ MATCH ? ORDER BY %@.rank LIMIT ?", [metadata selectStatementWithTable:table], searchTable, searchTable, [itemClass tableAlias], metadata.primaryKeyColumn, searchTable, searchTable];
+    
+    return [self resultWithStatement:statement criteria:@[query, limit > 0 ? @(limit) : @(-1)] completion:nil];
 }
 
--(void)insertWithStatement:(NSString *)statement values:(nonnull NSArray *)values completion:(GWMDBCompletionBlock _Nullable)completion
+#pragma mark Pages
+
+-(NSString *)continuationTokenWithSortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending sortValue:(id)sortValue key:(NSNumber *)key
 {
-    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+    NSDictionary *info = @{@"sortBy":sortBy, @"ascending":@(ascending), @"value":sortValue, @"key":key};
+    NSData *data = [NSJSONSerialization dataWithJSONObject:info options:0 error:nil];
+    return [data base64EncodedStringWithOptions:0];
+}
+
+///@discussion The sort value and key of a continuation token, or nil if the token is not valid or was made for another sort.
+-(NSDictionary *)pagePositionWithContinuationToken:(NSString *)continuationToken sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending
+{
+    NSData *data = [[NSData alloc] initWithBase64EncodedString:continuationToken options:0];
+    NSDictionary *info = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    
+    if (![info isKindOfClass:[NSDictionary class]])
+        return nil;
+    
+    id value = info[@"value"];
+    BOOL isValidValue = [value isKindOfClass:[NSNumber class]] || [value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNull class]];
+    
+    if (![info[@"sortBy"] isEqual:sortBy] || ![info[@"ascending"] isEqual:@(ascending)] || ![info[@"key"] isKindOfClass:[NSNumber class]] || !isValidValue)
+        return nil;
+    
+    return info;
+}
+
+-(GWMDatabaseResult *)pageOfItemsOfClass:(Class)itemClass criteria:(NSArray<NSDictionary<GWMColumnName,id> *> *)criteria sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending pageSize:(NSUInteger)pageSize continuationToken:(NSString *)continuationToken
+{
+    NSString *table = self.classToTableMapping[NSStringFromClass(itemClass)];
+    GWMClassMetadata *metadata = [GWMClassMetadata metadataForClass:itemClass];
+    GWMColumnName primaryKeyColumn = metadata.primaryKeyColumn;
+    GWMColumnName sortColumn = sortBy ?: primaryKeyColumn;
+    NSDictionary *position = continuationToken && sortColumn ? [self pagePositionWithContinuationToken:continuationToken sortBy:sortColumn ascending:ascending] : nil;
+    
+    if (!table || !primaryKeyColumn || pageSize == 0 || (continuationToken && !position)) {
+        GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+        NSString *message = nil;
+        if (!table || !primaryKeyColumn)
+            message = [NSString stringWithFormat:@"%@ has no table or primary key column", NSStringFromClass(itemClass)];
+        else if (pageSize == 0)
+            message = @"The page size must be greater than 0";
+        else
+            message = [NSString stringWithFormat:@"The continuation token was not made for %@ sorted by %@", NSStringFromClass(itemClass), sortColumn];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        NSLog(@"*** %@ ***", message);
+        return databaseResult;
+    }
+    
+    id sortValue = position[@"value"];
+    GWMPagePosition pagePosition = GWMPagePositionFirst;
+    if (position)
+        pagePosition = [sortValue isKindOfClass:[NSNull class]] ? GWMPagePositionAfterNullRow : GWMPagePositionAfterRow;
+    
+    // one row more than the page tells whether there is a next page
+    NSArray<NSArray<GWMColumnName>*> *criteriaShape = [GWMCompiledQuery criteriaShapeWithCriteria:criteria];
+    GWMCompiledQuery *query = [GWMCompiledQuery pageQueryWithStatement:[metadata pageSelectStatementWithTable:table sortBy:sortColumn] tableAlias:[itemClass tableAlias] criteriaShape:criteriaShape sortBy:sortColumn keyColumn:primaryKeyColumn ascending:ascending position:pagePosition limit:(NSInteger)pageSize + 1];
     
-    sqlite3_stmt *sqlite3PreparedStatement; // database prepared statment
+    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+    databaseResult.statement = query.statement;
     
-    const char *statementC = [statement UTF8String];
+    int prepareCode = GWMSQLiteResultOK;
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:query.statement code:&prepareCode database:&database];
     
-    //TODO: prepare DONE
-    int prepareCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, NULL);
     if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(database)];
         databaseResult.resultCode = prepareCode;
         databaseResult.resultMessage = message;
         databaseResult.errors[@(prepareCode)] = message;
         NSLog(@"*** %@ ***", message);
-    } else {
+        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
+        NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
+        @throw exception;
+    }
+    
+    /* bind values to statement */
+    [[query valuesWithCriteria:criteria afterSortValue:sortValue key:position[@"key"]] enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+    
+    GWMRowMappingPlan *rowMappingPlan = [self rowMappingPlanForPreparedStatement:sqlite3PreparedStatement searchesForClassColumn:YES];
+    NSUInteger identityMapGeneration = [self identityMapGeneration];
+    // the page select ends with the sort value and key columns, they are read whether or not the row can be mapped
+    int sortValueIndex = sqlite3_column_count(sqlite3PreparedStatement) - 2;
+    int keyIndex = sortValueIndex + 1;
+    NSMutableArray *mutableItems = [NSMutableArray new];
+    NSUInteger steppedRowCount = 0;
+    BOOL hasNextPage = NO;
+    id lastSortValue = nil;
+    NSNumber *lastKey = nil;
+    
+    while (databaseResult.resultCode == GWMSQLiteResultOK) {
         
-        sqlite3_exec(self.database, "BEGIN TRANSACTION", NULL, NULL, NULL);
+        int stepCode = sqlite3_step(sqlite3PreparedStatement);
         
-        [values enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+        if (stepCode == GWMSQLiteResultDone) {
+            // rows that could not be mapped left the page short, the rows after the limit have not been read yet
+            hasNextPage = steppedRowCount > pageSize;
+            break;
+        }
         
-        //TODO: fix step error DONE
-        int stepCode = sqlite3_step(sqlite3PreparedStatement);
-        if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
-            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+        if (stepCode != GWMSQLiteResultRow) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(database)];
+            int extendedResultCode = sqlite3_extended_errcode(database);
+            const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
             databaseResult.resultCode = stepCode;
             databaseResult.resultMessage = message;
             databaseResult.errors[@(stepCode)] = message;
+            databaseResult.extendedResultCode = extendedResultCode;
+            databaseResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
             NSLog(@"*** %@ ***", message);
+            break;
+        }
+        
+        if (mutableItems.count == pageSize) {
+            hasNextPage = YES;
+            break;
         }
         
-        sqlite3_exec(self.database, "END TRANSACTION", NULL, NULL, NULL);
+        steppedRowCount++;
+        
+        id obj = [self objectWithRowOfStatement:sqlite3PreparedStatement rowMappingPlan:rowMappingPlan identityMapGeneration:identityMapGeneration];
+        if (obj)
+            [mutableItems addObject:obj];
+        
+        // the sort value is read as it is stored, so it compares the same way when it is bound for the next page
+        lastKey = sqlite3_column_type(sqlite3PreparedStatement, keyIndex) == SQLITE_INTEGER ? @(sqlite3_column_int64(sqlite3PreparedStatement, keyIndex)) : nil;
+        switch (sqlite3_column_type(sqlite3PreparedStatement, sortValueIndex)) {
+            case SQLITE_NULL:
+                lastSortValue = [NSNull null];
+                break;
+            case SQLITE_INTEGER:
+                lastSortValue = @(sqlite3_column_int64(sqlite3PreparedStatement, sortValueIndex));
+                break;
+            case SQLITE_FLOAT:
+                lastSortValue = @(sqlite3_column_double(sqlite3PreparedStatement, sortValueIndex));
+                break;
+            case SQLITE_TEXT:
+                lastSortValue = [NSString stringWithUTF8String:(const char *)sqlite3_column_text(sqlite3PreparedStatement, sortValueIndex)];
+                break;
+            default:
+                lastSortValue = nil;
+                break;
+        }
     }
     
-    //TODO: fix finalize error DONE
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+    
+    if (finalizeCode != GWMSQLiteResultOK && databaseResult.errors.count == 0) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errstr(finalizeCode)];
         databaseResult.resultCode = finalizeCode;
         databaseResult.resultMessage = message;
         databaseResult.errors[@(finalizeCode)] = message;
         NSLog(@"*** %@ ***", message);
     }
     
-//    NSMutableDictionary *mutableUserInfo = [NSMutableDictionary dictionary];
-//
-//    [columns enumerateObjectsUsingBlock:^(NSString *key, NSUInteger idx, BOOL *stop){
-//        mutableUserInfo[key] = values[idx];
-//    }];
-    
-    if (completion) {
-        completion();
-    }
-}
-
-#pragma mark Read
-
--(GWMDatabaseResult *)resultWithStatement:(NSString *)statement criteria:(NSArray *)criteria completion:(GWMDBCompletionBlock)completionHandler
-{
-    [self openDatabase];
-    
-    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
-    
-    NSArray<NSString*> *statementComponents = [statement componentsSeparatedByString:@"?"];
+    databaseResult.data = [NSArray arrayWithArray:mutableItems];
     
-    NSMutableString *mutableStatement = [[NSMutableString alloc] init];
+    if (!hasNextPage || databaseResult.errors.count > 0)
+        return databaseResult;
     
-    [statementComponents enumerateObjectsUsingBlock:^(NSString *_Nonnull str, NSUInteger idx, BOOL *stop){
-        
-        [mutableStatement appendString:str];
-        
-        if (idx < [criteria count]) {
-            id value = criteria[idx];
-            
-            if ([value isKindOfClass:[NSString class]]) {
-                NSString *stringNS = (NSString *)value;
-                [mutableStatement appendString:stringNS];
-            } else if ([value isKindOfClass:[NSNumber class]]){
-                NSNumber *numberNS = (NSNumber *)value;
-                [mutableStatement appendString:[numberNS stringValue]];
-            }
-        }
-    }];
+    if (!lastKey || !lastSortValue) {
+        NSLog(@"*** The sort value or key of the last row of the page could not be read: '%@' ***", sortColumn);
+        return databaseResult;
+    }
     
-    databaseResult.statement = [NSString stringWithString:mutableStatement];
+    databaseResult.continuationToken = [self continuationTokenWithSortBy:sortColumn ascending:ascending sortValue:lastSortValue key:lastKey];
     
-    /* instantiate object to contain the result */
-    NSMutableArray *resultArray = [[NSMutableArray alloc] init];
+    return databaseResult;
+}
+
+#pragma mark Cursors
+
+-(GWMDatabaseCursor *)cursorWithStatement:(NSString *)statement criteria:(NSArray *)criteria
+{
+    [self openDatabase];
     
-    /* prepare the statement object */
-    sqlite3_stmt *sqlite3PreparedStatement;
+    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+    databaseResult.statement = statement;
     
-    int prepareCode = sqlite3_prepare_v2(self.database, [statement UTF8String], -1, &sqlite3PreparedStatement, NULL);
+    // the cursor keeps a reader connection, and its snapshot, until it is closed
+    int prepareCode = GWMSQLiteResultOK;
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&prepareCode database:&database];
     
     if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(database)];
         databaseResult.resultCode = prepareCode;
         databaseResult.resultMessage = message;
         databaseResult.errors[@(prepareCode)] = message;
@@ -1543,336 +3303,127 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
         NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
         NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
         @throw exception;
-    } else {
-        
-        if (criteria && criteria.count > 0) {
-            
-            /* bind values to statement */
-            [criteria enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
-        }
-        
-        int stepCode = GWMSQLiteResultRow;
-        
-        while (stepCode == GWMSQLiteResultRow) {
-            
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            
-            if (stepCode == GWMSQLiteResultDone)
-                break;
-            
-            //TODO: step
-            if (stepCode != GWMSQLiteResultRow) {
-                
-                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
-                int extendedResultCode = sqlite3_extended_errcode(self.database);
-                const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
-                databaseResult.resultCode = stepCode;
-                databaseResult.resultMessage = message;
-                databaseResult.errors[@(stepCode)] = message;
-                databaseResult.extendedResultCode = extendedResultCode;
-                databaseResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
-                NSLog(@"*** %@ ***", message);
-                
-            } else {
-                
-                /*
-                 1. each row has a class that will be used to contain the values from the row
-                 2. each row can have a different class associated with than all the other rows have
-                 3. the class name should always be returned by the first column
-                 */
-                int columnCount = sqlite3_column_count(sqlite3PreparedStatement);
-                
-                char *classNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, 0);
-                NSString *classNameNS = [NSString stringWithUTF8String:classNameC];
-                
-                Class class = NSClassFromString(classNameNS);
-                
-                id obj = [[class alloc] init];
-                
-                // return the values from the sqlite table
-                for (int index = 1; index < columnCount; index++) {
-                    
-                    int dataTypeI = sqlite3_column_type(sqlite3PreparedStatement, index);
-                    
-                    const char *declaredDataTypeC = sqlite3_column_decltype(sqlite3PreparedStatement, index);
-                    
-                    if (declaredDataTypeC == NULL) {
-                        declaredDataTypeC = "TEXT";
-                    }
-                    
-                    const char *columnNameC = sqlite3_column_name(sqlite3PreparedStatement, index);
-                    NSString *columnNameNS = [NSString stringWithUTF8String:columnNameC];
-                    
-                    /*
-                    Get the column names as understood by the SQL statement and use those to compare with the keys in the data object.
-                    Should not compare with the objects in the columnKeys array!!!
-                    */
-                    
-                    // Dates are stored in the database as a String but they will be stored in the custom class as a NSDate
-                    
-                    if ((!strcmp(declaredDataTypeC, "DATE_TIME") && dataTypeI != GWMDBDataTypeNull) || ([columnNameNS containsString:@"Date"] && ![columnNameNS containsString:@"String"])) {
-                        
-                        char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                        if (stringValueC != NULL) {
-                            NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                            
-                            NSDate *dateTimeD = [self dateWithFormat:GWMDBDateFormatDateTime string:stringValueNS andTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
-                            
-                            [obj setValue:dateTimeD forKey:columnNameNS];
-                        }
-                        
-                    } else if ((!strcmp(declaredDataTypeC, "HISTORIC_DATE") && dataTypeI != GWMDBDataTypeNull) || ([columnNameNS containsString:@"Date"] && ![columnNameNS containsString:@"String"])) {
-                        
-                        //TODO: don't let a NULL cString through!
-                        char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                        
-                        if (stringValueC) {
-                            
-                            int stringValueLengthI = (int)strlen(stringValueC);
-                            
-                            NSString *dateFormatNS = nil;
-                            NSTimeZone *timeZoneNS = [NSTimeZone localTimeZone];
-                            
-                            // determine and set the date format
-                            switch (stringValueLengthI) {
-                                    
-                                case GWMDBDateStringLengthDateTime:
-                                {
-                                    dateFormatNS = GWMDBDateFormatDateTime;
-                                    timeZoneNS = [NSTimeZone timeZoneWithName:@"UTC"];
-                                    break;
-                                }
-                                case GWMDBDateStringLengthShortDate:
-                                {
-                                    dateFormatNS = GWMDBDateFormatShortDate;
-                                    break;
-                                }
-                                case GWMDBDateStringLengthYearMonth:
-                                {
-                                    dateFormatNS = GWMDBDateFormatYearAndMonth;
-                                    break;
-                                }
-                                case GWMDBDateStringLengthYearOnly:
-                                {
-                                    dateFormatNS = GWMDBDateFormatYear;
-                                    break;
-                                }
-                                default:
-                                    break;
-                            }
-                            
-                            // set the value on the result object
-                            if (stringValueLengthI == GWMDBDateStringLengthYearOnly) {
-                                
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                [obj setValue:stringValueNS forKey:columnNameNS];
-                                
-                            } else {
-                                
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                
-                                NSDate *date = [self dateWithFormat:dateFormatNS string:stringValueNS andTimeZone:timeZoneNS];
-                                
-                                [obj setValue:date forKey:columnNameNS];
-                            }
-                        }
-                        
-                    } else {
-                        
-                        // TODO: sqlite data types IMPROVING
-                        switch (dataTypeI) {
-                            case GWMDBDataTypeInteger:{
-                                
-                                int integerValueI = sqlite3_column_int(sqlite3PreparedStatement, index);
-                                
-                                NSNumber *integerValueNS = nil;
-                                
-                                if (strcmp(declaredDataTypeC, "BOOLEAN") == 0) {
-                                    
-                                    BOOL boolValueB = integerValueI == 0 ? NO : YES;
-                                    
-                                    integerValueNS = [NSNumber numberWithBool:boolValueB];
-                                    
-                                } else {
-                                    
-                                    integerValueNS = [NSNumber numberWithInt:integerValueI];
-                                    
-                                }
-                                
-                                if ([obj respondsToSelector:NSSelectorFromString(columnNameNS)]) {
-                                    [obj setValue:integerValueNS forKey:columnNameNS];
-                                }
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeFloat:{
-                                
-                                float floatValueF = sqlite3_column_double(sqlite3PreparedStatement, index);
-                                NSNumber *floatValueNS = [NSNumber numberWithDouble:floatValueF];
-                                [obj setValue:floatValueNS forKey:columnNameNS];
-                                break;
-                            }
-                            case GWMDBDataTypeText:{
-                                //TODO: check for custom data types: DATE, DATETIME
-                                
-                                char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                
-                                SEL selectorSEL = NSSelectorFromString(columnNameNS);
-                                
-                                if (![columnNameNS isEqualToString:@"class"]) {
-                                    
-                                    if (strcmp(declaredDataTypeC, "BOOLEAN") == 0) {
-                                        
-                                        NSNumber *integerValueNS = nil;
-                                        
-                                        BOOL boolValueB = ([stringValueNS isEqualToString:@"TRUE"] || [stringValueNS isEqualToString:@"true"]) ? YES : NO;
-                                        
-                                        integerValueNS = [NSNumber numberWithBool:boolValueB];
-                                        
-                                        if ([obj respondsToSelector:NSSelectorFromString(columnNameNS)])
-                                            [obj setValue:integerValueNS forKey:columnNameNS];
-                                        
-                                    } else {
-                                        
-                                        if ([obj respondsToSelector:selectorSEL]) {
-                                            
-                                            [obj setValue:stringValueNS forKey:columnNameNS];
-                                            
-                                        } else {
-                                            //TODO: Need to document why I did the following:
-                                            obj = stringValueNS;
-                                        }
-                                        
-                                    }
-                                    
-                                }
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeBlob:{
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeNull:{
-                                
-                                break;
-                            }
-                                
-                            default:
-                                break;
-                        }
-                    }
-                }
-                
-                [resultArray addObject:obj];
-            }
-        }
-    }
-    //TODO: fix finalize error DONE
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
-        databaseResult.resultCode = finalizeCode;
-        databaseResult.resultMessage = message;
-        databaseResult.errors[@(finalizeCode)] = message;
-        NSLog(@"*** %@ ***", message);
-        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
-        NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
-        @throw exception;
     }
     
-    databaseResult.data = [NSArray arrayWithArray:resultArray];
-    databaseResult.resultCode = prepareCode;
-    databaseResult.resultMessage = [NSString stringWithFormat:@"%s",sqlite3_errmsg(self.database)];
+    /* bind values to statement */
+    if (criteria && criteria.count > 0)
+        [criteria enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
     
-    if (completionHandler) {
-        completionHandler();
-    }
+    GWMRowMappingPlan *rowMappingPlan = [self rowMappingPlanForPreparedStatement:sqlite3PreparedStatement searchesForClassColumn:NO];
     
-    return databaseResult;
+    return [[GWMDatabaseCursor alloc] initWithDatabaseController:self preparedStatement:sqlite3PreparedStatement rowMappingPlan:rowMappingPlan result:databaseResult];
 }
 
--(GWMDatabaseResult *)resultWithStatement:(NSString *)statement criteria:(NSArray<NSDictionary<GWMColumnName,id> *> *)criteriaValues exclude:(NSArray<__kindof GWMDataItem *> *)excludedItems sortBy:(GWMColumnName)sortBy ascending:(BOOL)ascending limit:(NSInteger)limit completion:(GWMDBCompletionBlock)completionHandler
+-(GWMDatabaseResult *)enumerateRowsWithStatement:(NSString *)statement criteria:(NSArray *)criteria block:(GWMDBRowEnumerationBlock)block
+{
+    return [self enumerateRowsWithStatement:statement criteria:criteria batchSize:0 block:block];
+}
+
+-(GWMDatabaseResult *)enumerateRowsWithStatement:(NSString *)statement criteria:(NSArray *)criteria batchSize:(NSUInteger)batchSize block:(GWMDBRowEnumerationBlock)block
 {
-    // build statement
+    if (batchSize == 0)
+        batchSize = 256;
     
-    NSMutableString *mutableStatement = [NSMutableString new];
-    [mutableStatement appendString:statement];
+    GWMDatabaseCursor *cursor = [self cursorWithStatement:statement criteria:criteria];
     
-    // build the WHERE clause
-    NSString *whereClause = nil;
-    NSArray *whereValues = nil;
-    if (criteriaValues) {
-        
-        NSMutableArray<NSString*> *mutableOrPredicates = [NSMutableArray<NSString*> new];
-        NSMutableArray<NSString*> *mutableValues = [NSMutableArray<NSString*> new];
-        
-        [criteriaValues enumerateObjectsUsingBlock:^(NSDictionary<NSString*,id> *_Nonnull info, NSUInteger idx, BOOL *stop){
-            
-            NSMutableArray<NSString*> *mutableAndPredicates = [NSMutableArray<NSString*> new];
-            
-            [info enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, id val, BOOL *stop){
-                [mutableValues addObject:val];
-                NSString *predicate = [NSString stringWithFormat:@"%@ = ?", key];
-                [mutableAndPredicates addObject:predicate];
-            }];
-            
-            NSString *andPredicate = [[NSArray arrayWithArray:mutableAndPredicates] componentsJoinedByString:@" AND "];
-            [mutableOrPredicates addObject:andPredicate];
-            
-        }];
-        
-        NSString *orPredicate = [[NSArray arrayWithArray:mutableOrPredicates] componentsJoinedByString:@") OR ("];
-        NSString *finalOrPredicate = nil;
-        if (mutableOrPredicates.count > 1)
-            finalOrPredicate = [NSString stringWithFormat:@"(%@)", orPredicate];
-        else
-            finalOrPredicate = orPredicate;
-        
-        whereClause = [NSString stringWithFormat:@" WHERE %@", finalOrPredicate];
-        whereValues = [NSArray arrayWithArray:mutableValues];
-        
-        [mutableStatement appendString:whereClause];
+    NSUInteger idx = 0;
+    BOOL stop = NO;
+    
+    // the statement and reader connection are given back even if the block throws
+    @try {
+        while (!stop && !cursor.isClosed) {
+            @autoreleasepool {
+                for (NSUInteger count = 0; count < batchSize && !stop; count++) {
+                    id obj = [cursor nextObject];
+                    if (!obj)
+                        break;
+                    block(obj, idx++, &stop);
+                }
+            }
+        }
+    } @finally {
+        [cursor close];
     }
     
-    if (excludedItems) {
-        NSMutableArray *mutableIDs = [NSMutableArray new];
-        [excludedItems enumerateObjectsUsingBlock:^(GWMDataItem *_Nonnull obj, NSUInteger idx, BOOL *stop){
-            [mutableIDs addObject:@(obj.itemID)];
-        }];
-        
-        NSString *idString = [mutableIDs componentsJoinedByString:@", "];
-        
-        NSString *extendedWhereClause = [NSString stringWithFormat:@" AND pKey NOT IN (SELECT %@)", idString];
-        [mutableStatement appendString:extendedWhereClause];
+    return cursor.result;
+}
+
+-(GWMColumnarResult *)columnarResultWithStatement:(NSString *)statement criteria:(NSArray *)criteria
+{
+    [self openDatabase];
+    
+    GWMColumnarResult *columnarResult = [GWMColumnarResult new];
+    columnarResult.statement = statement;
+    
+    int prepareCode = GWMSQLiteResultOK;
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&prepareCode database:&database];
+    
+    if (prepareCode != GWMSQLiteResultOK) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(database)];
+        columnarResult.resultCode = prepareCode;
+        columnarResult.resultMessage = message;
+        columnarResult.errors[@(prepareCode)] = message;
+        NSLog(@"*** %@ ***", message);
+        NSDictionary *info = @{GWMDBStatementKey:columnarResult.statement};
+        NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
+        @throw exception;
     }
     
-    if (sortBy) {
-        if (ascending)
-            [mutableStatement appendString:[NSString stringWithFormat:@" ORDER BY %@ ASC", sortBy]];
-        else
-            [mutableStatement appendString:[NSString stringWithFormat:@" ORDER BY %@ DESC", sortBy]];
+    /* bind values to statement */
+    if (criteria && criteria.count > 0)
+        [criteria enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:columnarResult preparedStatement:sqlite3PreparedStatement]];
+    
+    [columnarResult setColumnsWithPreparedStatement:sqlite3PreparedStatement];
+    
+    int stepCode = sqlite3_step(sqlite3PreparedStatement);
+    
+    while (stepCode == GWMSQLiteResultRow) {
+        [columnarResult appendRowOfStatement:sqlite3PreparedStatement];
+        stepCode = sqlite3_step(sqlite3PreparedStatement);
     }
     
-    if (limit > 0) {
-        NSString *LimitClause = [NSString stringWithFormat:@" LIMIT %li", (long)limit];
-        [mutableStatement appendString:LimitClause];
+    if (stepCode != GWMSQLiteResultDone) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(database)];
+        int extendedResultCode = sqlite3_extended_errcode(database);
+        const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
+        columnarResult.resultCode = stepCode;
+        columnarResult.resultMessage = message;
+        columnarResult.errors[@(stepCode)] = message;
+        columnarResult.extendedResultCode = extendedResultCode;
+        columnarResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
+        NSLog(@"*** %@ ***", message);
     }
     
-    NSString *finalStatement = [NSString stringWithString:mutableStatement];
-    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
-    databaseResult.statement = finalStatement;
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+    
+    // an error from stepping is reported again by reset, it has already been recorded
+    if (finalizeCode != GWMSQLiteResultOK && columnarResult.errors.count == 0) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errstr(finalizeCode)];
+        columnarResult.resultCode = finalizeCode;
+        columnarResult.resultMessage = message;
+        columnarResult.errors[@(finalizeCode)] = message;
+        NSLog(@"*** %@ ***", message);
+    }
     
-    sqlite3_stmt *sqlite3PreparedStatement;
+    return columnarResult;
+}
+
+#pragma mark Blobs
+
+-(GWMDatabaseResult *)enumerateBlobsWithStatement:(NSString *)statement criteria:(NSArray *)criteria block:(GWMDBBlobEnumerationBlock)block
+{
+    [self openDatabase];
     
-    int prepareCode = sqlite3_prepare_v2(self.database, finalStatement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+    databaseResult.statement = statement;
     
-    /* instantiate object to contain the result */
-    NSMutableArray *resultArray = [NSMutableArray new];
+    int prepareCode = GWMSQLiteResultOK;
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&prepareCode database:&database];
     
     if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(database)];
         databaseResult.resultCode = prepareCode;
         databaseResult.resultMessage = message;
         databaseResult.errors[@(prepareCode)] = message;
@@ -1880,274 +3431,93 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
         NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
         NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
         @throw exception;
-    } else {
-        
-        /* bind values to statement */
-        NSMutableArray *mutableValuesToBind = [NSMutableArray new];
-        if(whereValues)
-            [mutableValuesToBind addObjectsFromArray:whereValues];
-        
-        NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
-        
-//        __block int bindCode = GWMSQLiteResultOK;
-        
-        [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
-        
-        int stepCode = GWMSQLiteResultRow;
-        
-        while (stepCode == GWMSQLiteResultRow) {
-            
-            stepCode = sqlite3_step(sqlite3PreparedStatement);
-            
-            if (stepCode == GWMSQLiteResultDone)
-                break;
+    }
+    
+    /* bind values to statement */
+    if (criteria && criteria.count > 0)
+        [criteria enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+    
+    NSUInteger idx = 0;
+    BOOL stop = NO;
+    int stepCode = sqlite3_step(sqlite3PreparedStatement);
+    
+    while (stepCode == GWMSQLiteResultRow && !stop) {
+        @autoreleasepool {
+            NSData *data = nil;
             
-            //TODO: step
-            if (stepCode != GWMSQLiteResultRow) {
-                
-                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
-                int extendedResultCode = sqlite3_extended_errcode(self.database);
-                const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
-                databaseResult.resultCode = stepCode;
-                databaseResult.resultMessage = message;
-                databaseResult.errors[@(stepCode)] = message;
-                databaseResult.extendedResultCode = extendedResultCode;
-                databaseResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
-                NSLog(@"*** %@ ***", message);
-                
-            } else {
-                
-                /*
-                 1. each row has a class that will be used to contain the values from the row
-                 2. each row can have a different class associated with than all the other rows have
-                 3. the class name should always be returned by the first column
-                 */
-                int columnCount = sqlite3_column_count(sqlite3PreparedStatement);
-                
-                NSString *classNameNS = nil;
-                NSString *columnNameNS = nil;
-                
-                // find the 'class' column
-                for (int idx = 0; idx < columnCount; idx++) {
-                    const char *columnNameC = sqlite3_column_name(sqlite3PreparedStatement, idx);
-                    columnNameNS = [NSString stringWithUTF8String:columnNameC];
-                    if (![columnNameNS isEqualToString:GWMTableColumnClass])
-                        continue;
-                    
-                    char *classNameC = (char *) sqlite3_column_text(sqlite3PreparedStatement, idx);
-                    classNameNS = [NSString stringWithUTF8String:classNameC];
-                    break;
-                    
-                }
-                if (!classNameNS)
-                    classNameNS = NSStringFromClass([GWMDataItem class]);
-                
-                Class class = NSClassFromString(classNameNS);
-                
-                id obj = [[class alloc] init];
-                
-                // return the values from the sqlite table
-                for (int index = 1; index < columnCount; index++) {
-                    
-                    int dataTypeI = sqlite3_column_type(sqlite3PreparedStatement, index);
-                    
-                    const char *declaredDataTypeC = sqlite3_column_decltype(sqlite3PreparedStatement, index);
-                    
-                    if (declaredDataTypeC == NULL) {
-                        declaredDataTypeC = "TEXT";
-                    }
-                    
-                    const char *columnNameC = sqlite3_column_name(sqlite3PreparedStatement, index);
-                    columnNameNS = [NSString stringWithUTF8String:columnNameC];
-                    
-                    /*
-                     Get the column names as understood by the SQL statement and use those to compare with the keys in the data object.
-                     Should not compare with the objects in the columnKeys array!!!
-                     */
-                    
-                    // Dates are stored in the database as a String but they will be stored in the custom class as a NSDate
-                    
-                    if ((!strcmp(declaredDataTypeC, "DATE_TIME") && dataTypeI != GWMDBDataTypeNull) || ([columnNameNS containsString:@"Date"] && ![columnNameNS containsString:@"String"])) {
-                        
-                        char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                        if (stringValueC != NULL) {
-                            NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                            
-                            NSDate *dateTimeD = [self dateWithFormat:GWMDBDateFormatDateTime string:stringValueNS andTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
-                            
-                            [obj setValue:dateTimeD forKey:columnNameNS];
-                        }
-                        
-                    } else if ((!strcmp(declaredDataTypeC, "HISTORIC_DATE") && dataTypeI != GWMDBDataTypeNull) || ([columnNameNS containsString:@"Date"] && ![columnNameNS containsString:@"String"])) {
-                        
-                        //TODO: don't let a NULL cString through!
-                        char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                        
-                        if (stringValueC) {
-                            
-                            int stringValueLengthI = (int)strlen(stringValueC);
-                            
-                            NSString *dateFormatNS = nil;
-                            NSTimeZone *timeZoneNS = [NSTimeZone localTimeZone];
-                            
-                            // determine and set the date format
-                            switch (stringValueLengthI) {
-                                    
-                                case GWMDBDateStringLengthDateTime:
-                                {
-                                    dateFormatNS = GWMDBDateFormatDateTime;
-                                    timeZoneNS = [NSTimeZone timeZoneWithName:@"UTC"];
-                                    break;
-                                }
-                                case GWMDBDateStringLengthShortDate:
-                                {
-                                    dateFormatNS = GWMDBDateFormatShortDate;
-                                    break;
-                                }
-                                case GWMDBDateStringLengthYearMonth:
-                                {
-                                    dateFormatNS = GWMDBDateFormatYearAndMonth;
-                                    break;
-                                }
-                                case GWMDBDateStringLengthYearOnly:
-                                {
-                                    dateFormatNS = GWMDBDateFormatYear;
-                                    break;
-                                }
-                                default:
-                                    break;
-                            }
-                            
-                            // set the value on the result object
-                            if (stringValueLengthI == GWMDBDateStringLengthYearOnly) {
-                                
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                [obj setValue:stringValueNS forKey:columnNameNS];
-                                
-                            } else {
-                                
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                
-                                NSDate *date = [self dateWithFormat:dateFormatNS string:stringValueNS andTimeZone:timeZoneNS];
-                                
-                                [obj setValue:date forKey:columnNameNS];
-                            }
-                        }
-                        
-                    } else {
-                        
-                        // TODO: sqlite data types IMPROVING
-                        switch (dataTypeI) {
-                            case GWMDBDataTypeInteger:{
-                                
-                                int integerValueI = sqlite3_column_int(sqlite3PreparedStatement, index);
-                                
-                                NSNumber *integerValueNS = nil;
-                                
-                                if (strcmp(declaredDataTypeC, "BOOLEAN") == 0) {
-                                    
-                                    BOOL boolValueB = integerValueI == 0 ? NO : YES;
-                                    
-                                    integerValueNS = [NSNumber numberWithBool:boolValueB];
-                                    
-                                } else {
-                                    
-                                    integerValueNS = [NSNumber numberWithInt:integerValueI];
-                                    
-                                }
-                                
-                                if ([obj respondsToSelector:NSSelectorFromString(columnNameNS)]) {
-                                    [obj setValue:integerValueNS forKey:columnNameNS];
-                                }
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeFloat:{
-                                
-                                float floatValueF = sqlite3_column_double(sqlite3PreparedStatement, index);
-                                NSNumber *floatValueNS = [NSNumber numberWithDouble:floatValueF];
-                                [obj setValue:floatValueNS forKey:columnNameNS];
-                                break;
-                            }
-                            case GWMDBDataTypeText:{
-                                //TODO: check for custom data types: DATE, DATETIME
-                                
-                                char *stringValueC = (char *) sqlite3_column_text(sqlite3PreparedStatement, index);
-                                NSString *stringValueNS = [NSString stringWithUTF8String:stringValueC];
-                                
-                                SEL selectorSEL = NSSelectorFromString(columnNameNS);
-                                
-                                if (![columnNameNS isEqualToString:@"class"]) {
-                                    
-                                    if (strcmp(declaredDataTypeC, "BOOLEAN") == 0) {
-                                        
-                                        NSNumber *integerValueNS = nil;
-                                        
-                                        BOOL boolValueB = ([stringValueNS isEqualToString:@"TRUE"] || [stringValueNS isEqualToString:@"true"]) ? YES : NO;
-                                        
-                                        integerValueNS = [NSNumber numberWithBool:boolValueB];
-                                        
-                                        if ([obj respondsToSelector:NSSelectorFromString(columnNameNS)])
-                                            [obj setValue:integerValueNS forKey:columnNameNS];
-                                        
-                                    } else {
-                                        
-                                        if ([obj respondsToSelector:selectorSEL]) {
-                                            
-                                            [obj setValue:stringValueNS forKey:columnNameNS];
-                                            
-                                        } else {
-                                            //TODO: Need to document why I did the following:
-                                            obj = stringValueNS;
-                                        }
-                                        
-                                    }
-                                    
-                                }
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeBlob:{
-                                
-                                break;
-                            }
-                            case GWMDBDataTypeNull:{
-                                
-                                break;
-                            }
-                                
-                            default:
-                                break;
-                        }
-                    }
-                }
-                
-                [resultArray addObject:obj];
+            if (sqlite3_column_type(sqlite3PreparedStatement, 0) != SQLITE_NULL) {
+                // the bytes stay valid until the statement is stepped again
+                const void *bytes = sqlite3_column_blob(sqlite3PreparedStatement, 0);
+                int length = sqlite3_column_bytes(sqlite3PreparedStatement, 0);
+                data = bytes ? [NSData dataWithBytesNoCopy:(void *)bytes length:(NSUInteger)length freeWhenDone:NO] : [NSData data];
             }
+            
+            block(data, idx++, &stop);
         }
+        
+        if (!stop)
+            stepCode = sqlite3_step(sqlite3PreparedStatement);
     }
     
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errmsg(self.database)];
+    if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(database)];
+        int extendedResultCode = sqlite3_extended_errcode(database);
+        const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
+        databaseResult.resultCode = stepCode;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(stepCode)] = message;
+        databaseResult.extendedResultCode = extendedResultCode;
+        databaseResult.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
+        NSLog(@"*** %@ ***", message);
+    }
+    
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+    
+    // an error from stepping is reported again by reset, it has already been recorded
+    if (finalizeCode != GWMSQLiteResultOK && databaseResult.errors.count == 0) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errstr(finalizeCode)];
         databaseResult.resultCode = finalizeCode;
         databaseResult.resultMessage = message;
         databaseResult.errors[@(finalizeCode)] = message;
         NSLog(@"*** %@ ***", message);
-        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
-        NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
-        @throw exception;
     }
     
-    databaseResult.data = [NSArray arrayWithArray:resultArray];
-    databaseResult.resultCode = prepareCode;
-    databaseResult.resultMessage = [NSString stringWithFormat:@"%s",sqlite3_errmsg(self.database)];
+    return databaseResult;
+}
+
+-(GWMBlobHandle *)blobHandleWithTable:(GWMTableName)table column:(GWMColumnName)column rowID:(NSInteger)rowID readOnly:(BOOL)readOnly error:(NSError **)error
+{
+    [self openDatabase];
     
-    if (completionHandler) {
-        completionHandler();
+    NSArray<NSString*> *tableComponents = [table componentsSeparatedByString:@"."];
+    NSString *schema = tableComponents.count > 1 ? tableComponents.firstObject : GWMSchemaNameMain;
+    NSString *tableName = tableComponents.lastObject;
+    
+    __block sqlite3_blob *blob = NULL;
+    __block int openCode = GWMSQLiteResultOK;
+    
+    dispatch_block_t open = ^{
+        openCode = sqlite3_blob_open(self.database, schema.UTF8String, tableName.UTF8String, column.UTF8String, rowID, readOnly ? 0 : 1, &blob);
+    };
+    
+    // a handle that writes keeps a write transaction open, it has to be opened on the writer queue
+    if (readOnly)
+        open();
+    else
+        [self performWrite:open];
+    
+    if (openCode != GWMSQLiteResultOK) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorOpeningBlob,sqlite3_errstr(openCode)];
+        NSLog(@"*** %@ ***", message);
+        if (error) {
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            *error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+        }
+        sqlite3_blob_close(blob);
+        return nil;
     }
     
-    return databaseResult;
+    return [[GWMBlobHandle alloc] initWithDatabaseController:self blob:blob schema:schema table:tableName rowID:rowID readOnly:readOnly];
 }
 
 #pragma mark Update
@@ -2160,219 +3530,263 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
 
 -(GWMDatabaseResult *)updateTable:(GWMTableName)tableName withValues:(NSDictionary<GWMColumnName,NSObject *> *)newValues criteria:(NSDictionary<GWMColumnName,NSObject *> *)criteria onConflict:(GWMDBOnConflict)onConflict completion:(GWMDatabaseResultBlock)completionHandler
 {
-    // conflict resolution
-    NSString *conflict = [self stringWithConflict:onConflict];
+    __block GWMDatabaseResult *updateResult = nil;
     
-    // create the results object
-    GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
-    __block NSError *error = nil;
-    // assemble the statement
-    NSMutableArray<NSString*> *mutableComponents = [NSMutableArray new];
-    NSMutableArray *mutableValues = [NSMutableArray new];
-    [newValues enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, NSObject *_Nonnull value, BOOL *stop){
-        
-        if ([value isKindOfClass:[NSNull class]]) {
-            NSString *component = [NSString stringWithFormat:@"%@ IS ?", key];
-            [mutableComponents addObject:component];
-            [mutableValues addObject:value];
+    [self performWrite:^{
+        // create the results object
+        GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+        __block NSError *error = nil;
+        
+        // assemble the statement. note: there may or may not be any criteria, each criteria column is matched on its own
+        NSMutableArray<NSArray<GWMColumnName>*> *mutableCriteriaShape = [NSMutableArray new];
+        NSMutableArray<NSDictionary*> *mutableCriteria = [NSMutableArray new];
+        for (GWMColumnName column in [criteria.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            [mutableCriteriaShape addObject:@[column]];
+            [mutableCriteria addObject:criteria];
+        }
+        GWMCompiledQuery *query = [GWMCompiledQuery updateQueryWithTable:tableName columns:newValues.allKeys criteriaShape:mutableCriteriaShape onConflict:onConflict];
+        NSString *statementNS = query.statement;
+        
+        databaseResult.statement = statementNS;
+        
+        // prepare the statement
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:statementNS code:&prepareCode];
+        
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
+            databaseResult.resultCode = prepareCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(prepareCode)] = message;
+            NSLog(@"*** %@ ***", message);
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
+            NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
+            @throw exception;
         } else {
-            NSString *component = [NSString stringWithFormat:@"%@ = ?", key];
-            [mutableComponents addObject:component];
-            [mutableValues addObject:value];
+            // bind the values. the columns values can all be bound.
+            
+            /* bind values to statement */
+            NSArray *valuesToBind = [query valuesWithValues:newValues criteria:mutableCriteria excludedItemIDs:nil];
+            
+            [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
         }
         
-    }];
-    NSString *valuesClause = [mutableComponents componentsJoinedByString:@", "];
-    
-    NSString *statementNS;
-    
-    // note: there may or may not be any criteria
-    NSMutableArray *mutableCriteriaValues = [NSMutableArray new];
-    if (criteria && criteria.count > 0) {
-        NSMutableArray<NSString*> *mutableCriteriaComponents = [NSMutableArray new];
-        [criteria enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, NSObject *_Nonnull value, BOOL *stop){
-            NSString *component = [NSString stringWithFormat:@"%@ = ?", key];
-            [mutableCriteriaComponents addObject:component];
-            [mutableCriteriaValues addObject:value];
-        }];
-        NSString *criteriaClause = [mutableCriteriaComponents componentsJoinedByString:@" OR "];
+        int stepCode = sqlite3_step(sqlite3PreparedStatement);
+        if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
+            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+        };
         
-        statementNS = [NSString stringWithFormat:@"UPDATE %@ %@ SET %@ WHERE %@", conflict, tableName, valuesClause, criteriaClause];
-    } else {
-        statementNS = [NSString stringWithFormat:@"UPDATE %@ %@ SET %@", conflict, tableName, valuesClause];
-    }
-    
-    databaseResult.statement = statementNS;
-    
-    // prepare the statement
-    sqlite3_stmt *sqlite3PreparedStatement;
-    
-    const char *statementC = [statementNS UTF8String];
-    int prepareCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, NULL);
-    
-    if (prepareCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database)];
-        databaseResult.resultCode = prepareCode;
-        databaseResult.resultMessage = message;
-        databaseResult.errors[@(prepareCode)] = message;
-        NSLog(@"*** %@ ***", message);
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
-        NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
-        @throw exception;
-    } else {
-        // bind the values. the columns values can all be bound.
+        // finalize the prepared statement
+        int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        if (finalizeCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+            databaseResult.resultCode = finalizeCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(finalizeCode)] = message;
+            NSLog(@"*** %@ ***", message);
+            NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+            error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+            NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
+            NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
+            @throw exception;
+        }
         
-        /* bind values to statement */
-        NSMutableArray *mutableValuesToBind = [NSMutableArray new];
-        [mutableValuesToBind addObjectsFromArray:mutableValues];
-        [mutableValuesToBind addObjectsFromArray:mutableCriteriaValues];
+        NSString *statement = [NSString stringWithFormat:@"SELECT '%@' AS class, pKey AS itemID FROM %@", NSStringFromClass([GWMDataItem class]), tableName];
         
-        NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
+        //    [self resultWithStatement:statement criteria:@[criteria] exclude:nil limit:1 completion:nil completion:nil];
+        NSArray *criteriaValues = nil;
+        if (criteria)
+            criteriaValues = @[criteria];
+        GWMDatabaseResult *result = [self resultWithStatement:statement criteria:criteriaValues exclude:nil sortBy:@"updated" ascending:NO limit:1 completion:nil];
+        GWMDataItem *obj = result.data.firstObject;
         
-        //        __block int bindCode = GWMSQLiteResultOK;
+        // run completion handler
+        if(completionHandler)
+            completionHandler(obj,error);
         
-        [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
-    }
-    
-    int stepCode = sqlite3_step(sqlite3PreparedStatement);
-    if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone) {
-        NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
-    };
-    
-    // finalize the prepared statement
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
-        databaseResult.resultCode = finalizeCode;
-        databaseResult.resultMessage = message;
-        databaseResult.errors[@(finalizeCode)] = message;
-        NSLog(@"*** %@ ***", message);
-        NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
-        error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
-        NSDictionary *info = @{GWMDBStatementKey:databaseResult.statement};
-        NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
-        @throw exception;
-    }
-    
-    NSString *statement = [NSString stringWithFormat:@"SELECT '%@' AS class, pKey AS itemID FROM %@", NSStringFromClass([GWMDataItem class]), tableName];
-    
-    //    [self resultWithStatement:statement criteria:@[criteria] exclude:nil limit:1 completion:nil completion:nil];
-    NSArray *criteriaValues = nil;
-    if (criteria)
-        criteriaValues = @[criteria];
-    GWMDatabaseResult *result = [self resultWithStatement:statement criteria:criteriaValues exclude:nil sortBy:@"updated" ascending:NO limit:1 completion:nil];
-    GWMDataItem *obj = result.data.firstObject;
-    
-    // run completion handler
-    if(completionHandler)
-        completionHandler(obj,error);
-    
-    return databaseResult;
+        updateResult = databaseResult;
+    }];
     
+    return updateResult;
 }
 
 #pragma mark Delete
 
 -(void)deleteFromTable:(GWMTableName)table criteria:(NSArray<NSDictionary<GWMColumnName,NSObject *> *> *)criteria completion:(GWMDBErrorCompletionBlock)completionHandler
 {
-    //TODO: Implement new delete method
-    NSMutableString *mutableWhereClause = [[NSMutableString alloc] init];
-    
-    // build the WHERE clause
-    NSString *whereClause = nil;
-    NSArray *whereValues = nil;
-    if (criteria) {
+    [self performWrite:^{
+        // the columns of each dictionary are sorted, so the same criteria shape always gives the same statement
+        GWMCompiledQuery *query = [GWMCompiledQuery deleteQueryWithTable:table criteriaShape:[GWMCompiledQuery criteriaShapeWithCriteria:criteria]];
+        NSArray *whereValues = [query valuesWithValues:nil criteria:criteria excludedItemIDs:nil];
+        NSString *statement = query.statement;
         
-        NSMutableArray<NSString*> *mutableOrPredicates = [NSMutableArray<NSString*> new];
-        NSMutableArray<NSString*> *mutableValues = [NSMutableArray<NSString*> new];
+        const char *statementC = [statement UTF8String];
         
-        [criteria enumerateObjectsUsingBlock:^(NSDictionary<NSString*,id> *_Nonnull info, NSUInteger idx, BOOL *stop){
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:statement code:&prepareCode]; // database prepared statment
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
+            NSString *message = [NSString stringWithFormat:@"%s", statementC];
+            NSDictionary *info = @{GWMDBStatementKey:statement};
+            NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
+            @throw exception;
+        }
+        else {
             
-            NSMutableArray<NSString*> *mutableAndPredicates = [NSMutableArray<NSString*> new];
+            BOOL ownsTransaction = [self beginWriteTransaction];
             
-            [info enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull key, id val, BOOL *stop){
-                [mutableValues addObject:val];
-                
-                NSString *predicate = nil;
-                // support other comparisons besides 'equals'
-                if ([key containsString:@"?"])
-                    predicate = key;
-                else
-                    predicate = [NSString stringWithFormat:@"%@ = ?", key];
-                [mutableAndPredicates addObject:predicate];
-            }];
+            GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+            databaseResult.statement = statement;
+            [whereValues enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
             
-            NSString *andPredicate = [[NSArray arrayWithArray:mutableAndPredicates] componentsJoinedByString:@" AND "];
-            [mutableOrPredicates addObject:andPredicate];
+            int stepCode = sqlite3_step(sqlite3PreparedStatement);
             
-        }];
+            if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
+                NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+            
+            [self endWriteTransaction:ownsTransaction];
+            
+        }
         
-        NSString *orPredicate = [[NSArray arrayWithArray:mutableOrPredicates] componentsJoinedByString:@") OR ("];
-        NSString *finalOrPredicate = nil;
-        if (mutableOrPredicates.count > 1)
-            finalOrPredicate = [NSString stringWithFormat:@"(%@)", orPredicate];
-        else
-            finalOrPredicate = orPredicate;
+        int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
+        if (finalizeCode != GWMSQLiteResultOK) {
+            NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+            NSString *message = [NSString stringWithFormat:@"%s", statementC];
+            NSDictionary *info = @{GWMDBStatementKey:statement};
+            NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
+            @throw exception;
+        }
         
-        whereClause = [NSString stringWithFormat:@" WHERE %@", finalOrPredicate];
-        whereValues = [NSArray arrayWithArray:mutableValues];
+        if(completionHandler)
+            completionHandler(nil);
+    }];
+}
+
+-(void)deleteFromTable:(GWMTableName)table matchingColumns:(NSArray<GWMColumnName> *)columns values:(NSArray<NSArray *> *)rows chunkSize:(NSUInteger)chunkSize completion:(GWMDBBulkDeleteCompletionBlock)completion
+{
+    [self performWrite:^{
         
-        [mutableWhereClause appendString:whereClause];
-    }
-    
-    NSMutableString *mutableStatement = [[NSMutableString alloc] init];
-    
-    [mutableStatement appendString:[NSString stringWithFormat:@"DELETE FROM %@ ",table]];
-    
-    if (whereClause) {
-        [mutableStatement appendString:whereClause];
-    }
-    
-    NSString *statement = [NSString stringWithString:mutableStatement];
-    
-    sqlite3_stmt *sqlite3PreparedStatement; // database prepared statment
-    
-    const char *statementC = [statement UTF8String];
-    
-    int prepareCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, NULL);
-    if (prepareCode != GWMSQLiteResultOK) {
-        NSLog(@"%@: %s", GWMSQLiteErrorPreparingStatement, sqlite3_errmsg(self.database));
-        NSString *message = [NSString stringWithFormat:@"%s", statementC];
-        NSDictionary *info = @{GWMDBStatementKey:statement};
-        NSException *exception = [NSException exceptionWithName:GWMPreparingStatementException reason:message userInfo:info];
-        @throw exception;
-    }
-    else {
+        NSMutableDictionary<NSNumber*,NSError*> *mutableRowErrors = [NSMutableDictionary<NSNumber*,NSError*> new];
+        NSError *error = nil;
+        NSUInteger deletedCount = 0;
         
-        sqlite3_exec(self.database, "BEGIN TRANSACTION", NULL, NULL, NULL);
+        // keep every statement under the limit on bound parameters
+        NSUInteger columnCount = MAX(columns.count, (NSUInteger)1);
+        NSUInteger maximumChunkSize = MAX((NSUInteger)sqlite3_limit(self.database, SQLITE_LIMIT_VARIABLE_NUMBER, -1) / columnCount, (NSUInteger)1);
+        NSUInteger rowsPerStatement = chunkSize > 0 ? MIN(chunkSize, maximumChunkSize) : maximumChunkSize;
         
-        GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
-        databaseResult.statement = statement;
-        [whereValues enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+        // one column is matched with IN (?,...), several with a row value IN (VALUES (?,?),...)
+        NSString *rowPlaceholder = nil;
+        NSString *matchedColumns = nil;
+        if (columns.count == 1) {
+            rowPlaceholder = @"?";
+            matchedColumns = columns.firstObject;
+        } else {
+            NSMutableArray<NSString*> *mutablePlaceholders = [NSMutableArray<NSString*> new];
+            for (NSUInteger columnIdx = 0; columnIdx < columns.count; columnIdx++)
+                [mutablePlaceholders addObject:@"?"];
+            rowPlaceholder = [NSString stringWithFormat:@"(%@)", [mutablePlaceholders componentsJoinedByString:@","]];
+            matchedColumns = [NSString stringWithFormat:@"(%@)", [columns componentsJoinedByString:@","]];
+        }
         
-        int stepCode = sqlite3_step(sqlite3PreparedStatement);
+        BOOL ownsTransaction = sqlite3_get_autocommit(self.database) != 0;
+        if (ownsTransaction) {
+            int beginCode = sqlite3_exec(self.database, "BEGIN IMMEDIATE TRANSACTION", NULL, NULL, NULL);
+            // without the transaction the chunks would be deleted one by one
+            if (beginCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database)];
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                if (completion)
+                    completion(0, nil, error);
+                return;
+            }
+        }
         
-        if (stepCode != GWMSQLiteResultRow && stepCode != GWMSQLiteResultDone)
-            NSLog(@"%@: %s", GWMSQLiteErrorSteppingToRow, sqlite3_errmsg(self.database));
+        for (NSUInteger location = 0; location < rows.count; location += rowsPerStatement) {
+            
+            @autoreleasepool {
+                
+                NSRange chunkRange = NSMakeRange(location, MIN(rowsPerStatement, rows.count - location));
+                NSArray<NSArray*> *chunk = [rows subarrayWithRange:chunkRange];
+                
+                NSMutableArray<NSString*> *mutableRowPlaceholders = [NSMutableArray<NSString*> new];
+                NSMutableArray *mutableValuesToBind = [NSMutableArray new];
+                for (NSArray *row in chunk) {
+                    [mutableRowPlaceholders addObject:rowPlaceholder];
+                    [mutableValuesToBind addObjectsFromArray:row];
+                }
+                
+                NSString *statement = nil;
+                if (columns.count == 1)
+                    statement = [NSString stringWithFormat:@"DELETE FROM %@ WHERE %@ IN (%@)", table, matchedColumns, [mutableRowPlaceholders componentsJoinedByString:@","]];
+                else
+                    statement = [NSString stringWithFormat:@"DELETE FROM %@ WHERE %@ IN (VALUES %@)", table, matchedColumns, [mutableRowPlaceholders componentsJoinedByString:@","]];
+                
+                GWMDatabaseResult *databaseResult = [[GWMDatabaseResult alloc] init];
+                databaseResult.statement = statement;
+                
+                int prepareCode = GWMSQLiteResultOK;
+                sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:statement code:&prepareCode];
+                
+                NSString *message = nil;
+                if (prepareCode != GWMSQLiteResultOK) {
+                    message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),statement];
+                } else {
+                    [mutableValuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+                    
+                    if (databaseResult.resultCode != GWMSQLiteResultOK) {
+                        message = databaseResult.resultMessage;
+                    } else {
+                        int stepCode = sqlite3_step(sqlite3PreparedStatement);
+                        if (stepCode != GWMSQLiteResultDone)
+                            message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                        else
+                            deletedCount += (NSUInteger)sqlite3_changes(self.database);
+                    }
+                }
+                
+                [self relinquishPreparedStatement:sqlite3PreparedStatement];
+                
+                // every row of a failed statement is reported
+                if (message) {
+                    NSLog(@"*** %@ ***", message);
+                    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                    NSError *chunkError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                    for (NSUInteger idx = chunkRange.location; idx < NSMaxRange(chunkRange); idx++)
+                        mutableRowErrors[@(idx)] = chunkError;
+                }
+                
+                if (ownsTransaction && sqlite3_get_autocommit(self.database)) {
+                    NSString *rollbackMessage = [NSString stringWithFormat:@"%@: the transaction was rolled back, no rows were deleted", GWMSQLiteErrorExecutingStatement];
+                    NSLog(@"*** %@ ***", rollbackMessage);
+                    NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:rollbackMessage};
+                    error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                    deletedCount = 0;
+                    ownsTransaction = NO;
+                    break;
+                }
+            }
+        }
         
-        sqlite3_exec(self.database, "END TRANSACTION", NULL, NULL, NULL);
+        if (ownsTransaction) {
+            int commitCode = sqlite3_exec(self.database, "COMMIT TRANSACTION", NULL, NULL, NULL);
+            if (commitCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorExecutingStatement,sqlite3_errmsg(self.database)];
+                NSLog(@"*** %@ ***", message);
+                NSDictionary *errorInfo = @{NSLocalizedDescriptionKey:message};
+                error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:errorInfo];
+                deletedCount = 0;
+                sqlite3_exec(self.database, "ROLLBACK TRANSACTION", NULL, NULL, NULL);
+            }
+        }
         
-    }
-    
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
-    if (finalizeCode != GWMSQLiteResultOK) {
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
-        NSString *message = [NSString stringWithFormat:@"%s", statementC];
-        NSDictionary *info = @{GWMDBStatementKey:statement};
-        NSException *exception = [NSException exceptionWithName:GWMFinalizingStatementException reason:message userInfo:info];
-        @throw exception;
-    }
-    
-    if(completionHandler)
-        completionHandler(nil);
-    
+        if (completion)
+            completion(deletedCount, mutableRowErrors.count > 0 ? [NSDictionary dictionaryWithDictionary:mutableRowErrors] : nil, error);
+    }];
 }
 
 //int callback(void *arg, int argc, char **argv, char **colName) {
@@ -2384,6 +3798,67 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
 //    return 0;
 //}
 
+#pragma mark Compiled Queries
+
+-(GWMDatabaseResult *)performCompiledQuery:(GWMCompiledQuery *)query values:(NSDictionary<GWMColumnName,id> *)values criteria:(NSArray<NSDictionary<GWMColumnName,id> *> *)criteria completion:(GWMDBErrorCompletionBlock)completionHandler
+{
+    GWMDatabaseResult *databaseResult = [GWMDatabaseResult new];
+    databaseResult.statement = query.statement;
+    
+    NSArray *valuesToBind = [query valuesWithValues:values criteria:criteria excludedItemIDs:nil];
+    
+    if (!valuesToBind || query.kind == GWMCompiledQuerySelect) {
+        NSString *message = [NSString stringWithFormat:@"%@: the criteria do not match the compiled query", GWMSQLiteErrorExecutingStatement];
+        databaseResult.resultCode = GWMSQLiteResultError;
+        databaseResult.resultMessage = message;
+        databaseResult.errors[@(GWMSQLiteResultError)] = message;
+        NSLog(@"*** %@ ***", message);
+        if (completionHandler)
+            completionHandler([NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}]);
+        return databaseResult;
+    }
+    
+    [self performWrite:^{
+        
+        int prepareCode = GWMSQLiteResultOK;
+        sqlite3_stmt *sqlite3PreparedStatement = [self preparedStatementWithString:query.statement code:&prepareCode];
+        
+        if (prepareCode != GWMSQLiteResultOK) {
+            NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorPreparingStatement,sqlite3_errmsg(self.database),query.statement];
+            databaseResult.resultCode = prepareCode;
+            databaseResult.resultMessage = message;
+            databaseResult.errors[@(prepareCode)] = message;
+            NSLog(@"*** %@ ***", message);
+        } else {
+            
+            [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:databaseResult preparedStatement:sqlite3PreparedStatement]];
+            
+            int stepCode = GWMSQLiteResultError;
+            if (databaseResult.resultCode == GWMSQLiteResultOK)
+                stepCode = sqlite3_step(sqlite3PreparedStatement);
+            
+            if (stepCode != GWMSQLiteResultDone && databaseResult.resultCode == GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(self.database)];
+                databaseResult.resultCode = stepCode;
+                databaseResult.resultMessage = message;
+                databaseResult.errors[@(stepCode)] = message;
+                NSLog(@"*** %@ ***", message);
+            }
+        }
+        
+        [self relinquishPreparedStatement:sqlite3PreparedStatement];
+    }];
+    
+    if (completionHandler) {
+        NSError *error = nil;
+        if (databaseResult.errors.count > 0)
+            error = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:databaseResult.resultMessage}];
+        completionHandler(error);
+    }
+    
+    return databaseResult;
+}
+
 #pragma mark - Convenience
 
 -(void)migrateDataFromTable:(GWMTableName)fromTable fromSchema:(GWMSchemaName)fromSchema toTable:(GWMTableName)toTable toSchema:(GWMSchemaName)toSchema columns:(NSDictionary<GWMColumnName,GWMColumnName> *)columnInfo values:(NSDictionary<GWMColumnName,id> * _Nullable)valueInfo completion:(GWMDBErrorCompletionBlock _Nullable)completionHandler
@@ -2458,38 +3933,168 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
 
 #pragma mark - Transactions
 
--(BOOL)applyStatements:(NSArray<NSString *> *)statements identifier:(NSString *)identifier completion:(GWMDBCompletionBlock)completion
+-(BOOL)performTransaction:(void (^)(GWMTransaction *transaction))block error:(NSError **)error
 {
-    if(!statements)
-        return NO;
+    return [self performTransactionWithMode:GWMTransactionModeImmediate block:block error:error];
+}
 
-    self.transactionName = identifier;
-    self.isTransactionInProgress = YES;
+-(BOOL)performTransactionWithMode:(GWMTransactionMode)mode block:(void (^)(GWMTransaction *transaction))block error:(NSError **)error
+{
+    [self openDatabase];
     
-    NSMutableArray *mutableStatements = [NSMutableArray new];
+    __block BOOL committed = NO;
+    __block NSError *transactionError = nil;
     
-    [mutableStatements addObject:@"BEGIN TRANSACTION"];
-    [mutableStatements addObjectsFromArray:statements];
-    [mutableStatements addObject:@"END TRANSACTION"];
+    [self performWrite:^{
+        NSError *scopeError = nil;
+        committed = [self runTransactionWithMode:mode block:block error:&scopeError];
+        transactionError = scopeError;
+    }];
     
-    NSString *statement = [mutableStatements componentsJoinedByString:@";"];
+    if (error)
+        *error = transactionError;
     
-    char *errorMessageC;
-    NSLog(@"*** Transaction started: '%@' ***", identifier);
-    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    return committed;
+}
 
-    if (executeCode != GWMSQLiteResultOK) {
-        NSString *message = [NSString stringWithFormat:@"%@: '%@' Message: %s Database: '%@'", GWMSQLiteErrorExecutingStatement, identifier, errorMessageC, self.databasePath];
-        NSLog(@"%@", message);
-        sqlite3_free(errorMessageC);
-        NSDictionary *info = @{GWMDBStatementKey:statement};
-        NSException *exception = [NSException exceptionWithName:GWMExecutingStatementException reason:message userInfo:info];
-        @throw exception;
+-(BOOL)runTransactionWithMode:(GWMTransactionMode)mode block:(void (^)(GWMTransaction *transaction))block error:(NSError **)error
+{
+    GWMTransaction *outerTransaction = self.transactionStack.firstObject;
+    NSUInteger depth = self.transactionStack.count;
+    
+    // a transaction begun with BEGIN outside performTransaction is joined with a savepoint too
+    BOOL isSavepoint = !sqlite3_get_autocommit(self.database);
+    NSString *name = [NSString stringWithFormat:@"GWMSavepoint%lu", (unsigned long)depth];
+    GWMTransaction *transaction = [[GWMTransaction alloc] initWithName:name mode:outerTransaction ? outerTransaction.mode : mode depth:depth isSavepoint:isSavepoint];
+    
+    NSError *beginError = [self executeTransactionStatement:[transaction beginStatement]];
+    if (beginError) {
+        if (error)
+            *error = beginError;
+        return NO;
     }
-    NSLog(@"*** Transaction finished: '%@' ***", identifier);
     
-    self.isTransactionInProgress = NO;
-    self.transactionName = nil;
+    // the rollback hook is not called when a savepoint is rolled back
+    NSUInteger changeMark = [self.changeRecorder mark];
+    
+    [self.transactionStack addObject:transaction];
+    if (depth == 0) {
+        self.transactionName = name;
+        self.isTransactionInProgress = YES;
+    }
+    
+    NSException *blockException = nil;
+    @try {
+        block(transaction);
+    } @catch (NSException *exception) {
+        blockException = exception;
+    }
+    
+    [self.transactionStack removeLastObject];
+    if (depth == 0) {
+        self.isTransactionInProgress = NO;
+        self.transactionName = nil;
+    }
+    
+    NSError *transactionError = nil;
+    
+    if (sqlite3_get_autocommit(self.database)) {
+        // errors such as SQLITE_FULL roll back the whole transaction without a ROLLBACK statement
+        NSString *message = [NSString stringWithFormat:@"%@: transaction '%@' was rolled back by SQLite: %s", GWMSQLiteErrorExecutingStatement, name, sqlite3_errmsg(self.database)];
+        NSLog(@"*** %@ ***", message);
+        transactionError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+        [self clearIdentityMap];
+        [self clearResultCache];
+    } else if (blockException || transaction.isRolledBack) {
+        transactionError = transaction.error;
+        if (blockException && !transactionError) {
+            NSString *message = [NSString stringWithFormat:@"%@: transaction '%@' was rolled back: %@", GWMSQLiteErrorExecutingStatement, name, blockException.reason];
+            transactionError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+        }
+        if ([self executeTransactionStatement:[transaction rollbackStatement]] == nil && transaction.isSavepoint)
+            [self.changeRecorder rollbackToMark:changeMark];
+        // rows read inside the scope can hold values that were never committed
+        [self clearIdentityMap];
+        [self clearResultCache];
+    } else {
+        transactionError = [self executeTransactionStatement:[transaction commitStatement]];
+        if (transactionError && !sqlite3_get_autocommit(self.database)) {
+            [self executeTransactionStatement:[transaction rollbackStatement]];
+            [self clearIdentityMap];
+            [self clearResultCache];
+        }
+    }
+    
+    if (blockException)
+        @throw blockException;
+    
+    if (error)
+        *error = transactionError;
+    
+    return transactionError == nil && !transaction.isRolledBack;
+}
+
+-(NSError *)executeTransactionStatement:(NSString *)statement
+{
+    char *errorMessageC = NULL;
+    int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+    
+    if (executeCode == GWMSQLiteResultOK)
+        return nil;
+    
+    NSString *message = [NSString stringWithFormat:@"%@: %s sql: %@", GWMSQLiteErrorExecutingStatement, errorMessageC, statement];
+    NSLog(@"*** %@ ***", message);
+    sqlite3_free(errorMessageC);
+    
+    return [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+}
+
+-(BOOL)beginWriteTransaction
+{
+    // a write inside performTransaction joins the enclosing transaction
+    if (!sqlite3_get_autocommit(self.database))
+        return NO;
+    
+    return [self executeTransactionStatement:@"BEGIN TRANSACTION"] == nil;
+}
+
+-(void)endWriteTransaction:(BOOL)ownsTransaction
+{
+    if (!ownsTransaction || sqlite3_get_autocommit(self.database))
+        return;
+    
+    if ([self executeTransactionStatement:@"COMMIT TRANSACTION"])
+        [self executeTransactionStatement:@"ROLLBACK TRANSACTION"];
+}
+
+-(BOOL)applyStatements:(NSArray<NSString *> *)statements identifier:(NSString *)identifier completion:(GWMDBCompletionBlock)completion
+{
+    if(!statements)
+        return NO;
+
+    NSLog(@"*** Transaction started: '%@' ***", identifier);
+    
+    // a failing statement throws, which rolls the transaction back
+    [self performTransaction:^(GWMTransaction *transaction){
+        if (transaction.depth == 0)
+            self.transactionName = identifier;
+        
+        for (NSString *statement in statements) {
+            char *errorMessageC = NULL;
+            int executeCode = sqlite3_exec(self.database, statement.UTF8String, NULL, NULL, &errorMessageC);
+            
+            if (executeCode != GWMSQLiteResultOK) {
+                NSString *message = [NSString stringWithFormat:@"%@: '%@' Message: %s Database: '%@'", GWMSQLiteErrorExecutingStatement, identifier, errorMessageC, self.databasePath];
+                NSLog(@"%@", message);
+                sqlite3_free(errorMessageC);
+                NSDictionary *info = @{GWMDBStatementKey:statement};
+                NSException *exception = [NSException exceptionWithName:GWMExecutingStatementException reason:message userInfo:info];
+                @throw exception;
+            }
+        }
+    } error:nil];
+    
+    NSLog(@"*** Transaction finished: '%@' ***", identifier);
 
     if(completion)
         completion();
@@ -2501,34 +4106,19 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
 {
     NSInteger qty = 0;
     
-    NSMutableString *mutableStatement = [NSMutableString stringWithFormat:@"SELECT count(%@) FROM %@ ",column,table];
-    GWMWhereClauseItem *container = [self whereClauseWithCriteria:criteria];
-    if(criteria){
-        
-        NSString *whereClause = container.whereClause;
-        [mutableStatement appendString:whereClause];
-    }
-    
-    NSString *statement = [NSString stringWithString:mutableStatement];
-    
-    const char *statementC = [statement UTF8String];
-    
-    sqlite3_stmt *sqlite3PreparedStatement;
+    NSString *countColumn = [NSString stringWithFormat:@"count(%@)", column];
+    GWMCompiledQuery *query = [GWMCompiledQuery queryWithTable:table columns:@[countColumn] criteriaShape:[GWMCompiledQuery criteriaShapeWithCriteria:criteria] sortBy:nil ascending:YES limit:0];
+    NSString *statement = query.statement;
     
     int dbReturnCode; // database return code
     
-    
-    dbReturnCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, nil);
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&dbReturnCode database:&database];
     if (dbReturnCode == SQLITE_OK) {
         
         /* bind values to statement */
-        NSMutableArray *mutableValuesToBind = [NSMutableArray new];
-        if(container.whereValues)
-            [mutableValuesToBind addObjectsFromArray:container.whereValues];
+        NSArray *valuesToBind = [query valuesWithValues:nil criteria:criteria excludedItemIDs:nil];
         
-        NSArray *valuesToBind = [NSArray arrayWithArray:mutableValuesToBind];
-        
-        //        __block int bindCode = GWMSQLiteResultOK;
         GWMDatabaseResult *result = [GWMDatabaseResult new];
         [valuesToBind enumerateObjectsUsingBlock:[self bindValuesEnumerationBlockWithResult:result preparedStatement:sqlite3PreparedStatement]];
         
@@ -2538,10 +4128,10 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
         }
     }
     
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
     
     if (finalizeCode != SQLITE_OK) {
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(database));
     }
     
     return qty;
@@ -2553,14 +4143,10 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
     
     NSInteger qty = 0;
     
-    const char *statementC = [statement UTF8String];
-    
-    sqlite3_stmt *sqlite3PreparedStatement;
-    
     int dbReturnCode; // database return code
     
-    
-    dbReturnCode = sqlite3_prepare_v2(self.database, statementC, -1, &sqlite3PreparedStatement, nil);
+    sqlite3 *database = NULL;
+    sqlite3_stmt *sqlite3PreparedStatement = [self readerStatementWithString:statement code:&dbReturnCode database:&database];
     if (dbReturnCode == SQLITE_OK)
     {
         while (sqlite3_step(sqlite3PreparedStatement) == SQLITE_ROW)
@@ -2570,10 +4156,10 @@ NSString * const GWMPK_UserDatabaseSchemaVersion = @"GWMPK_UserDatabaseSchemaVer
         }
     }
     
-    int finalizeCode = sqlite3_finalize(sqlite3PreparedStatement);
+    int finalizeCode = [self relinquishPreparedStatement:sqlite3PreparedStatement];
     
     if (finalizeCode != SQLITE_OK) {
-        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(self.database));
+        NSLog(@"%@: %s", GWMSQLiteErrorFinalizingStatement, sqlite3_errmsg(database));
     }
     
     return qty;
@@ -0,0 +1,47 @@
+//
+//  GWMDatabaseCursor.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+@class GWMDatabaseResult;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMDatabaseCursor
+ * @discussion An enumerator over the rows of a query. Rows are stepped and mapped one at a time as they are asked for, so only the rows the caller is holding on to are in memory. Rows are mapped to objects the same way resultWithStatement:criteria:completion: maps them. You get a cursor from a GWMDatabaseController with cursorWithStatement:criteria:. A cursor keeps its prepared statement, and the reader connection it was prepared on, until it has returned its last row or is closed, so close a cursor you are done with before closing the database. Rows that can't be mapped to an object are skipped and counted in skippedRowCount.
+ */
+@interface GWMDatabaseCursor : NSEnumerator
+
+///@discussion Holds the statement and any SQLite errors. Its data property is always nil; the rows are returned by the cursor.
+@property (nonatomic, readonly) GWMDatabaseResult *result;
+///@discussion The number of rows returned so far.
+@property (nonatomic, readonly) NSUInteger rowCount;
+///@discussion The number of rows skipped so far because they could not be mapped to an object, for example because the class named by the row does not exist.
+@property (nonatomic, readonly) NSUInteger skippedRowCount;
+///@discussion YES once the last row has been returned, an error occurred or the cursor was closed.
+@property (nonatomic, readonly) BOOL isClosed;
+
+-(instancetype)init NS_UNAVAILABLE;
+/*!
+ * @discussion Steps to the next row and returns it.
+ * @return The object for the next row or nil if there are no more rows.
+ */
+-(id _Nullable)nextObject;
+/*!
+ * @discussion Steps through up to count rows. Temporary objects created while mapping the rows are released before this method returns.
+ * @param count The largest number of rows to return.
+ * @return An NSArray with the objects for the rows. The array is empty when there are no more rows.
+ */
+-(NSArray *)nextObjectsWithCount:(NSUInteger)count;
+///@discussion Gives the prepared statement back to the database controller. A cursor is closed automatically after its last row.
+-(void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,143 @@
+//
+//  GWMDatabaseCursor.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMDatabaseCursor.h"
+#import "GWMDatabaseController.h"
+#import "GWMDatabaseResult.h"
+#import "GWMRowMappingPlan.h"
+
+@interface GWMDatabaseController (GWMDatabaseCursor)
+
+-(int)relinquishPreparedStatement:(sqlite3_stmt *)sqlite3PreparedStatement;
+-(id _Nullable)objectWithRowOfStatement:(sqlite3_stmt *)sqlite3PreparedStatement rowMappingPlan:(GWMRowMappingPlan *)rowMappingPlan identityMapGeneration:(NSUInteger)identityMapGeneration;
+-(NSUInteger)identityMapGeneration;
+
+@end
+
+@interface GWMDatabaseCursor ()
+{
+    sqlite3_stmt *_preparedStatement;
+}
+
+@property (nonatomic, strong) GWMDatabaseController *databaseController;
+@property (nonatomic, strong) GWMRowMappingPlan *rowMappingPlan;
+///@discussion The identity map generation when the cursor was created, rows read after a write are not cached.
+@property (nonatomic, assign) NSUInteger identityMapGeneration;
+@property (nonatomic, readwrite) NSUInteger rowCount;
+@property (nonatomic, readwrite) NSUInteger skippedRowCount;
+@property (nonatomic, readwrite) BOOL isClosed;
+
+@end
+
+@implementation GWMDatabaseCursor
+
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController preparedStatement:(sqlite3_stmt *)preparedStatement rowMappingPlan:(GWMRowMappingPlan *)rowMappingPlan result:(GWMDatabaseResult *)result
+{
+    if (self = [super init]) {
+        _databaseController = databaseController;
+        _preparedStatement = preparedStatement;
+        _rowMappingPlan = rowMappingPlan;
+        _result = result;
+        _identityMapGeneration = [databaseController identityMapGeneration];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    [self close];
+}
+
+-(id)nextObject
+{
+    // a row that can't be mapped is skipped, nil would end the enumeration
+    while (!self.isClosed) {
+        id obj = [self nextRowObject];
+        if (obj)
+            return obj;
+    }
+    return nil;
+}
+
+///@discussion Steps to the next row and maps it. Returns nil, without closing the cursor, when the row can't be mapped.
+-(id)nextRowObject
+{
+    int stepCode = sqlite3_step(_preparedStatement);
+
+    if (stepCode == GWMSQLiteResultDone) {
+        [self close];
+        return nil;
+    }
+
+    if (stepCode != GWMSQLiteResultRow) {
+
+        sqlite3 *database = sqlite3_db_handle(_preparedStatement);
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorSteppingToRow,sqlite3_errmsg(database)];
+        int extendedResultCode = sqlite3_extended_errcode(database);
+        const char *extendedResultMessageC = sqlite3_errstr(extendedResultCode);
+        self.result.resultCode = stepCode;
+        self.result.resultMessage = message;
+        self.result.errors[@(stepCode)] = message;
+        self.result.extendedResultCode = extendedResultCode;
+        self.result.extendedResultMessage = [NSString stringWithUTF8String:extendedResultMessageC];
+        NSLog(@"*** %@ ***", message);
+
+        [self close];
+        return nil;
+    }
+
+    id obj = [self.databaseController objectWithRowOfStatement:_preparedStatement rowMappingPlan:self.rowMappingPlan identityMapGeneration:self.identityMapGeneration];
+
+    if (obj)
+        self.rowCount++;
+    else
+        self.skippedRowCount++;
+
+    return obj;
+}
+
+-(NSArray *)nextObjectsWithCount:(NSUInteger)count
+{
+    NSMutableArray *mutableObjects = [NSMutableArray new];
+
+    @autoreleasepool {
+        while (mutableObjects.count < count) {
+            id obj = [self nextObject];
+            if (!obj)
+                break;
+            [mutableObjects addObject:obj];
+        }
+    }
+
+    return [NSArray arrayWithArray:mutableObjects];
+}
+
+-(void)close
+{
+    if (self.isClosed)
+        return;
+
+    self.isClosed = YES;
+
+    if (self.skippedRowCount > 0)
+        NSLog(@"*** %lu rows could not be mapped to an object and were skipped: '%@' ***", (unsigned long)self.skippedRowCount, self.result.statement);
+
+    int finalizeCode = [self.databaseController relinquishPreparedStatement:_preparedStatement];
+    _preparedStatement = NULL;
+
+    // an error from stepping is reported again by reset, it has already been recorded
+    if (finalizeCode != GWMSQLiteResultOK && self.result.errors.count == 0) {
+        NSString *message = [NSString stringWithFormat:@"%@: %s", GWMSQLiteErrorFinalizingStatement,sqlite3_errstr(finalizeCode)];
+        self.result.resultCode = finalizeCode;
+        self.result.resultMessage = message;
+        self.result.errors[@(finalizeCode)] = message;
+        NSLog(@"*** %@ ***", message);
+    }
+}
+
+@end
@@ -51,6 +51,14 @@ typedef NS_ENUM(NSInteger, GWMConstraintStyle) {
     GWMConstraintForeignKey
 };
 
+typedef NS_ENUM(NSInteger, GWMAggregateFunction) {
+    GWMAggregateCount = 0,
+    GWMAggregateSum,
+    GWMAggregateAverage,
+    GWMAggregateMinimum,
+    GWMAggregateMaximum
+};
+
 typedef NS_ENUM(NSInteger, GWMDBOnConflict) {
     GWMDBOnConflictRollback = 0,
     GWMDBOnConflictAbort,
@@ -106,6 +114,40 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+/*!
+ * @class GWMAggregateDefinition
+ * @discussion An instance of GWMAggregateDefinition describes a value computed from the rows of another table that refer to a record, such as the number of its relationships or the latest updateDate among them. The value is selected with the record by a correlated subquery, so it is read without loading the related rows. The subquery matches foreignKeyColumn against the primary key of the record, so foreignKeyColumn should be the first column of an index.
+ */
+@interface GWMAggregateDefinition : NSObject
+
+///@discussion An NSString representation of the object property the value maps to. A property whose name contains 'Date' is read as a date.
+@property (nonatomic, readonly) NSString *property;
+///@discussion The aggregate function. Choices are COUNT, SUM, AVG, MIN, or MAX.
+@property (nonatomic, readonly) GWMAggregateFunction function;
+///@discussion The column of table the function is applied to. For GWMAggregateCount nil counts every row. Other functions need a column.
+@property (nonatomic, readonly) GWMColumnName _Nullable column;
+///@discussion The table that holds the related rows.
+@property (nonatomic, readonly) GWMTableName table;
+///@discussion The column of table that holds the primary key of the record, such as the itemKey of a relationship table.
+@property (nonatomic, readonly) GWMColumnName foreignKeyColumn;
+///@discussion The value can be included in a list or detail or both.
+@property (nonatomic, readonly) GWMColumnInclusion include;
+///@discussion For GWMAggregateCount, the key of the collection property that holds the related items. countOfRelatedItemsForKey: returns the value of property for this key instead of loading the collection. Can be nil.
+@property (nonatomic, readonly) NSString *_Nullable collectionKey;
+
++(instancetype)aggregateDefinitionWithProperty:(NSString *)property function:(GWMAggregateFunction)function column:(GWMColumnName _Nullable)column table:(GWMTableName)table foreignKeyColumn:(GWMColumnName)foreignKeyColumn include:(GWMColumnInclusion)include collectionKey:(NSString *_Nullable)collectionKey;
+
+-(instancetype)initWithProperty:(NSString *)property function:(GWMAggregateFunction)function column:(GWMColumnName _Nullable)column table:(GWMTableName)table foreignKeyColumn:(GWMColumnName)foreignKeyColumn include:(GWMColumnInclusion)include collectionKey:(NSString *_Nullable)collectionKey;
+/*!
+ * @discussion Builds the SQLite SELECT substring of the value.
+ * @param alias The alias of the table of the records.
+ * @param primaryKeyColumn The primary key column of the table of the records.
+ * @return An NSString such as (SELECT COUNT(*) FROM table WHERE table.foreignKeyColumn = alias.primaryKeyColumn) AS property.
+ */
+-(NSString *)selectStringWithTableAlias:(GWMTableAlias)alias primaryKeyColumn:(GWMColumnName)primaryKeyColumn;
+
+@end
+
 /*!
  * @class GWMTableConstraintDefinition
  * @discussion An instance of GWMTableConstraintDefinition contains information for constructing a table constraint.
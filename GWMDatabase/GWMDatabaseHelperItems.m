@@ -86,6 +86,59 @@
 
 @end
 
+@implementation GWMAggregateDefinition
+
++(instancetype)aggregateDefinitionWithProperty:(NSString *)property function:(GWMAggregateFunction)function column:(GWMColumnName)column table:(GWMTableName)table foreignKeyColumn:(GWMColumnName)foreignKeyColumn include:(GWMColumnInclusion)include collectionKey:(NSString *)collectionKey
+{
+    return [[self alloc] initWithProperty:property function:function column:column table:table foreignKeyColumn:foreignKeyColumn include:include collectionKey:collectionKey];
+}
+
+-(instancetype)initWithProperty:(NSString *)property function:(GWMAggregateFunction)function column:(GWMColumnName)column table:(GWMTableName)table foreignKeyColumn:(GWMColumnName)foreignKeyColumn include:(GWMColumnInclusion)include collectionKey:(NSString *)collectionKey
+{
+    if (self = [super init]) {
+        _property = property;
+        _function = function;
+        _column = column;
+        _table = table;
+        _foreignKeyColumn = foreignKeyColumn;
+        _include = include;
+        _collectionKey = collectionKey;
+    }
+    return self;
+}
+
+-(NSString *)selectStringWithTableAlias:(GWMTableAlias)alias primaryKeyColumn:(GWMColumnName)primaryKeyColumn
+{
+    NSString *function = nil;
+    switch (self.function) {
+        case GWMAggregateCount:
+            function = @"COUNT";
+            break;
+        case GWMAggregateSum:
+            function = @"SUM";
+            break;
+        case GWMAggregateAverage:
+            function = @"AVG";
+            break;
+        case GWMAggregateMinimum:
+            function = @"MIN";
+            break;
+        case GWMAggregateMaximum:
+            function = @"MAX";
+            break;
+        default:
+            function = @"COUNT";
+            break;
+    }
+    
+    NSString *argument = self.column ? [NSString stringWithFormat:@"%@.%@", self.table, self.column] : @"*";
+    
+    // the table is not aliased, so it is matched inside the subquery even when it is the table of the records
+    return [NSString stringWithFormat:@"(SELECT %@(%@) FROM %@ WHERE %@.%@ = %@.%@) AS %@", function, argument, self.table, self.table, self.foreignKeyColumn, alias, primaryKeyColumn, self.property];
+}
+
+@end
+
 @implementation GWMTableConstraintDefinition
 
 +(instancetype)tableConstraintWithName:(GWMConstraintName)name style:(GWMConstraintStyle)style columns:(NSArray<GWMColumnName> *)columns referenceTable:(GWMTableName _Nullable)refTable referenceColumn:(GWMColumnName _Nullable)refColumn onConflict:(GWMDBOnConflict)onConflict
@@ -43,6 +43,8 @@ NS_ASSUME_NONNULL_BEGIN
 @property NSString *_Nullable extendedResultMessage;
 ///@discussion The extended result code returned from SQLite.
 @property NSInteger extendedResultCode;
+///@discussion For a page read with pageOfItemsOfClass:criteria:sortBy:ascending:pageSize:continuationToken:, the token that reads the next page, or nil if this is the last page.
+@property NSString *_Nullable continuationToken;
 ///@discussion An NSMutableDictionary containing errors from SQLite where the key is the code and the value is the message.
 @property (nonatomic, readonly) NSMutableDictionary<NSNumber*,NSString*> *errors;
 
@@ -0,0 +1,44 @@
+//
+//  GWMDateCoding.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ Decoding and encoding of the date strings stored in the database. These work directly on the bytes SQLite returns, without creating a NSString or going through a NSDateFormatter, and are safe to call from any thread.
+
+ The strings use the GWMDBDateFormat layouts with the Gregorian calendar. Like NSDateFormatter, dates before 15 October 1582 are read and written with the Julian calendar.
+ */
+
+///@discussion The length of a buffer that can hold a encoded date and time, including the terminating NUL.
+#define GWMDateTimeCStringBufferLength 20
+
+/*!
+ * @discussion Decodes a date and time in the format yyyy-MM-dd HH:mm:ss, interpreted as UTC.
+ * @param string A NUL terminated string.
+ * @return The date or nil if the string is not in the expected format.
+ */
+FOUNDATION_EXTERN NSDate *_Nullable GWMDateWithDateTimeCString(const char *string);
+/*!
+ * @discussion Decodes a date whose format is given by the length of the string: yyyy-MM-dd HH:mm:ss in UTC, or yyyy-MM-dd or yyyy-MM at midnight in the local time zone.
+ * @param string A NUL terminated string.
+ * @param length The length of string.
+ * @param localTimeZone The time zone used for the dates that do not have a time.
+ * @return The date or nil if the string is not in one of the expected formats.
+ */
+FOUNDATION_EXTERN NSDate *_Nullable GWMDateWithHistoricDateCString(const char *string, size_t length, NSTimeZone *localTimeZone);
+/*!
+ * @discussion Encodes a date in UTC in the format yyyy-MM-dd HH:mm:ss. Fractions of a second are dropped.
+ * @param date The date to encode.
+ * @param buffer A buffer of at least GWMDateTimeCStringBufferLength bytes that receives the NUL terminated string.
+ * @return YES if the date was encoded, NO if its year is outside 1 to 9999.
+ */
+FOUNDATION_EXTERN BOOL GWMDateTimeCStringWithDate(NSDate *date, char *buffer);
+
+NS_ASSUME_NONNULL_END
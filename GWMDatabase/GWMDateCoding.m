@@ -0,0 +1,215 @@
+//
+//  GWMDateCoding.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMDateCoding.h"
+#import "GWMDatabaseController.h"
+
+// Julian day number of 15 October 1582, the first day of the Gregorian calendar
+static const int64_t GWMGregorianCutoverJulianDay = 2299161;
+// Julian day number of 1 January 1970
+static const int64_t GWMUnixEpochJulianDay = 2440588;
+static const int64_t GWMSecondsPerDay = 86400;
+
+#pragma mark - Calendar Arithmetic
+
+static BOOL GWMIsGregorianDate(int year, int month, int day)
+{
+    if (year != 1582)
+        return year > 1582;
+    if (month != 10)
+        return month > 10;
+    return day >= 15;
+}
+
+static int GWMDaysInMonth(int year, int month, BOOL gregorian)
+{
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    if (month != 2)
+        return days[month - 1];
+
+    BOOL leapYear = gregorian ? ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0) : year % 4 == 0;
+    return leapYear ? 29 : 28;
+}
+
+static int64_t GWMJulianDayWithDate(int year, int month, int day)
+{
+    int64_t a = (14 - month) / 12;
+    int64_t y = year + 4800 - a;
+    int64_t m = month + 12 * a - 3;
+
+    if (GWMIsGregorianDate(year, month, day))
+        return day + (153 * m + 2) / 5 + 365 * y + y / 4 - y / 100 + y / 400 - 32045;
+
+    return day + (153 * m + 2) / 5 + 365 * y + y / 4 - 32083;
+}
+
+static void GWMDateWithJulianDay(int64_t julianDay, int *year, int *month, int *day)
+{
+    int64_t b = 0;
+    int64_t c = 0;
+
+    if (julianDay >= GWMGregorianCutoverJulianDay) {
+        int64_t a = julianDay + 32044;
+        b = (4 * a + 3) / 146097;
+        c = a - 146097 * b / 4;
+    } else {
+        c = julianDay + 32082;
+    }
+
+    int64_t d = (4 * c + 3) / 1461;
+    int64_t e = c - 1461 * d / 4;
+    int64_t m = (5 * e + 2) / 153;
+
+    *day = (int)(e - (153 * m + 2) / 5 + 1);
+    *month = (int)(m + 3 - 12 * (m / 10));
+    *year = (int)(100 * b + d - 4800 + m / 10);
+}
+
+#pragma mark - Parsing
+
+static BOOL GWMParseDigits(const char *string, int count, int *value)
+{
+    int result = 0;
+
+    for (int idx = 0; idx < count; idx++) {
+        char character = string[idx];
+        if (character < '0' || character > '9')
+            return NO;
+        result = result * 10 + (character - '0');
+    }
+
+    *value = result;
+    return YES;
+}
+
+/*
+ Reads yyyy, yyyy-MM, yyyy-MM-dd or yyyy-MM-dd HH:mm:ss depending on length and returns the number of seconds from 1970-01-01 00:00:00 to the wall clock time it describes.
+ */
+static BOOL GWMWallClockSecondsWithCString(const char *string, size_t length, int64_t *seconds)
+{
+    int year = 0, month = 1, day = 1, hour = 0, minute = 0, second = 0;
+
+    if (!GWMParseDigits(string, 4, &year) || year < 1)
+        return NO;
+
+    if (length >= GWMDBDateStringLengthYearMonth) {
+        if (string[4] != '-' || !GWMParseDigits(string + 5, 2, &month) || month < 1 || month > 12)
+            return NO;
+    }
+
+    if (length >= GWMDBDateStringLengthShortDate) {
+        if (string[7] != '-' || !GWMParseDigits(string + 8, 2, &day) || day < 1 || day > GWMDaysInMonth(year, month, GWMIsGregorianDate(year, month, 1)))
+            return NO;
+    }
+
+    if (length >= GWMDBDateStringLengthDateTime) {
+        if (string[10] != ' ' || string[13] != ':' || string[16] != ':')
+            return NO;
+        if (!GWMParseDigits(string + 11, 2, &hour) || !GWMParseDigits(string + 14, 2, &minute) || !GWMParseDigits(string + 17, 2, &second))
+            return NO;
+        if (hour > 23 || minute > 59 || second > 59)
+            return NO;
+    }
+
+    int64_t days = GWMJulianDayWithDate(year, month, day) - GWMUnixEpochJulianDay;
+    *seconds = days * GWMSecondsPerDay + hour * 3600 + minute * 60 + second;
+
+    return YES;
+}
+
+static int64_t GWMSecondsFromGMT(NSTimeZone *timeZone, int64_t seconds)
+{
+    return (int64_t)[timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSinceReferenceDate:(NSTimeInterval)seconds - NSTimeIntervalSince1970]];
+}
+
+static NSDate *GWMDateWithLocalWallClockSeconds(int64_t wallClockSeconds, NSTimeZone *localTimeZone)
+{
+    int64_t firstGuess = wallClockSeconds - GWMSecondsFromGMT(localTimeZone, wallClockSeconds);
+    int64_t secondGuess = wallClockSeconds - GWMSecondsFromGMT(localTimeZone, firstGuess);
+
+    // the wall clock time was skipped by a daylight saving transition, use the moment the clocks moved forward
+    if (GWMSecondsFromGMT(localTimeZone, secondGuess) != GWMSecondsFromGMT(localTimeZone, firstGuess))
+        secondGuess = MAX(firstGuess, secondGuess);
+
+    return [NSDate dateWithTimeIntervalSince1970:secondGuess];
+}
+
+NSDate *GWMDateWithDateTimeCString(const char *string)
+{
+    if (strlen(string) != GWMDBDateStringLengthDateTime)
+        return nil;
+
+    int64_t seconds = 0;
+    if (!GWMWallClockSecondsWithCString(string, GWMDBDateStringLengthDateTime, &seconds))
+        return nil;
+
+    return [NSDate dateWithTimeIntervalSince1970:seconds];
+}
+
+NSDate *GWMDateWithHistoricDateCString(const char *string, size_t length, NSTimeZone *localTimeZone)
+{
+    int64_t seconds = 0;
+
+    switch (length) {
+        case GWMDBDateStringLengthDateTime:
+            return GWMDateWithDateTimeCString(string);
+        case GWMDBDateStringLengthShortDate:
+        case GWMDBDateStringLengthYearMonth:
+            if (!GWMWallClockSecondsWithCString(string, length, &seconds))
+                return nil;
+            return GWMDateWithLocalWallClockSeconds(seconds, localTimeZone);
+        default:
+            return nil;
+    }
+}
+
+#pragma mark - Formatting
+
+static void GWMWriteDigits(char *buffer, int value, int count)
+{
+    for (int idx = count - 1; idx >= 0; idx--) {
+        buffer[idx] = '0' + value % 10;
+        value /= 10;
+    }
+}
+
+BOOL GWMDateTimeCStringWithDate(NSDate *date, char *buffer)
+{
+    NSTimeInterval interval = floor(date.timeIntervalSince1970);
+    int64_t seconds = (int64_t)interval;
+
+    int64_t days = seconds / GWMSecondsPerDay;
+    int64_t secondOfDay = seconds % GWMSecondsPerDay;
+
+    if (secondOfDay < 0) {
+        secondOfDay += GWMSecondsPerDay;
+        days--;
+    }
+
+    int year = 0, month = 0, day = 0;
+    GWMDateWithJulianDay(days + GWMUnixEpochJulianDay, &year, &month, &day);
+
+    if (year < 1 || year > 9999)
+        return NO;
+
+    GWMWriteDigits(buffer, year, 4);
+    buffer[4] = '-';
+    GWMWriteDigits(buffer + 5, month, 2);
+    buffer[7] = '-';
+    GWMWriteDigits(buffer + 8, day, 2);
+    buffer[10] = ' ';
+    GWMWriteDigits(buffer + 11, (int)(secondOfDay / 3600), 2);
+    buffer[13] = ':';
+    GWMWriteDigits(buffer + 14, (int)(secondOfDay / 60 % 60), 2);
+    buffer[16] = ':';
+    GWMWriteDigits(buffer + 17, (int)(secondOfDay % 60), 2);
+    buffer[19] = '\0';
+
+    return YES;
+}
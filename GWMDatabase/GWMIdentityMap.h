@@ -0,0 +1,64 @@
+//
+//  GWMIdentityMap.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMIdentityMap
+ * @discussion A bounded, least recently used cache of the objects created for database rows. Objects are keyed by their class, their itemID and the columns of the query that created them, so a row read with the columns of a list is never returned for a query that asks for the columns of a detail. Each object has an estimated cost in bytes and the least recently used objects are evicted when the total cost goes over the memory limit.
+ */
+@interface GWMIdentityMap : NSObject
+
+///@discussion The largest total cost, in bytes, of the cached objects.
+@property (nonatomic, assign) NSUInteger memoryLimit;
+///@discussion The total cost, in bytes, of the cached objects.
+@property (readonly) NSUInteger memoryUsage;
+///@discussion The number of objects currently held by the map.
+@property (readonly) NSUInteger count;
+///@discussion The number of times a cached object was returned.
+@property (readonly) NSUInteger hits;
+///@discussion The number of times an object was not in the map.
+@property (readonly) NSUInteger misses;
+///@discussion Changes every time rows are removed. An object read before a removal may be out of date and is not cached.
+@property (readonly) NSUInteger generation;
+
+-(instancetype)initWithMemoryLimit:(NSUInteger)memoryLimit;
+/*!
+ * @discussion Returns the cached object for a row.
+ * @param className The class of the object.
+ * @param itemID The primary key of the row.
+ * @param columnSignature Identifies the columns the object was created from.
+ * @return The cached object or nil.
+ */
+-(id _Nullable)objectForClassName:(NSString *)className itemID:(NSInteger)itemID columnSignature:(NSString *)columnSignature;
+/*!
+ * @discussion Caches the object for a row, evicting the least recently used objects if the memory limit is reached.
+ * @param object The object to cache.
+ * @param className The class of the object.
+ * @param itemID The primary key of the row.
+ * @param columnSignature Identifies the columns the object was created from.
+ * @param cost The estimated size of the object in bytes.
+ * @param generation The generation of the map before the row was read. The object is not cached if rows were removed since.
+ */
+-(void)setObject:(id)object forClassName:(NSString *)className itemID:(NSInteger)itemID columnSignature:(NSString *)columnSignature cost:(NSUInteger)cost generation:(NSUInteger)generation;
+///@discussion Removes every object for a row, whatever columns it was created from. The row is remembered until removePendingRows is called.
+-(void)removeObjectsForClassName:(NSString *)className itemID:(NSInteger)itemID;
+///@discussion Removes the objects of the rows removed since the last call again. Call it once a write has committed, a reader that started before the commit may have cached the old row in the meantime.
+-(void)removePendingRows;
+///@discussion Removes every object of a class.
+-(void)removeObjectsForClassName:(NSString *)className;
+///@discussion Removes every object.
+-(void)removeAllObjects;
+///@discussion Sets the hit and miss counters back to zero.
+-(void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
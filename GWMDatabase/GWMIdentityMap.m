@@ -0,0 +1,217 @@
+//
+//  GWMIdentityMap.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMIdentityMap.h"
+
+@interface GWMIdentityMapEntry : NSObject
+
+@property (nonatomic, strong) id object;
+@property (nonatomic, strong) NSString *rowKey;
+@property (nonatomic, strong) NSString *className;
+@property (nonatomic, assign) NSUInteger cost;
+
+@end
+
+@implementation GWMIdentityMapEntry
+
+@end
+
+@interface GWMIdentityMap ()
+
+///@discussion Cached entries where the key is the class, the itemID and the column signature.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,GWMIdentityMapEntry*> *entries;
+///@discussion The entry keys of each row where the key is the class and the itemID.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,NSMutableSet<NSString*>*> *entryKeysByRow;
+///@discussion Entry keys ordered from least to most recently used.
+@property (nonatomic, strong) NSMutableOrderedSet<NSString*> *recentlyUsed;
+///@discussion Rows removed since the last call to removePendingRows.
+@property (nonatomic, strong) NSMutableSet<NSString*> *pendingRowKeys;
+@property (readwrite) NSUInteger memoryUsage;
+@property (readwrite) NSUInteger hits;
+@property (readwrite) NSUInteger misses;
+@property (readwrite) NSUInteger generation;
+
+@end
+
+@implementation GWMIdentityMap
+
+-(instancetype)initWithMemoryLimit:(NSUInteger)memoryLimit
+{
+    if (self = [super init]) {
+        _memoryLimit = memoryLimit;
+        _entries = [NSMutableDictionary new];
+        _entryKeysByRow = [NSMutableDictionary new];
+        _recentlyUsed = [NSMutableOrderedSet new];
+        _pendingRowKeys = [NSMutableSet new];
+    }
+    return self;
+}
+
+static NSString *GWMIdentityMapRowKey(NSString *className, NSInteger itemID)
+{
+    return [NSString stringWithFormat:@"%@:%ld", className, (long)itemID];
+}
+
+-(NSUInteger)count
+{
+    @synchronized (self) {
+        return self.entries.count;
+    }
+}
+
+-(void)setMemoryLimit:(NSUInteger)memoryLimit
+{
+    @synchronized (self) {
+        _memoryLimit = memoryLimit;
+        [self evictToMemoryLimit:memoryLimit];
+    }
+}
+
+-(id)objectForClassName:(NSString *)className itemID:(NSInteger)itemID columnSignature:(NSString *)columnSignature
+{
+    NSString *entryKey = [NSString stringWithFormat:@"%@|%@", GWMIdentityMapRowKey(className, itemID), columnSignature];
+
+    @synchronized (self) {
+
+        GWMIdentityMapEntry *entry = self.entries[entryKey];
+
+        if (!entry) {
+            self.misses++;
+            return nil;
+        }
+
+        [self.recentlyUsed removeObject:entryKey];
+        [self.recentlyUsed addObject:entryKey];
+        self.hits++;
+
+        return entry.object;
+    }
+}
+
+-(void)setObject:(id)object forClassName:(NSString *)className itemID:(NSInteger)itemID columnSignature:(NSString *)columnSignature cost:(NSUInteger)cost generation:(NSUInteger)generation
+{
+    NSString *rowKey = GWMIdentityMapRowKey(className, itemID);
+    NSString *entryKey = [NSString stringWithFormat:@"%@|%@", rowKey, columnSignature];
+
+    @synchronized (self) {
+
+        // an object bigger than the whole map is not worth keeping, one read before a removal may be out of date
+        if (cost > self.memoryLimit || generation != self.generation)
+            return;
+
+        [self removeEntryForKey:entryKey];
+        [self evictToMemoryLimit:self.memoryLimit - cost];
+
+        GWMIdentityMapEntry *entry = [GWMIdentityMapEntry new];
+        entry.object = object;
+        entry.rowKey = rowKey;
+        entry.className = className;
+        entry.cost = cost;
+
+        self.entries[entryKey] = entry;
+        [self.recentlyUsed addObject:entryKey];
+        self.memoryUsage += cost;
+
+        if (!self.entryKeysByRow[rowKey])
+            self.entryKeysByRow[rowKey] = [NSMutableSet new];
+        [self.entryKeysByRow[rowKey] addObject:entryKey];
+    }
+}
+
+-(void)removeObjectsForClassName:(NSString *)className itemID:(NSInteger)itemID
+{
+    NSString *rowKey = GWMIdentityMapRowKey(className, itemID);
+
+    @synchronized (self) {
+        [self removeEntriesForRowKey:rowKey];
+        [self.pendingRowKeys addObject:rowKey];
+        self.generation++;
+    }
+}
+
+-(void)removePendingRows
+{
+    @synchronized (self) {
+        
+        if (self.pendingRowKeys.count == 0)
+            return;
+        
+        for (NSString *rowKey in self.pendingRowKeys)
+            [self removeEntriesForRowKey:rowKey];
+        
+        [self.pendingRowKeys removeAllObjects];
+        self.generation++;
+    }
+}
+
+-(void)removeObjectsForClassName:(NSString *)className
+{
+    @synchronized (self) {
+        NSArray<NSString*> *entryKeys = [self.entries keysOfEntriesPassingTest:^BOOL(NSString *_Nonnull entryKey, GWMIdentityMapEntry *_Nonnull entry, BOOL *stop){
+            return [entry.className isEqualToString:className];
+        }].allObjects;
+
+        for (NSString *entryKey in entryKeys)
+            [self removeEntryForKey:entryKey];
+        
+        self.generation++;
+    }
+}
+
+-(void)removeAllObjects
+{
+    @synchronized (self) {
+        [self.entries removeAllObjects];
+        [self.entryKeysByRow removeAllObjects];
+        [self.recentlyUsed removeAllObjects];
+        [self.pendingRowKeys removeAllObjects];
+        self.memoryUsage = 0;
+        self.generation++;
+    }
+}
+
+-(void)resetStatistics
+{
+    @synchronized (self) {
+        self.hits = 0;
+        self.misses = 0;
+    }
+}
+
+#pragma mark - Eviction
+
+-(void)evictToMemoryLimit:(NSUInteger)memoryLimit
+{
+    while (self.memoryUsage > memoryLimit && self.recentlyUsed.count > 0)
+        [self removeEntryForKey:self.recentlyUsed.firstObject];
+}
+
+-(void)removeEntriesForRowKey:(NSString *)rowKey
+{
+    for (NSString *entryKey in [self.entryKeysByRow[rowKey] allObjects])
+        [self removeEntryForKey:entryKey];
+}
+
+-(void)removeEntryForKey:(NSString *)entryKey
+{
+    GWMIdentityMapEntry *entry = self.entries[entryKey];
+
+    if (!entry)
+        return;
+
+    [self.entries removeObjectForKey:entryKey];
+    [self.recentlyUsed removeObject:entryKey];
+    self.memoryUsage -= entry.cost;
+
+    NSMutableSet<NSString*> *rowEntryKeys = self.entryKeysByRow[entry.rowKey];
+    [rowEntryKeys removeObject:entryKey];
+    if (rowEntryKeys.count == 0)
+        [self.entryKeysByRow removeObjectForKey:entry.rowKey];
+}
+
+@end
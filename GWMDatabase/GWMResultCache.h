@@ -0,0 +1,73 @@
+//
+//  GWMResultCache.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMResultCache
+ * @discussion A bounded, least recently used cache of query results. Results are keyed by their SQL text and bound values and remember the tables they were read from, so a change to a table removes only the results that depend on it. Each result has an estimated cost in bytes and the least recently used results are evicted when the total cost goes over the memory limit.
+ */
+@interface GWMResultCache : NSObject
+
+///@discussion The largest total cost, in bytes, of the cached results.
+@property (nonatomic, assign) NSUInteger memoryLimit;
+///@discussion The total cost, in bytes, of the cached results.
+@property (readonly) NSUInteger memoryUsage;
+///@discussion The number of results currently held by the cache.
+@property (readonly) NSUInteger count;
+///@discussion The number of times a cached result was returned.
+@property (readonly) NSUInteger hits;
+///@discussion The number of times a result was not in the cache.
+@property (readonly) NSUInteger misses;
+///@discussion The number of results removed to stay under the memory limit.
+@property (readonly) NSUInteger evictions;
+///@discussion The number of results removed because a table they were read from changed.
+@property (readonly) NSUInteger invalidations;
+///@discussion Changes every time tables are removed. A result read before a removal may be out of date and is not cached.
+@property (readonly) NSUInteger generation;
+
+-(instancetype)initWithMemoryLimit:(NSUInteger)memoryLimit;
+/*!
+ * @discussion Returns a key for a query.
+ * @param statement The SQL text of the query.
+ * @param values The values bound to the query.
+ * @return A key that is equal for queries with the same SQL text and values.
+ */
++(NSString *)keyWithStatement:(NSString *)statement values:(NSArray *_Nullable)values;
+/*!
+ * @discussion Returns the cached result for a key.
+ * @param key A key returned by keyWithStatement:values:.
+ * @return The cached rows or nil.
+ */
+-(NSArray *_Nullable)dataForKey:(NSString *)key;
+/*!
+ * @discussion Caches a result, evicting the least recently used results if the memory limit is reached.
+ * @param data The rows of the result.
+ * @param key A key returned by keyWithStatement:values:.
+ * @param tables The tables the query reads, in the form schema.table.
+ * @param cost The estimated size of the rows in bytes.
+ * @param generation The generation of the cache before the query ran. The result is not cached if tables were removed since.
+ */
+-(void)setData:(NSArray *)data forKey:(NSString *)key tables:(NSSet<NSString*> *)tables cost:(NSUInteger)cost generation:(NSUInteger)generation;
+/*!
+ * @discussion Removes every result read from a table. The table is remembered until removePendingTables is called.
+ * @param table The table in the form schema.table.
+ */
+-(void)removeDataReadingTable:(NSString *)table;
+///@discussion Removes the results of the tables removed since the last call again. Call it once a write has committed, a reader that started before the commit may have cached an old result in the meantime.
+-(void)removePendingTables;
+///@discussion Removes every result.
+-(void)removeAllData;
+///@discussion Sets the hit, miss, eviction and invalidation counters back to zero.
+-(void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,218 @@
+//
+//  GWMResultCache.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMResultCache.h"
+
+@interface GWMResultCacheEntry : NSObject
+
+@property (nonatomic, strong) NSArray *data;
+@property (nonatomic, strong) NSSet<NSString*> *tables;
+@property (nonatomic, assign) NSUInteger cost;
+
+@end
+
+@implementation GWMResultCacheEntry
+
+@end
+
+@interface GWMResultCache ()
+
+///@discussion Cached entries where the key is the SQL text and bound values.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,GWMResultCacheEntry*> *entries;
+///@discussion The keys of the entries read from each table.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,NSMutableSet<NSString*>*> *keysByTable;
+///@discussion Keys ordered from least to most recently used.
+@property (nonatomic, strong) NSMutableOrderedSet<NSString*> *recentlyUsed;
+///@discussion Tables removed since the last call to removePendingTables.
+@property (nonatomic, strong) NSMutableSet<NSString*> *pendingTables;
+@property (readwrite) NSUInteger memoryUsage;
+@property (readwrite) NSUInteger hits;
+@property (readwrite) NSUInteger misses;
+@property (readwrite) NSUInteger evictions;
+@property (readwrite) NSUInteger invalidations;
+@property (readwrite) NSUInteger generation;
+
+@end
+
+@implementation GWMResultCache
+
+-(instancetype)initWithMemoryLimit:(NSUInteger)memoryLimit
+{
+    if (self = [super init]) {
+        _memoryLimit = memoryLimit;
+        _entries = [NSMutableDictionary new];
+        _keysByTable = [NSMutableDictionary new];
+        _recentlyUsed = [NSMutableOrderedSet new];
+        _pendingTables = [NSMutableSet new];
+    }
+    return self;
+}
+
++(NSString *)keyWithStatement:(NSString *)statement values:(NSArray *)values
+{
+    NSMutableString *mutableKey = [NSMutableString stringWithString:statement];
+
+    // the class and length of each value keep 1 and '1' or 'a,b' and 'a', 'b' apart
+    for (id value in values) {
+        // the description of a long NSData leaves out most of its bytes
+        NSString *description = [value isKindOfClass:[NSData class]] ? [(NSData *)value base64EncodedStringWithOptions:0] : [value description];
+        [mutableKey appendFormat:@"|%@:%lu:%@", NSStringFromClass([value class]), (unsigned long)description.length, description];
+    }
+
+    return [NSString stringWithString:mutableKey];
+}
+
+-(NSUInteger)count
+{
+    @synchronized (self) {
+        return self.entries.count;
+    }
+}
+
+-(void)setMemoryLimit:(NSUInteger)memoryLimit
+{
+    @synchronized (self) {
+        _memoryLimit = memoryLimit;
+        [self evictToMemoryLimit:memoryLimit];
+    }
+}
+
+-(NSArray *)dataForKey:(NSString *)key
+{
+    @synchronized (self) {
+
+        GWMResultCacheEntry *entry = self.entries[key];
+
+        if (!entry) {
+            self.misses++;
+            return nil;
+        }
+
+        [self.recentlyUsed removeObject:key];
+        [self.recentlyUsed addObject:key];
+        self.hits++;
+
+        return entry.data;
+    }
+}
+
+-(void)setData:(NSArray *)data forKey:(NSString *)key tables:(NSSet<NSString*> *)tables cost:(NSUInteger)cost generation:(NSUInteger)generation
+{
+    @synchronized (self) {
+
+        // a result bigger than the whole cache is not worth keeping, one read before a removal may be out of date
+        if (cost > self.memoryLimit || generation != self.generation)
+            return;
+
+        [self removeEntryForKey:key];
+        [self evictToMemoryLimit:self.memoryLimit - cost];
+
+        GWMResultCacheEntry *entry = [GWMResultCacheEntry new];
+        entry.data = data;
+        entry.tables = tables;
+        entry.cost = cost;
+
+        self.entries[key] = entry;
+        [self.recentlyUsed addObject:key];
+        self.memoryUsage += cost;
+
+        for (NSString *table in tables) {
+            if (!self.keysByTable[table])
+                self.keysByTable[table] = [NSMutableSet new];
+            [self.keysByTable[table] addObject:key];
+        }
+    }
+}
+
+-(void)removeDataReadingTable:(NSString *)table
+{
+    @synchronized (self) {
+        [self removeEntriesForTable:table];
+        [self.pendingTables addObject:table];
+        self.generation++;
+    }
+}
+
+-(void)removePendingTables
+{
+    @synchronized (self) {
+
+        if (self.pendingTables.count == 0)
+            return;
+
+        for (NSString *table in self.pendingTables)
+            [self removeEntriesForTable:table];
+
+        [self.pendingTables removeAllObjects];
+        self.generation++;
+    }
+}
+
+-(void)removeAllData
+{
+    @synchronized (self) {
+        self.invalidations += self.entries.count;
+        [self.entries removeAllObjects];
+        [self.keysByTable removeAllObjects];
+        [self.recentlyUsed removeAllObjects];
+        [self.pendingTables removeAllObjects];
+        self.memoryUsage = 0;
+        self.generation++;
+    }
+}
+
+-(void)resetStatistics
+{
+    @synchronized (self) {
+        self.hits = 0;
+        self.misses = 0;
+        self.evictions = 0;
+        self.invalidations = 0;
+    }
+}
+
+#pragma mark - Eviction
+
+-(void)evictToMemoryLimit:(NSUInteger)memoryLimit
+{
+    while (self.memoryUsage > memoryLimit && self.recentlyUsed.count > 0) {
+        [self removeEntryForKey:self.recentlyUsed.firstObject];
+        self.evictions++;
+    }
+}
+
+-(void)removeEntriesForTable:(NSString *)table
+{
+    NSArray<NSString*> *keys = [self.keysByTable[table] allObjects];
+
+    for (NSString *key in keys)
+        [self removeEntryForKey:key];
+
+    self.invalidations += keys.count;
+}
+
+-(void)removeEntryForKey:(NSString *)key
+{
+    GWMResultCacheEntry *entry = self.entries[key];
+
+    if (!entry)
+        return;
+
+    [self.entries removeObjectForKey:key];
+    [self.recentlyUsed removeObject:key];
+    self.memoryUsage -= entry.cost;
+
+    for (NSString *table in entry.tables) {
+        NSMutableSet<NSString*> *tableKeys = self.keysByTable[table];
+        [tableKeys removeObject:key];
+        if (tableKeys.count == 0)
+            [self.keysByTable removeObjectForKey:table];
+    }
+}
+
+@end
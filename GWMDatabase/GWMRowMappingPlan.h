@@ -0,0 +1,59 @@
+//
+//  GWMRowMappingPlan.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMRowMappingPlan
+ * @discussion Describes how the rows of a prepared statement are turned into objects. The column names and declared types of the statement are read once when the plan is created, and the setter for each column is resolved once per class the first time a row of that class is mapped. Every row after that only reads the column values and calls the setters.
+ */
+@interface GWMRowMappingPlan : NSObject
+
+///@discussion YES if the class of each row is read from the column named 'class', NO if it is read from the first column.
+@property (nonatomic, readonly) BOOL searchesForClassColumn;
+///@discussion The column names of the statement joined by commas. Objects mapped by plans with the same signature have the same properties set.
+@property (nonatomic, readonly) NSString *columnSignature;
+
+/*!
+ * @discussion Creates a plan for the columns of a prepared statement.
+ * @param preparedStatement The prepared statement whose rows will be mapped.
+ * @param searchesForClassColumn Enter YES to read the class of each row from the column named 'class', falling back to GWMDataItem if there is no such column. Enter NO to read the class from the first column.
+ */
+-(instancetype)initWithPreparedStatement:(sqlite3_stmt *)preparedStatement searchesForClassColumn:(BOOL)searchesForClassColumn;
+/*!
+ * @discussion Creates an object from the row the prepared statement is currently on.
+ * @param preparedStatement The prepared statement the plan was created with. sqlite3_step must have returned SQLITE_ROW.
+ * @return The object for the row.
+ */
+-(id _Nullable)objectWithRowOfStatement:(sqlite3_stmt *)preparedStatement;
+/*!
+ * @discussion Reads the class of the row the prepared statement is currently on without creating an object.
+ * @param preparedStatement The prepared statement the plan was created with. sqlite3_step must have returned SQLITE_ROW.
+ * @return The class for the row or Nil if the class column is NULL.
+ */
+-(Class _Nullable)classOfRowOfStatement:(sqlite3_stmt *)preparedStatement;
+/*!
+ * @discussion Reads the itemID of the row the prepared statement is currently on from the column named 'itemID'.
+ * @param itemID On return, the itemID of the row.
+ * @param preparedStatement The prepared statement the plan was created with. sqlite3_step must have returned SQLITE_ROW.
+ * @return YES if the statement has an integer itemID column, NO otherwise.
+ */
+-(BOOL)getItemID:(NSInteger *)itemID ofRowOfStatement:(sqlite3_stmt *)preparedStatement;
+/*!
+ * @discussion Estimates the memory used by the object for the row the prepared statement is currently on.
+ * @param preparedStatement The prepared statement the plan was created with. sqlite3_step must have returned SQLITE_ROW.
+ * @return An estimate in bytes.
+ */
+-(NSUInteger)costOfRowOfStatement:(sqlite3_stmt *)preparedStatement;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,442 @@
+//
+//  GWMRowMappingPlan.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMRowMappingPlan.h"
+#import "GWMDatabaseController.h"
+#import "GWMDataItem.h"
+#import "GWMDateCoding.h"
+
+@import ObjectiveC.runtime;
+
+typedef NS_ENUM(NSInteger, GWMColumnDeclaredType) {
+    GWMColumnDeclaredTypeOther = 0,
+    GWMColumnDeclaredTypeDateTime,
+    GWMColumnDeclaredTypeHistoricDate,
+    GWMColumnDeclaredTypeBoolean
+};
+
+typedef NS_ENUM(char, GWMSetterArgumentType) {
+    GWMSetterArgumentUnknown = 0,
+    GWMSetterArgumentObject = '@',
+    GWMSetterArgumentChar = 'c',
+    GWMSetterArgumentUnsignedChar = 'C',
+    GWMSetterArgumentBool = 'B',
+    GWMSetterArgumentShort = 's',
+    GWMSetterArgumentUnsignedShort = 'S',
+    GWMSetterArgumentInt = 'i',
+    GWMSetterArgumentUnsignedInt = 'I',
+    GWMSetterArgumentLong = 'l',
+    GWMSetterArgumentUnsignedLong = 'L',
+    GWMSetterArgumentLongLong = 'q',
+    GWMSetterArgumentUnsignedLongLong = 'Q',
+    GWMSetterArgumentFloat = 'f',
+    GWMSetterArgumentDouble = 'd'
+};
+
+///@discussion What is known about a column without looking at any row.
+typedef struct {
+    BOOL isDateColumn;
+    BOOL isClassColumn;
+    BOOL isUnmapped;
+    GWMColumnDeclaredType declaredType;
+} GWMColumnDescription;
+
+///@discussion How a column is written to an instance of a particular class.
+typedef struct {
+    BOOL respondsToGetter;
+    SEL setter;
+    IMP setterIMP;
+    GWMSetterArgumentType argumentType;
+} GWMColumnSetter;
+
+#pragma mark - Class Binding
+
+/*!
+ * @class GWMRowMappingClassBinding
+ * @discussion The setters of one class for every column of a statement.
+ */
+@interface GWMRowMappingClassBinding : NSObject
+{
+    @public
+    GWMColumnSetter *_setters;
+}
+
+@end
+
+@implementation GWMRowMappingClassBinding
+
+-(instancetype)initWithClass:(Class)class columnNames:(NSArray<NSString*> *)columnNames
+{
+    if (self = [super init]) {
+
+        _setters = calloc(columnNames.count, sizeof(GWMColumnSetter));
+
+        // a class that customizes key-value coding has to keep going through it
+        BOOL usesDefaultKeyValueCoding = [class instanceMethodForSelector:@selector(setValue:forKey:)] == [NSObject instanceMethodForSelector:@selector(setValue:forKey:)];
+
+        [columnNames enumerateObjectsUsingBlock:^(NSString *_Nonnull columnName, NSUInteger idx, BOOL *stop){
+
+            GWMColumnSetter *setter = &self->_setters[idx];
+            setter->respondsToGetter = [class instancesRespondToSelector:NSSelectorFromString(columnName)];
+
+            if (!usesDefaultKeyValueCoding || columnName.length == 0)
+                return;
+
+            NSString *setterName = [NSString stringWithFormat:@"set%@%@:", [columnName substringToIndex:1].uppercaseString, [columnName substringFromIndex:1]];
+            SEL selector = NSSelectorFromString(setterName);
+            Method method = class_getInstanceMethod(class, selector);
+
+            if (!method || method_getNumberOfArguments(method) != 3)
+                return;
+
+            char argumentType[16];
+            method_getArgumentType(method, 2, argumentType, sizeof(argumentType));
+
+            switch (argumentType[0]) {
+                case GWMSetterArgumentObject:
+                case GWMSetterArgumentChar:
+                case GWMSetterArgumentUnsignedChar:
+                case GWMSetterArgumentBool:
+                case GWMSetterArgumentShort:
+                case GWMSetterArgumentUnsignedShort:
+                case GWMSetterArgumentInt:
+                case GWMSetterArgumentUnsignedInt:
+                case GWMSetterArgumentLong:
+                case GWMSetterArgumentUnsignedLong:
+                case GWMSetterArgumentLongLong:
+                case GWMSetterArgumentUnsignedLongLong:
+                case GWMSetterArgumentFloat:
+                case GWMSetterArgumentDouble:
+                    setter->argumentType = argumentType[0];
+                    setter->setter = selector;
+                    setter->setterIMP = method_getImplementation(method);
+                    break;
+                default:
+                    break;
+            }
+        }];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    free(_setters);
+}
+
+@end
+
+#pragma mark - Setting Values
+
+#define GWMCallSetter(obj, columnSetter, type, value) ((void (*)(id, SEL, type))(columnSetter)->setterIMP)(obj, (columnSetter)->setter, (type)(value))
+
+/*
+ The converted value is handed to the setter directly. These conversions match what -setValue:forKey: does when it unboxes a NSNumber for a scalar property.
+ */
+
+static void GWMSetObject(id obj, GWMColumnSetter *setter, NSString *key, id _Nullable value)
+{
+    if (setter->argumentType == GWMSetterArgumentObject)
+        GWMCallSetter(obj, setter, id, value);
+    else
+        [obj setValue:value forKey:key];
+}
+
+static void GWMSetInteger(id obj, GWMColumnSetter *setter, NSString *key, int value, BOOL isBoolean)
+{
+    if (isBoolean)
+        value = value == 0 ? NO : YES;
+
+    switch (setter->argumentType) {
+        case GWMSetterArgumentObject:
+            GWMCallSetter(obj, setter, id, isBoolean ? [NSNumber numberWithBool:value] : [NSNumber numberWithInt:value]);
+            break;
+        case GWMSetterArgumentChar: GWMCallSetter(obj, setter, char, value); break;
+        case GWMSetterArgumentUnsignedChar: GWMCallSetter(obj, setter, unsigned char, value); break;
+        case GWMSetterArgumentBool: GWMCallSetter(obj, setter, bool, value != 0); break;
+        case GWMSetterArgumentShort: GWMCallSetter(obj, setter, short, value); break;
+        case GWMSetterArgumentUnsignedShort: GWMCallSetter(obj, setter, unsigned short, value); break;
+        case GWMSetterArgumentInt: GWMCallSetter(obj, setter, int, value); break;
+        case GWMSetterArgumentUnsignedInt: GWMCallSetter(obj, setter, unsigned int, value); break;
+        case GWMSetterArgumentLong: GWMCallSetter(obj, setter, long, value); break;
+        case GWMSetterArgumentUnsignedLong: GWMCallSetter(obj, setter, unsigned long, value); break;
+        case GWMSetterArgumentLongLong: GWMCallSetter(obj, setter, long long, value); break;
+        case GWMSetterArgumentUnsignedLongLong: GWMCallSetter(obj, setter, unsigned long long, value); break;
+        case GWMSetterArgumentFloat: GWMCallSetter(obj, setter, float, value); break;
+        case GWMSetterArgumentDouble: GWMCallSetter(obj, setter, double, value); break;
+        default:
+            [obj setValue:isBoolean ? [NSNumber numberWithBool:value] : [NSNumber numberWithInt:value] forKey:key];
+            break;
+    }
+}
+
+static void GWMSetDouble(id obj, GWMColumnSetter *setter, NSString *key, double value)
+{
+    switch (setter->argumentType) {
+        case GWMSetterArgumentObject: GWMCallSetter(obj, setter, id, [NSNumber numberWithDouble:value]); break;
+        case GWMSetterArgumentChar: GWMCallSetter(obj, setter, char, value); break;
+        case GWMSetterArgumentUnsignedChar: GWMCallSetter(obj, setter, unsigned char, value); break;
+        case GWMSetterArgumentBool: GWMCallSetter(obj, setter, bool, value != 0); break;
+        case GWMSetterArgumentShort: GWMCallSetter(obj, setter, short, value); break;
+        case GWMSetterArgumentUnsignedShort: GWMCallSetter(obj, setter, unsigned short, value); break;
+        case GWMSetterArgumentInt: GWMCallSetter(obj, setter, int, value); break;
+        case GWMSetterArgumentUnsignedInt: GWMCallSetter(obj, setter, unsigned int, value); break;
+        case GWMSetterArgumentLong: GWMCallSetter(obj, setter, long, value); break;
+        case GWMSetterArgumentUnsignedLong: GWMCallSetter(obj, setter, unsigned long, value); break;
+        case GWMSetterArgumentLongLong: GWMCallSetter(obj, setter, long long, value); break;
+        case GWMSetterArgumentUnsignedLongLong: GWMCallSetter(obj, setter, unsigned long long, value); break;
+        case GWMSetterArgumentFloat: GWMCallSetter(obj, setter, float, value); break;
+        case GWMSetterArgumentDouble: GWMCallSetter(obj, setter, double, value); break;
+        default:
+            [obj setValue:[NSNumber numberWithDouble:value] forKey:key];
+            break;
+    }
+}
+
+#pragma mark - Plan
+
+@interface GWMRowMappingPlan ()
+{
+    int _columnCount;
+    int _classColumnIndex;
+    int _itemIDColumnIndex;
+    GWMColumnDescription *_columns;
+    char *_lastClassName;
+    Class _lastClass;
+}
+
+@property (nonatomic, strong) NSArray<NSString*> *columnNames;
+@property (nonatomic, strong) NSMutableDictionary<NSString*,GWMRowMappingClassBinding*> *classBindings;
+@property (nonatomic, strong) NSTimeZone *localTimeZone;
+
+@end
+
+@implementation GWMRowMappingPlan
+
+-(instancetype)initWithPreparedStatement:(sqlite3_stmt *)preparedStatement searchesForClassColumn:(BOOL)searchesForClassColumn
+{
+    if (self = [super init]) {
+
+        _searchesForClassColumn = searchesForClassColumn;
+        _columnCount = sqlite3_column_count(preparedStatement);
+        _columns = calloc(_columnCount > 0 ? _columnCount : 1, sizeof(GWMColumnDescription));
+        _classColumnIndex = searchesForClassColumn ? -1 : 0;
+        _itemIDColumnIndex = -1;
+        _classBindings = [NSMutableDictionary new];
+        _localTimeZone = [NSTimeZone localTimeZone];
+
+        NSMutableArray<NSString*> *mutableColumnNames = [NSMutableArray<NSString*> new];
+
+        for (int index = 0; index < _columnCount; index++) {
+
+            NSString *columnName = [NSString stringWithUTF8String:sqlite3_column_name(preparedStatement, index)];
+            [mutableColumnNames addObject:columnName];
+
+            if (searchesForClassColumn && _classColumnIndex < 0 && [columnName isEqualToString:GWMTableColumnClass])
+                _classColumnIndex = index;
+
+            if (_itemIDColumnIndex < 0 && [columnName isEqualToString:NSStringFromSelector(@selector(itemID))])
+                _itemIDColumnIndex = index;
+
+            const char *declaredDataTypeC = sqlite3_column_decltype(preparedStatement, index);
+
+            if (declaredDataTypeC == NULL)
+                declaredDataTypeC = "TEXT";
+
+            GWMColumnDescription *column = &_columns[index];
+            column->isDateColumn = [columnName containsString:@"Date"] && ![columnName containsString:@"String"];
+            column->isClassColumn = [columnName isEqualToString:@"class"];
+            column->isUnmapped = [columnName isEqualToString:GWMTableColumnPageSortValue] || [columnName isEqualToString:GWMTableColumnPageKey];
+
+            if (strcmp(declaredDataTypeC, "DATE_TIME") == 0)
+                column->declaredType = GWMColumnDeclaredTypeDateTime;
+            else if (strcmp(declaredDataTypeC, "HISTORIC_DATE") == 0)
+                column->declaredType = GWMColumnDeclaredTypeHistoricDate;
+            else if (strcmp(declaredDataTypeC, "BOOLEAN") == 0)
+                column->declaredType = GWMColumnDeclaredTypeBoolean;
+        }
+
+        _columnNames = [NSArray arrayWithArray:mutableColumnNames];
+        _columnSignature = [_columnNames componentsJoinedByString:@","];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    free(_columns);
+    free(_lastClassName);
+}
+
+-(GWMRowMappingClassBinding *)bindingForClass:(Class)class
+{
+    NSString *className = NSStringFromClass(class);
+    GWMRowMappingClassBinding *binding = self.classBindings[className];
+
+    if (!binding) {
+        binding = [[GWMRowMappingClassBinding alloc] initWithClass:class columnNames:self.columnNames];
+        self.classBindings[className] = binding;
+    }
+
+    return binding;
+}
+
+-(Class)classOfRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    if (_classColumnIndex < 0)
+        return [GWMDataItem class];
+
+    const char *classNameC = (const char *)sqlite3_column_text(preparedStatement, _classColumnIndex);
+
+    if (classNameC == NULL)
+        return Nil;
+
+    // rows of a result almost always share a class
+    if (_lastClassName == NULL || strcmp(_lastClassName, classNameC) != 0) {
+        free(_lastClassName);
+        _lastClassName = strdup(classNameC);
+        _lastClass = NSClassFromString([NSString stringWithUTF8String:classNameC]);
+    }
+
+    return _lastClass;
+}
+
+-(BOOL)getItemID:(NSInteger *)itemID ofRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    if (_itemIDColumnIndex < 0 || sqlite3_column_type(preparedStatement, _itemIDColumnIndex) != SQLITE_INTEGER)
+        return NO;
+
+    *itemID = (NSInteger)sqlite3_column_int64(preparedStatement, _itemIDColumnIndex);
+    return YES;
+}
+
+-(NSUInteger)costOfRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    // the object itself plus a boxed value or string for every column
+    NSUInteger cost = 64;
+
+    for (int index = 0; index < _columnCount; index++) {
+        int dataTypeI = sqlite3_column_type(preparedStatement, index);
+        // sqlite3_column_bytes would convert numbers to text
+        if (dataTypeI == SQLITE_TEXT || dataTypeI == SQLITE_BLOB)
+            cost += 16 + (NSUInteger)sqlite3_column_bytes(preparedStatement, index);
+        else
+            cost += 16;
+    }
+
+    return cost;
+}
+
+-(id)objectWithRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    Class class = [self classOfRowOfStatement:preparedStatement];
+
+    id obj = [[class alloc] init];
+
+    if (!obj)
+        return nil;
+
+    GWMRowMappingClassBinding *binding = [self bindingForClass:[obj class]];
+
+    for (int index = 1; index < _columnCount; index++) {
+
+        GWMColumnDescription *column = &_columns[index];
+        GWMColumnSetter *setter = &binding->_setters[index];
+        NSString *columnName = self.columnNames[index];
+
+        // read by the caller, not by the item
+        if (column->isUnmapped)
+            continue;
+
+        int dataTypeI = sqlite3_column_type(preparedStatement, index);
+
+        // Dates are stored in the database as a String but they will be stored in the custom class as a NSDate
+
+        if (column->isDateColumn || (column->declaredType == GWMColumnDeclaredTypeDateTime && dataTypeI != SQLITE_NULL)) {
+
+            const char *stringValueC = (const char *)sqlite3_column_text(preparedStatement, index);
+
+            if (stringValueC != NULL)
+                GWMSetObject(obj, setter, columnName, GWMDateWithDateTimeCString(stringValueC));
+
+        } else if (column->declaredType == GWMColumnDeclaredTypeHistoricDate && dataTypeI != SQLITE_NULL) {
+
+            const char *stringValueC = (const char *)sqlite3_column_text(preparedStatement, index);
+
+            if (stringValueC == NULL)
+                continue;
+
+            int stringValueLengthI = sqlite3_column_bytes(preparedStatement, index);
+
+            // a year on its own is kept as a string
+            if (stringValueLengthI == GWMDBDateStringLengthYearOnly)
+                GWMSetObject(obj, setter, columnName, [NSString stringWithUTF8String:stringValueC]);
+            else
+                GWMSetObject(obj, setter, columnName, GWMDateWithHistoricDateCString(stringValueC, stringValueLengthI, self.localTimeZone));
+
+        } else {
+
+            switch (dataTypeI) {
+                case SQLITE_INTEGER:
+                {
+                    if (setter->respondsToGetter)
+                        GWMSetInteger(obj, setter, columnName, sqlite3_column_int(preparedStatement, index), column->declaredType == GWMColumnDeclaredTypeBoolean);
+                    break;
+                }
+                case SQLITE_FLOAT:
+                {
+                    float floatValueF = sqlite3_column_double(preparedStatement, index);
+                    GWMSetDouble(obj, setter, columnName, floatValueF);
+                    break;
+                }
+                case SQLITE_TEXT:
+                {
+                    if (column->isClassColumn)
+                        break;
+
+                    const char *stringValueC = (const char *)sqlite3_column_text(preparedStatement, index);
+
+                    if (column->declaredType == GWMColumnDeclaredTypeBoolean) {
+
+                        if (setter->respondsToGetter) {
+                            BOOL boolValueB = (strcmp(stringValueC, "TRUE") == 0 || strcmp(stringValueC, "true") == 0) ? YES : NO;
+                            GWMSetInteger(obj, setter, columnName, boolValueB, YES);
+                        }
+
+                    } else if (setter->respondsToGetter) {
+
+                        GWMSetObject(obj, setter, columnName, [NSString stringWithUTF8String:stringValueC]);
+
+                    } else {
+                        // a single value statement such as SELECT 'GWMDataItem', name FROM ... returns the value itself
+                        obj = [NSString stringWithUTF8String:stringValueC];
+                        binding = [self bindingForClass:[obj class]];
+                    }
+                    break;
+                }
+                case SQLITE_BLOB:
+                {
+                    if (!setter->respondsToGetter)
+                        break;
+
+                    // the column memory only lives until the next step, so the bytes are copied once into the object
+                    const void *bytes = sqlite3_column_blob(preparedStatement, index);
+                    int length = sqlite3_column_bytes(preparedStatement, index);
+                    GWMSetObject(obj, setter, columnName, bytes ? [NSData dataWithBytes:bytes length:(NSUInteger)length] : [NSData data]);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    return obj;
+}
+
+@end
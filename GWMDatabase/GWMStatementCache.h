@@ -0,0 +1,68 @@
+//
+//  GWMStatementCache.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMStatementCache
+ * @discussion A bounded, least recently used cache of prepared statements for a single SQLite database connection. Statements are keyed by their SQL text. A statement is checked out for the duration of a query and checked back in when the query is finished, at which point it is reset and its bindings are cleared so it can be reused. A statement that is already checked out is never handed out a second time; a fresh, uncached statement is prepared instead and finalized when it is checked in.
+ */
+@interface GWMStatementCache : NSObject
+
+///@discussion The database connection the cached statements belong to.
+@property (nonatomic, readonly) sqlite3 *database;
+///@discussion The maximum number of statements to keep. Entering 0 disables caching; every statement will be prepared and finalized.
+@property (nonatomic, assign) NSUInteger capacity;
+///@discussion The number of times a statement was found in the cache.
+@property (readonly) NSUInteger hits;
+///@discussion The number of times a statement had to be prepared.
+@property (readonly) NSUInteger misses;
+///@discussion The number of statements currently held by the cache.
+@property (readonly) NSUInteger count;
+///@discussion When YES, DELETE statements prepared on the database remove the rows of a table one at a time, so a DELETE without a WHERE clause reports every row to the update hook instead of emptying the table at once. It is done with an authorizer that ignores SQLITE_DELETE, which the cache puts back on the database after it prepares a statement. The default is NO.
+@property (nonatomic, assign) BOOL deletesRowsIndividually;
+
+-(instancetype)initWithDatabase:(sqlite3 *)database capacity:(NSUInteger)capacity;
+/*!
+ * @discussion Returns a prepared statement for the SQL text, preparing it if necessary.
+ * @param statement The SQL text of the statement.
+ * @param prepareCode On return, the SQLite result code of preparing the statement. GWMSQLiteResultOK if the statement came from the cache.
+ * @return A prepared statement or NULL if the statement could not be prepared.
+ */
+-(sqlite3_stmt *_Nullable)checkoutStatement:(NSString *)statement prepareCode:(int *)prepareCode;
+/*!
+ * @discussion Returns a statement to the cache. Cached statements are reset and their bindings cleared. Statements that are not cached are finalized.
+ * @param preparedStatement A statement returned by checkoutStatement:prepareCode:. Can be NULL.
+ * @return The result code from sqlite3_reset or sqlite3_finalize.
+ */
+-(int)checkinStatement:(sqlite3_stmt *_Nullable)preparedStatement;
+/*!
+ * @discussion Returns a dictionary that lives as long as the cached statement does. Use it to keep information that is derived from the statement, such as how its columns map onto an object, so it does not have to be worked out again the next time the statement is used.
+ * @param preparedStatement A statement that is currently checked out.
+ * @return A mutable dictionary or nil if the statement is not cached.
+ */
+-(NSMutableDictionary *_Nullable)userInfoForStatement:(sqlite3_stmt *)preparedStatement;
+/*!
+ * @discussion Returns the tables the statement reads. They are recorded with an authorizer while the statement is prepared, including the tables behind any views it reads.
+ * @param preparedStatement A statement that is currently checked out.
+ * @return A set of table names in the form schema.table or nil if the statement is not cached.
+ */
+-(NSSet<NSString*> *_Nullable)readTablesForStatement:(sqlite3_stmt *)preparedStatement;
+/*!
+ * @discussion Finalizes every cached statement. Statements that are currently checked out are finalized when they are checked in. Call this after a schema change and before closing the database connection.
+ */
+-(void)removeAllStatements;
+///@discussion Sets the hit and miss counters back to zero.
+-(void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,287 @@
+//
+//  GWMStatementCache.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMStatementCache.h"
+
+@interface GWMStatementCacheEntry : NSObject
+
+@property (nonatomic, strong) NSString *statement;
+@property (nonatomic) sqlite3_stmt *preparedStatement;
+@property (nonatomic, assign) BOOL isCheckedOut;
+@property (nonatomic, assign) BOOL isEvicted;
+@property (nonatomic, strong) NSMutableDictionary *_Nullable userInfo;
+@property (nonatomic, strong) NSSet<NSString*> *_Nullable readTables;
+
+@end
+
+@implementation GWMStatementCacheEntry
+
+@end
+
+@interface GWMStatementCache ()
+
+///@discussion Cached entries where the key is the SQL text.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,GWMStatementCacheEntry*> *entries;
+///@discussion Checked out entries where the key is the address of the prepared statement.
+@property (nonatomic, strong) NSMutableDictionary<NSValue*,GWMStatementCacheEntry*> *checkedOutEntries;
+///@discussion SQL text ordered from least to most recently used.
+@property (nonatomic, strong) NSMutableOrderedSet<NSString*> *recentlyUsed;
+@property (readwrite) NSUInteger hits;
+@property (readwrite) NSUInteger misses;
+///@discussion The table of the DROP statement being prepared, set by the authorizer while deletesRowsIndividually is YES.
+@property (nonatomic, copy) NSString *_Nullable droppedTable;
+
+@end
+
+@implementation GWMStatementCache
+
+static int GWMStatementCacheDeleteAuthorizer(void *context, int action, const char *argument1, const char *argument2, const char *schema, const char *trigger)
+{
+    GWMStatementCache *statementCache = (__bridge GWMStatementCache *)context;
+
+    switch (action) {
+        case SQLITE_DROP_TABLE:
+        case SQLITE_DROP_TEMP_TABLE:
+        case SQLITE_DROP_VIEW:
+        case SQLITE_DROP_TEMP_VIEW:
+        case SQLITE_DROP_VTABLE:
+            // the table is checked for SQLITE_DELETE next and is not dropped if that is ignored
+            statementCache.droppedTable = argument1 ? [NSString stringWithUTF8String:argument1] : nil;
+            return SQLITE_OK;
+        case SQLITE_DELETE:
+            break;
+        default:
+            return SQLITE_OK;
+    }
+
+    // DROP statements also check SQLITE_DELETE on the schema table
+    if (argument1 == NULL || strncmp(argument1, "sqlite_", 7) == 0)
+        return SQLITE_OK;
+
+    if (statementCache.droppedTable && strcmp(statementCache.droppedTable.UTF8String, argument1) == 0) {
+        statementCache.droppedTable = nil;
+        return SQLITE_OK;
+    }
+
+    // deletes the rows one at a time instead of using the truncate optimization of DELETE without a WHERE clause
+    return SQLITE_IGNORE;
+}
+
+typedef struct {
+    void *readTables;
+    // the statement cache when deletesRowsIndividually is YES
+    void *_Nullable statementCache;
+} GWMStatementCacheAuthorizerContext;
+
+static int GWMStatementCacheAuthorizer(void *context, int action, const char *argument1, const char *argument2, const char *schema, const char *trigger)
+{
+    GWMStatementCacheAuthorizerContext *authorizerContext = (GWMStatementCacheAuthorizerContext *)context;
+
+    // reading no columns of a table, as count(*) does, is reported with an empty column name
+    if (action == SQLITE_READ && argument1 != NULL) {
+        NSMutableSet<NSString*> *readTables = (__bridge NSMutableSet<NSString*> *)authorizerContext->readTables;
+        [readTables addObject:[NSString stringWithFormat:@"%s.%s", schema ? schema : "main", argument1]];
+    }
+
+    if (authorizerContext->statementCache != NULL)
+        return GWMStatementCacheDeleteAuthorizer(authorizerContext->statementCache, action, argument1, argument2, schema, trigger);
+
+    return SQLITE_OK;
+}
+
+-(instancetype)initWithDatabase:(sqlite3 *)database capacity:(NSUInteger)capacity
+{
+    if (self = [super init]) {
+        _database = database;
+        _capacity = capacity;
+        _entries = [NSMutableDictionary new];
+        _checkedOutEntries = [NSMutableDictionary new];
+        _recentlyUsed = [NSMutableOrderedSet new];
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    [self removeAllStatements];
+}
+
+-(void)setDeletesRowsIndividually:(BOOL)deletesRowsIndividually
+{
+    @synchronized (self) {
+        _deletesRowsIndividually = deletesRowsIndividually;
+        sqlite3_set_authorizer(self.database, deletesRowsIndividually ? GWMStatementCacheDeleteAuthorizer : NULL, (__bridge void *)self);
+    }
+}
+
+-(NSUInteger)count
+{
+    @synchronized (self) {
+        return self.entries.count;
+    }
+}
+
+-(void)setCapacity:(NSUInteger)capacity
+{
+    @synchronized (self) {
+        _capacity = capacity;
+        [self evictToCapacity:capacity];
+    }
+}
+
+-(sqlite3_stmt *)checkoutStatement:(NSString *)statement prepareCode:(int *)prepareCode
+{
+    @synchronized (self) {
+
+        GWMStatementCacheEntry *entry = self.entries[statement];
+
+        if (entry && !entry.isCheckedOut) {
+            entry.isCheckedOut = YES;
+            self.checkedOutEntries[[NSValue valueWithPointer:entry.preparedStatement]] = entry;
+            [self.recentlyUsed removeObject:statement];
+            [self.recentlyUsed addObject:statement];
+            self.hits++;
+            *prepareCode = SQLITE_OK;
+            return entry.preparedStatement;
+        }
+
+        self.misses++;
+
+        sqlite3_stmt *sqlite3PreparedStatement = NULL;
+        NSMutableSet<NSString*> *readTables = [NSMutableSet new];
+
+        GWMStatementCacheAuthorizerContext authorizerContext = {(__bridge void *)readTables, self.deletesRowsIndividually ? (__bridge void *)self : NULL};
+
+        sqlite3_set_authorizer(self.database, GWMStatementCacheAuthorizer, &authorizerContext);
+        *prepareCode = sqlite3_prepare_v2(self.database, statement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+        sqlite3_set_authorizer(self.database, self.deletesRowsIndividually ? GWMStatementCacheDeleteAuthorizer : NULL, (__bridge void *)self);
+
+        if (*prepareCode != SQLITE_OK) {
+            sqlite3_finalize(sqlite3PreparedStatement);
+            return NULL;
+        }
+
+        // the same statement is already in use further up the stack, hand out an uncached copy
+        if (entry || self.capacity == 0)
+            return sqlite3PreparedStatement;
+
+        [self evictToCapacity:self.capacity - 1];
+
+        entry = [GWMStatementCacheEntry new];
+        entry.statement = statement;
+        entry.preparedStatement = sqlite3PreparedStatement;
+        entry.isCheckedOut = YES;
+        entry.readTables = readTables;
+
+        self.entries[statement] = entry;
+        self.checkedOutEntries[[NSValue valueWithPointer:sqlite3PreparedStatement]] = entry;
+        [self.recentlyUsed addObject:statement];
+
+        return sqlite3PreparedStatement;
+    }
+}
+
+-(int)checkinStatement:(sqlite3_stmt *)preparedStatement
+{
+    if (preparedStatement == NULL)
+        return SQLITE_OK;
+
+    @synchronized (self) {
+
+        NSValue *key = [NSValue valueWithPointer:preparedStatement];
+        GWMStatementCacheEntry *entry = self.checkedOutEntries[key];
+
+        if (!entry)
+            return sqlite3_finalize(preparedStatement);
+
+        [self.checkedOutEntries removeObjectForKey:key];
+        entry.isCheckedOut = NO;
+
+        if (entry.isEvicted)
+            return sqlite3_finalize(preparedStatement);
+
+        int resetCode = sqlite3_reset(preparedStatement);
+        sqlite3_clear_bindings(preparedStatement);
+
+        return resetCode;
+    }
+}
+
+-(NSMutableDictionary *)userInfoForStatement:(sqlite3_stmt *)preparedStatement
+{
+    @synchronized (self) {
+
+        GWMStatementCacheEntry *entry = self.checkedOutEntries[[NSValue valueWithPointer:preparedStatement]];
+
+        if (!entry || entry.isEvicted)
+            return nil;
+
+        if (!entry.userInfo)
+            entry.userInfo = [NSMutableDictionary new];
+
+        return entry.userInfo;
+    }
+}
+
+-(NSSet<NSString*> *)readTablesForStatement:(sqlite3_stmt *)preparedStatement
+{
+    @synchronized (self) {
+
+        GWMStatementCacheEntry *entry = self.checkedOutEntries[[NSValue valueWithPointer:preparedStatement]];
+
+        if (!entry || entry.isEvicted)
+            return nil;
+
+        return entry.readTables;
+    }
+}
+
+-(void)removeAllStatements
+{
+    @synchronized (self) {
+        [self.entries enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull statement, GWMStatementCacheEntry *_Nonnull entry, BOOL *stop){
+            [self evictEntry:entry];
+        }];
+        [self.entries removeAllObjects];
+        [self.recentlyUsed removeAllObjects];
+    }
+}
+
+-(void)resetStatistics
+{
+    @synchronized (self) {
+        self.hits = 0;
+        self.misses = 0;
+    }
+}
+
+#pragma mark - Eviction
+
+-(void)evictToCapacity:(NSUInteger)capacity
+{
+    while (self.recentlyUsed.count > capacity) {
+        NSString *statement = self.recentlyUsed.firstObject;
+        [self evictEntry:self.entries[statement]];
+        [self.entries removeObjectForKey:statement];
+        [self.recentlyUsed removeObjectAtIndex:0];
+    }
+}
+
+-(void)evictEntry:(GWMStatementCacheEntry *)entry
+{
+    // a statement that is checked out is finalized when it is checked in
+    if (entry.isCheckedOut) {
+        entry.isEvicted = YES;
+        return;
+    }
+    sqlite3_finalize(entry.preparedStatement);
+    entry.preparedStatement = NULL;
+    entry.userInfo = nil;
+}
+
+@end
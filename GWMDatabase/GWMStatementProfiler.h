@@ -0,0 +1,50 @@
+//
+//  GWMStatementProfiler.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import <sqlite3.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMStatementProfiler
+ * @discussion Records how long each statement takes on the database connections it is attached to. The profiler is told about every statement that finishes with sqlite3_trace_v2 and reads the sqlite3_stmt_status counters of the statement at that point, so nothing is recorded for connections it is not attached to and a connection that is not attached does no extra work. Statements are grouped by their SQL text, which does not change with the values bound to it. Runs that take longer than slowStatementThreshold are also kept on their own with the values that were bound. The profiler can be used by several connections on different threads at once.
+ */
+@interface GWMStatementProfiler : NSObject
+
+///@discussion Runs that take at least this long, in seconds, are kept as slow statements. Entering 0 keeps none. The default is 0.
+@property (atomic, assign) NSTimeInterval slowStatementThreshold;
+///@discussion The largest number of slow statements kept. The oldest is removed when the limit is reached. The default is 100.
+@property (atomic, assign) NSUInteger slowStatementLimit;
+
+/*!
+ * @discussion Starts recording the statements of a connection. The profiler must be detached before it is released or the connection is closed.
+ * @param database A connection that is not being used by another thread.
+ */
+-(void)attachToDatabase:(sqlite3 *)database;
+/*!
+ * @discussion Stops recording the statements of a connection.
+ * @param database A connection that is not being used by another thread.
+ */
++(void)detachFromDatabase:(sqlite3 *)database;
+/*!
+ * @discussion Runs EXPLAIN QUERY PLAN for the slow statements that do not have a query plan yet. The plan is not worked out while the slow statement is running so the statement is not slowed down further.
+ * @param database The connection to run EXPLAIN QUERY PLAN on.
+ */
+-(void)explainSlowStatementsWithDatabase:(sqlite3 *)database;
+/*!
+ * @discussion Returns what has been recorded so far.
+ * @return An NSDictionary with a statements entry, an NSArray with a dictionary for each statement sorted from the most to the least total time, and a slowStatements entry, an NSArray with a dictionary for each slow run from the oldest to the newest. Every value can be written as JSON.
+ */
+-(NSDictionary<NSString*,id> *)snapshot;
+///@discussion Removes every recorded statement and slow statement.
+-(void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,326 @@
+//
+//  GWMStatementProfiler.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMStatementProfiler.h"
+
+///@discussion The number of the most recent run times kept for each statement to work out its percentiles.
+static const NSUInteger GWMStatementProfileSampleCount = 512;
+
+@interface GWMStatementProfile : NSObject
+
+@property (nonatomic, strong) NSString *statement;
+@property (nonatomic, assign) NSUInteger calls;
+@property (nonatomic, assign) NSUInteger rows;
+@property (nonatomic, assign) NSUInteger prepares;
+@property (nonatomic, assign) NSUInteger fullScanSteps;
+@property (nonatomic, assign) NSUInteger sorts;
+@property (nonatomic, assign) NSUInteger autoIndexes;
+@property (nonatomic, assign) NSUInteger vmSteps;
+@property (nonatomic, assign) sqlite3_uint64 totalNanoseconds;
+///@discussion The run times in nanoseconds, written over from the start once GWMStatementProfileSampleCount is reached.
+@property (nonatomic, strong) NSMutableData *samples;
+
+@end
+
+@implementation GWMStatementProfile
+
+-(void)addSample:(sqlite3_uint64)nanoseconds
+{
+    if (!self.samples)
+        self.samples = [NSMutableData dataWithCapacity:GWMStatementProfileSampleCount * sizeof(sqlite3_uint64)];
+
+    NSUInteger count = self.samples.length / sizeof(sqlite3_uint64);
+
+    if (count < GWMStatementProfileSampleCount)
+        [self.samples appendBytes:&nanoseconds length:sizeof(sqlite3_uint64)];
+    else
+        ((sqlite3_uint64 *)self.samples.mutableBytes)[(self.calls - 1) % GWMStatementProfileSampleCount] = nanoseconds;
+}
+
+-(NSDictionary<NSString*,id> *)dictionaryRepresentation
+{
+    NSUInteger count = self.samples.length / sizeof(sqlite3_uint64);
+    NSMutableArray<NSNumber*> *mutableSamples = [NSMutableArray<NSNumber*> arrayWithCapacity:count];
+    const sqlite3_uint64 *samples = self.samples.bytes;
+
+    for (NSUInteger idx = 0; idx < count; idx++)
+        [mutableSamples addObject:@(samples[idx])];
+
+    [mutableSamples sortUsingSelector:@selector(compare:)];
+
+    // nearest rank
+    double (^percentile)(double) = ^double(double fraction){
+        if (count == 0)
+            return 0.0;
+        NSUInteger rank = (NSUInteger)ceil(fraction * count);
+        return mutableSamples[rank > 0 ? rank - 1 : 0].unsignedLongLongValue / 1e9;
+    };
+
+    return @{@"statement": self.statement,
+             @"calls": @(self.calls),
+             @"totalTime": @(self.totalNanoseconds / 1e9),
+             @"p50Time": @(percentile(0.50)),
+             @"p99Time": @(percentile(0.99)),
+             @"rows": @(self.rows),
+             @"prepares": @(self.prepares),
+             @"fullScanSteps": @(self.fullScanSteps),
+             @"sorts": @(self.sorts),
+             @"autoIndexes": @(self.autoIndexes),
+             @"vmSteps": @(self.vmSteps)};
+}
+
+@end
+
+@interface GWMSlowStatement : NSObject
+
+@property (nonatomic, strong) NSString *statement;
+@property (nonatomic, strong) NSString *_Nullable expandedStatement;
+@property (nonatomic, assign) NSTimeInterval time;
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, assign) NSUInteger rows;
+@property (nonatomic, strong) NSString *_Nullable queryPlan;
+
+@end
+
+@implementation GWMSlowStatement
+
+-(NSDictionary<NSString*,id> *)dictionaryRepresentation
+{
+    NSMutableDictionary<NSString*,id> *mutableInfo = [NSMutableDictionary new];
+
+    mutableInfo[@"statement"] = self.statement;
+    mutableInfo[@"expandedStatement"] = self.expandedStatement;
+    mutableInfo[@"time"] = @(self.time);
+    mutableInfo[@"date"] = @(self.date.timeIntervalSince1970);
+    mutableInfo[@"rows"] = @(self.rows);
+    mutableInfo[@"queryPlan"] = self.queryPlan;
+
+    return [NSDictionary dictionaryWithDictionary:mutableInfo];
+}
+
+@end
+
+@interface GWMStatementProfiler ()
+
+///@discussion The recorded statements where the key is the SQL text.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,GWMStatementProfile*> *profiles;
+///@discussion The rows returned so far by each running statement, where the key is the address of the prepared statement.
+@property (nonatomic, strong) NSMapTable *rowCounts;
+///@discussion Slow runs from the oldest to the newest.
+@property (nonatomic, strong) NSMutableArray<GWMSlowStatement*> *slowStatements;
+
+-(void)didReturnRowOfStatement:(sqlite3_stmt *)preparedStatement;
+-(void)didFinishStatement:(sqlite3_stmt *)preparedStatement nanoseconds:(sqlite3_uint64)nanoseconds;
+
+@end
+
+@implementation GWMStatementProfiler
+
+static int GWMStatementProfilerTrace(unsigned int type, void *context, void *statement, void *argument)
+{
+    sqlite3_stmt *preparedStatement = statement;
+
+    // the query plans of slow statements are not recorded themselves
+    if (sqlite3_stmt_isexplain(preparedStatement))
+        return SQLITE_OK;
+
+    GWMStatementProfiler *profiler = (__bridge GWMStatementProfiler *)context;
+
+    if (type == SQLITE_TRACE_ROW)
+        [profiler didReturnRowOfStatement:preparedStatement];
+    else if (type == SQLITE_TRACE_PROFILE)
+        [profiler didFinishStatement:preparedStatement nanoseconds:*(sqlite3_uint64 *)argument];
+
+    return SQLITE_OK;
+}
+
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _slowStatementLimit = 100;
+        _profiles = [NSMutableDictionary new];
+        _rowCounts = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality capacity:0];
+        _slowStatements = [NSMutableArray new];
+    }
+    return self;
+}
+
+-(void)attachToDatabase:(sqlite3 *)database
+{
+    sqlite3_trace_v2(database, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, GWMStatementProfilerTrace, (__bridge void *)self);
+}
+
++(void)detachFromDatabase:(sqlite3 *)database
+{
+    sqlite3_trace_v2(database, 0, NULL, NULL);
+}
+
+#pragma mark - Recording
+
+-(void)didReturnRowOfStatement:(sqlite3_stmt *)preparedStatement
+{
+    @synchronized (self) {
+        NSUInteger rows = (NSUInteger)NSMapGet(self.rowCounts, preparedStatement);
+        NSMapInsert(self.rowCounts, preparedStatement, (void *)(rows + 1));
+    }
+}
+
+-(void)didFinishStatement:(sqlite3_stmt *)preparedStatement nanoseconds:(sqlite3_uint64)nanoseconds
+{
+    const char *statementC = sqlite3_sql(preparedStatement);
+
+    if (statementC == NULL)
+        return;
+
+    // the counters are set back to zero so the next run only counts its own steps
+    int runs = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_RUN, 0);
+    int reprepares = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_REPREPARE, 1);
+    int fullScanSteps = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    int sorts = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_SORT, 1);
+    int autoIndexes = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    int vmSteps = sqlite3_stmt_status(preparedStatement, SQLITE_STMTSTATUS_VM_STEP, 1);
+
+    NSString *statement = [NSString stringWithUTF8String:statementC];
+    NSTimeInterval time = nanoseconds / 1e9;
+    NSTimeInterval threshold = self.slowStatementThreshold;
+    NSString *expandedStatement = nil;
+
+    // the bound values are cleared once the statement is checked in, so they are read now
+    if (threshold > 0 && time >= threshold) {
+        char *expandedStatementC = sqlite3_expanded_sql(preparedStatement);
+        if (expandedStatementC) {
+            expandedStatement = [NSString stringWithUTF8String:expandedStatementC];
+            sqlite3_free(expandedStatementC);
+        }
+    }
+
+    @synchronized (self) {
+
+        NSUInteger rows = (NSUInteger)NSMapGet(self.rowCounts, preparedStatement);
+        NSMapRemove(self.rowCounts, preparedStatement);
+
+        GWMStatementProfile *profile = self.profiles[statement];
+        if (!profile) {
+            profile = [GWMStatementProfile new];
+            profile.statement = statement;
+            self.profiles[statement] = profile;
+        }
+
+        profile.calls++;
+        profile.rows += rows;
+        profile.totalNanoseconds += nanoseconds;
+        // the first run of a statement is the first since it was prepared
+        profile.prepares += (runs == 1 ? 1 : 0) + reprepares;
+        profile.fullScanSteps += fullScanSteps;
+        profile.sorts += sorts;
+        profile.autoIndexes += autoIndexes;
+        profile.vmSteps += vmSteps;
+        [profile addSample:nanoseconds];
+
+        if (threshold <= 0 || time < threshold || self.slowStatementLimit == 0)
+            return;
+
+        GWMSlowStatement *slowStatement = [GWMSlowStatement new];
+        slowStatement.statement = statement;
+        slowStatement.expandedStatement = expandedStatement;
+        slowStatement.time = time;
+        slowStatement.date = [NSDate date];
+        slowStatement.rows = rows;
+
+        [self.slowStatements addObject:slowStatement];
+
+        if (self.slowStatements.count > self.slowStatementLimit)
+            [self.slowStatements removeObjectsInRange:NSMakeRange(0, self.slowStatements.count - self.slowStatementLimit)];
+    }
+}
+
+#pragma mark - Query Plans
+
+-(void)explainSlowStatementsWithDatabase:(sqlite3 *)database
+{
+    NSArray<GWMSlowStatement*> *slowStatements = nil;
+
+    @synchronized (self) {
+        slowStatements = [self.slowStatements filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"queryPlan == nil"]];
+    }
+
+    NSMutableDictionary<NSString*,NSString*> *mutableQueryPlans = [NSMutableDictionary new];
+
+    for (GWMSlowStatement *slowStatement in slowStatements) {
+        // the plan of the SQL text is the plan the statement ran with, whatever values were bound
+        if (!mutableQueryPlans[slowStatement.statement])
+            mutableQueryPlans[slowStatement.statement] = [self queryPlanWithStatement:slowStatement.statement database:database];
+    }
+
+    @synchronized (self) {
+        for (GWMSlowStatement *slowStatement in slowStatements)
+            slowStatement.queryPlan = mutableQueryPlans[slowStatement.statement];
+    }
+}
+
+-(NSString *)queryPlanWithStatement:(NSString *)statement database:(sqlite3 *)database
+{
+    NSString *explainStatement = [NSString stringWithFormat:@"EXPLAIN QUERY PLAN %@", statement];
+    sqlite3_stmt *sqlite3PreparedStatement = NULL;
+
+    int prepareCode = sqlite3_prepare_v2(database, explainStatement.UTF8String, -1, &sqlite3PreparedStatement, NULL);
+
+    if (prepareCode != SQLITE_OK) {
+        NSString *queryPlan = [NSString stringWithFormat:@"Error: %s", sqlite3_errmsg(database)];
+        sqlite3_finalize(sqlite3PreparedStatement);
+        return queryPlan;
+    }
+
+    NSMutableArray<NSString*> *mutableLines = [NSMutableArray<NSString*> new];
+    NSMutableDictionary<NSNumber*,NSNumber*> *mutableDepths = [NSMutableDictionary new];
+
+    // columns are id, parent, notused and detail; a row is nested under the row whose id is its parent
+    while (sqlite3_step(sqlite3PreparedStatement) == SQLITE_ROW) {
+
+        int nodeID = sqlite3_column_int(sqlite3PreparedStatement, 0);
+        int parentID = sqlite3_column_int(sqlite3PreparedStatement, 1);
+        const unsigned char *detailC = sqlite3_column_text(sqlite3PreparedStatement, 3);
+
+        NSUInteger depth = mutableDepths[@(parentID)] ? mutableDepths[@(parentID)].unsignedIntegerValue + 1 : 0;
+        mutableDepths[@(nodeID)] = @(depth);
+
+        NSString *detail = detailC ? [NSString stringWithUTF8String:(const char *)detailC] : @"";
+        [mutableLines addObject:[[@"" stringByPaddingToLength:depth * 2 withString:@" " startingAtIndex:0] stringByAppendingString:detail]];
+    }
+
+    sqlite3_finalize(sqlite3PreparedStatement);
+
+    return [mutableLines componentsJoinedByString:@"\n"];
+}
+
+#pragma mark - Snapshot
+
+-(NSDictionary<NSString*,id> *)snapshot
+{
+    @synchronized (self) {
+
+        NSArray<GWMStatementProfile*> *profiles = [self.profiles.allValues sortedArrayUsingComparator:^NSComparisonResult(GWMStatementProfile *profile1, GWMStatementProfile *profile2){
+            if (profile1.totalNanoseconds == profile2.totalNanoseconds)
+                return NSOrderedSame;
+            return profile1.totalNanoseconds > profile2.totalNanoseconds ? NSOrderedAscending : NSOrderedDescending;
+        }];
+
+        return @{@"statements": [profiles valueForKey:@"dictionaryRepresentation"],
+                 @"slowStatements": [self.slowStatements valueForKey:@"dictionaryRepresentation"]};
+    }
+}
+
+-(void)reset
+{
+    @synchronized (self) {
+        [self.profiles removeAllObjects];
+        [self.slowStatements removeAllObjects];
+    }
+}
+
+@end
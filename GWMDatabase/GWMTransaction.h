@@ -0,0 +1,49 @@
+//
+//  GWMTransaction.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, GWMTransactionMode) {
+    ///@discussion Takes the write lock at the first write. Another connection can take it first, and the first write then fails with SQLITE_BUSY.
+    GWMTransactionModeDeferred = 0,
+    ///@discussion Takes the write lock when the transaction begins.
+    GWMTransactionModeImmediate,
+    ///@discussion Takes the write lock when the transaction begins and, outside write-ahead logging mode, keeps other connections from reading.
+    GWMTransactionModeExclusive
+};
+
+/*!
+ * @class GWMTransaction
+ * @discussion A scope opened by GWMDatabaseController performTransaction. The outermost scope is a SQLite transaction and every scope opened inside it is a SAVEPOINT, so a nested scope can be rolled back without rolling back the scopes around it. A scope is committed when its block returns, unless rollback or rollbackWithError: was called or the block threw an exception. Only use a transaction inside its own block.
+ */
+@interface GWMTransaction : NSObject
+
+///@discussion The name of the SAVEPOINT of the scope, or of the transaction for the outermost scope.
+@property (nonatomic, readonly) NSString *name;
+///@discussion The mode the transaction began with. Nested scopes have the mode of the outermost scope.
+@property (nonatomic, readonly) GWMTransactionMode mode;
+///@discussion 0 for the outermost scope, 1 for a scope opened inside it, and so on.
+@property (nonatomic, readonly) NSUInteger depth;
+///@discussion YES once rollback or rollbackWithError: has been called.
+@property (nonatomic, readonly) BOOL isRolledBack;
+///@discussion The error passed to rollbackWithError:.
+@property (nonatomic, readonly) NSError *_Nullable error;
+
+///@discussion Rolls back the changes of the scope when its block returns.
+-(void)rollback;
+/*!
+ * @discussion Rolls back the changes of the scope when its block returns and has performTransaction return the error.
+ * @param error The reason for the rollback.
+ */
+-(void)rollbackWithError:(NSError *_Nullable)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
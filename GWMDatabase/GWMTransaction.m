@@ -0,0 +1,75 @@
+//
+//  GWMTransaction.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMTransaction.h"
+
+@interface GWMTransaction ()
+
+@property (nonatomic, readwrite) BOOL isRolledBack;
+@property (nonatomic, readwrite) NSError *error;
+///@discussion YES if the scope is a SAVEPOINT rather than a transaction of its own.
+@property (nonatomic, assign) BOOL isSavepoint;
+
+@end
+
+@implementation GWMTransaction
+
+-(instancetype)initWithName:(NSString *)name mode:(GWMTransactionMode)mode depth:(NSUInteger)depth isSavepoint:(BOOL)isSavepoint
+{
+    if (self = [super init]) {
+        _name = name;
+        _mode = mode;
+        _depth = depth;
+        _isSavepoint = isSavepoint;
+    }
+    return self;
+}
+
+-(void)rollback
+{
+    self.isRolledBack = YES;
+}
+
+-(void)rollbackWithError:(NSError *)error
+{
+    self.isRolledBack = YES;
+    if (!self.error)
+        self.error = error;
+}
+
+#pragma mark - Statements
+
+// https://www.sqlite.org/lang_transaction.html
+// https://www.sqlite.org/lang_savepoint.html
+-(NSString *)beginStatement
+{
+    if (self.isSavepoint)
+        return [NSString stringWithFormat:@"SAVEPOINT %@", self.name];
+
+    switch (self.mode) {
+        case GWMTransactionModeImmediate:
+            return @"BEGIN IMMEDIATE TRANSACTION";
+        case GWMTransactionModeExclusive:
+            return @"BEGIN EXCLUSIVE TRANSACTION";
+        default:
+            return @"BEGIN DEFERRED TRANSACTION";
+    }
+}
+
+-(NSString *)commitStatement
+{
+    return self.isSavepoint ? [NSString stringWithFormat:@"RELEASE SAVEPOINT %@", self.name] : @"COMMIT TRANSACTION";
+}
+
+-(NSString *)rollbackStatement
+{
+    // rolling back to a savepoint leaves it open
+    return self.isSavepoint ? [NSString stringWithFormat:@"ROLLBACK TRANSACTION TO SAVEPOINT %@; RELEASE SAVEPOINT %@", self.name, self.name] : @"ROLLBACK TRANSACTION";
+}
+
+@end
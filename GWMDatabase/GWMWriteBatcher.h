@@ -0,0 +1,51 @@
+//
+//  GWMWriteBatcher.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseController.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMWriteBatcher
+ * @discussion The write-behind queue of a GWMDatabaseController. Writes from any thread are collected for batchInterval, or until batchSize of them are waiting, and are then run one after another in a single transaction on a serial queue of the batcher. Each write runs in its own SAVEPOINT, so a write that fails is rolled back without the rest of its batch. The completions of a batch run on the same serial queue once the batch has been committed.
+ */
+@interface GWMWriteBatcher : NSObject
+
+///@discussion How long, in seconds, the first write of a batch waits for others to join it. The default is 0.01.
+@property (atomic, assign) NSTimeInterval batchInterval;
+///@discussion The largest number of writes committed in one transaction. A batch is committed as soon as this many writes are waiting. The default is 256.
+@property (atomic, assign) NSUInteger batchSize;
+///@discussion The number of writes waiting to be committed.
+@property (nonatomic, readonly) NSUInteger queueDepth;
+
+/*!
+ * @discussion Creates a batcher.
+ * @param databaseController The controller the batches are committed with.
+ * @return A batcher.
+ */
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController;
+/*!
+ * @discussion Adds a write to the next batch.
+ * @param write The write. Runs on the serial queue of the batcher inside the batch transaction.
+ * @param completion Runs once the batch is committed or rolled back. This parameter can be nil.
+ */
+-(void)enqueueWrite:(GWMDBWriteBlock)write completion:(GWMDBErrorCompletionBlock _Nullable)completion;
+///@discussion Commits every waiting write and waits for their completions. Does nothing when called from a write or a completion, Calling it from the writer queue of the controller, such as inside a transaction block, is a programming error because the batch could never be committed from there. It asserts in debug builds and does nothing otherwise.
+-(void)flush;
+/*!
+ * @discussion Returns what has been recorded since the batcher was created or reset.
+ * @return An NSDictionary that can be written as JSON.
+ */
+-(NSDictionary<NSString*,id> *)statistics;
+///@discussion Sets the counters back to zero.
+-(void)resetStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
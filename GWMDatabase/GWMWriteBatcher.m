@@ -0,0 +1,260 @@
+//
+//  GWMWriteBatcher.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMWriteBatcher.h"
+@import os.log;
+#include <time.h>
+
+static uint64_t GWMWriteBatcherNanoseconds(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+}
+
+///@discussion A write waiting in the queue.
+@interface GWMPendingWrite : NSObject
+
+@property (nonatomic, copy) GWMDBWriteBlock write;
+@property (nonatomic, copy) GWMDBErrorCompletionBlock completion;
+@property (nonatomic, assign) uint64_t enqueuedTime;
+@property (nonatomic, strong) NSError *error;
+
+@end
+
+@implementation GWMPendingWrite
+
+@end
+
+@interface GWMDatabaseController (GWMWriteBatcher)
+
+-(BOOL)isOnWriterQueue;
+
+@end
+
+@interface GWMWriteBatcher ()
+
+@property (nonatomic, weak) GWMDatabaseController *databaseController;
+@property (nonatomic, strong) dispatch_queue_t queue;
+// guarded by @synchronized (self)
+@property (nonatomic, strong) NSMutableArray<GWMPendingWrite*> *pendingWrites;
+@property (nonatomic, assign) BOOL isCommitScheduled;
+@property (nonatomic, assign) NSUInteger enqueuedWrites;
+@property (nonatomic, assign) NSUInteger committedWrites;
+@property (nonatomic, assign) NSUInteger failedWrites;
+@property (nonatomic, assign) NSUInteger batches;
+@property (nonatomic, assign) NSUInteger maxQueueDepth;
+@property (nonatomic, assign) NSUInteger maxBatchSize;
+@property (nonatomic, assign) uint64_t totalCommitNanoseconds;
+@property (nonatomic, assign) uint64_t maxCommitNanoseconds;
+@property (nonatomic, assign) uint64_t totalLatencyNanoseconds;
+@property (nonatomic, assign) uint64_t maxLatencyNanoseconds;
+
+@end
+
+@implementation GWMWriteBatcher
+
+-(instancetype)initWithDatabaseController:(GWMDatabaseController *)databaseController
+{
+    if (self = [super init]) {
+        _databaseController = databaseController;
+        _queue = dispatch_queue_create("GWMDatabaseController.writeBehind", DISPATCH_QUEUE_SERIAL);
+        dispatch_queue_set_specific(_queue, (__bridge void *)self, (__bridge void *)self, NULL);
+        _pendingWrites = [NSMutableArray<GWMPendingWrite*> new];
+        _batchInterval = 0.01;
+        _batchSize = 256;
+    }
+    return self;
+}
+
+-(NSUInteger)queueDepth
+{
+    @synchronized (self) {
+        return self.pendingWrites.count;
+    }
+}
+
+#pragma mark - Queue
+
+-(void)enqueueWrite:(GWMDBWriteBlock)write completion:(GWMDBErrorCompletionBlock)completion
+{
+    GWMPendingWrite *pendingWrite = [GWMPendingWrite new];
+    pendingWrite.write = write;
+    pendingWrite.completion = completion;
+    pendingWrite.enqueuedTime = GWMWriteBatcherNanoseconds();
+
+    BOOL commitsNow = NO;
+    BOOL schedulesCommit = NO;
+
+    @synchronized (self) {
+        [self.pendingWrites addObject:pendingWrite];
+        self.enqueuedWrites++;
+        self.maxQueueDepth = MAX(self.maxQueueDepth, self.pendingWrites.count);
+
+        if (self.pendingWrites.count >= MAX(self.batchSize, (NSUInteger)1)) {
+            commitsNow = YES;
+        } else if (!self.isCommitScheduled) {
+            self.isCommitScheduled = YES;
+            schedulesCommit = YES;
+        }
+    }
+
+    if (commitsNow) {
+        dispatch_async(self.queue, ^{
+            [self commitPendingWrites];
+        });
+    } else if (schedulesCommit) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.batchInterval * NSEC_PER_SEC)), self.queue, ^{
+            [self commitPendingWrites];
+        });
+    }
+}
+
+-(void)flush
+{
+    if (dispatch_get_specific((__bridge void *)self) == (__bridge void *)self)
+        return;
+
+    // a batch commits through the writer queue of the controller, so waiting for it from that queue never returns
+    BOOL isOnWriterQueue = [self.databaseController isOnWriterQueue];
+    NSAssert(!isOnWriterQueue, @"Can't flush the write-behind queue from the writer queue of its controller");
+    if (isOnWriterQueue)
+        return;
+
+    dispatch_sync(self.queue, ^{
+        [self commitPendingWrites];
+    });
+}
+
+-(NSArray<GWMPendingWrite*> *)nextBatch
+{
+    @synchronized (self) {
+        NSUInteger count = MIN(self.pendingWrites.count, MAX(self.batchSize, (NSUInteger)1));
+        NSArray<GWMPendingWrite*> *batch = [self.pendingWrites subarrayWithRange:NSMakeRange(0, count)];
+        [self.pendingWrites removeObjectsInRange:NSMakeRange(0, count)];
+        if (self.pendingWrites.count == 0)
+            self.isCommitScheduled = NO;
+        return batch;
+    }
+}
+
+-(void)commitPendingWrites
+{
+    NSArray<GWMPendingWrite*> *batch = [self nextBatch];
+
+    while (batch.count > 0) {
+        @autoreleasepool {
+            [self commitBatch:batch];
+        }
+        batch = [self nextBatch];
+    }
+}
+
+-(void)commitBatch:(NSArray<GWMPendingWrite*> *)batch
+{
+    GWMDatabaseController *databaseController = self.databaseController;
+    NSError *batchError = nil;
+
+    uint64_t start = GWMWriteBatcherNanoseconds();
+
+    if (!databaseController) {
+        batchError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:@"The database controller was released before the writes were committed"}];
+    } else {
+        @try {
+            [databaseController performTransaction:^(GWMTransaction *transaction){
+                for (GWMPendingWrite *pendingWrite in batch) {
+                    // a write that fails is rolled back on its own
+                    NSError *writeError = nil;
+                    @try {
+                        [databaseController performTransaction:^(GWMTransaction *scope){
+                            NSError *error = pendingWrite.write();
+                            if (error)
+                                [scope rollbackWithError:error];
+                        } error:&writeError];
+                    } @catch (NSException *exception) {
+                        NSString *message = [NSString stringWithFormat:@"%@: %@", exception.name, exception.reason];
+                        writeError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+                    }
+                    pendingWrite.error = writeError;
+                }
+            } error:&batchError];
+        } @catch (NSException *exception) {
+            NSString *message = [NSString stringWithFormat:@"%@: %@", exception.name, exception.reason];
+            batchError = [NSError errorWithDomain:GWMErrorDomainDatabase code:1 userInfo:@{NSLocalizedDescriptionKey:message}];
+        }
+    }
+
+    uint64_t commitTime = GWMWriteBatcherNanoseconds() - start;
+
+    if (batchError)
+        os_log_debug(OS_LOG_DEFAULT, "A batch of %lu writes was not committed: %s", (unsigned long)batch.count, [batchError.localizedDescription UTF8String]);
+
+    NSUInteger failedCount = 0;
+    for (GWMPendingWrite *pendingWrite in batch) {
+        NSError *error = batchError ?: pendingWrite.error;
+        if (error)
+            failedCount++;
+        if (pendingWrite.completion)
+            pendingWrite.completion(error);
+    }
+
+    uint64_t end = GWMWriteBatcherNanoseconds();
+
+    @synchronized (self) {
+        self.batches++;
+        self.committedWrites += batch.count - failedCount;
+        self.failedWrites += failedCount;
+        self.maxBatchSize = MAX(self.maxBatchSize, batch.count);
+        self.totalCommitNanoseconds += commitTime;
+        self.maxCommitNanoseconds = MAX(self.maxCommitNanoseconds, commitTime);
+        for (GWMPendingWrite *pendingWrite in batch) {
+            uint64_t latency = end - pendingWrite.enqueuedTime;
+            self.totalLatencyNanoseconds += latency;
+            self.maxLatencyNanoseconds = MAX(self.maxLatencyNanoseconds, latency);
+        }
+    }
+}
+
+#pragma mark - Statistics
+
+-(NSDictionary<NSString*,id> *)statistics
+{
+    @synchronized (self) {
+        NSUInteger completedWrites = self.committedWrites + self.failedWrites;
+        return @{@"enqueuedWrites": @(self.enqueuedWrites),
+                 @"committedWrites": @(self.committedWrites),
+                 @"failedWrites": @(self.failedWrites),
+                 @"batches": @(self.batches),
+                 @"queueDepth": @(self.pendingWrites.count),
+                 @"maxQueueDepth": @(self.maxQueueDepth),
+                 @"meanBatchSize": @(self.batches > 0 ? (double)completedWrites / self.batches : 0.0),
+                 @"maxBatchSize": @(self.maxBatchSize),
+                 @"meanCommitTime": @(self.batches > 0 ? self.totalCommitNanoseconds / 1e9 / self.batches : 0.0),
+                 @"maxCommitTime": @(self.maxCommitNanoseconds / 1e9),
+                 @"meanLatency": @(completedWrites > 0 ? self.totalLatencyNanoseconds / 1e9 / completedWrites : 0.0),
+                 @"maxLatency": @(self.maxLatencyNanoseconds / 1e9)};
+    }
+}
+
+-(void)resetStatistics
+{
+    @synchronized (self) {
+        self.enqueuedWrites = 0;
+        self.committedWrites = 0;
+        self.failedWrites = 0;
+        self.batches = 0;
+        self.maxQueueDepth = self.pendingWrites.count;
+        self.maxBatchSize = 0;
+        self.totalCommitNanoseconds = 0;
+        self.maxCommitNanoseconds = 0;
+        self.totalLatencyNanoseconds = 0;
+        self.maxLatencyNanoseconds = 0;
+    }
+}
+
+@end
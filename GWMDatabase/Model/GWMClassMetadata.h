@@ -0,0 +1,59 @@
+//
+//  GWMClassMetadata.h
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+@import Foundation;
+#import "GWMDatabaseHelperItems.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ * @class GWMClassMetadata
+ * @discussion The table columns of a GWMDataItem class and the SQL built from them. The metadata of a class is built once, the first time it is asked for, from the columnDefinitionItems and tableAlias of the class and is shared by every thread. Statements are built once for each table the class is mapped to.
+ */
+@interface GWMClassMetadata : NSObject
+
+///@discussion The name of the class.
+@property (nonatomic, readonly) NSString *className;
+///@discussion The result of columnDefinitionItems.
+@property (nonatomic, readonly) NSArray<GWMColumnDefinition*> *columnDefinitions;
+///@discussion The result of aggregateDefinitionItems.
+@property (nonatomic, readonly) NSArray<GWMAggregateDefinition*> *aggregateDefinitions;
+///@discussion The GWMAggregateCount definitions with a collectionKey, where the key is the collectionKey.
+@property (nonatomic, readonly) NSDictionary<NSString*,GWMAggregateDefinition*> *countDefinitionsByCollectionKey;
+///@discussion The SELECT string of every column. Aggregates are not included.
+@property (nonatomic, readonly) NSArray<NSString*> *tableColumns;
+///@discussion The SELECT string of every column and aggregate included in a list.
+@property (nonatomic, readonly) NSArray<NSString*> *listTableColumns;
+///@discussion The SELECT string of every column and aggregate included in a detail.
+@property (nonatomic, readonly) NSArray<NSString*> *detailTableColumns;
+///@discussion tableColumns joined with commas.
+@property (nonatomic, readonly) NSString *selectColumnsString;
+///@discussion The column with the primary key option or nil.
+@property (nonatomic, readonly) GWMColumnName _Nullable primaryKeyColumn;
+///@discussion The property the primary key column maps to or nil.
+@property (nonatomic, readonly) NSString *_Nullable primaryKeyProperty;
+///@discussion The property each column maps to, where the key is the column.
+@property (nonatomic, readonly) NSDictionary<GWMColumnName,NSString*> *tableColumnInfo;
+
+/*!
+ * @discussion Returns the metadata of a class, building it if it has not been asked for before.
+ * @param class A GWMDataItem class.
+ * @return A GWMClassMetadata object.
+ */
++(instancetype)metadataForClass:(Class)class;
+-(instancetype)init NS_UNAVAILABLE;
+///@discussion SELECT tableColumns FROM table AS tableAlias
+-(NSString *)selectStatementWithTable:(NSString *)table;
+///@discussion SELECT listTableColumns FROM table AS tableAlias
+-(NSString *)listSelectStatementWithTable:(NSString *)table;
+///@discussion SELECT listTableColumns, tableAlias.sortBy AS pageSortValue, tableAlias.primaryKeyColumn AS pageKey FROM table AS tableAlias
+-(NSString *)pageSelectStatementWithTable:(NSString *)table sortBy:(GWMColumnName)sortBy;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,156 @@
+//
+//  GWMClassMetadata.m
+//  GWMDatabase
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+
+#import "GWMClassMetadata.h"
+#import "GWMDataItem.h"
+
+@interface GWMClassMetadata ()
+
+@property (nonatomic, readwrite) NSString *className;
+@property (nonatomic, readwrite) NSArray<GWMColumnDefinition*> *columnDefinitions;
+@property (nonatomic, readwrite) NSArray<GWMAggregateDefinition*> *aggregateDefinitions;
+@property (nonatomic, readwrite) NSDictionary<NSString*,GWMAggregateDefinition*> *countDefinitionsByCollectionKey;
+@property (nonatomic, readwrite) NSArray<NSString*> *tableColumns;
+@property (nonatomic, readwrite) NSArray<NSString*> *listTableColumns;
+@property (nonatomic, readwrite) NSArray<NSString*> *detailTableColumns;
+@property (nonatomic, readwrite) NSString *selectColumnsString;
+@property (nonatomic, readwrite) GWMColumnName primaryKeyColumn;
+@property (nonatomic, readwrite) NSString *primaryKeyProperty;
+@property (nonatomic, readwrite) NSDictionary<GWMColumnName,NSString*> *tableColumnInfo;
+@property (nonatomic, strong) NSString *tableAlias;
+///@discussion The statements built for each table, where the key is the table and then the kind of statement.
+@property (nonatomic, strong) NSMutableDictionary<NSString*,NSMutableDictionary<NSString*,NSString*>*> *statementsByTable;
+
+@end
+
+@implementation GWMClassMetadata
+
++(instancetype)metadataForClass:(Class)class
+{
+    static NSMutableDictionary<NSString*,GWMClassMetadata*> *_registry = nil;
+    static dispatch_once_t predicate;
+
+    dispatch_once(&predicate, ^{
+        _registry = [NSMutableDictionary new];
+    });
+
+    NSString *className = NSStringFromClass(class);
+
+    @synchronized (_registry) {
+        GWMClassMetadata *metadata = _registry[className];
+        if (!metadata) {
+            metadata = [[self alloc] initWithClass:class];
+            _registry[className] = metadata;
+        }
+        return metadata;
+    }
+}
+
+-(instancetype)initWithClass:(Class<GWMDataItem>)class
+{
+    if (self = [super init]) {
+
+        NSArray<GWMColumnDefinition*> *definitions = [class columnDefinitionItems];
+        NSMutableArray<NSString*> *mutableTableColumns = [NSMutableArray<NSString*> new];
+        NSMutableArray<NSString*> *mutableListColumns = [NSMutableArray<NSString*> new];
+        NSMutableArray<NSString*> *mutableDetailColumns = [NSMutableArray<NSString*> new];
+        NSMutableDictionary<GWMColumnName,NSString*> *mutableColumnInfo = [NSMutableDictionary new];
+
+        for (GWMColumnDefinition *definition in definitions) {
+
+            // selectString looks up the alias of the class every time it is called
+            NSString *selectString = definition.selectString;
+            [mutableTableColumns addObject:selectString];
+            if (definition.include &GWMColumnIncludeInList)
+                [mutableListColumns addObject:selectString];
+            if (definition.include &GWMColumnIncludeInDetail)
+                [mutableDetailColumns addObject:selectString];
+
+            mutableColumnInfo[definition.name] = definition.property;
+
+            if (definition.options &GWMColumnOptionPrimaryKey && !_primaryKeyColumn) {
+                _primaryKeyColumn = definition.name;
+                _primaryKeyProperty = definition.property;
+            }
+        }
+
+        // aggregates are matched against the primary key, so a class without one has none
+        NSArray<GWMAggregateDefinition*> *aggregateDefinitions = _primaryKeyColumn ? [class aggregateDefinitionItems] : nil;
+        NSMutableDictionary<NSString*,GWMAggregateDefinition*> *mutableCountDefinitions = [NSMutableDictionary new];
+        NSString *tableAlias = [class tableAlias];
+
+        for (GWMAggregateDefinition *definition in aggregateDefinitions) {
+
+            NSString *selectString = [definition selectStringWithTableAlias:tableAlias primaryKeyColumn:_primaryKeyColumn];
+            if (definition.include &GWMColumnIncludeInList)
+                [mutableListColumns addObject:selectString];
+            if (definition.include &GWMColumnIncludeInDetail)
+                [mutableDetailColumns addObject:selectString];
+
+            if (definition.function == GWMAggregateCount && definition.collectionKey)
+                mutableCountDefinitions[definition.collectionKey] = definition;
+        }
+
+        _className = NSStringFromClass(class);
+        _columnDefinitions = [NSArray arrayWithArray:definitions];
+        _aggregateDefinitions = aggregateDefinitions ? [NSArray arrayWithArray:aggregateDefinitions] : @[];
+        _countDefinitionsByCollectionKey = [NSDictionary dictionaryWithDictionary:mutableCountDefinitions];
+        _tableColumns = [NSArray arrayWithArray:mutableTableColumns];
+        _listTableColumns = [NSArray arrayWithArray:mutableListColumns];
+        _detailTableColumns = [NSArray arrayWithArray:mutableDetailColumns];
+        _selectColumnsString = [_tableColumns componentsJoinedByString:@", "];
+        _tableColumnInfo = [NSDictionary dictionaryWithDictionary:mutableColumnInfo];
+        _tableAlias = tableAlias;
+        _statementsByTable = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Statements
+
+-(NSString *)statementWithTable:(NSString *)table kind:(NSString *)kind builder:(NSString *(^)(void))builder
+{
+    @synchronized (self) {
+        NSMutableDictionary<NSString*,NSString*> *statements = self.statementsByTable[table];
+        if (!statements) {
+            statements = [NSMutableDictionary new];
+            self.statementsByTable[table] = statements;
+        }
+
+        NSString *statement = statements[kind];
+        if (!statement) {
+            statement = builder();
+            statements[kind] = statement;
+        }
+        return statement;
+    }
+}
+
+-(NSString *)selectStatementWithTable:(NSString *)table
+{
+    return [self statementWithTable:table kind:@"SELECT" builder:^NSString *{
+        return [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@", self.selectColumnsString, table, self.tableAlias];
+    }];
+}
+
+-(NSString *)listSelectStatementWithTable:(NSString *)table
+{
+    return [self statementWithTable:table kind:@"SELECT LIST" builder:^NSString *{
+        return [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@", [self.listTableColumns componentsJoinedByString:@", "], table, self.tableAlias];
+    }];
+}
+
+-(NSString *)pageSelectStatementWithTable:(NSString *)table sortBy:(GWMColumnName)sortBy
+{
+    NSString *kind = [NSString stringWithFormat:@"SELECT PAGE %@", sortBy];
+    return [self statementWithTable:table kind:kind builder:^NSString *{
+        return [NSString stringWithFormat:@"SELECT %@, %@.%@ AS %@, %@.%@ AS %@ FROM %@ AS %@", [self.listTableColumns componentsJoinedByString:@", "], self.tableAlias, sortBy, GWMTableColumnPageSortValue, self.tableAlias, self.primaryKeyColumn, GWMTableColumnPageKey, table, self.tableAlias];
+    }];
+}
+
+@end
@@ -26,6 +26,13 @@ typedef NS_ENUM(NSInteger, GWMReadWriteDestination) {
  * @param error An NSError.
  */
 typedef void (^GWMSaveDataItemCompletionBlock)(NSInteger itemID, NSError *_Nullable error);
+/*!
+ * @brief A block that will run after a batch save or delete.
+ * @param itemIDs An NSArray with one NSInteger for each item, in the same order as the items. For a save it is the value assigned from the database or kGWMNewRecordValue if the item could not be saved. For a delete it is the itemID of the item.
+ * @param itemErrors An NSDictionary where the key is the index of an item that could not be saved or deleted and the value is the error. nil if there were no errors.
+ * @param error An NSError that is generated if a group of items could not be committed.
+ */
+typedef void (^GWMSaveDataItemsCompletionBlock)(NSArray<NSNumber*> *itemIDs, NSDictionary<NSNumber*,NSError*> *_Nullable itemErrors, NSError *_Nullable error);
 
 /*!
  * GWMDataItem is a class that can represent a record in a SQLite table. It can be used as is or it can be subclassed.
@@ -98,6 +105,7 @@ typedef void (^GWMSaveDataItemCompletionBlock)(NSInteger itemID, NSError *_Nulla
 +(NSDictionary<GWMColumnName,GWMColumnName>*)columnOverrideInfo;
 /*!
  *@brief Used to create and select data from tables in a SQLite database.
+ *@discussion This method is called once per class, the first time the columns of the class are needed. The result is kept and used by tableColumnInfo, tableColumns, listTableColumns, detailTableColumns and the statements that save and delete records, so it should not change while the application is running.
  *@return An NSArray of GWMColumnDefinition objects.
  */
 +(NSArray<GWMColumnDefinition*>*)columnDefinitionItems;
@@ -117,6 +125,12 @@ typedef void (^GWMSaveDataItemCompletionBlock)(NSInteger itemID, NSError *_Nulla
  *@return An NSArray of GWMTriggerDefinition objects.
  */
 +(NSArray<GWMTriggerDefinition*>*_Nullable)triggerDefinitionItems;
+/*!
+ *@brief Values computed from related rows, such as counts of relationships, that are selected with the records.
+ *@discussion The values are added to listTableColumns and detailTableColumns as correlated subqueries, following the include of each definition, so a list can show the count of related items without loading them. They are not part of tableColumns and are never saved. The default implementation returns nil.
+ *@return An NSArray of GWMAggregateDefinition objects.
+ */
++(NSArray<GWMAggregateDefinition*>*_Nullable)aggregateDefinitionItems;
 /*!
  *@brief Column to property mappings.
  *@return An NSDictionary containing column to property mappings where the key is the table column and the value is the object property.
@@ -137,6 +151,19 @@ typedef void (^GWMSaveDataItemCompletionBlock)(NSInteger itemID, NSError *_Nulla
  */
 +(NSString *)tableAlias;
 /*!
+ *@brief The columns that identify an existing record when the record is saved.
+ *@discussion saveTo:completion: inserts the record, or updates the existing record with the same values in these columns, in a single statement. The table must have a PRIMARY KEY or UNIQUE constraint on exactly these columns. The default implementation returns the primary key column.
+ *@return A NSArray object.
+ */
++(NSArray<GWMColumnName>*)upsertConflictColumns;
+/*!
+ *@brief The text columns kept in a full-text search index.
+ *@discussion When a subclass returns columns, createTableWithClassName:schema:completion: also creates an FTS5 index of these columns that triggers keep in sync with the table, and searchItemsOfClass:matching:scope:limit: can search it. The default implementation returns nil, so the table has no search index.
+ *@return A NSArray object, or nil.
+ */
++(NSArray<GWMColumnName>*_Nullable)searchableColumns;
+/*!
+ * @discussion If one of the aggregateDefinitionItems of the class is a GWMAggregateCount with key as its collectionKey, the count selected with the record is returned and the collection is not read.
  * @param key An NSString representation of a property of the reciever whose return type is an NSArray, NSDictionary, or NSSet. Cannot be nil.
  * @return An NSInteger that tells the count of the collection.
  */
@@ -156,13 +183,25 @@ typedef void (^GWMSaveDataItemCompletionBlock)(NSInteger itemID, NSError *_Nulla
  * @return An NSDictionary of entries where the key is the class and the value is a NSString representation of the selector to use when the device is rotated to landscape.
  */
 -(NSDictionary<NSString*,NSString*> *)childDetailLandscapeDataSelectors;
+/*!
+ * @brief The column values written when the receiver is saved.
+ * @discussion The key is the table column and the value is the value to write. The primary key is included when the receiver already has an itemID.
+ * @return An NSDictionary object.
+ */
+-(NSDictionary<GWMColumnName,id> *)valuesForSaving;
 /*!
  * @brief Save the record represented by the receiver.
- * @discussion The first thing this method does is determine whether the record being saved already exists. For a GWMDataItem, the record is queried based on the itemID. For a GWMRelationshipItem, the record is queried based on the itemID and the relatedItemID.
+ * @discussion The record is inserted or, if it already exists, updated with a single INSERT ... ON CONFLICT DO UPDATE statement. For a GWMDataItem, an existing record is matched on the itemID. For a GWMRelationshipItem, an existing record is matched on the itemID and the relatedItemID. See upsertConflictColumns. When the statement cannot be used, because of an older SQLite version or a table without the matching constraint, the record is queried first and then updated or inserted.
  * @param destination The database to save to. Current choices are local and cloud.
  * @param completion A block that will run after the query has finished. The block takes an NSInteger and an NSError as arguments and returns void. This paramter can be nil.
  */
 -(void)saveTo:(GWMReadWriteDestination)destination completion:(GWMSaveDataItemCompletionBlock _Nullable)completion;
+/*!
+ * @brief Save the record represented by the receiver in the next batch of the write-behind queue.
+ * @discussion Runs saveTo:completion: with GWMReadWriteLocal in the write-behind queue of the databaseController, so it is committed together with other small writes. See GWMDatabaseController enqueueWrite:completion:. The values of the receiver are read when the batch runs, not when this method is called.
+ * @param completion A block that will run after the batch has been committed. The block takes an NSInteger and an NSError as arguments and returns void. This paramter can be nil.
+ */
+-(void)enqueueSaveWithCompletion:(GWMSaveDataItemCompletionBlock _Nullable)completion;
 /*!
  * @brief Delete the record represented by the receiver.
  * @discussion The first thing this method does is determine whether the record being saved already exists. For a GWMDataItem, the record is queried based on the itemID. For a GWMRelationshipItem, the record is queried based on the itemID and the relatedItemID.
@@ -227,6 +266,16 @@ extern GWMColumnAffinity const GWMColumnAffinityHistoricDateTime;
  *@discussion The coresponding value is a NSString representation of the class that will be instantiated by the GWMDatabaseController. This column is a derived column, it is not used in table creation neither is the class value stored in any table.
  */
 extern GWMColumnName const GWMTableColumnClass;
+/*!
+ *@brief Represents the 'pageSortValue' column in a SQLite select statement.
+ *@discussion The value a page of items is sorted by, as it is stored in the table. The GWMDatabaseController reads it from the last row of a page to build the continuation token. It is not set on the item.
+ */
+extern GWMColumnName const GWMTableColumnPageSortValue;
+/*!
+ *@brief Represents the 'pageKey' column in a SQLite select statement.
+ *@discussion The primary key of a row of a page of items. Like pageSortValue, it is read by the GWMDatabaseController for the continuation token, even when the row can't be mapped to an item, and is not set on the item.
+ */
+extern GWMColumnName const GWMTableColumnPageKey;
 /*!
  *@brief Represents the 'pKey' column in a SQLite table.
  *@discussion This is currently the default primary key column of any table that coresponds to a GWMDataItem.
@@ -304,6 +353,26 @@ extern NSErrorDomain const GWMErrorDomainDataModel;
  */
 -(instancetype)initWithName:(NSString *)name;
 
+#pragma mark Batch Operations
+/*!
+ * @brief Save many records at once.
+ * @discussion The items are grouped by class and saved to the table in classToTableMapping with one upsert statement per group, which is prepared once and reused for every item in the group. Each group is committed in one transaction or in chunks. Groups that cannot use an upsert are saved one item at a time with saveTo:completion:.
+ * @param items The GWMDataItem objects to save. Items of different classes can be mixed.
+ * @param destination The database to save to. Current choices are local and cloud.
+ * @param chunkSize The number of records to commit at a time. Entering 0 commits each group in a single transaction.
+ * @param completion A block that will run after every item has been saved. This paramter can be nil.
+ */
++(void)saveItems:(NSArray<__kindof GWMDataItem*> *)items to:(GWMReadWriteDestination)destination chunkSize:(NSUInteger)chunkSize completion:(GWMSaveDataItemsCompletionBlock _Nullable)completion;
+/*!
+ * @brief Delete many records at once.
+ * @discussion The items are grouped by class and deleted from the table in classToTableMapping with DELETE ... WHERE ... IN (...) statements that match the upsertConflictColumns of the class. Each group is deleted in one transaction.
+ * @param items The GWMDataItem objects to delete. Items of different classes can be mixed.
+ * @param destination The database to delete from. Current choices are local and cloud.
+ * @param chunkSize The number of records to match in one statement. Entering 0 matches as many as SQLite allows.
+ * @param completion A block that will run after every item has been deleted. This paramter can be nil.
+ */
++(void)deleteItems:(NSArray<__kindof GWMDataItem*> *)items from:(GWMReadWriteDestination)destination chunkSize:(NSUInteger)chunkSize completion:(GWMSaveDataItemsCompletionBlock _Nullable)completion;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -9,6 +9,7 @@
 #import "GWMDataItem.h"
 #import "GWMDatabaseResult.h"
 #import "GWMDatabaseController.h"
+#import "GWMClassMetadata.h"
 
 const NSInteger kGWMNewRecordValue = -1;
 const NSInteger kGWMColumnSequenceItemClass = -2;
@@ -26,6 +27,8 @@ GWMColumnAffinity const GWMColumnAffinityDateTime = @"DATE_TIME";
 GWMColumnAffinity const GWMColumnAffinityHistoricDateTime = @"HISTORIC_DATE_TIME";
 
 GWMColumnName const GWMTableColumnClass = @"class";
+GWMColumnName const GWMTableColumnPageSortValue = @"pageSortValue";
+GWMColumnName const GWMTableColumnPageKey = @"pageKey";
 GWMColumnName const GWMTableColumnPkey = @"pKey";
 GWMColumnName const GWMTableColumnName = @"name";
 GWMColumnName const GWMTableColumnDescription = @"description";
@@ -152,6 +155,20 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
     return self;
 }
 
+#pragma mark - Helpers
+
+static GWMColumnName GWMPrimaryKeyColumnOfClass(Class class)
+{
+    return [GWMClassMetadata metadataForClass:class].primaryKeyColumn;
+}
+
+static id GWMColumnValueOfItem(GWMDataItem *item, GWMColumnName column)
+{
+    NSString *property = [GWMClassMetadata metadataForClass:[item class]].tableColumnInfo[column];
+    id value = property ? [item valueForKey:property] : nil;
+    return value ?: [NSNull null];
+}
+
 #pragma mark - GWMDataItem methods
 
 #pragma mark Save Record Changes
@@ -169,38 +186,31 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
                     completion(kGWMNewRecordValue,error);
                 return;
             }
-            NSDictionary<NSString*,NSString*> *columnToPropertyInfo = [[self class] tableColumnInfo];
-            NSMutableDictionary *mutableValues = [NSMutableDictionary new];
-            [columnToPropertyInfo enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull col, NSString *_Nonnull prop, BOOL *_Nonnull stop){
-                if ([col isEqualToString:GWMTableColumnPkey] || [prop isEqualToString:GWMTableColumnClass])
-                    return ;
-                
-                if ([self respondsToSelector:NSSelectorFromString(prop)]) {
-                    id valueToInsert = [self valueForKey:prop];
-                    if (valueToInsert != nil) {
-                        mutableValues[col] = valueToInsert;
-                    }
-                }
-                
-            }];
-            NSDictionary *values = [NSDictionary dictionaryWithDictionary:mutableValues];
-            __block GWMColumnName primaryKeyColumn = nil;
-            [[[self class] columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *col, NSUInteger idx, BOOL *stop){
-                if (col.options &GWMColumnOptionPrimaryKey) {
-                    primaryKeyColumn = col.name;
-                    *stop = YES;
-                }
-            }];
+            GWMColumnName primaryKeyColumn = GWMPrimaryKeyColumnOfClass([self class]);
             if (!primaryKeyColumn) {
                 NSError *error = [NSError errorWithDomain:GWMErrorDomainDataModel code:0 userInfo:@{}];
                 if(completion)
                     completion(kGWMNewRecordValue,error);
                 return;
             }
+            NSDictionary *upsertValues = [self valuesForSaving];
+            NSMutableDictionary *mutableValues = [NSMutableDictionary dictionaryWithDictionary:upsertValues];
+            mutableValues[primaryKeyColumn] = nil;
+            NSDictionary *values = [NSDictionary dictionaryWithDictionary:mutableValues];
+            
+            // insert or update in one statement
+            __block BOOL didUpsert = NO;
+            [self.databaseController upsertIntoTable:table values:upsertValues conflictColumns:[[self class] upsertConflictColumns] returningColumn:primaryKeyColumn completion:^(GWMDataItem *_Nullable itm, NSError *_Nullable err){
+                didUpsert = YES;
+                if(completion)
+                    completion(itm ? itm.itemID : kGWMNewRecordValue,err);
+            }];
+            // the completion does not run when the statement could not be prepared
+            if (didUpsert)
+                break;
+            
             NSDictionary *criteria = @{primaryKeyColumn:@(self.itemID)};
-            NSString *columns = [[[self class] tableColumns] componentsJoinedByString:@", "];
-            NSString *tableAlias = [[self class] tableAlias];
-            NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@", columns,table, tableAlias];
+            NSString *statement = [[GWMClassMetadata metadataForClass:[self class]] selectStatementWithTable:table];
             GWMDatabaseResult *result = [self.databaseController resultWithStatement:statement criteria:@[criteria] exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
             
             if (result.data.count > 0) {
@@ -233,6 +243,45 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
     }
 }
 
+-(void)enqueueSaveWithCompletion:(GWMSaveDataItemCompletionBlock)completion
+{
+    __block NSInteger savedItemID = kGWMNewRecordValue;
+    
+    [self.databaseController enqueueWrite:^NSError *{
+        __block NSError *saveError = nil;
+        [self saveTo:GWMReadWriteLocal completion:^(NSInteger itemID, NSError *_Nullable error){
+            savedItemID = itemID;
+            saveError = error;
+        }];
+        return saveError;
+    } completion:^(NSError *_Nullable error){
+        if (completion)
+            completion(error ? kGWMNewRecordValue : savedItemID, error);
+    }];
+}
+
+-(NSDictionary<GWMColumnName,id> *)valuesForSaving
+{
+    NSDictionary<NSString*,NSString*> *columnToPropertyInfo = [[self class] tableColumnInfo];
+    NSMutableDictionary *mutableValues = [NSMutableDictionary new];
+    [columnToPropertyInfo enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull col, NSString *_Nonnull prop, BOOL *_Nonnull stop){
+        if ([col isEqualToString:GWMTableColumnPkey] || [prop isEqualToString:GWMTableColumnClass])
+            return ;
+        
+        if ([self respondsToSelector:NSSelectorFromString(prop)]) {
+            id valueToInsert = [self valueForKey:prop];
+            if (valueToInsert != nil) {
+                mutableValues[col] = valueToInsert;
+            }
+        }
+        
+    }];
+    GWMColumnName primaryKeyColumn = GWMPrimaryKeyColumnOfClass([self class]);
+    if (primaryKeyColumn && self.itemID != kGWMNewRecordValue)
+        mutableValues[primaryKeyColumn] = @(self.itemID);
+    return [NSDictionary dictionaryWithDictionary:mutableValues];
+}
+
 -(void)deleteFrom:(GWMReadWriteDestination)destination completion:(GWMSaveDataItemCompletionBlock)completion
 {
     switch (destination) {
@@ -246,13 +295,8 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
                     completion(kGWMNewRecordValue,error);
                 return;
             }
-            __block GWMColumnName primaryKeyColumn = nil;
-            [[[self class] columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *col, NSUInteger idx, BOOL *stop){
-                if (col.options &GWMColumnOptionPrimaryKey) {
-                    primaryKeyColumn = col.name;
-                    *stop = YES;
-                }
-            }];
+            GWMClassMetadata *metadata = [GWMClassMetadata metadataForClass:[self class]];
+            GWMColumnName primaryKeyColumn = metadata.primaryKeyColumn;
             if (!primaryKeyColumn) {
                 NSError *error = [NSError errorWithDomain:GWMErrorDomainDataModel code:0 userInfo:@{}];
                 if(completion)
@@ -260,9 +304,7 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
                 return;
             }
             NSDictionary *criteria = @{primaryKeyColumn:@(self.itemID)};
-            NSString *columns = [[[self class] tableColumns] componentsJoinedByString:@", "];
-            NSString *tableAlias = [[self class] tableAlias];
-            NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@ %@", columns,table, tableAlias];
+            NSString *statement = [metadata selectStatementWithTable:table];
             GWMDatabaseResult *result = [self.databaseController resultWithStatement:statement criteria:@[criteria] exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
             
             if (result.data.count > 0){
@@ -286,6 +328,152 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
     }
 }
 
+#pragma mark Batch Operations
+
++(void)saveItems:(NSArray<__kindof GWMDataItem*> *)items to:(GWMReadWriteDestination)destination chunkSize:(NSUInteger)chunkSize completion:(GWMSaveDataItemsCompletionBlock)completion
+{
+    NSMutableArray<NSNumber*> *mutableItemIDs = [NSMutableArray<NSNumber*> new];
+    NSMutableDictionary<NSNumber*,NSError*> *mutableItemErrors = [NSMutableDictionary<NSNumber*,NSError*> new];
+    __block NSError *batchError = nil;
+    
+    for (NSUInteger idx = 0; idx < items.count; idx++)
+        [mutableItemIDs addObject:@(kGWMNewRecordValue)];
+    
+    if (destination != GWMReadWriteLocal) {
+        if (completion)
+            completion([NSArray arrayWithArray:mutableItemIDs], nil, nil);
+        return;
+    }
+    
+    // group the items by class, keeping their indexes
+    NSMutableDictionary<NSString*,NSMutableIndexSet*> *mutableGroups = [NSMutableDictionary new];
+    [items enumerateObjectsUsingBlock:^(GWMDataItem *_Nonnull item, NSUInteger idx, BOOL *stop){
+        NSString *className = NSStringFromClass([item class]);
+        if (!mutableGroups[className])
+            mutableGroups[className] = [NSMutableIndexSet indexSet];
+        [mutableGroups[className] addIndex:idx];
+    }];
+    
+    [mutableGroups enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull className, NSMutableIndexSet *_Nonnull indexes, BOOL *stop){
+        
+        NSArray<GWMDataItem*> *groupItems = [items objectsAtIndexes:indexes];
+        NSArray<NSNumber*> *groupIndexes = [self arrayWithIndexSet:indexes];
+        Class itemClass = NSClassFromString(className);
+        GWMDatabaseController *databaseController = groupItems.firstObject.databaseController;
+        NSString *table = databaseController.classToTableMapping[className];
+        GWMColumnName primaryKeyColumn = GWMPrimaryKeyColumnOfClass(itemClass);
+        
+        if (!table || !primaryKeyColumn) {
+            NSError *error = [NSError errorWithDomain:GWMErrorDomainDataModel code:0 userInfo:@{}];
+            for (NSNumber *itemIdx in groupIndexes)
+                mutableItemErrors[itemIdx] = error;
+            return;
+        }
+        
+        NSMutableArray<NSDictionary*> *mutableRows = [NSMutableArray<NSDictionary*> new];
+        for (GWMDataItem *item in groupItems)
+            [mutableRows addObject:[item valuesForSaving]];
+        
+        __block BOOL didUpsert = NO;
+        [databaseController upsertIntoTable:table rows:mutableRows conflictColumns:[itemClass upsertConflictColumns] returningColumn:primaryKeyColumn chunkSize:chunkSize completion:^(NSArray<NSNumber*> *itemIDs, NSDictionary<NSNumber*,NSError*> *rowErrors, NSError *error){
+            didUpsert = YES;
+            [itemIDs enumerateObjectsUsingBlock:^(NSNumber *_Nonnull itemID, NSUInteger rowIdx, BOOL *stop){
+                mutableItemIDs[groupIndexes[rowIdx].unsignedIntegerValue] = itemID;
+            }];
+            [rowErrors enumerateKeysAndObjectsUsingBlock:^(NSNumber *_Nonnull rowIdx, NSError *_Nonnull rowError, BOOL *stop){
+                mutableItemErrors[groupIndexes[rowIdx.unsignedIntegerValue]] = rowError;
+            }];
+            if (error)
+                batchError = error;
+        }];
+        
+        if (didUpsert)
+            return;
+        
+        // the table cannot be upserted, save the items one at a time
+        [groupItems enumerateObjectsUsingBlock:^(GWMDataItem *_Nonnull item, NSUInteger rowIdx, BOOL *stop){
+            NSNumber *itemIdx = groupIndexes[rowIdx];
+            [item saveTo:destination completion:^(NSInteger itemID, NSError *_Nullable error){
+                mutableItemIDs[itemIdx.unsignedIntegerValue] = @(itemID);
+                if (error)
+                    mutableItemErrors[itemIdx] = error;
+            }];
+        }];
+    }];
+    
+    if (completion)
+        completion([NSArray arrayWithArray:mutableItemIDs], mutableItemErrors.count > 0 ? [NSDictionary dictionaryWithDictionary:mutableItemErrors] : nil, batchError);
+}
+
++(void)deleteItems:(NSArray<__kindof GWMDataItem*> *)items from:(GWMReadWriteDestination)destination chunkSize:(NSUInteger)chunkSize completion:(GWMSaveDataItemsCompletionBlock)completion
+{
+    NSMutableArray<NSNumber*> *mutableItemIDs = [NSMutableArray<NSNumber*> new];
+    NSMutableDictionary<NSNumber*,NSError*> *mutableItemErrors = [NSMutableDictionary<NSNumber*,NSError*> new];
+    __block NSError *batchError = nil;
+    
+    for (GWMDataItem *item in items)
+        [mutableItemIDs addObject:@(item.itemID)];
+    
+    if (destination != GWMReadWriteLocal) {
+        if (completion)
+            completion([NSArray arrayWithArray:mutableItemIDs], nil, nil);
+        return;
+    }
+    
+    NSMutableDictionary<NSString*,NSMutableIndexSet*> *mutableGroups = [NSMutableDictionary new];
+    [items enumerateObjectsUsingBlock:^(GWMDataItem *_Nonnull item, NSUInteger idx, BOOL *stop){
+        NSString *className = NSStringFromClass([item class]);
+        if (!mutableGroups[className])
+            mutableGroups[className] = [NSMutableIndexSet indexSet];
+        [mutableGroups[className] addIndex:idx];
+    }];
+    
+    [mutableGroups enumerateKeysAndObjectsUsingBlock:^(NSString *_Nonnull className, NSMutableIndexSet *_Nonnull indexes, BOOL *stop){
+        
+        NSArray<GWMDataItem*> *groupItems = [items objectsAtIndexes:indexes];
+        NSArray<NSNumber*> *groupIndexes = [self arrayWithIndexSet:indexes];
+        Class itemClass = NSClassFromString(className);
+        GWMDatabaseController *databaseController = groupItems.firstObject.databaseController;
+        NSString *table = databaseController.classToTableMapping[className];
+        NSArray<GWMColumnName> *columns = [itemClass upsertConflictColumns];
+        
+        if (!table || columns.count == 0) {
+            NSError *error = [NSError errorWithDomain:GWMErrorDomainDataModel code:0 userInfo:@{}];
+            for (NSNumber *itemIdx in groupIndexes)
+                mutableItemErrors[itemIdx] = error;
+            return;
+        }
+        
+        NSMutableArray<NSArray*> *mutableRows = [NSMutableArray<NSArray*> new];
+        for (GWMDataItem *item in groupItems) {
+            NSMutableArray *mutableRow = [NSMutableArray new];
+            for (GWMColumnName column in columns)
+                [mutableRow addObject:GWMColumnValueOfItem(item, column)];
+            [mutableRows addObject:[NSArray arrayWithArray:mutableRow]];
+        }
+        
+        [databaseController deleteFromTable:table matchingColumns:columns values:mutableRows chunkSize:chunkSize completion:^(NSUInteger deletedCount, NSDictionary<NSNumber*,NSError*> *rowErrors, NSError *error){
+            [rowErrors enumerateKeysAndObjectsUsingBlock:^(NSNumber *_Nonnull rowIdx, NSError *_Nonnull rowError, BOOL *stop){
+                mutableItemErrors[groupIndexes[rowIdx.unsignedIntegerValue]] = rowError;
+            }];
+            if (error)
+                batchError = error;
+        }];
+    }];
+    
+    if (completion)
+        completion([NSArray arrayWithArray:mutableItemIDs], mutableItemErrors.count > 0 ? [NSDictionary dictionaryWithDictionary:mutableItemErrors] : nil, batchError);
+}
+
++(NSArray<NSNumber*> *)arrayWithIndexSet:(NSIndexSet *)indexes
+{
+    NSMutableArray<NSNumber*> *mutableIndexes = [NSMutableArray<NSNumber*> new];
+    [indexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop){
+        [mutableIndexes addObject:@(idx)];
+    }];
+    return [NSArray arrayWithArray:mutableIndexes];
+}
+
 #pragma mark Table Column Info
 
 +(NSArray<GWMColumnName>*)excludedColumns
@@ -369,44 +557,41 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
     return nil;
 }
 
++(NSArray<GWMAggregateDefinition*>*)aggregateDefinitionItems
+{
+    return nil;
+}
+
++(NSArray<GWMColumnName>*)upsertConflictColumns
+{
+    GWMColumnName primaryKeyColumn = GWMPrimaryKeyColumnOfClass(self);
+    return primaryKeyColumn ? @[primaryKeyColumn] : @[];
+}
+
++(NSArray<GWMColumnName>*)searchableColumns
+{
+    return nil;
+}
+
+// built once per class from columnDefinitionItems, see GWMClassMetadata
 +(NSDictionary<GWMColumnName,NSString*> *)tableColumnInfo
 {
-    NSMutableDictionary<GWMColumnName,NSString*> *mutableColumnInfo = [NSMutableDictionary new];
-    
-    [[self columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *col, NSUInteger idx, BOOL *stop){
-        mutableColumnInfo[col.name] = col.property;
-    }];
-    
-    return [NSDictionary dictionaryWithDictionary:mutableColumnInfo];
+    return [GWMClassMetadata metadataForClass:self].tableColumnInfo;
 }
 
 +(NSArray<GWMColumnName> *)tableColumns
 {
-    NSMutableArray<NSString*> *mutableColumnDefs = [NSMutableArray<NSString*> new];
-    [[self columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *_Nonnull definition, NSUInteger idx, BOOL *_Nonnull stop){
-        [mutableColumnDefs addObject:definition.selectString];
-    }];
-    return [NSArray<NSString*> arrayWithArray:mutableColumnDefs];
+    return [GWMClassMetadata metadataForClass:self].tableColumns;
 }
 
 +(NSArray<GWMColumnName> *)listTableColumns
 {
-    NSMutableArray<NSString*> *mutableColumnDefs = [NSMutableArray<NSString*> new];
-    [[self columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *_Nonnull definition, NSUInteger idx, BOOL *_Nonnull stop){
-        if (definition.include &GWMColumnIncludeInList)
-            [mutableColumnDefs addObject:definition.selectString];
-    }];
-    return [NSArray<NSString*> arrayWithArray:mutableColumnDefs];
+    return [GWMClassMetadata metadataForClass:self].listTableColumns;
 }
 
 +(NSArray<GWMColumnName> *)detailTableColumns
 {
-    NSMutableArray<NSString*> *mutableColumnDefs = [NSMutableArray<NSString*> new];
-    [[self columnDefinitionItems] enumerateObjectsUsingBlock:^(GWMColumnDefinition *_Nonnull definition, NSUInteger idx, BOOL *_Nonnull stop){
-        if (definition.include &GWMColumnIncludeInDetail)
-            [mutableColumnDefs addObject:definition.selectString];
-    }];
-    return [NSArray<NSString*> arrayWithArray:mutableColumnDefs];
+    return [GWMClassMetadata metadataForClass:self].detailTableColumns;
 }
 
 -(NSString *)rowIdentifier
@@ -431,6 +616,11 @@ NSErrorDomain const GWMErrorDomainDataModel = @"GWMErrorDomainDataModel";
 
 -(NSInteger)countOfRelatedItemsForKey:(NSString *)key
 {
+    // a count selected with the record avoids loading the collection
+    GWMAggregateDefinition *countDefinition = [GWMClassMetadata metadataForClass:[self class]].countDefinitionsByCollectionKey[key];
+    if (countDefinition)
+        return [[self valueForKey:countDefinition.property] integerValue];
+    
     id rawItems = [self valueForKey:key];
     
     if ([rawItems isKindOfClass:[NSArray class]]) {
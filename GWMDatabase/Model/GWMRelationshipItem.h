@@ -25,10 +25,20 @@ extern GWMColumnName const GWMTableColumnRelationshipKey;
 @property (nonatomic, assign) NSInteger dataItemID;
 @property (nonatomic, assign) NSInteger relatedDataItemID;
 @property (nonatomic, assign) NSInteger relationshipID;
+///@discussion The item with the relatedDataItemID, when the relationship was loaded by prefetchRelationshipsForItems:relatedClass:. Otherwise nil.
+@property (nonatomic, strong, nullable) __kindof GWMDataItem *relatedItem;
 
 +(instancetype)relationshipItemWithDataID:(NSInteger)dataID relatedID:(NSInteger)relatedID;
 
 -(instancetype)initWithDataID:(NSInteger)dataID relatedID:(NSInteger)relatedID;
+/*!
+ * @brief Load the relationships of many items at once.
+ * @discussion Calling initWithDataID:relatedID: for the relationships of each item of a list runs one query per relationship. This method runs one query for the relationship rows of all the items, matched on their itemIDs with json_each, and one more query for the related items, so a list costs the same two queries for any number of items. Call it on the relationship class whose table holds the rows.
+ * @param items The GWMDataItem objects whose relationships to load. Their itemID is matched against the dataItemID of the relationships.
+ * @param relatedClass The GWMDataItem class of the related items, which are set as the relatedItem of each relationship. Entering nil loads only the relationships.
+ * @return An NSDictionary where the key is the itemID of an item and the value is an NSArray of its relationships, in table order. Items without relationships are left out.
+ */
++(NSDictionary<NSNumber*,NSArray<__kindof GWMRelationshipItem*>*> *)prefetchRelationshipsForItems:(NSArray<__kindof GWMDataItem*> *)items relatedClass:(Class _Nullable)relatedClass;
 
 @end
 
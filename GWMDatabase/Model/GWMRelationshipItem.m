@@ -9,6 +9,8 @@
 #import "GWMRelationshipItem.h"
 #import "GWMDatabaseResult.h"
 #import "GWMDatabaseController.h"
+#import "GWMClassMetadata.h"
+#import "GWMCompiledQuery.h"
 
 GWMColumnName const GWMTableColumnDataItemKey = @"itemKey";
 GWMColumnName const GWMTableColumnRelatedDataItemKey = @"relatedItemKey";
@@ -33,14 +35,13 @@ GWMColumnName const GWMTableColumnRelationshipKey = @"relationshipKey";
                 //                if(completion)
                 //                    completion(kGWMNewRecordValue, error);
                 //                return;
+                return self;
             }
             NSDictionary *overrideInfo = [[self class] columnOverrideInfo];
             NSArray *criteria = @[@{overrideInfo[GWMTableColumnDataItemKey]:@(dataID),
                                     overrideInfo[GWMTableColumnRelatedDataItemKey]:@(relatedID)
                                     }];
-            NSString *columns = [[[self class] tableColumns] componentsJoinedByString:@", "];
-            NSString *tableString = [NSString stringWithFormat:@"%@ %@",table,[[self class] tableAlias]];
-            NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@", columns,tableString];
+            NSString *statement = [[GWMClassMetadata metadataForClass:[self class]] selectStatementWithTable:table];
             GWMDatabaseResult *result = [self.databaseController resultWithStatement:statement criteria:criteria exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
             
             if (result.data.count > 0) {
@@ -53,6 +54,54 @@ GWMColumnName const GWMTableColumnRelationshipKey = @"relationshipKey";
     return self;
 }
 
++(NSDictionary<NSNumber*,NSArray<__kindof GWMRelationshipItem*>*> *)prefetchRelationshipsForItems:(NSArray<__kindof GWMDataItem*> *)items relatedClass:(Class)relatedClass
+{
+    GWMDatabaseController *databaseController = items.firstObject.databaseController;
+    NSString *table = databaseController.classToTableMapping[NSStringFromClass(self)];
+    
+    if (!table || items.count == 0)
+        return @{};
+    
+    NSMutableOrderedSet<NSNumber*> *mutableItemIDs = [NSMutableOrderedSet<NSNumber*> new];
+    for (GWMDataItem *item in items)
+        [mutableItemIDs addObject:@(item.itemID)];
+    
+    // one statement for the relationships of all the items
+    NSDictionary *overrideInfo = [self columnOverrideInfo];
+    NSString *statement = [NSString stringWithFormat:@"%@ WHERE %@.%@ IN (%@)", [[GWMClassMetadata metadataForClass:self] selectStatementWithTable:table], [self tableAlias], overrideInfo[GWMTableColumnDataItemKey], GWMSQLiteItemIDSetSelect];
+    GWMDatabaseResult *result = [databaseController resultWithStatement:statement criteria:@[GWMJSONArrayWithItemIDs(mutableItemIDs.array)] completion:nil];
+    
+    NSArray<GWMRelationshipItem*> *relationships = result.data;
+    
+    if (relationships.count == 0)
+        return @{};
+    
+    // one more for the related items
+    if (relatedClass) {
+        NSMutableOrderedSet<NSNumber*> *mutableRelatedIDs = [NSMutableOrderedSet<NSNumber*> new];
+        for (GWMRelationshipItem *relationship in relationships)
+            [mutableRelatedIDs addObject:@(relationship.relatedDataItemID)];
+        
+        NSArray<GWMDataItem*> *relatedItems = [databaseController fetchItemsOfClass:relatedClass withIDs:mutableRelatedIDs.array].data;
+        NSMutableDictionary<NSNumber*,GWMDataItem*> *mutableRelatedItems = [NSMutableDictionary<NSNumber*,GWMDataItem*> dictionaryWithCapacity:relatedItems.count];
+        for (GWMDataItem *relatedItem in relatedItems)
+            mutableRelatedItems[@(relatedItem.itemID)] = relatedItem;
+        
+        for (GWMRelationshipItem *relationship in relationships)
+            relationship.relatedItem = mutableRelatedItems[@(relationship.relatedDataItemID)];
+    }
+    
+    NSMutableDictionary<NSNumber*,NSMutableArray<GWMRelationshipItem*>*> *mutableRelationships = [NSMutableDictionary new];
+    for (GWMRelationshipItem *relationship in relationships) {
+        NSNumber *dataItemID = @(relationship.dataItemID);
+        if (!mutableRelationships[dataItemID])
+            mutableRelationships[dataItemID] = [NSMutableArray<GWMRelationshipItem*> new];
+        [mutableRelationships[dataItemID] addObject:relationship];
+    }
+    
+    return [NSDictionary dictionaryWithDictionary:mutableRelationships];
+}
+
 +(NSString*)tableAlias
 {
     return @"LK";
@@ -110,20 +159,35 @@ GWMColumnName const GWMTableColumnRelationshipKey = @"relationshipKey";
     return [NSArray arrayWithArray:mutableDefinitions];
 }
 
-+(NSDictionary<GWMColumnName,NSString*> *)tableColumnInfo
++(NSArray<GWMTableConstraintDefinition*>*)constraintDefinitionItems
 {
-    NSMutableDictionary *mutableInfo = [NSMutableDictionary dictionaryWithDictionary:[super tableColumnInfo]];
-    
-    mutableInfo[GWMTableColumnDataItemKey] = NSStringFromSelector(@selector(dataItemID));
-    mutableInfo[GWMTableColumnRelatedDataItemKey] = NSStringFromSelector(@selector(relatedDataItemID));
-    mutableInfo[GWMTableColumnRelationshipKey] = NSStringFromSelector(@selector(relationshipID));
-    mutableInfo[GWMTableColumnName] = nil;
-    mutableInfo[GWMTableColumnDescription] = nil;
-    return [NSDictionary dictionaryWithDictionary:mutableInfo];
+    NSDictionary *columnNameInfo = [[self class] columnOverrideInfo];
+    return @[[GWMTableConstraintDefinition tableConstraintWithName:@"un_RelationshipItem_items" style:GWMConstraintUnique columns:@[columnNameInfo[GWMTableColumnDataItemKey], columnNameInfo[GWMTableColumnRelatedDataItemKey]] referenceTable:nil referenceColumn:nil onConflict:GWMDBOnConflictAbort]];
+}
+
++(NSArray<GWMColumnName>*)upsertConflictColumns
+{
+    NSDictionary *columnNameInfo = [[self class] columnOverrideInfo];
+    return @[columnNameInfo[GWMTableColumnDataItemKey], columnNameInfo[GWMTableColumnRelatedDataItemKey]];
 }
 
 #pragma mark Save Record Changes
 
+-(NSDictionary<GWMColumnName,id> *)valuesForSaving
+{
+    NSDictionary *overrideInfo = [[self class] columnOverrideInfo];
+    NSDictionary<NSString*,id> *values = @{overrideInfo[GWMTableColumnDataItemKey]:@(self.dataItemID),
+                                           overrideInfo[GWMTableColumnRelatedDataItemKey]:@(self.relatedDataItemID),
+                                           overrideInfo[GWMTableColumnRelationshipKey]:@(self.relationshipID)};
+    NSArray *excluded = [[self class] excludedColumns];
+    NSMutableDictionary *mutableValues = [NSMutableDictionary new];
+    [values enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop){
+        if (![excluded containsObject:key])
+            mutableValues[key] = obj;
+    }];
+    return [NSDictionary dictionaryWithDictionary:mutableValues];
+}
+
 -(void)saveTo:(GWMReadWriteDestination)destination completion:(GWMSaveDataItemCompletionBlock _Nullable)completion
 {
     switch (destination) {
@@ -138,21 +202,22 @@ GWMColumnName const GWMTableColumnRelationshipKey = @"relationshipKey";
                 return;
             }
             NSDictionary *overrideInfo = [[self class] columnOverrideInfo];
-            NSDictionary<NSString*,id> *values = @{overrideInfo[GWMTableColumnDataItemKey]:@(self.dataItemID),
-                                     overrideInfo[GWMTableColumnRelatedDataItemKey]:@(self.relatedDataItemID),
-                                     overrideInfo[GWMTableColumnRelationshipKey]:@(self.relationshipID)};
-            NSArray *excluded = [[self class] excludedColumns];
-            NSMutableDictionary *mutableValues = [NSMutableDictionary new];
-            [values enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop){
-                if (![excluded containsObject:key])
-                    mutableValues[key] = obj;
+            NSDictionary *finalValues = [self valuesForSaving];
+            
+            // insert or update in one statement
+            __block BOOL didUpsert = NO;
+            [self.databaseController upsertIntoTable:table values:finalValues conflictColumns:[[self class] upsertConflictColumns] returningColumn:overrideInfo[GWMTableColumnPkey] completion:^(GWMDataItem *_Nullable itm, NSError *_Nullable err){
+                didUpsert = YES;
+                if(completion)
+                    completion(itm ? itm.itemID : kGWMNewRecordValue,err);
             }];
-            NSDictionary *finalValues = [NSDictionary dictionaryWithDictionary:mutableValues];
+            // the completion does not run when the statement could not be prepared
+            if (didUpsert)
+                break;
+            
             NSDictionary *criteria = @{overrideInfo[GWMTableColumnDataItemKey]:@(self.dataItemID),
                                        overrideInfo[GWMTableColumnRelatedDataItemKey]:@(self.relatedDataItemID)};
-            NSString *columns = [[[self class] tableColumns] componentsJoinedByString:@", "];
-            NSString *tableString = [NSString stringWithFormat:@"%@ %@",table,[[self class] tableAlias]];
-            NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@", columns,tableString];
+            NSString *statement = [[GWMClassMetadata metadataForClass:[self class]] selectStatementWithTable:table];
             GWMDatabaseResult *result = [self.databaseController resultWithStatement:statement criteria:@[criteria] exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
             
             if (result.data.count > 0) {
@@ -202,9 +267,7 @@ GWMColumnName const GWMTableColumnRelationshipKey = @"relationshipKey";
             NSDictionary *overrideInfo = [[self class] columnOverrideInfo];
             NSDictionary *criteria = @{overrideInfo[GWMTableColumnDataItemKey]:@(self.dataItemID),
                                        overrideInfo[GWMTableColumnRelatedDataItemKey]:@(self.relatedDataItemID)};
-            NSString *columns = [[[self class] tableColumns] componentsJoinedByString:@", "];
-            NSString *tableString = [NSString stringWithFormat:@"%@ %@",table,[[self class] tableAlias]];
-            NSString *statement = [NSString stringWithFormat:@"SELECT %@ FROM %@", columns,tableString];
+            NSString *statement = [[GWMClassMetadata metadataForClass:[self class]] selectStatementWithTable:table];
             GWMDatabaseResult *result = [self.databaseController resultWithStatement:statement criteria:@[criteria] exclude:nil sortBy:nil ascending:YES limit:0 completion:nil];
             
             if (result.data.count > 0){
@@ -0,0 +1,200 @@
+//
+//  main.m
+//  GWMDatabaseTests
+//
+//  Created by Gregory Moore on 10/16/26.
+//  Copyright © 2026 Gregory Moore. All rights reserved.
+//
+//  Checks GWMDatabaseController against a scratch database and prints one line for every check. Exits with a
+//  non-zero status when a check fails. The database is written to a temporary file unless one is given:
+//
+//      GWMDatabaseTests -path /tmp/GWMDatabaseTests.sqlite
+//
+
+@import Foundation;
+#import <sqlite3.h>
+#import "GWMDatabaseController.h"
+#import "GWMDatabaseResult.h"
+#import "GWMChangeSet.h"
+#import "GWMDataItem.h"
+
+static GWMTableName const GWMTestNoteTable = @"notes";
+static GWMTableName const GWMTestTagTable = @"tags";
+
+/*!
+ * @class GWMTestNote
+ * @discussion A GWMDataItem with a search index on its name and description.
+ */
+@interface GWMTestNote : GWMDataItem
+
+@end
+
+@implementation GWMTestNote
+
++(NSString *)tableAlias
+{
+    return @"N";
+}
+
++(NSArray<GWMColumnName>*)searchableColumns
+{
+    return @[GWMTableColumnName, GWMTableColumnDescription];
+}
+
+@end
+
+/*!
+ * @class GWMTestTag
+ * @discussion A GWMDataItem without a search index, read into the identity map and the result cache while notes are written.
+ */
+@interface GWMTestTag : GWMDataItem
+
+@end
+
+@implementation GWMTestTag
+
++(NSString *)tableAlias
+{
+    return @"T";
+}
+
+@end
+
+#pragma mark - Checks
+
+static NSUInteger GWMTestFailureCount = 0;
+
+static void GWMTestExpect(BOOL condition, NSString *description)
+{
+    if (!condition)
+        GWMTestFailureCount++;
+    fprintf(stderr, "%s %s\n", condition ? "PASS" : "FAIL", description.UTF8String);
+}
+
+static NSString *GWMTestSelectStatement(Class itemClass, GWMTableName table)
+{
+    return [NSString stringWithFormat:@"SELECT %@ FROM %@ AS %@", [[itemClass tableColumns] componentsJoinedByString:@", "], table, [itemClass tableAlias]];
+}
+
+static BOOL GWMTestCreateDatabaseFile(NSString *path)
+{
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    for (NSString *suffix in @[@"-wal", @"-shm"])
+        [[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix] error:NULL];
+
+    sqlite3 *database = NULL;
+    int openCode = sqlite3_open_v2(path.UTF8String, &database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+    sqlite3_close(database);
+
+    return openCode == SQLITE_OK;
+}
+
+static NSDictionary<GWMColumnName,id> *GWMTestRowValues(NSString *name)
+{
+    return @{GWMTableColumnName: name, GWMTableColumnDescription: [NSString stringWithFormat:@"The %@ row", name]};
+}
+
+#pragma mark - Search Index Change Tracking
+
+/*
+ Writes to a table with a search index also write to the shadow tables of its FTS5 table through the triggers of the
+ index. Those writes must not be reported as changes, must not clear the identity map or the result cache, and the
+ rows of the table itself must all be reported, including when DELETE without a WHERE clause empties it.
+ */
+static void GWMTestSearchIndexWrites(GWMDatabaseController *controller)
+{
+    [controller insertIntoTable:GWMTestTagTable rows:@[GWMTestRowValues(@"red"), GWMTestRowValues(@"green")] chunkSize:0 completion:nil];
+    [controller insertIntoTable:GWMTestNoteTable rows:@[GWMTestRowValues(@"first"), GWMTestRowValues(@"second"), GWMTestRowValues(@"third")] chunkSize:0 completion:nil];
+
+    NSString *tagStatement = GWMTestSelectStatement([GWMTestTag class], GWMTestTagTable);
+    NSArray *tags = [controller resultWithStatement:tagStatement criteria:nil completion:nil].data;
+
+    GWMTestExpect(tags.count == 2, @"tags are read");
+
+    NSUInteger identityMapCount = controller.identityMapCount;
+    NSUInteger resultCacheInvalidations = controller.resultCacheInvalidations;
+
+    GWMTestExpect(identityMapCount == 2, @"tags are kept in the identity map");
+
+    dispatch_queue_t observerQueue = dispatch_queue_create("GWMDatabaseTests.changes", DISPATCH_QUEUE_SERIAL);
+    NSMutableArray<GWMChangeSet*> *changeSets = [NSMutableArray new];
+
+    id<NSObject> observer = [controller addChangeObserverForTables:nil queue:observerQueue block:^(GWMChangeSet *changeSet){
+        [changeSets addObject:changeSet];
+    }];
+
+    [controller insertIntoTable:GWMTestNoteTable values:GWMTestRowValues(@"fourth") completion:nil];
+    [controller updateTable:GWMTestNoteTable withValues:@{GWMTableColumnName: @"first again"} criteria:@{GWMTableColumnName: @"first"} completion:nil];
+
+    // change sets are delivered asynchronously on the serial queue
+    dispatch_sync(observerQueue, ^{});
+
+    GWMTestExpect(changeSets.count == 2, @"the insert and the update each publish a change set");
+    for (GWMChangeSet *changeSet in changeSets) {
+        GWMTestExpect(changeSet.isComplete, [NSString stringWithFormat:@"%@ is complete", changeSet]);
+        GWMTestExpect([changeSet.tables isEqualToArray:@[GWMTestNoteTable]], [NSString stringWithFormat:@"%@ only has the notes table", changeSet]);
+    }
+
+    GWMTestExpect(controller.identityMapCount == identityMapCount, @"writing notes keeps tags in the identity map");
+    GWMTestExpect(controller.resultCacheInvalidations == resultCacheInvalidations, @"writing notes keeps the result of the tag query");
+
+    NSUInteger resultCacheHits = controller.resultCacheHits;
+    [controller resultWithStatement:tagStatement criteria:nil completion:nil];
+    GWMTestExpect(controller.resultCacheHits == resultCacheHits + 1, @"the tag query is answered from the result cache");
+
+    [changeSets removeAllObjects];
+
+    NSInteger noteCount = [controller countOfRecordsFromTable:GWMTestNoteTable column:GWMTableColumnPkey criteria:nil];
+    [controller deleteFromTable:GWMTestNoteTable criteria:nil completion:nil];
+
+    dispatch_sync(observerQueue, ^{});
+
+    GWMChangeSet *deleteChangeSet = changeSets.firstObject;
+    GWMTestExpect(changeSets.count == 1 && deleteChangeSet.isComplete, @"deleting every note publishes a complete change set");
+    GWMTestExpect((NSInteger)[deleteChangeSet deletedRowIDsInTable:GWMTestNoteTable].count == noteCount, @"every deleted note is reported");
+    GWMTestExpect(controller.identityMapCount == identityMapCount, @"deleting every note keeps tags in the identity map");
+
+    [controller removeChangeObserver:observer];
+
+    __block NSError *dropError = nil;
+    [controller dropTableWithClassName:NSStringFromClass([GWMTestNote class]) schema:nil completion:^(NSError *_Nullable error){
+        dropError = error;
+    }];
+
+    GWMTestExpect(!dropError && ![[controller tablesWithSchema:nil] containsObject:GWMTestNoteTable], @"the notes table is dropped");
+}
+
+int main(int argc, const char * argv[])
+{
+    @autoreleasepool {
+
+        NSString *path = [[NSUserDefaults standardUserDefaults] stringForKey:@"path"] ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"GWMDatabaseTests.sqlite"];
+
+        if (!GWMTestCreateDatabaseFile(path)) {
+            fprintf(stderr, "Could not create the database at %s\n", path.UTF8String);
+            return 1;
+        }
+
+        GWMDatabaseController *controller = [GWMDatabaseController new];
+        controller.classToTableMapping = @{NSStringFromClass([GWMTestNote class]): GWMTestNoteTable,
+                                           NSStringFromClass([GWMTestTag class]): GWMTestTagTable};
+        controller.identityMapMemoryLimit = 1024 * 1024;
+        controller.resultCacheMemoryLimit = 1024 * 1024;
+
+        if ([controller openDatabaseAtPath:path] != GWMDBOperationDatabaseOpened) {
+            fprintf(stderr, "Could not open the database at %s\n", path.UTF8String);
+            return 1;
+        }
+
+        [controller createTableWithClassName:NSStringFromClass([GWMTestNote class]) schema:nil completion:nil];
+        [controller createTableWithClassName:NSStringFromClass([GWMTestTag class]) schema:nil completion:nil];
+
+        GWMTestSearchIndexWrites(controller);
+
+        [controller closeDatabase];
+
+        fprintf(stderr, "%lu failed\n", (unsigned long)GWMTestFailureCount);
+
+        return GWMTestFailureCount == 0 ? 0 : 1;
+    }
+}